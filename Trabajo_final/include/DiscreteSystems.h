@@ -10,6 +10,11 @@
  * - Clase base DiscreteSystem (y estructura Sample)
  * - TransferFunctionSystem (función de transferencia)
  * - StateSpaceSystem (espacio de estados)
+ * - Polynomial (utilidades de polinomios: raíces, producto)
+ * - StreamRecorder (grabación continua a disco)
+ * - Analysis (respuesta en frecuencia, impulso, escalón, polos y márgenes)
+ * - PartitionedConvolver (convolución FFT de FIR largos)
+ * - CheckpointWriter / CheckpointReader (instantáneas binarias del estado)
  * 
  * @example
  * #include <DiscreteSystems/DiscreteSystems.h>
@@ -29,5 +34,11 @@
 #include "DiscreteSystems/DiscreteSystem.h"
 #include "DiscreteSystems/TransferFunctionSystem.h"
 #include "DiscreteSystems/StateSpaceSystem.h"
+#include "DiscreteSystems/Polynomial.h"
+#include "DiscreteSystems/TransferFunctionBank.h"
+#include "DiscreteSystems/StreamRecorder.h"
+#include "DiscreteSystems/Analysis.h"
+#include "DiscreteSystems/Checkpoint.h"
+#include "DiscreteSystems/PartitionedConvolver.h"
 
 #endif // DISCRETESYSTEMS_H
@@ -0,0 +1,186 @@
+/**
+ * @file Analysis.h
+ * @brief Análisis sin simulación: respuesta en frecuencia, impulso, escalón, polos y márgenes
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ *
+ * Todas las funciones trabajan sobre los coeficientes de los sistemas
+ * (getNumerator()/getDenominator(), getA()...getD()): no crean objetos de
+ * simulación ni tocan su estado, buffer o k.
+ *
+ * Las frecuencias se dan en rad/s y se evalúan en z = e^{jωTs}, con Ts el
+ * período de muestreo del sistema; la de Nyquist es π/Ts.
+ */
+
+#ifndef DISCRETESYSTEMS_ANALYSIS_H
+#define DISCRETESYSTEMS_ANALYSIS_H
+
+#include "DiscreteSystems/StateSpaceSystem.h"
+#include "DiscreteSystems/TransferFunctionSystem.h"
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace DiscreteSystems {
+namespace Analysis {
+
+typedef std::complex<double> Complex;
+
+/**
+ * @brief n frecuencias equiespaciadas en escala logarítmica
+ * @param wMin Primera frecuencia [rad/s] (> 0)
+ * @param wMax Última frecuencia [rad/s] (>= wMin)
+ * @param n Número de puntos
+ * @return Rejilla de wMin a wMax, ambos incluidos
+ * @throws std::invalid_argument si wMin <= 0 o wMax < wMin
+ */
+std::vector<double> logspace(double wMin, double wMax, size_t n);
+
+/**
+ * @brief H(e^{jωTs}) = b(z^-1) / a(z^-1) en n frecuencias
+ *
+ * Horner vectorizado entre frecuencias: las frecuencias se procesan en
+ * bloques con las partes real e imaginaria en arrays separados, de modo que
+ * cada paso de Horner es un bucle sin dependencias sobre el bloque. Con
+ * threads != 1 la rejilla se reparte entre hilos (threads = 0: automático,
+ * un hilo por núcleo sólo si la rejilla es grande). El resultado no depende
+ * del número de hilos.
+ *
+ * @param b Numerador en potencias de z^-1
+ * @param a Denominador en potencias de z^-1
+ * @param Ts Período de muestreo [s]
+ * @param omega Frecuencias [rad/s]
+ * @param H Salida (n elementos)
+ * @param n Número de frecuencias
+ * @param threads Número de hilos (default: 0, automático)
+ */
+void frequencyResponse(const std::vector<double>& b, const std::vector<double>& a, double Ts,
+                       const double* omega, Complex* H, size_t n, unsigned threads = 0);
+
+/**
+ * @brief Respuesta en frecuencia de una función de transferencia
+ * @param sys Sistema (sólo se leen sus coeficientes)
+ * @param omega Frecuencias [rad/s]
+ * @param threads Número de hilos (default: 0, automático)
+ * @return H en cada frecuencia
+ */
+std::vector<Complex> frequencyResponse(const TransferFunctionSystem& sys, const std::vector<double>& omega,
+                                       unsigned threads = 0);
+
+/**
+ * @brief Respuesta en frecuencia de un sistema en espacio de estados
+ *
+ * H(z) = C (zI - A)^-1 B + D. A se reduce una vez a forma de Hessenberg con
+ * reflexiones de Householder (semejanza ortogonal) y cada frecuencia
+ * resuelve el sistema de Hessenberg en O(n²) en lugar de O(n³).
+ *
+ * @param sys Sistema (sólo se leen sus matrices)
+ * @param omega Frecuencias [rad/s]
+ * @param threads Número de hilos (default: 0, automático)
+ * @return H en cada frecuencia
+ */
+std::vector<Complex> frequencyResponse(const StateSpaceSystem& sys, const std::vector<double>& omega,
+                                       unsigned threads = 0);
+
+/**
+ * @struct Bode
+ * @brief Módulo y fase de una respuesta en frecuencia
+ */
+struct Bode {
+    std::vector<double> omega;        ///< Frecuencias [rad/s]
+    std::vector<double> magnitudeDb;  ///< 20·log10|H| [dB]
+    std::vector<double> phaseDeg;     ///< Fase desenrollada [grados]
+};
+
+/**
+ * @brief Módulo en dB y fase desenrollada (saltos de ±360° eliminados)
+ * @param omega Frecuencias [rad/s]
+ * @param H Respuesta en frecuencia en esas frecuencias
+ * @return Diagrama de Bode
+ * @throws InvalidDimensions si omega y H tienen tamaños distintos
+ */
+Bode bode(const std::vector<double>& omega, const std::vector<Complex>& H);
+
+/**
+ * @brief Respuesta al impulso h(0..N-1) de b(z^-1) / a(z^-1)
+ *
+ * Ecuación en diferencias directa sobre los coeficientes: O(N·(m+n)), sin
+ * error de truncamiento (a diferencia de invertir una FFT de H).
+ *
+ * @param b Numerador en potencias de z^-1
+ * @param a Denominador en potencias de z^-1 (a[0] != 0)
+ * @param N Longitud
+ * @throws InvalidCoefficients si a está vacío o a[0] == 0
+ */
+std::vector<double> impulse(const std::vector<double>& b, const std::vector<double>& a, size_t N);
+
+/**
+ * @brief Respuesta al escalón unitario de b(z^-1) / a(z^-1) (ver impulse())
+ */
+std::vector<double> step(const std::vector<double>& b, const std::vector<double>& a, size_t N);
+
+/** @name Impulso y escalón desde el estado nulo */
+///@{
+std::vector<double> impulse(const TransferFunctionSystem& sys, size_t N);
+std::vector<double> step(const TransferFunctionSystem& sys, size_t N);
+std::vector<double> impulse(const StateSpaceSystem& sys, size_t N);   ///< h(0) = D, h(k) = C A^(k-1) B
+std::vector<double> step(const StateSpaceSystem& sys, size_t N);
+///@}
+
+/**
+ * @brief Polos de b(z^-1) / a(z^-1) en el plano z
+ *
+ * Raíces de a leído en potencias de z (autovalores de su matriz compañera,
+ * Polynomial::roots()), con los polos en z = 0 que aporta un numerador de
+ * mayor grado. No se cancelan polos con ceros.
+ *
+ * @param b Numerador en potencias de z^-1
+ * @param a Denominador en potencias de z^-1
+ * @return max(m, n) polos
+ */
+std::vector<Complex> poles(const std::vector<double>& b, const std::vector<double>& a);
+
+/** @name Polos de un sistema */
+///@{
+std::vector<Complex> poles(const TransferFunctionSystem& sys);
+/** Autovalores de A por QR de Francis sobre su forma de Hessenberg (estable
+ *  hacia atrás, sin formar el polinomio característico). */
+std::vector<Complex> poles(const StateSpaceSystem& sys);
+///@}
+
+/**
+ * @brief Indica si todos los polos están estrictamente dentro del círculo unidad
+ */
+bool isStable(const std::vector<Complex>& poles);
+
+/**
+ * @struct Margins
+ * @brief Márgenes de estabilidad de un lazo abierto L(z)
+ *
+ * Si la curva no cruza, el margen correspondiente es infinito y su
+ * frecuencia NaN. Con varios cruces se da el más desfavorable.
+ */
+struct Margins {
+    double gainMargin;       ///< 1/|L| donde L es real negativo [veces]
+    double phaseCrossover;   ///< Frecuencia del margen de ganancia [rad/s]
+    double phaseMargin;      ///< 180° + ∠L donde |L| = 1 [grados]
+    double gainCrossover;    ///< Frecuencia del margen de fase [rad/s]
+};
+
+/**
+ * @brief Márgenes de ganancia y de fase de L(z) = b(z^-1) / a(z^-1)
+ *
+ * Busca los cruces en una rejilla logarítmica hasta la frecuencia de
+ * Nyquist y los refina por bisección evaluando L exactamente.
+ *
+ * @param b Numerador del lazo abierto en potencias de z^-1
+ * @param a Denominador del lazo abierto en potencias de z^-1
+ * @param Ts Período de muestreo [s]
+ * @param points Puntos de la rejilla de búsqueda (default: 4096)
+ */
+Margins margins(const std::vector<double>& b, const std::vector<double>& a, double Ts, size_t points = 4096);
+
+} // namespace Analysis
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_ANALYSIS_H
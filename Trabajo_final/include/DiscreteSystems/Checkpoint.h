@@ -0,0 +1,177 @@
+/**
+ * @file Checkpoint.h
+ * @brief Instantáneas binarias versionadas del estado de los bloques
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef DISCRETESYSTEMS_CHECKPOINT_H
+#define DISCRETESYSTEMS_CHECKPOINT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace DiscreteSystems {
+
+/**
+ * @brief Etiqueta de sección a partir de cuatro caracteres (p. ej. 'T', 'F', 'S', ' ')
+ */
+constexpr uint32_t checkpointTag(char a, char b, char c, char d) {
+    return static_cast<uint32_t>(static_cast<unsigned char>(a))
+         | static_cast<uint32_t>(static_cast<unsigned char>(b)) << 8
+         | static_cast<uint32_t>(static_cast<unsigned char>(c)) << 16
+         | static_cast<uint32_t>(static_cast<unsigned char>(d)) << 24;
+}
+
+/**
+ * @class CheckpointWriter
+ * @brief Serializa el estado de uno o más bloques en memoria
+ *
+ * Formato (little-endian): cabecera de 16 bytes ("DSCKP001", versión del
+ * contenedor y banderas) seguida de secciones. Cada sección es una
+ * cabecera {etiqueta u32, versión u32, bytes u64} y su contenido; las
+ * secciones se anidan (el lazo contiene a sus bloques). Todos los campos
+ * miden 8 bytes o son vectores {n u64, n valores} rellenados a múltiplo de
+ * 8, de modo que los datos quedan alineados en el fichero y un lector que
+ * lo proyecta con mmap los copia sin reinterpretar.
+ *
+ * Con buffers = false no se guardan los buffers de registro (historial de
+ * DiscreteSystem y de las señales): la instantánea y su restauración sólo
+ * cuestan lo que el estado dinámico, sin depender de bufferSize, y los
+ * buffers restaurados quedan vacíos con k intacto.
+ */
+class CheckpointWriter {
+public:
+    /**
+     * @brief Constructor
+     * @param buffers Guardar también los buffers de registro (default: true)
+     */
+    explicit CheckpointWriter(bool buffers = true);
+
+    /**
+     * @brief Abre una sección (se cierra con end())
+     * @param tag Etiqueta (checkpointTag())
+     * @param version Versión del contenido de la sección
+     */
+    void begin(uint32_t tag, uint32_t version);
+
+    /**
+     * @brief Cierra la última sección abierta
+     */
+    void end();
+
+    /** @name Campos */
+    ///@{
+    void writeU64(uint64_t v);
+    void writeF64(double v);
+    void writeArray(const double* p, std::size_t n);
+    void writeArray(const float* p, std::size_t n);
+    void writeArray(const std::vector<double>& v) { writeArray(v.data(), v.size()); }
+    void writeArray(const std::vector<float>& v) { writeArray(v.data(), v.size()); }
+    ///@}
+
+    /**
+     * @brief Escribe la instantánea en un fichero (se trunca)
+     * @throws CheckpointError si queda alguna sección abierta o el fichero no se puede escribir
+     */
+    void save(const std::string& path) const;
+
+    /** @name Getters */
+    ///@{
+    bool buffers() const { return buffers_; }
+    const std::vector<char>& data() const { return data_; }   ///< Instantánea completa
+    std::size_t size() const { return data_.size(); }          ///< Bytes
+    ///@}
+
+private:
+    void append(const void* p, std::size_t bytes);
+
+    bool buffers_;                    ///< Se guardan los buffers de registro
+    std::vector<char> data_;          ///< Cabecera y secciones
+    std::vector<std::size_t> open_;   ///< Desplazamiento de las secciones abiertas
+};
+
+/**
+ * @class CheckpointReader
+ * @brief Lee una instantánea de CheckpointWriter desde memoria o desde un fichero proyectado
+ *
+ * El constructor con ruta proyecta el fichero con mmap (sólo lectura): abrir
+ * no lee ni copia nada y cada restore() toca sólo las páginas de lo que
+ * restaura. Las secciones se leen en orden; begin() comprueba la etiqueta y
+ * la versión, y end() salta lo que quede de la sección, de modo que una
+ * versión posterior puede añadir campos al final.
+ */
+class CheckpointReader {
+public:
+    /**
+     * @brief Proyecta un fichero de instantánea
+     * @throws CheckpointError si no se puede abrir o la cabecera no es válida
+     */
+    explicit CheckpointReader(const std::string& path);
+
+    /**
+     * @brief Lee una instantánea en memoria (no se copia: debe seguir viva)
+     * @throws CheckpointError si la cabecera no es válida
+     */
+    CheckpointReader(const char* data, std::size_t size);
+
+    /**
+     * @brief Lee la instantánea de un escritor (que debe seguir vivo y sin cambios)
+     */
+    explicit CheckpointReader(const CheckpointWriter& writer);
+
+    /**
+     * @brief Entra en la siguiente sección
+     * @param tag Etiqueta esperada
+     * @param maxVersion Versión más reciente que entiende el llamador
+     * @return Versión de la sección
+     * @throws CheckpointError si la etiqueta no coincide, la versión es posterior o la sección está truncada
+     */
+    uint32_t begin(uint32_t tag, uint32_t maxVersion);
+
+    /**
+     * @brief Sale de la sección actual, saltando los campos no leídos
+     */
+    void end();
+
+    /** @name Campos (mismo orden que en la escritura) */
+    ///@{
+    uint64_t readU64();
+    double readF64();
+    void readArray(std::vector<double>& out);
+    void readArray(std::vector<float>& out);
+    /** Vector de exactamente n valores en dst */
+    void readArray(double* dst, std::size_t n);
+    ///@}
+
+    /**
+     * @brief Vuelve al principio (para restaurar la misma instantánea en otro objeto)
+     */
+    void rewind();
+
+    /** @name Getters */
+    ///@{
+    bool buffers() const { return buffers_; }      ///< La instantánea incluye los buffers de registro
+    bool mapped() const { return storage_ != nullptr; }
+    std::size_t size() const { return size_; }
+    ///@}
+
+private:
+    void open();
+    void need(std::size_t bytes) const;
+    uint64_t arrayLength(std::size_t bytesPerValue);
+
+    std::shared_ptr<const void> storage_;   ///< Proyección del fichero (nulo en memoria)
+    const char* base_;                      ///< Primer byte
+    std::size_t size_;                      ///< Bytes
+    std::size_t pos_;                       ///< Posición de lectura
+    bool buffers_;                          ///< Bandera de la cabecera
+    std::vector<std::size_t> ends_;         ///< Final de las secciones abiertas
+};
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_CHECKPOINT_H
@@ -8,6 +8,8 @@
 #ifndef DISCRETESYSTEMS_DISCRETESYSTEM_H
 #define DISCRETESYSTEMS_DISCRETESYSTEM_H
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include <iostream>
 #include <string>
@@ -17,20 +19,82 @@ namespace DiscreteSystems {
 /**
  * @struct Sample
  * @brief Representa una muestra del sistema con entrada, salida y paso temporal
+ *
+ * Es el formato de intercambio de snapshot() y readSince(); el buffer
+ * interno no lo almacena tal cual (ver RecordingPolicy).
  */
 struct Sample {
-    double in;    ///< Valor de entrada u(k)
+    double in;    ///< Valor de entrada u(k) (NaN si la política no registra la entrada)
     double out;   ///< Valor de salida y(k)
     int k;        ///< Índice temporal (paso k)
 };
 
+/**
+ * @enum RecordFields
+ * @brief Señales que se guardan en el buffer en cada next() / process()
+ */
+enum class RecordFields {
+    None,          ///< Sin registro: next() no toca el buffer
+    Output,        ///< Sólo y(k)
+    InputOutput    ///< u(k) e y(k)
+};
+
+/**
+ * @enum RecordPrecision
+ * @brief Tipo con el que se guardan las columnas del buffer
+ */
+enum class RecordPrecision {
+    Double,        ///< float64, exacto
+    Float          ///< float32, mitad de memoria (redondeo al leer o exportar)
+};
+
+/**
+ * @struct RecordingPolicy
+ * @brief Qué registra el buffer de un DiscreteSystem y con qué precisión
+ *
+ * El buffer se guarda por columnas (una por señal registrada) y k no se
+ * almacena: se deduce de la posición. Bytes por muestra:
+ * InputOutput/Double 16 (por defecto), Output/Double 8,
+ * InputOutput/Float 8, Output/Float 4 y None 0.
+ */
+struct RecordingPolicy {
+    RecordFields fields;          ///< Señales registradas
+    RecordPrecision precision;    ///< Precisión de almacenamiento
+
+    /**
+     * @brief Constructor (por defecto: u e y en double)
+     */
+    RecordingPolicy(RecordFields f = RecordFields::InputOutput,
+                    RecordPrecision p = RecordPrecision::Double)
+        : fields(f), precision(p) {}
+
+    /**
+     * @brief Bytes de buffer por muestra
+     */
+    size_t bytesPerSample() const {
+        const size_t columns = fields == RecordFields::None ? 0 : (fields == RecordFields::Output ? 1 : 2);
+        return columns * (precision == RecordPrecision::Double ? sizeof(double) : sizeof(float));
+    }
+};
+
+class StreamRecorder;
+class CheckpointWriter;
+class CheckpointReader;
+
 /**
  * @enum ExportFormat
  * @brief Formato de exportación del buffer de muestras
+ * 
+ * Los formatos binarios guardan tres columnas k, u(k), y(k) como bloques
+ * float64 little-endian consecutivos (orden por columnas), de modo que el
+ * buffer se vuelca sin formatear números.
  */
 enum class ExportFormat {
     TSV,      ///< Tab-Separated Values (compatible con MATLAB/Octave)
-    MATLAB    ///< Formato MATLAB con espacios y sintaxis load()
+    MATLAB,   ///< Formato MATLAB con espacios y sintaxis load()
+    RAW,      ///< Binario sin cabecera: bloques k, u, y de getCount() float64 cada uno
+    NPY,      ///< NumPy .npy: matriz (n, 3) '<f8' en orden Fortran (numpy.load)
+    MAT       ///< MATLAB Level-5 .mat: matriz `data` de n x 3 (load('fichero.mat'))
 };
 
 /**
@@ -41,8 +105,19 @@ enum class ExportFormat {
  * que todas las muestras se almacenan correctamente en el buffer
  * circular independientemente de la implementación concreta.
  * 
+ * El buffer admite un único escritor (el hilo que llama a next() /
+ * process() / reset()) y cualquier número de lectores concurrentes mediante
+ * snapshot() y readSince(). Los lectores nunca bloquean al escritor: éste
+ * anuncia en writing_ hasta qué secuencia va a escribir, escribe y publica
+ * en published_ (esquema seqlock). El lector copia y después descarta las
+ * muestras que el escritor pudo sobrescribir durante la copia.
+ * 
+ * El contenido del buffer lo decide la RecordingPolicy: columnas de u e y
+ * (SoA) en double o float, sólo y, o nada. El índice k de la muestra de
+ * secuencia s es s + kOffset_, de modo que no ocupa memoria.
+ * 
  * @invariant 0 <= count_ <= bufferSize_
- * @invariant 0 <= writeIndex_ < bufferSize_
+ * @invariant writeIndex_ == published_ % bufferSize_
  * @invariant k_ >= 0
  */
 class DiscreteSystem {
@@ -51,9 +126,21 @@ public:
      * @brief Constructor
      * @param Ts Período de muestreo (debe ser > 0)
      * @param bufferSize Tamaño del buffer circular (por defecto 100)
+     * @param recording Política de registro (por defecto u e y en double)
      * @throws InvalidSamplingTime si Ts <= 0
      */
-    DiscreteSystem(double Ts, size_t bufferSize = 100);
+    DiscreteSystem(double Ts, size_t bufferSize = 100, RecordingPolicy recording = RecordingPolicy());
+
+    /**
+     * @brief Constructor de copia (copia estado y buffer; no debe haber
+     *        escrituras concurrentes en el original)
+     */
+    DiscreteSystem(const DiscreteSystem& other);
+
+    /**
+     * @brief Asignación de copia (mismas condiciones que el constructor de copia)
+     */
+    DiscreteSystem& operator=(const DiscreteSystem& other);
 
     /**
      * @brief Destructor virtual
@@ -66,6 +153,7 @@ public:
      * Este método público no es virtual. Garantiza que:
      * 1. Se llama a compute(uk) para calcular la salida
      * 2. La muestra se almacena en el buffer mediante storeSample()
+     *    (salvo con RecordFields::None) y se envía al grabador, si lo hay
      * 3. El índice temporal k_ se incrementa
      * 
      * @param uk Entrada en el paso k
@@ -73,6 +161,53 @@ public:
      */
     double next(double uk);
 
+    /**
+     * @brief Procesa un bloque de n muestras (método NVI)
+     * 
+     * Equivalente a llamar n veces a next(), con resultados idénticos
+     * bit a bit, pero amortiza el coste por muestra:
+     * 1. Se llama una única vez a computeBlock(u, y, n)
+     * 2. El bloque se copia al buffer circular en uno o dos tramos
+     *    contiguos mediante storeBlock()
+     * 3. El índice temporal k_ avanza n pasos
+     * 
+     * @param u Entradas u(k), ..., u(k+n-1)
+     * @param y Salidas y(k), ..., y(k+n-1) (no debe solaparse con u)
+     * @param n Número de muestras del bloque
+     */
+    void process(const double* u, double* y, size_t n);
+
+    /**
+     * @brief Avanza steps pasos con la entrada constante u (método NVI)
+     * 
+     * Equivale a steps llamadas a next(u), salvo en el registro: los
+     * sistemas lineales lo resuelven con potencias de la matriz de
+     * transición en O(log steps) (ver computeHold()), y en el buffer y en el
+     * grabador sólo queda la última muestra. Si steps > 1 el buffer se vacía
+     * antes (como en reset(), pero sin tocar k ni el estado), porque las
+     * muestras intermedias no existen.
+     * 
+     * @param steps Pasos a avanzar (0: no hace nada y devuelve NaN)
+     * @param u Entrada mantenida
+     * @return Salida del último paso, y(k + steps - 1)
+     */
+    double advance(size_t steps, double u);
+
+    /**
+     * @brief Registra steps pasos en reposo sin calcularlos (método NVI)
+     * 
+     * Para tramos en los que el llamador sabe que el sistema está en un
+     * punto fijo (entrada u y salida y constantes): el estado no cambia y
+     * k avanza steps pasos. El buffer recibe min(steps, bufferSize) copias
+     * de (u, y) y el grabador un único registro de tramo mantenido (ver
+     * StreamRecorder::appendHold()).
+     * 
+     * @param steps Pasos en reposo
+     * @param u Entrada mantenida
+     * @param y Salida mantenida
+     */
+    void hold(size_t steps, double u, double y);
+
     /**
      * @brief Reinicia el sistema al estado inicial
      * 
@@ -84,13 +219,95 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Guarda el estado completo en una instantánea (método NVI)
+     * 
+     * Sección 'DSYS' con k, el estado del buffer circular (sus columnas
+     * sólo si w.buffers()) y, anidada, la sección del estado propio de la
+     * derivada (hook saveState()). No debe haber escrituras concurrentes.
+     * 
+     * @param w Instantánea de destino
+     * @throws CheckpointError si el sistema no admite instantáneas
+     */
+    void checkpoint(CheckpointWriter& w) const;
+
+    /**
+     * @brief Restaura el estado guardado por checkpoint() sin re-simular (método NVI)
+     * 
+     * El sistema debe tener el mismo período y la misma estructura que el
+     * guardado (los coeficientes no forman parte del estado y pueden
+     * diferir). Se restauran k, la política de registro y el buffer; si la
+     * instantánea no incluye los buffers, éste queda vacío. El grabador no
+     * cambia. No debe llamarse con lectores concurrentes.
+     * 
+     * @param r Instantánea, posicionada en la sección 'DSYS' del sistema
+     * @throws CheckpointError si la instantánea no corresponde a este sistema
+     */
+    void restore(CheckpointReader& r);
+
     /**
      * @brief Exporta el buffer de muestras a un stream
+     * 
+     * Los formatos de texto respetan la precisión y el modo (fixed,
+     * scientific o general) de os, y se formatean en un buffer intermedio
+     * que se escribe en bloques grandes. Para los binarios, os debe estar
+     * abierto en modo binario.
+     * 
      * @param os Stream de salida
-     * @param format Formato de exportación (TSV o MATLAB)
+     * @param format Formato de exportación
      */
     void bufferDump(std::ostream& os, ExportFormat format = ExportFormat::TSV) const;
 
+    /**
+     * @brief Exporta el buffer de muestras directamente a un fichero
+     * 
+     * Los formatos binarios reservan el fichero con su tamaño final, lo
+     * proyectan con mmap y trasponen el buffer circular sobre la proyección
+     * sin copias intermedias (con pwrite por bloques si mmap no es posible),
+     * sin pasar por iostream.
+     * 
+     * @param path Fichero de destino (se trunca)
+     * @param format Formato de exportación
+     * @throws ExportError si el fichero no se puede crear o escribir
+     */
+    void bufferDump(const std::string& path, ExportFormat format) const;
+
+    /**
+     * @brief Copia consistente de las últimas muestras, apta para otro hilo
+     * 
+     * Nunca bloquea al escritor ni reintenta: si durante la copia el
+     * escritor sobrescribe las muestras más antiguas, éstas se descartan y
+     * se devuelven menos. Las muestras devueltas son consecutivas y están
+     * ordenadas de la más antigua a la más reciente.
+     * 
+     * @param out Destino (al menos n elementos)
+     * @param n Número máximo de muestras
+     * @return Número de muestras copiadas
+     */
+    size_t snapshot(Sample* out, size_t n) const;
+
+    /**
+     * @brief Añade a out las muestras publicadas desde la secuencia cursor
+     * 
+     * Permite a un lector (p. ej. la UI) traer sólo los incrementos. El
+     * cursor es el número de secuencia de muestra, que crece con cada
+     * muestra almacenada y no vuelve a 0 con reset(). Es seguro frente a un
+     * escritor concurrente, con las mismas garantías que snapshot().
+     * 
+     * @param cursor Primera secuencia pedida (0 en la primera llamada)
+     * @param out Vector al que se añaden las muestras, en orden
+     * @param lost Si no es nulo, recibe el número de muestras pedidas que ya
+     *             no estaban disponibles (sobrescritas o anteriores a reset())
+     * @return Cursor para la siguiente llamada
+     */
+    uint64_t readSince(uint64_t cursor, std::vector<Sample>& out, uint64_t* lost = nullptr) const;
+
+    /**
+     * @brief Número de secuencia de la próxima muestra (seguro desde otro hilo)
+     * @return Muestras almacenadas desde la construcción
+     */
+    uint64_t getSequence() const { return published_.load(std::memory_order_acquire); }
+
     /**
      * @brief Obtiene el período de muestreo
      * @return Período de muestreo Ts
@@ -109,6 +326,34 @@ public:
      */
     size_t getCount() const { return count_; }
 
+    /**
+     * @brief Envía además cada muestra almacenada a un grabador continuo
+     * 
+     * El buffer circular sigue funcionando igual; el grabador recibe todas
+     * las muestras, sin el límite de bufferSize. No se adquiere la
+     * propiedad: el grabador debe vivir mientras esté conectado. Las copias
+     * del sistema no heredan el grabador.
+     * 
+     * @param recorder Grabador, o nullptr para desconectarlo
+     */
+    void setRecorder(StreamRecorder* recorder) { recorder_ = recorder; }
+
+    /**
+     * @brief Cambia la política de registro del buffer
+     * 
+     * Vacía el buffer (como reset(), pero sin tocar k ni el estado del
+     * sistema) y reserva las columnas nuevas. No debe llamarse con
+     * lectores concurrentes.
+     * 
+     * @param recording Nueva política
+     */
+    void setRecordingPolicy(RecordingPolicy recording);
+
+    /**
+     * @brief Obtiene la política de registro
+     */
+    RecordingPolicy getRecordingPolicy() const { return recording_; }
+
 protected:
     /**
      * @brief Calcula la salida del sistema (método virtual puro)
@@ -122,6 +367,32 @@ protected:
      */
     virtual double compute(double uk) = 0;
 
+    /**
+     * @brief Calcula la salida para un bloque de muestras (hook virtual)
+     * 
+     * La implementación por defecto llama a compute() para cada muestra.
+     * Las clases derivadas pueden sobrescribirlo con un bucle ajustado
+     * que mantenga el estado en variables locales, siempre que el
+     * resultado coincida exactamente con n llamadas a compute().
+     * 
+     * @param u Entradas del bloque
+     * @param y Salidas del bloque
+     * @param n Número de muestras
+     */
+    virtual void computeBlock(const double* u, double* y, size_t n);
+
+    /**
+     * @brief Avanza steps pasos con entrada constante (hook virtual)
+     * 
+     * La implementación por defecto llama steps veces a compute(u). Las
+     * clases lineales lo sobrescriben con un salto exacto salvo redondeo.
+     * 
+     * @param u Entrada mantenida
+     * @param steps Pasos (> 0)
+     * @return Salida del último paso
+     */
+    virtual double computeHold(double u, size_t steps);
+
     /**
      * @brief Reinicia el estado interno del sistema (hook virtual)
      * 
@@ -130,6 +401,25 @@ protected:
      */
     virtual void resetState() = 0;
 
+    /**
+     * @brief Guarda el estado interno en su propia sección (hook virtual)
+     * 
+     * La implementación por defecto lanza CheckpointError: las derivadas
+     * que admiten instantáneas lo sobrescriben junto con loadState().
+     * 
+     * @param w Instantánea de destino
+     */
+    virtual void saveState(CheckpointWriter& w) const;
+
+    /**
+     * @brief Restaura el estado interno guardado por saveState() (hook virtual)
+     * 
+     * Debe validar la sección antes de modificar el estado.
+     * 
+     * @param r Instantánea, posicionada en la sección de la derivada
+     */
+    virtual void loadState(CheckpointReader& r);
+
 private:
     /**
      * @brief Almacena una muestra en el buffer circular
@@ -142,12 +432,88 @@ private:
      */
     void storeSample(double uk, double yk);
 
+    /**
+     * @brief Almacena un bloque de muestras en el buffer circular
+     * @param u Entradas del bloque
+     * @param y Salidas del bloque
+     * @param n Número de muestras
+     * 
+     * Sólo se copian las últimas min(n, bufferSize_) muestras, en como
+     * máximo dos tramos contiguos (hasta el final del buffer y desde el
+     * principio), sin operación módulo por muestra.
+     */
+    void storeBlock(const double* u, const double* y, size_t n);
+
+    /**
+     * @brief Registra el final de un salto de steps pasos
+     * @param steps Pasos saltados desde k_
+     * @param held Muestras finales (u, y) a almacenar (<= bufferSize_)
+     * 
+     * Si held < steps el resto del salto no existe en el buffer: las
+     * muestras anteriores se descartan para que k siga siendo contiguo.
+     */
+    void storeJump(size_t steps, size_t held, double u, double y);
+
+    /**
+     * @brief Copia las secuencias [lo, hi) del buffer y valida la copia
+     * @param lo Primera secuencia
+     * @param hi Secuencia final (exclusiva), ya publicada
+     * @param out Destino (hi - lo elementos)
+     * @return Primera secuencia válida; las anteriores pudieron sobrescribirse
+     */
+    uint64_t copyRange(uint64_t lo, uint64_t hi, Sample* out) const;
+
+    /**
+     * @brief Muestras válidas en orden temporal como dos tramos contiguos
+     * @param start Posición del buffer donde empieza cada tramo
+     * @param len Longitud de cada tramo (len[0] + len[1] == count_)
+     * @return Índice k de la muestra más antigua
+     */
+    int64_t orderedSegments(size_t start[2], size_t len[2]) const;
+
+    /**
+     * @brief Reserva las columnas que pide recording_ (a cero)
+     */
+    void allocateColumns();
+
+    /**
+     * @brief Escribe n muestras en las columnas a partir de la posición start
+     */
+    void storeColumns(size_t start, const double* u, const double* y, size_t n);
+
+    /**
+     * @brief Reconstruye n muestras desde la posición start (k = k0, k0 + 1, ...)
+     */
+    void loadColumns(size_t start, size_t n, int64_t k0, Sample* out) const;
+
+    /**
+     * @brief Copia n valores de la columna c (0: k, 1: u, 2: y) en float64 little-endian
+     */
+    void exportColumn(int c, size_t start, size_t n, int64_t k0, double* dst) const;
+
+    /**
+     * @brief Entrega las columnas k, u, y una tras otra en bloques (binarios)
+     */
+    template <class Sink>
+    void writeColumns(Sink sink) const;
+
     double Ts_;                      ///< Período de muestreo
     int k_;                          ///< Índice temporal actual
     size_t bufferSize_;              ///< Tamaño del buffer
     size_t writeIndex_;              ///< Índice de escritura en el buffer circular
     size_t count_;                   ///< Número de muestras válidas (0 <= count_ <= bufferSize_)
-    std::vector<Sample> buffer_;     ///< Buffer circular de muestras
+    RecordingPolicy recording_;      ///< Qué se registra y con qué precisión
+    std::vector<double> in_;         ///< Columna u (InputOutput, Double)
+    std::vector<double> out_;        ///< Columna y (Double)
+    std::vector<float> inF_;         ///< Columna u (InputOutput, Float)
+    std::vector<float> outF_;        ///< Columna y (Float)
+
+    std::atomic<uint64_t> writing_;    ///< Secuencia hasta la que el escritor puede estar escribiendo
+    std::atomic<uint64_t> published_;  ///< Secuencias completamente escritas
+    std::atomic<uint64_t> resetMark_;  ///< Primera secuencia posterior al último reset()
+    std::atomic<int64_t> kOffset_;     ///< k de la muestra de secuencia s = s + kOffset_
+
+    StreamRecorder* recorder_;       ///< Grabador continuo (no propietario, puede ser nulo)
 };
 
 } // namespace DiscreteSystems
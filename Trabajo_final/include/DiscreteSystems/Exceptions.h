@@ -59,6 +59,39 @@ public:
         : std::invalid_argument(message) {}
 };
 
+/**
+ * @class ExportError
+ * @brief Excepción lanzada cuando no se puede escribir una exportación a fichero
+ * 
+ * Ejemplos: fichero no creable, disco lleno, fallo de mmap y de pwrite.
+ */
+class ExportError : public std::runtime_error {
+public:
+    /**
+     * @brief Constructor
+     * @param message Mensaje descriptivo del error
+     */
+    explicit ExportError(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+/**
+ * @class CheckpointError
+ * @brief Excepción lanzada al guardar o restaurar una instantánea de estado
+ * 
+ * Ejemplos: fichero truncado o de otro formato, sección de otro bloque,
+ * bloque con distinto orden o período que el guardado.
+ */
+class CheckpointError : public std::runtime_error {
+public:
+    /**
+     * @brief Constructor
+     * @param message Mensaje descriptivo del error
+     */
+    explicit CheckpointError(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
 } // namespace DiscreteSystems
 
 #endif // DISCRETESYSTEMS_EXCEPTIONS_H
@@ -0,0 +1,349 @@
+/**
+ * @file FixedSystems.h
+ * @brief Sistemas discretos de orden fijo en tiempo de compilación
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ *
+ * Núcleos header-only parametrizados por el orden del sistema:
+ * - FixedTransferFunction<M, N>: función de transferencia con coeficientes en std::array
+ * - StaticTransferFunction<Coefs>: función de transferencia con coeficientes constexpr
+ * - FixedStateSpace<N>: espacio de estados con matrices en std::array
+ * - FixedSystemAdapter<Kernel>: adapta cualquiera de ellos a la interfaz DiscreteSystem
+ *
+ * Los núcleos no son polimórficos: step() es inline y no virtual, y todos
+ * los bucles tienen cotas constantes, por lo que el compilador los desenrolla
+ * por completo para órdenes pequeños. Las operaciones se evalúan en el mismo
+ * orden que TransferFunctionSystem y StateSpaceSystem, de modo que los
+ * resultados son idénticos bit a bit a los de las clases dinámicas.
+ */
+
+#ifndef DISCRETESYSTEMS_FIXEDSYSTEMS_H
+#define DISCRETESYSTEMS_FIXEDSYSTEMS_H
+
+#include "DiscreteSystems/DiscreteSystem.h"
+#include "DiscreteSystems/Exceptions.h"
+
+#include <array>
+#include <cstddef>
+
+namespace DiscreteSystems {
+
+namespace detail {
+
+/**
+ * @brief Historiales de entrada y salida de tamaño fijo (registro de desplazamiento)
+ *
+ * Para órdenes pequeños el desplazamiento se resuelve en registros tras el
+ * desenrollado, por lo que no compensa un buffer circular.
+ */
+template <std::size_t M, std::size_t N>
+struct FixedHistory {
+    std::array<double, M + 1> u;        ///< [u(k), u(k-1), ..., u(k-M)]
+    std::array<double, (N > 0 ? N : 1)> y; ///< [y(k-1), ..., y(k-N)]
+
+    FixedHistory() { clear(); }
+
+    void clear() {
+        u.fill(0.0);
+        y.fill(0.0);
+    }
+
+    void pushInput(double uk) {
+        for (std::size_t i = M; i > 0; --i) {
+            u[i] = u[i - 1];
+        }
+        u[0] = uk;
+    }
+
+    void pushOutput(double yk) {
+        if (N == 0) {
+            return;
+        }
+        for (std::size_t i = N - 1; i > 0; --i) {
+            y[i] = y[i - 1];
+        }
+        y[0] = yk;
+    }
+};
+
+} // namespace detail
+
+/**
+ * @class FixedTransferFunction
+ * @brief Función de transferencia de orden fijo (numerador M, denominador N)
+ *
+ *         b[0] + b[1]*z^-1 + ... + b[M]*z^-M
+ * H(z) = ------------------------------------
+ *         a[0] + a[1]*z^-1 + ... + a[N]*z^-N
+ *
+ * @tparam M Orden del numerador (b tiene M+1 coeficientes)
+ * @tparam N Orden del denominador (a tiene N+1 coeficientes)
+ */
+template <std::size_t M, std::size_t N>
+class FixedTransferFunction {
+public:
+    static const std::size_t numeratorOrder = M;    ///< Orden del numerador
+    static const std::size_t denominatorOrder = N;  ///< Orden del denominador
+
+    /**
+     * @brief Constructor
+     * @param b Coeficientes del numerador [b0, ..., bM]
+     * @param a Coeficientes del denominador [a0, ..., aN]
+     * @throws InvalidCoefficients si a[0] == 0
+     * @note Los coeficientes se normalizan para que a[0] = 1
+     */
+    FixedTransferFunction(const std::array<double, M + 1>& b,
+                          const std::array<double, N + 1>& a)
+        : b_(), a_(), hist_()
+    {
+        if (a[0] == 0.0) {
+            throw InvalidCoefficients("FixedTransferFunction: a[0] debe ser distinto de 0 para permitir la normalización");
+        }
+        const double a0 = a[0];
+        for (std::size_t i = 0; i <= N; ++i) {
+            a_[i] = a[i] / a0;
+        }
+        for (std::size_t i = 0; i <= M; ++i) {
+            b_[i] = b[i] / a0;
+        }
+    }
+
+    /**
+     * @brief Calcula la siguiente salida (inline, sin despacho virtual)
+     * @param uk Entrada en el paso k
+     * @return Salida y(k)
+     */
+    double step(double uk) {
+        hist_.pushInput(uk);
+        double y_num = 0.0;
+        for (std::size_t i = 0; i <= M; ++i) {
+            y_num += b_[i] * hist_.u[i];
+        }
+        double y_den = 0.0;
+        for (std::size_t j = 1; j <= N; ++j) {
+            y_den += a_[j] * hist_.y[j - 1];
+        }
+        const double yk = y_num - y_den;
+        hist_.pushOutput(yk);
+        return yk;
+    }
+
+    /**
+     * @brief Procesa un bloque de muestras
+     * @param u Entradas
+     * @param y Salidas
+     * @param n Número de muestras
+     */
+    void process(const double* u, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            y[i] = step(u[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia los historiales a cero
+     */
+    void reset() { hist_.clear(); }
+
+    /** @name Getters */
+    ///@{
+    const std::array<double, M + 1>& getNumerator() const { return b_; }
+    const std::array<double, N + 1>& getDenominator() const { return a_; }
+    ///@}
+
+private:
+    std::array<double, M + 1> b_;       ///< Numerador normalizado
+    std::array<double, N + 1> a_;       ///< Denominador normalizado (a[0] = 1)
+    detail::FixedHistory<M, N> hist_;   ///< Historiales de entrada y salida
+};
+
+/**
+ * @class StaticTransferFunction
+ * @brief Función de transferencia con coeficientes conocidos en compilación
+ *
+ * Los coeficientes se toman de una clase de política Coefs con:
+ * - static const std::size_t M y N (órdenes)
+ * - static constexpr double b(std::size_t i) y a(std::size_t i)
+ *
+ * Al ser funciones constexpr, cada coeficiente se pliega como constante
+ * inmediata en el código generado: el objeto sólo almacena los historiales.
+ *
+ * @tparam Coefs Política de coeficientes
+ */
+template <class Coefs>
+class StaticTransferFunction {
+public:
+    static const std::size_t M = Coefs::M;  ///< Orden del numerador
+    static const std::size_t N = Coefs::N;  ///< Orden del denominador
+
+    /**
+     * @brief Calcula la siguiente salida (inline, sin despacho virtual)
+     * @param uk Entrada en el paso k
+     * @return Salida y(k)
+     */
+    double step(double uk) {
+        hist_.pushInput(uk);
+        double y_num = 0.0;
+        for (std::size_t i = 0; i <= M; ++i) {
+            y_num += (Coefs::b(i) / Coefs::a(0)) * hist_.u[i];
+        }
+        double y_den = 0.0;
+        for (std::size_t j = 1; j <= N; ++j) {
+            y_den += (Coefs::a(j) / Coefs::a(0)) * hist_.y[j - 1];
+        }
+        const double yk = y_num - y_den;
+        hist_.pushOutput(yk);
+        return yk;
+    }
+
+    /**
+     * @brief Procesa un bloque de muestras
+     * @param u Entradas
+     * @param y Salidas
+     * @param n Número de muestras
+     */
+    void process(const double* u, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            y[i] = step(u[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia los historiales a cero
+     */
+    void reset() { hist_.clear(); }
+
+private:
+    detail::FixedHistory<M, N> hist_;   ///< Historiales de entrada y salida
+};
+
+/**
+ * @class FixedStateSpace
+ * @brief Sistema en espacio de estados de orden fijo N
+ *
+ * x(k+1) = A*x(k) + B*u(k)
+ * y(k)   = C*x(k) + D*u(k)
+ *
+ * @tparam N Dimensión del estado
+ */
+template <std::size_t N>
+class FixedStateSpace {
+public:
+    typedef std::array<std::array<double, N>, N> Matrix;  ///< Matriz N×N por filas
+    typedef std::array<double, N> Vector;                 ///< Vector de tamaño N
+
+    /**
+     * @brief Constructor
+     * @param A Matriz de estado
+     * @param B Vector de entrada
+     * @param C Vector de salida
+     * @param D Ganancia directa
+     */
+    FixedStateSpace(const Matrix& A, const Vector& B, const Vector& C, double D)
+        : A_(A), B_(B), C_(C), D_(D), x_()
+    {
+        x_.fill(0.0);
+    }
+
+    /**
+     * @brief Calcula la siguiente salida y actualiza el estado
+     * @param uk Entrada en el paso k
+     * @return Salida y(k)
+     */
+    double step(double uk) {
+        double yk = 0.0;
+        for (std::size_t i = 0; i < N; ++i) {
+            yk += C_[i] * x_[i];
+        }
+        yk += D_ * uk;
+
+        Vector x_next;
+        for (std::size_t i = 0; i < N; ++i) {
+            double sum = 0.0;
+            for (std::size_t j = 0; j < N; ++j) {
+                sum += A_[i][j] * x_[j];
+            }
+            x_next[i] = sum + B_[i] * uk;
+        }
+        x_ = x_next;
+        return yk;
+    }
+
+    /**
+     * @brief Procesa un bloque de muestras
+     * @param u Entradas
+     * @param y Salidas
+     * @param n Número de muestras
+     */
+    void process(const double* u, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            y[i] = step(u[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia el estado a cero
+     */
+    void reset() { x_.fill(0.0); }
+
+    /**
+     * @brief Obtiene el vector de estado actual
+     * @return Referencia constante a x(k)
+     */
+    const Vector& getState() const { return x_; }
+
+private:
+    Matrix A_;     ///< Matriz de estado
+    Vector B_;     ///< Vector de entrada
+    Vector C_;     ///< Vector de salida
+    double D_;     ///< Ganancia directa
+    Vector x_;     ///< Estado actual
+};
+
+/**
+ * @class FixedSystemAdapter
+ * @brief Adapta un núcleo de orden fijo a la interfaz polimórfica DiscreteSystem
+ *
+ * Añade el buffer circular, el índice k y reset() de DiscreteSystem. Sólo
+ * hay una llamada virtual por muestra (o por bloque con process()); en
+ * bucles donde se conoce el tipo concreto conviene usar kernel().step().
+ *
+ * @tparam Kernel Núcleo con step(), process() y reset()
+ */
+template <class Kernel>
+class FixedSystemAdapter : public DiscreteSystem {
+public:
+    /**
+     * @brief Constructor
+     * @param kernel Núcleo a adaptar (se copia)
+     * @param Ts Período de muestreo (debe ser > 0)
+     * @param bufferSize Tamaño del buffer circular (por defecto 100)
+     * @param recording Política de registro del buffer
+     */
+    FixedSystemAdapter(const Kernel& kernel, double Ts, size_t bufferSize = 100,
+                       RecordingPolicy recording = RecordingPolicy())
+        : DiscreteSystem(Ts, bufferSize, recording), kernel_(kernel) {}
+
+    /**
+     * @brief Acceso al núcleo para llamadas sin despacho virtual
+     * @return Referencia al núcleo
+     */
+    Kernel& kernel() { return kernel_; }
+    const Kernel& kernel() const { return kernel_; }
+
+protected:
+    double compute(double uk) override { return kernel_.step(uk); }
+
+    void computeBlock(const double* u, double* y, size_t n) override {
+        kernel_.process(u, y, n);
+    }
+
+    void resetState() override { kernel_.reset(); }
+
+private:
+    Kernel kernel_;  ///< Núcleo de orden fijo
+};
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_FIXEDSYSTEMS_H
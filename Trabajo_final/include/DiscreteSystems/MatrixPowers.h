@@ -0,0 +1,65 @@
+/**
+ * @file MatrixPowers.h
+ * @brief Potencias de una matriz de transición con caché, para saltos de k pasos
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef DISCRETESYSTEMS_MATRIXPOWERS_H
+#define DISCRETESYSTEMS_MATRIXPOWERS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace DiscreteSystems {
+
+/**
+ * @class MatrixPowers
+ * @brief Aplica T^k a un vector mediante exponenciación binaria
+ *
+ * Guarda T^(2^j) para los j ya usados: la primera vez que se necesita un
+ * nivel cuesta un producto de matrices O(d³); después, aplicar T^k cuesta
+ * O(d² log k) (un producto matriz-vector por bit de k a 1). Las potencias de
+ * T conmutan, así que el orden de aplicación no importa.
+ *
+ * @invariant powers_[j] == T^(2^j), cada una d×d por filas
+ */
+class MatrixPowers {
+public:
+    /**
+     * @brief Caché vacía (dimensión 0): apply() no hace nada
+     */
+    MatrixPowers() : d_(0) {}
+
+    /**
+     * @brief Constructor
+     * @param T Matriz de transición d×d por filas
+     * @param d Dimensión
+     * @throws InvalidDimensions si T.size() != d*d
+     */
+    MatrixPowers(const std::vector<double>& T, size_t d);
+
+    /**
+     * @brief z <- T^k z
+     * @param k Exponente
+     * @param z Vector de d elementos (entrada y salida)
+     */
+    void apply(uint64_t k, double* z);
+
+    /** @name Getters */
+    ///@{
+    size_t dimension() const { return d_; }
+    size_t cachedLevels() const { return powers_.size(); }   ///< Potencias T^(2^j) calculadas
+    bool empty() const { return d_ == 0; }
+    ///@}
+
+private:
+    size_t d_;                                   ///< Dimensión
+    std::vector<std::vector<double> > powers_;   ///< T^(2^j)
+    std::vector<double> tmp_;                    ///< Vector auxiliar preasignado
+};
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_MATRIXPOWERS_H
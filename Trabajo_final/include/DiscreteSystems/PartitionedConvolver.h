@@ -0,0 +1,116 @@
+/**
+ * @file PartitionedConvolver.h
+ * @brief Convolución FFT uniformemente particionada (overlap-save) para FIR largos
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef DISCRETESYSTEMS_PARTITIONEDCONVOLVER_H
+#define DISCRETESYSTEMS_PARTITIONEDCONVOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+namespace DiscreteSystems {
+
+/**
+ * @class PartitionedConvolver
+ * @brief y = h * x por bloques de P muestras con FFT de tamaño 2P
+ *
+ * El filtro se parte en K = ceil(len(h) / P) tramos de P coeficientes, cuyos
+ * espectros se calculan una vez. Cada bloque de entrada se transforma junto
+ * con el anterior (overlap-save) y se guarda en una línea de retardo
+ * frecuencial de K espectros; la salida del bloque es la IFFT de
+ * Σ H_k X_{j-k}. El coste por bloque es fijo (dos FFT reales de 2P puntos
+ * más K productos de P + 1 bins), de modo que la latencia de cálculo está
+ * acotada por P y no por la longitud del filtro.
+ *
+ * Las salidas coinciden con la convolución lineal salvo redondeo de la FFT:
+ * |error| ≲ 1e-15 · log2(2P) · Σ|h| · max|x|.
+ *
+ * @invariant P es potencia de dos (>= 2)
+ * @invariant Hre_.size() == Xre_.size() == K * (P + 1)
+ */
+class PartitionedConvolver {
+public:
+    /**
+     * @brief Convolucionador vacío (partitionSize() == 0)
+     */
+    PartitionedConvolver() : P_(0), K_(0), head_(0) {}
+
+    /**
+     * @brief Constructor
+     * @param h Respuesta al impulso (no vacía)
+     * @param partition Tamaño de partición P (potencia de dos >= 2)
+     * @throws InvalidDimensions si h está vacío o P no es potencia de dos >= 2
+     */
+    PartitionedConvolver(const std::vector<double>& h, size_t partition);
+
+    /**
+     * @brief Convoluciona un bloque de P muestras
+     * @param x Entradas (P muestras)
+     * @param y Salidas (P muestras; puede coincidir con x)
+     */
+    void process(const double* x, double* y);
+
+    /**
+     * @brief Reconstruye la línea de retardo a partir de las entradas pasadas
+     *
+     * Deja el estado como si se hubieran procesado esas entradas, para
+     * retomar la convolución tras haber avanzado por otro camino.
+     *
+     * @param past Las últimas K·P entradas, de la más antigua a la más reciente
+     */
+    void prime(const double* past);
+
+    /**
+     * @brief Vacía la línea de retardo (entradas pasadas nulas)
+     */
+    void reset();
+
+    /** @name Getters */
+    ///@{
+    size_t partitionSize() const { return P_; }
+    size_t partitions() const { return K_; }
+    bool empty() const { return P_ == 0; }
+    ///@}
+
+private:
+    /**
+     * @brief FFT compleja in situ de P puntos, partes real e imaginaria separadas
+     * @param inverse true para la transformada inversa (sin escalar)
+     */
+    void fft(double* re, double* im, bool inverse) const;
+
+    /**
+     * @brief Espectro (bins 0..P) de 2P muestras reales mediante una FFT compleja de P puntos
+     */
+    void forward(const double* x, double* re, double* im);
+
+    /**
+     * @brief 2P muestras reales a partir de los bins 0..P (escala incluida en H)
+     */
+    void inverse(const double* re, const double* im, double* x);
+
+    /**
+     * @brief Transforma [last_, x] en el siguiente hueco de la línea de retardo
+     */
+    void pushSpectrum(const double* x);
+
+    size_t P_;                      ///< Tamaño de partición (muestras por bloque)
+    size_t K_;                      ///< Número de particiones
+    size_t head_;                   ///< Hueco del espectro más reciente
+    std::vector<double> Hre_, Him_; ///< Espectros de las particiones (escalados por 1/P)
+    std::vector<double> Xre_, Xim_; ///< Línea de retardo frecuencial
+    std::vector<double> last_;      ///< Bloque de entrada anterior
+    std::vector<double> frame_;     ///< 2P muestras de trabajo
+    std::vector<double> accRe_, accIm_; ///< Acumulador Σ H_k X_{j-k}
+    std::vector<double> zr_, zi_;   ///< FFT compleja de P puntos
+    std::vector<double> twr_, twi_; ///< e^{-j2πt/P}, t < P/2
+    std::vector<double> splitR_, splitI_; ///< e^{-j2πk/2P}, k <= P
+    std::vector<size_t> rev_;       ///< Permutación de inversión de bits
+};
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_PARTITIONEDCONVOLVER_H
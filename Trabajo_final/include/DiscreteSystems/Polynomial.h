@@ -0,0 +1,76 @@
+/**
+ * @file Polynomial.h
+ * @brief Utilidades de polinomios con coeficientes reales
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ *
+ * Los polinomios se representan como vectores de coeficientes en potencias
+ * descendentes: p = [p0, p1, ..., pn] representa p0*x^n + p1*x^(n-1) + ... + pn.
+ * Es la misma disposición que los vectores b y a de TransferFunctionSystem
+ * leídos en potencias de z (tras multiplicar por z^n).
+ */
+
+#ifndef DISCRETESYSTEMS_POLYNOMIAL_H
+#define DISCRETESYSTEMS_POLYNOMIAL_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace DiscreteSystems {
+namespace Polynomial {
+
+/**
+ * @brief Evalúa el polinomio en un punto complejo mediante Horner
+ * @param p Coeficientes en potencias descendentes
+ * @param x Punto de evaluación
+ * @return p(x)
+ */
+std::complex<double> evaluate(const std::vector<double>& p, std::complex<double> x);
+
+/**
+ * @brief Producto de dos polinomios (convolución de coeficientes)
+ * @param p Primer factor
+ * @param q Segundo factor
+ * @return p * q (tamaño p.size() + q.size() - 1; vacío si algún factor lo es)
+ */
+std::vector<double> multiply(const std::vector<double>& p, const std::vector<double>& q);
+
+/**
+ * @brief Autovalores de una matriz de Hessenberg superior real
+ *
+ * Equilibra la matriz y aplica el QR de Francis con desplazamiento doble.
+ * Es estable hacia atrás: los autovalores son exactos para una matriz a
+ * distancia O(eps·||H||). Los complejos salen en pares conjugados exactos
+ * (el de parte imaginaria positiva primero) y los reales con parte
+ * imaginaria nula.
+ *
+ * @param H Matriz n x n por filas (nula bajo la subdiagonal)
+ * @param n Orden
+ * @return n autovalores
+ * @throws std::runtime_error si el QR no converge
+ */
+std::vector<std::complex<double>> hessenbergEigenvalues(std::vector<double> H, size_t n);
+
+/**
+ * @brief Calcula todas las raíces del polinomio (autovalores de la compañera)
+ *
+ * Las raíces son los autovalores de la matriz compañera equilibrada
+ * (hessenbergEigenvalues()), de modo que el polinomio reconstruido a partir
+ * de ellas difiere del original en O(eps) relativo a sus coeficientes, sea
+ * cual sea el orden o la multiplicidad de las raíces. Las raíces múltiples
+ * se devuelven dispersas en la medida que fija su condicionamiento.
+ *
+ * Los coeficientes nulos iniciales se ignoran; los nulos finales producen
+ * raíces exactamente en 0. Las raíces complejas se devuelven en pares
+ * conjugados exactos y las reales con parte imaginaria nula.
+ *
+ * @param p Coeficientes en potencias descendentes
+ * @return Raíces (tantas como el grado efectivo del polinomio)
+ */
+std::vector<std::complex<double>> roots(const std::vector<double>& p);
+
+} // namespace Polynomial
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_POLYNOMIAL_H
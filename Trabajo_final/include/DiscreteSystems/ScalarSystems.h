@@ -0,0 +1,470 @@
+/**
+ * @file ScalarSystems.h
+ * @brief Tipos escalares (float, punto fijo Q15/Q31) y núcleos parametrizados por el tipo
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ *
+ * Contenido:
+ * - Fixed<Storage, Frac, Overflow, Rounding>: palabra de punto fijo con
+ *   políticas explícitas de desbordamiento y redondeo; Q15 y Q31
+ * - ScalarTraits<T>: tipo de coeficiente, acumulador y conversiones de T
+ * - BasicTransferFunction<T>: función de transferencia en forma directa I
+ *   con muestras, coeficientes e historiales de tipo T
+ * - ReferenceCheck<Kernel, Reference>: ejecuta un núcleo junto a su
+ *   referencia en double y mide la desviación máxima
+ *
+ * Con T = double las operaciones se evalúan en el mismo orden que
+ * TransferFunctionSystem, de modo que BasicTransferFunction<double> es
+ * idéntico bit a bit a la clase dinámica.
+ *
+ * En punto fijo las muestras son fracciones en [-1, 1) y los coeficientes
+ * se guardan en int32_t con CoefFrac bits fraccionarios (rango ±2^(31-CoefFrac)).
+ * Los productos se acumulan en int64_t sin redondeo intermedio y el
+ * resultado se redondea y se satura (o se envuelve) una sola vez por salida.
+ */
+
+#ifndef DISCRETESYSTEMS_SCALARSYSTEMS_H
+#define DISCRETESYSTEMS_SCALARSYSTEMS_H
+
+#include "DiscreteSystems/Exceptions.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace DiscreteSystems {
+
+/**
+ * @enum Overflow
+ * @brief Tratamiento de los valores fuera del rango de la palabra de punto fijo
+ */
+enum class Overflow {
+    Saturate,   ///< Se recortan al máximo o al mínimo representable
+    Wrap        ///< Se envuelven en complemento a dos (aritmética modular)
+};
+
+/**
+ * @enum Rounding
+ * @brief Redondeo al descartar bits fraccionarios
+ */
+enum class Rounding {
+    Nearest,    ///< Al más cercano (los empates hacia +infinito)
+    Truncate    ///< Hacia -infinito (desplazamiento aritmético)
+};
+
+/**
+ * @struct Fixed
+ * @brief Palabra de punto fijo con signo: valor = raw / 2^Frac
+ *
+ * Sólo almacena la palabra; la aritmética la hace ScalarTraits con las
+ * políticas del tipo.
+ *
+ * @tparam Storage Entero con signo de la palabra (int16_t, int32_t)
+ * @tparam Frac Bits fraccionarios
+ * @tparam O Política de desbordamiento
+ * @tparam R Política de redondeo
+ */
+template <class Storage, int Frac, Overflow O = Overflow::Saturate, Rounding R = Rounding::Nearest>
+struct Fixed {
+    typedef Storage StorageType;                      ///< Entero de la palabra
+    static const int fractionalBits = Frac;           ///< Bits fraccionarios
+    static const Overflow overflow = O;               ///< Política de desbordamiento
+    static const Rounding rounding = R;               ///< Política de redondeo
+
+    Storage raw;   ///< Palabra
+
+    /**
+     * @brief Construye a partir de la palabra
+     */
+    static Fixed fromRaw(Storage r) {
+        Fixed f;
+        f.raw = r;
+        return f;
+    }
+};
+
+typedef Fixed<int16_t, 15> Q15;   ///< Palabra de 16 bits en [-1, 1), paso 2^-15
+typedef Fixed<int32_t, 31> Q31;   ///< Palabra de 32 bits en [-1, 1), paso 2^-31
+
+/**
+ * @struct FloatTraits
+ * @brief Rasgos de un tipo de coma flotante
+ * @tparam T float o double
+ * @tparam A Acumulador (p. ej. double para muestras float)
+ */
+template <class T, class A = T>
+struct FloatTraits {
+    typedef T Value;   ///< Muestra
+    typedef T Coef;    ///< Coeficiente
+    typedef A Acc;     ///< Acumulador de productos
+
+    static Coef coef(double c) { return static_cast<Coef>(c); }
+    static Value fromDouble(double x) { return static_cast<Value>(x); }
+    static double toDouble(Value v) { return static_cast<double>(v); }
+    static Acc zero() { return Acc(0); }
+    static Acc widen(Value v) { return static_cast<Acc>(v); }
+    static Acc mac(Acc acc, Coef c, Value v) { return acc + static_cast<Acc>(c) * static_cast<Acc>(v); }
+    static Value narrow(Acc acc) { return static_cast<Value>(acc); }
+};
+
+/**
+ * @struct FixedTraits
+ * @brief Rasgos de una palabra de punto fijo
+ *
+ * Las muestras se acumulan con Frac + CoefFrac bits fraccionarios. Para L
+ * productos con |coeficiente| <= C, Q31 admite L·C < 2^(32 - CoefFrac) sin
+ * desbordar el acumulador (L·C < 32 con el valor por defecto, ±16 por
+ * coeficiente); Q15 tiene 16 bits más de margen. En Q31 la resolución de
+ * los coeficientes (2^-27) domina sobre el redondeo de las muestras.
+ *
+ * @tparam F Fixed<...>
+ * @tparam CoefFrac Bits fraccionarios de los coeficientes (int32_t)
+ */
+template <class F, int CoefFrac = (sizeof(typename F::StorageType) <= 2 ? 28 : 27)>
+struct FixedTraits {
+    typedef F Value;         ///< Muestra
+    typedef int32_t Coef;    ///< Coeficiente con CoefFrac bits fraccionarios
+    typedef int64_t Acc;     ///< Acumulador de productos
+    typedef typename F::StorageType Storage;
+
+    static const int coefFractionalBits = CoefFrac;   ///< Bits fraccionarios de los coeficientes
+
+    /**
+     * @brief Cuantiza un coeficiente
+     * @throws InvalidCoefficients si no es representable con CoefFrac bits fraccionarios
+     */
+    static Coef coef(double c) {
+        const double scaled = roundScaled(c, CoefFrac);
+        if (!(scaled >= -2147483648.0 && scaled <= 2147483647.0)) {
+            throw InvalidCoefficients("FixedTraits: coeficiente fuera del rango representable");
+        }
+        return static_cast<Coef>(scaled);
+    }
+
+    /**
+     * @brief Cuantiza una muestra con las políticas del tipo (NaN se convierte en 0)
+     */
+    static Value fromDouble(double x) {
+        if (x != x) {
+            return Value::fromRaw(0);
+        }
+        const double scaled = roundScaled(x, F::fractionalBits);
+        const double lo = static_cast<double>(std::numeric_limits<Storage>::min());
+        const double hi = static_cast<double>(std::numeric_limits<Storage>::max());
+        if (F::overflow == Overflow::Saturate || !(std::fabs(scaled) < 9.0e18)) {
+            return Value::fromRaw(static_cast<Storage>(scaled < lo ? lo : scaled > hi ? hi : scaled));
+        }
+        return wrap(static_cast<int64_t>(scaled));
+    }
+
+    static double toDouble(Value v) { return std::ldexp(static_cast<double>(v.raw), -F::fractionalBits); }
+    static Acc zero() { return 0; }
+    static Acc widen(Value v) { return static_cast<Acc>(v.raw) * (static_cast<Acc>(1) << CoefFrac); }
+    static Acc mac(Acc acc, Coef c, Value v) { return acc + static_cast<Acc>(c) * static_cast<Acc>(v.raw); }
+
+    /**
+     * @brief Descarta los CoefFrac bits sobrantes y ajusta a la palabra
+     */
+    static Value narrow(Acc acc) {
+        // Desplazamiento aritmético de enteros negativos: definido por la
+        // implementación en C++11, aritmético en GCC y Clang
+        if (F::rounding == Rounding::Nearest) {
+            acc += static_cast<Acc>(1) << (CoefFrac - 1);
+        }
+        const Acc v = acc >> CoefFrac;
+        if (F::overflow == Overflow::Saturate) {
+            const Acc lo = std::numeric_limits<Storage>::min();
+            const Acc hi = std::numeric_limits<Storage>::max();
+            return Value::fromRaw(static_cast<Storage>(v < lo ? lo : v > hi ? hi : v));
+        }
+        return wrap(v);
+    }
+
+private:
+    static double roundScaled(double x, int bits) {
+        const double s = std::ldexp(x, bits);
+        return F::rounding == Rounding::Nearest ? std::floor(s + 0.5) : std::floor(s);
+    }
+
+    static Value wrap(int64_t v) {
+        // Reducción módulo 2^bits; la conversión a Storage es la del complemento a dos
+        const int bits = static_cast<int>(sizeof(Storage)) * 8;
+        const uint64_t mask = (bits >= 64) ? ~static_cast<uint64_t>(0) : ((static_cast<uint64_t>(1) << bits) - 1);
+        const uint64_t u = static_cast<uint64_t>(v) & mask;
+        const int64_t s = (u >> (bits - 1)) ? static_cast<int64_t>(u) - static_cast<int64_t>(mask) - 1
+                                            : static_cast<int64_t>(u);
+        return Value::fromRaw(static_cast<Storage>(s));
+    }
+};
+
+/**
+ * @struct ScalarTraits
+ * @brief Rasgos por defecto de cada tipo de muestra
+ *
+ * float acumula en float; para acumular en double usar
+ * FloatTraits<float, double> como segundo parámetro de los núcleos.
+ */
+template <class T>
+struct ScalarTraits;
+
+template <>
+struct ScalarTraits<double> : FloatTraits<double> {};
+
+template <>
+struct ScalarTraits<float> : FloatTraits<float> {};
+
+template <class Storage, int Frac, Overflow O, Rounding R>
+struct ScalarTraits<Fixed<Storage, Frac, O, R> > : FixedTraits<Fixed<Storage, Frac, O, R> > {};
+
+/**
+ * @class BasicTransferFunction
+ * @brief Función de transferencia de orden arbitrario sobre el tipo T
+ *
+ * Misma ecuación y misma forma directa I con historiales espejo que
+ * TransferFunctionSystem (modo DirectForm), sin buffer de registro ni
+ * despacho virtual. Los coeficientes se normalizan en double y después se
+ * cuantizan con Traits::coef().
+ *
+ * @tparam T Tipo de las muestras (double, float, Q15, Q31)
+ * @tparam Tr Rasgos del tipo (por defecto ScalarTraits<T>)
+ */
+template <class T, class Tr = ScalarTraits<T> >
+class BasicTransferFunction {
+public:
+    typedef Tr Traits;                        ///< Rasgos del tipo
+    typedef typename Traits::Value Value;     ///< Muestra
+    typedef typename Traits::Coef Coef;       ///< Coeficiente
+    typedef typename Traits::Acc Acc;         ///< Acumulador
+
+    /**
+     * @brief Constructor
+     * @param b Coeficientes del numerador [b0, ..., bm]
+     * @param a Coeficientes del denominador [a0, ..., an]
+     * @throws InvalidCoefficients si a o b están vacíos, a[0] == 0 o algún
+     *         coeficiente normalizado no es representable en Coef
+     */
+    BasicTransferFunction(const std::vector<double>& b, const std::vector<double>& a)
+        : uPos_(0), yPos_(0)
+    {
+        if (a.empty() || b.empty()) {
+            throw InvalidCoefficients("BasicTransferFunction: los vectores de coeficientes no pueden estar vacíos");
+        }
+        if (a[0] == 0.0) {
+            throw InvalidCoefficients("BasicTransferFunction: a[0] debe ser distinto de 0 para permitir la normalización");
+        }
+        for (std::size_t i = 0; i < b.size(); ++i) {
+            b_.push_back(Traits::coef(b[i] / a[0]));
+        }
+        for (std::size_t i = 0; i < a.size(); ++i) {
+            a_.push_back(Traits::coef(a[i] / a[0]));
+        }
+        uHist_.resize(2 * b_.size());
+        yHist_.resize(2 * (a_.size() - 1));
+        reset();
+    }
+
+    /**
+     * @brief Calcula la siguiente salida (inline, sin despacho virtual)
+     * @param uk Entrada en el paso k
+     * @return Salida y(k)
+     */
+    Value step(Value uk) {
+        const std::size_t Lu = b_.size();
+        uPos_ = (uPos_ == 0 ? Lu : uPos_) - 1;
+        uHist_[uPos_] = uk;
+        uHist_[uPos_ + Lu] = uk;
+        const Value* uw = &uHist_[uPos_];
+
+        Acc y_num = Traits::zero();
+        for (std::size_t i = 0; i < Lu; ++i) {
+            y_num = Traits::mac(y_num, b_[i], uw[i]);
+        }
+        const std::size_t Ly = a_.size() - 1;
+        Acc y_den = Traits::zero();
+        if (Ly > 0) {
+            const Value* yw = &yHist_[yPos_];
+            for (std::size_t j = 1; j <= Ly; ++j) {
+                y_den = Traits::mac(y_den, a_[j], yw[j - 1]);
+            }
+        }
+        const Value yk = Traits::narrow(y_num - y_den);
+
+        if (Ly > 0) {
+            yPos_ = (yPos_ == 0 ? Ly : yPos_) - 1;
+            yHist_[yPos_] = yk;
+            yHist_[yPos_ + Ly] = yk;
+        }
+        return yk;
+    }
+
+    /**
+     * @brief Procesa un bloque de muestras
+     * @param u Entradas
+     * @param y Salidas
+     * @param n Número de muestras
+     */
+    void process(const Value* u, Value* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            y[i] = step(u[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia los historiales a cero
+     */
+    void reset() {
+        const Value zero = Traits::fromDouble(0.0);
+        for (std::size_t i = 0; i < uHist_.size(); ++i) {
+            uHist_[i] = zero;
+        }
+        for (std::size_t i = 0; i < yHist_.size(); ++i) {
+            yHist_[i] = zero;
+        }
+        uPos_ = 0;
+        yPos_ = 0;
+    }
+
+    /** @name Getters */
+    ///@{
+    const std::vector<Coef>& getNumerator() const { return b_; }
+    const std::vector<Coef>& getDenominator() const { return a_; }
+    ///@}
+
+private:
+    std::vector<Coef> b_;        ///< Numerador normalizado y cuantizado
+    std::vector<Coef> a_;        ///< Denominador normalizado y cuantizado (a[0] = 1)
+    std::vector<Value> uHist_;   ///< Historial espejo de entradas
+    std::vector<Value> yHist_;   ///< Historial espejo de salidas
+    std::size_t uPos_;           ///< Inicio de la ventana de entradas
+    std::size_t yPos_;           ///< Inicio de la ventana de salidas
+};
+
+/**
+ * @struct Deviation
+ * @brief Desviación de un núcleo frente a su referencia en double
+ */
+struct Deviation {
+    double maxAbs;         ///< max |y - y_ref|
+    double rms;            ///< sqrt(media de (y - y_ref)^2)
+    std::size_t argMax;    ///< Muestra donde se alcanza maxAbs
+    std::size_t samples;   ///< Muestras comparadas
+};
+
+/**
+ * @class ReferenceCheck
+ * @brief Modo de validación: avanza un núcleo y su referencia con la misma entrada
+ *
+ * step(double) cuantiza la entrada con Kernel::Traits, avanza ambos y
+ * devuelve la salida del núcleo en double, de modo que puede ocupar el
+ * lugar del bloque en un Lazo::LoopRunner. La referencia recibe la entrada
+ * sin cuantizar: la desviación incluye el error de cuantización de la
+ * entrada, de los coeficientes y del redondeo interno.
+ *
+ * @tparam Kernel Núcleo con Traits, step(Value) y reset() (BasicTransferFunction, Controlador::BasicPID)
+ * @tparam Reference Bloque en double con step(double) (p. ej. el mismo núcleo con T = double)
+ */
+template <class Kernel, class Reference>
+class ReferenceCheck {
+public:
+    typedef typename Kernel::Traits Traits;   ///< Rasgos del núcleo
+
+    ReferenceCheck(const Kernel& kernel, const Reference& reference)
+        : kernel_(kernel), reference_(reference) {
+        clearDeviation();
+    }
+
+    /**
+     * @brief Avanza núcleo y referencia y acumula la desviación
+     * @param uk Entrada en double
+     * @return Salida del núcleo convertida a double
+     */
+    double step(double uk) {
+        const double y = Traits::toDouble(kernel_.step(Traits::fromDouble(uk)));
+        const double d = std::fabs(y - reference_.step(uk));
+        if (!(d <= maxAbs_)) {
+            maxAbs_ = d;
+            argMax_ = n_;
+        }
+        sumSq_ += d * d;
+        ++n_;
+        return y;
+    }
+
+    /**
+     * @brief Procesa un bloque de muestras en double
+     */
+    void process(const double* u, double* y, std::size_t n) {
+        for (std::size_t i = 0; i < n; ++i) {
+            y[i] = step(u[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia núcleo y referencia; la desviación acumulada se conserva
+     */
+    void reset() {
+        kernel_.reset();
+        reference_.reset();
+    }
+
+    /**
+     * @brief Borra la desviación acumulada
+     */
+    void clearDeviation() {
+        maxAbs_ = 0.0;
+        sumSq_ = 0.0;
+        argMax_ = 0;
+        n_ = 0;
+    }
+
+    /**
+     * @brief Desviación desde la construcción o desde clearDeviation()
+     */
+    Deviation deviation() const {
+        Deviation d;
+        d.maxAbs = maxAbs_;
+        d.rms = n_ ? std::sqrt(sumSq_ / static_cast<double>(n_)) : 0.0;
+        d.argMax = argMax_;
+        d.samples = n_;
+        return d;
+    }
+
+    /** @name Acceso a los bloques */
+    ///@{
+    Kernel& kernel() { return kernel_; }
+    Reference& reference() { return reference_; }
+    ///@}
+
+private:
+    Kernel kernel_;          ///< Núcleo validado
+    Reference reference_;    ///< Referencia en double
+    double maxAbs_;          ///< max |y - y_ref|
+    double sumSq_;           ///< Σ (y - y_ref)^2
+    std::size_t argMax_;     ///< Muestra del máximo
+    std::size_t n_;          ///< Muestras comparadas
+};
+
+/**
+ * @brief Desviación máxima de un núcleo frente a su referencia sobre una entrada
+ *
+ * Copia ambos bloques: los originales no avanzan.
+ *
+ * @param kernel Núcleo a validar
+ * @param reference Referencia en double
+ * @param u Entrada
+ * @param n Número de muestras
+ */
+template <class Kernel, class Reference>
+Deviation compareWithReference(const Kernel& kernel, const Reference& reference, const double* u, std::size_t n) {
+    ReferenceCheck<Kernel, Reference> check(kernel, reference);
+    for (std::size_t i = 0; i < n; ++i) {
+        check.step(u[i]);
+    }
+    return check.deviation();
+}
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_SCALARSYSTEMS_H
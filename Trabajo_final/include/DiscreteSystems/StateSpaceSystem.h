@@ -9,6 +9,7 @@
 #define DISCRETESYSTEMS_STATESPACESYSTEM_H
 
 #include "DiscreteSystems/DiscreteSystem.h"
+#include "DiscreteSystems/MatrixPowers.h"
 #include <vector>
 
 namespace DiscreteSystems {
@@ -31,11 +32,26 @@ namespace DiscreteSystems {
  * - C ∈ R^n es el vector de salida
  * - D ∈ R es la ganancia directa (escalar)
  * 
+ * **Núcleo de cálculo:** la matriz A se guarda además en un único bloque
+ * contiguo por columnas (Acol_), de modo que x(k+1) = A*x(k) se evalúa como
+ * una suma de columnas escaladas (AXPY) que el compilador vectoriza sobre
+ * el índice de fila. Cada componente x(k+1)[i] acumula sus términos en el
+ * mismo orden que el producto fila por vector, así que el resultado es
+ * idéntico bit a bit. El estado siguiente se escribe en un segundo buffer
+ * preasignado (ping-pong), sin reservas de memoria en compute().
+ * 
+ * **Entrada mantenida:** advance(steps, u) salta steps - 1 pasos con la
+ * matriz aumentada M = [A B; 0 1] aplicada a [x; u] (x(k+s) = A^s x(k) +
+ * Σ A^i B u) y calcula el último con compute(). Las potencias M^(2^j) se
+ * guardan la primera vez que se usan: O(n³ log steps) la primera vez y
+ * O(n² log steps) después.
+ * 
  * @invariant A_.size() == n (filas)
  * @invariant A_[i].size() == n (columnas) para todo i
+ * @invariant Acol_.size() == n * n, con Acol_[j*n + i] == A_[i][j]
  * @invariant B_.size() == n
  * @invariant C_.size() == n
- * @invariant x_.size() == n
+ * @invariant x_.size() == xNext_.size() == n
  */
 class StateSpaceSystem : public DiscreteSystem {
 public:
@@ -47,6 +63,7 @@ public:
      * @param D Ganancia directa (escalar)
      * @param Ts Período de muestreo (debe ser > 0)
      * @param bufferSize Tamaño del buffer circular (por defecto 100)
+     * @param recording Política de registro del buffer
      * @throws InvalidDimensions si las dimensiones son inconsistentes
      * @throws InvalidSamplingTime si Ts <= 0
      * 
@@ -59,11 +76,13 @@ public:
                     const std::vector<double>& C,
                     double D,
                     double Ts,
-                    size_t bufferSize = 100);
+                    size_t bufferSize = 100,
+                    RecordingPolicy recording = RecordingPolicy());
 
     /**
      * @brief Obtiene la matriz A
-     * @return Referencia constante a la matriz de estado
+     * @return Referencia constante a la matriz de estado (copia por filas,
+     *         no usada en el cálculo)
      */
     const std::vector<std::vector<double>>& getA() const { return A_; }
 
@@ -103,18 +122,49 @@ protected:
      */
     double compute(double uk) override;
 
+    /**
+     * @brief Procesa un bloque de muestras sin despacho virtual por muestra
+     * @param u Entradas del bloque
+     * @param y Salidas del bloque
+     * @param n Número de muestras
+     */
+    void computeBlock(const double* u, double* y, size_t n) override;
+
     /**
      * @brief Reinicia el estado interno (vector x a cero)
      */
     void resetState() override;
 
+    /**
+     * @brief Guarda el vector de estado x en la sección 'SSS '
+     */
+    void saveState(CheckpointWriter& w) const override;
+
+    /**
+     * @brief Restaura el estado guardado por saveState()
+     * @throws CheckpointError si el orden no coincide
+     */
+    void loadState(CheckpointReader& r) override;
+
+    /**
+     * @brief Salto con entrada constante mediante potencias de [A B; 0 1]
+     * @param u Entrada mantenida
+     * @param steps Pasos (> 0)
+     * @return Salida del último paso
+     */
+    double computeHold(double u, size_t steps) override;
+
 private:
-    std::vector<std::vector<double>> A_;  ///< Matriz de estado n×n
+    std::vector<std::vector<double>> A_;  ///< Matriz de estado n×n (vista para getA())
+    std::vector<double> Acol_;            ///< Matriz A contigua por columnas (n*n)
     std::vector<double> B_;               ///< Vector de entrada (tamaño n)
     std::vector<double> C_;               ///< Vector de salida (tamaño n)
     double D_;                            ///< Ganancia directa (escalar)
     std::vector<double> x_;               ///< Vector de estado actual x(k)
+    std::vector<double> xNext_;           ///< Buffer preasignado para x(k+1) (ping-pong con x_)
     size_t n_;                            ///< Orden del sistema (dimensión de x)
+    MatrixPowers holdPowers_;             ///< Potencias de [A B; 0 1] (se crean en el primer salto)
+    std::vector<double> z_;               ///< Vector aumentado [x; u] del salto
 };
 
 /**
@@ -0,0 +1,225 @@
+/**
+ * @file StreamRecorder.h
+ * @brief Grabación continua de muestras a disco con un hilo escritor
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef DISCRETESYSTEMS_STREAMRECORDER_H
+#define DISCRETESYSTEMS_STREAMRECORDER_H
+
+#include "DiscreteSystems/DiscreteSystem.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace DiscreteSystems {
+
+/**
+ * @enum DropPolicy
+ * @brief Qué hacer cuando el escritor no ha liberado ninguna página
+ */
+enum class DropPolicy {
+    DropNewest,   ///< Descartar las muestras entrantes hasta que se libere una página
+    DropPage      ///< Descartar la página recién llena y reutilizarla (conserva lo más reciente)
+};
+
+/**
+ * @enum Compression
+ * @brief Compresión del fichero de grabación
+ */
+enum class Compression {
+    None,         ///< Registros crudos
+    Gzip          ///< Fichero gzip (requiere zlib; ver compressionAvailable())
+};
+
+/**
+ * @class StreamRecorder
+ * @brief Sumidero de muestras sin límite de longitud con escritura asíncrona
+ *
+ * El hilo de control añade muestras a páginas preasignadas; una página llena
+ * se entrega al hilo escritor al llegar la muestra siguiente, que la vuelca al fichero con una sola
+ * escritura secuencial grande (comprimida si se pide) y la devuelve.
+ * Productor y escritor recorren las páginas en el mismo orden circular y
+ * cada página lleva un estado atómico (libre / llena), de modo que append()
+ * es wait-free, sin reservas de memoria ni llamadas al sistema.
+ *
+ * Si el escritor se retrasa y no hay página libre se aplica la DropPolicy;
+ * las muestras descartadas se cuentan en dropped() y dejan un hueco en k.
+ *
+ * Formato del fichero (nativo, little-endian en x86/ARM): cabecera de 16
+ * bytes ("DSREC001", tamaño de registro y muestras por página) seguida de
+ * registros StreamRecorder::Record. readFile() lo lee con o sin gzip.
+ *
+ * Un tramo en reposo (appendHold()) ocupa un único registro con k < 0:
+ * k = ~(n << 32 | k0) indica n muestras k0, ..., k0 + n - 1 iguales a
+ * (in, out). readFile() lo expande; los contadores lo cuentan como un
+ * registro.
+ *
+ * Hilos: append(), appendBlock(), flush() y close() sólo desde el hilo
+ * productor; los contadores pueden leerse desde cualquier hilo.
+ */
+class StreamRecorder {
+public:
+    /**
+     * @struct Record
+     * @brief Registro en disco (24 bytes, sin relleno)
+     */
+    struct Record {
+        int64_t k;      ///< Índice temporal
+        double in;      ///< Entrada u(k)
+        double out;     ///< Salida y(k)
+    };
+
+    /**
+     * @brief Crea el fichero y arranca el hilo escritor
+     * @param path Fichero de destino (se trunca)
+     * @param pageSamples Muestras por página (> 0)
+     * @param pages Páginas del conjunto (>= 2)
+     * @param policy Política de descarte
+     * @param compression Compresión del fichero
+     * @throws InvalidDimensions si pageSamples == 0 o pages < 2
+     * @throws ExportError si no se puede crear el fichero o no hay zlib para Gzip
+     */
+    explicit StreamRecorder(const std::string& path, size_t pageSamples = 65536, size_t pages = 4,
+                            DropPolicy policy = DropPolicy::DropNewest,
+                            Compression compression = Compression::None);
+
+    /**
+     * @brief Cierra la grabación (close())
+     */
+    ~StreamRecorder();
+
+    StreamRecorder(const StreamRecorder&) = delete;
+    StreamRecorder& operator=(const StreamRecorder&) = delete;
+
+    /**
+     * @brief Añade una muestra (wait-free)
+     */
+    void append(int k, double in, double out) { put(k, in, out); }
+
+    /**
+     * @brief Añade n muestras consecutivas k0, k0+1, ...
+     */
+    void appendBlock(const double* u, const double* y, size_t n, int k0);
+
+    /**
+     * @brief Añade un tramo de n muestras iguales k0, ..., k0 + n - 1 como un único registro
+     * @param k0 Primera muestra del tramo (>= 0)
+     * @param n Longitud del tramo (< 2^31)
+     */
+    void appendHold(int k0, size_t n, double in, double out) { put(holdKey(k0, n), in, out); }
+
+    /**
+     * @name Registros de tramo en reposo
+     */
+    ///@{
+    static bool isHold(const Record& r) { return r.k < 0; }
+    static int holdStart(const Record& r) { return static_cast<int>(static_cast<uint64_t>(~r.k) & 0xffffffffu); }
+    static size_t holdLength(const Record& r) { return static_cast<size_t>(static_cast<uint64_t>(~r.k) >> 32); }
+    static int64_t holdKey(int k0, size_t n)
+    {
+        return ~static_cast<int64_t>((static_cast<uint64_t>(n) << 32) | static_cast<uint32_t>(k0));
+    }
+    ///@}
+
+    /**
+     * @brief Entrega al escritor la página en curso aunque no esté llena
+     *
+     * Si no queda ninguna página libre, las muestras siguientes se
+     * descartan (con cualquier política) hasta que el escritor libere una.
+     */
+    void flush();
+
+    /**
+     * @brief Entrega la página en curso, espera a que se escriba todo y cierra
+     *
+     * Idempotente. Tras close() las muestras nuevas se descartan.
+     */
+    void close();
+
+    /**
+     * @name Contadores (seguros desde cualquier hilo)
+     *
+     * Tras close(), written() + dropped() == appended() salvo error de escritura.
+     */
+    ///@{
+    uint64_t appended() const { return appended_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+    ///@}
+
+    /**
+     * @brief Indica si Compression::Gzip está disponible en esta compilación
+     */
+    static bool compressionAvailable();
+
+    /**
+     * @brief Lee un fichero de grabación (comprimido o no)
+     * @param path Fichero
+     * @return Muestras en orden de grabación, con los tramos en reposo expandidos
+     * @throws ExportError si el fichero no existe o no es una grabación
+     */
+    static std::vector<Sample> readFile(const std::string& path);
+
+private:
+    /** @brief Estado de una página */
+    struct Page {
+        std::atomic<uint32_t> full;   ///< 0: del productor, 1: del escritor
+        size_t count;                 ///< Registros válidos (escrito antes de full)
+    };
+
+    void put(int64_t k, double in, double out)
+    {
+        appended_.store(++appended_local_, std::memory_order_relaxed);
+        if (fill_ == end_ && !advance()) {
+            dropped_.store(++dropped_local_, std::memory_order_relaxed);
+            return;
+        }
+        fill_->k = k;
+        fill_->in = in;
+        fill_->out = out;
+        ++fill_;
+    }
+
+    Record* pageBegin(size_t p) { return storage_.data() + p * pageSamples_; }
+    bool advance();
+    bool acquirePage();
+    void handOff();
+    void writerLoop();
+    bool writeBytes(const void* data, size_t bytes);
+
+    size_t pageSamples_;              ///< Muestras por página
+    size_t pagesCount_;               ///< Número de páginas
+    DropPolicy policy_;               ///< Política de descarte
+    Compression compression_;         ///< Compresión
+    std::vector<Record> storage_;     ///< Páginas contiguas (pagesCount_ * pageSamples_)
+    std::vector<Page> pages_;         ///< Estado de cada página
+
+    // Estado del productor
+    size_t producerPage_;             ///< Página en curso (o siguiente a pedir)
+    Record* fill_;                    ///< Próximo registro (nullptr: sin página)
+    Record* end_;                     ///< Fin de la página en curso (fill_ == end_: llena o sin página)
+    uint64_t appended_local_;         ///< Copia local de appended_
+    uint64_t dropped_local_;          ///< Copia local de dropped_
+    bool closed_;                     ///< close() ya llamado
+
+    std::atomic<uint64_t> appended_;  ///< Muestras recibidas por append()
+    std::atomic<uint64_t> dropped_;   ///< Muestras descartadas
+    std::atomic<uint64_t> written_;   ///< Muestras escritas a disco
+    std::atomic<bool> failed_;        ///< Error de escritura
+    std::atomic<bool> stop_;          ///< Petición de parada al escritor
+
+    int fd_;                          ///< Fichero sin comprimir
+    void* gz_;                        ///< gzFile si hay compresión
+    std::thread writer_;              ///< Hilo escritor
+};
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_STREAMRECORDER_H
@@ -0,0 +1,151 @@
+/**
+ * @file TransferFunctionBank.h
+ * @brief Banco de funciones de transferencia independientes en disposición SoA
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef DISCRETESYSTEMS_TRANSFERFUNCTIONBANK_H
+#define DISCRETESYSTEMS_TRANSFERFUNCTIONBANK_H
+
+#include <cstddef>
+#include <vector>
+
+namespace DiscreteSystems {
+
+/**
+ * @class TransferFunctionBank
+ * @brief N canales de funciones de transferencia del mismo orden avanzados en bloque
+ *
+ * Cada canal c es un sistema independiente con su propio numerador b_c y
+ * denominador a_c (mismos órdenes m y n para todos). Los coeficientes y los
+ * historiales se guardan como estructura de arrays (SoA): el coeficiente i
+ * de todos los canales es contiguo, igual que la muestra u(k-i) de todos los
+ * canales. Así cada término de la ecuación en diferencias es un bucle sobre
+ * canales que el compilador vectoriza con el ancho SIMD disponible.
+ *
+ * Los historiales usan el mismo esquema espejo que TransferFunctionSystem
+ * (DirectForm), con una posición de escritura común a todos los canales, de
+ * modo que cada canal produce exactamente la misma salida que un
+ * TransferFunctionSystem independiente con los mismos coeficientes.
+ *
+ * El número de canales se redondea internamente a múltiplo de 8 (stride_)
+ * para que los bucles no tengan restos; los canales de relleno tienen
+ * coeficientes nulos.
+ *
+ * @invariant b_.size() == (m+1) * stride_
+ * @invariant a_.size() == (n+1) * stride_
+ * @invariant uHist_.size() == 2 * (m+1) * stride_
+ * @invariant yHist_.size() == 2 * n * stride_
+ */
+class TransferFunctionBank {
+public:
+    /**
+     * @class Channel
+     * @brief Vista de un canal del banco para leer y escribir coeficientes y estado
+     */
+    class Channel {
+    public:
+        /**
+         * @brief Establece los coeficientes del canal (se normalizan con a[0])
+         * @param b Numerador [b0, ..., bm] (tamaño m+1)
+         * @param a Denominador [a0, ..., an] (tamaño n+1)
+         * @throws InvalidCoefficients si los tamaños no coinciden con el banco o a[0] == 0
+         */
+        void setCoefficients(const std::vector<double>& b, const std::vector<double>& a);
+
+        /** @name Coeficientes normalizados */
+        ///@{
+        double numerator(std::size_t i) const;
+        double denominator(std::size_t j) const;
+        ///@}
+
+        /** @name Estado tras el último paso: u(k-i) para i = 0..m, y(k-j) para j = 1..n */
+        ///@{
+        double input(std::size_t i) const;
+        double output(std::size_t j) const;
+        void setInput(std::size_t i, double value);
+        void setOutput(std::size_t j, double value);
+        ///@}
+
+        /**
+         * @brief Reinicia a cero el estado del canal
+         */
+        void reset();
+
+    private:
+        friend class TransferFunctionBank;
+        Channel(TransferFunctionBank& bank, std::size_t index) : bank_(&bank), index_(index) {}
+
+        TransferFunctionBank* bank_;  ///< Banco al que pertenece
+        std::size_t index_;           ///< Índice del canal
+    };
+
+    /**
+     * @brief Constructor
+     * @param channels Número de canales (debe ser > 0)
+     * @param numOrder Orden del numerador m (b tiene m+1 coeficientes)
+     * @param denOrder Orden del denominador n (a tiene n+1 coeficientes)
+     * @param Ts Período de muestreo común (debe ser > 0)
+     * @throws InvalidDimensions si channels == 0
+     * @throws InvalidSamplingTime si Ts <= 0
+     *
+     * @note Todos los canales se inicializan con H(z) = 0 (b = 0, a = [1, 0, ...])
+     */
+    TransferFunctionBank(std::size_t channels, std::size_t numOrder, std::size_t denOrder, double Ts);
+
+    /**
+     * @brief Avanza un paso todos los canales
+     * @param u Entradas u_c(k), una por canal (tamaño channels())
+     * @param y Salidas y_c(k), una por canal (tamaño channels())
+     */
+    void step(const double* u, double* y);
+
+    /**
+     * @brief Avanza n pasos todos los canales
+     * @param u Entradas entrelazadas por paso: u[t * channels() + c]
+     * @param y Salidas con la misma disposición
+     * @param n Número de pasos
+     */
+    void process(const double* u, double* y, std::size_t n);
+
+    /**
+     * @brief Reinicia a cero el estado de todos los canales
+     */
+    void reset();
+
+    /**
+     * @brief Obtiene una vista de un canal
+     * @param c Índice del canal (0 <= c < channels())
+     * @return Vista del canal
+     * @throws std::out_of_range si c >= channels()
+     */
+    Channel channel(std::size_t c);
+
+    /** @name Getters */
+    ///@{
+    std::size_t channels() const { return channels_; }
+    std::size_t numeratorOrder() const { return Lu_ - 1; }
+    std::size_t denominatorOrder() const { return Ly_; }
+    double getSamplingTime() const { return Ts_; }
+    ///@}
+
+private:
+    double Ts_;                 ///< Período de muestreo común
+    std::size_t channels_;      ///< Número de canales útiles
+    std::size_t stride_;        ///< Canales reservados (múltiplo de 8)
+    std::size_t Lu_;            ///< Longitud de la ventana de entradas (m+1)
+    std::size_t Ly_;            ///< Longitud de la ventana de salidas (n)
+    std::size_t uPos_;          ///< Inicio de la ventana de entradas
+    std::size_t yPos_;          ///< Inicio de la ventana de salidas
+    std::vector<double> b_;     ///< Numeradores SoA: b_[i * stride_ + c]
+    std::vector<double> a_;     ///< Denominadores SoA: a_[j * stride_ + c]
+    std::vector<double> uHist_; ///< Historial espejo de entradas SoA
+    std::vector<double> yHist_; ///< Historial espejo de salidas SoA
+    std::vector<double> num_;   ///< Acumulador del numerador por canal
+    std::vector<double> den_;   ///< Acumulador del denominador por canal
+};
+
+} // namespace DiscreteSystems
+
+#endif // DISCRETESYSTEMS_TRANSFERFUNCTIONBANK_H
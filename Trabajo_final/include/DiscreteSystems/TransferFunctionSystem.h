@@ -9,10 +9,21 @@
 #define DISCRETESYSTEMS_TRANSFERFUNCTIONSYSTEM_H
 
 #include "DiscreteSystems/DiscreteSystem.h"
+#include "DiscreteSystems/MatrixPowers.h"
+#include "DiscreteSystems/PartitionedConvolver.h"
 #include <vector>
 
 namespace DiscreteSystems {
 
+/**
+ * @enum FilterStructure
+ * @brief Estructura de realización de la función de transferencia
+ */
+enum class FilterStructure {
+    DirectForm,          ///< Forma directa I con historiales circulares (exacta respecto a la ecuación en diferencias)
+    SecondOrderSections  ///< Cascada de secciones de segundo orden (biquads) en forma directa II transpuesta
+};
+
 /**
  * @class TransferFunctionSystem
  * @brief Sistema discreto SISO definido por función de transferencia
@@ -30,9 +41,36 @@ namespace DiscreteSystems {
  * 
  * Se normaliza internamente para que a[0] = 1.
  * 
+ * **Estructuras disponibles** (FilterStructure):
+ * - DirectForm: los historiales de entrada y salida son buffers circulares
+ *   con almacenamiento espejo (cada muestra se escribe dos veces, en p y en
+ *   p + L). La ventana [p, p + L) es siempre contigua, de modo que cada paso
+ *   cuesta O(1) en movimientos de memoria más los dos productos escalares,
+ *   que se evalúan en el mismo orden que la ecuación en diferencias.
+ * - SecondOrderSections: se factorizan numerador y denominador (raíces como
+ *   autovalores de la matriz compañera, estable hacia atrás) y se
+ *   agrupan en biquads en forma directa II transpuesta, emparejando cada par
+ *   de polos con los ceros más cercanos. Recomendado para órdenes altos con
+ *   polos próximos a la circunferencia unidad.
+ * 
+ * **Entrada mantenida:** advance(steps, u) salta steps - 1 pasos con la
+ * forma compañera aumentada, cuyo estado es [y(k-1..k-n), u(k-1..k-m), u]
+ * (en SecondOrderSections, [estado de los biquads, u]), y calcula el último
+ * con step(). Las potencias se guardan la primera vez que se usan.
+ * 
+ * **FIR largos:** si a = [a0] y el numerador tiene al menos kFftMinTaps
+ * coeficientes, process() convoluciona por bloques de P muestras con
+ * PartitionedConvolver (overlap-save uniformemente particionado, P de 64 a
+ * 256 según la longitud). next(), step() y los restos de menos de P
+ * muestras siguen en forma directa; al volver a process() la línea de
+ * retardo frecuencial se reconstruye desde el historial de entradas. Las
+ * salidas por FFT difieren de la forma directa en el redondeo:
+ * |Δy| ≲ 1e-15 · log2(2P) · Σ|b| · max|u|.
+ * 
  * @invariant a[0] != 0 (garantizado por normalización)
- * @invariant uHist_.size() == b_.size()
- * @invariant yHist_.size() == a_.size() - 1
+ * @invariant uHist_.size() == 2 * b_.size()
+ * @invariant yHist_.size() == 2 * (a_.size() - 1)
+ * @invariant sos_.size() == 5 * sosState_.size() / 2
  */
 class TransferFunctionSystem : public DiscreteSystem {
 public:
@@ -42,6 +80,8 @@ public:
      * @param a Coeficientes del denominador [a0, a1, ..., an]
      * @param Ts Período de muestreo (debe ser > 0)
      * @param bufferSize Tamaño del buffer circular (por defecto 100)
+     * @param structure Estructura de realización (por defecto DirectForm)
+     * @param recording Política de registro del buffer
      * @throws InvalidCoefficients si a está vacío, b está vacío, o a[0] == 0
      * @throws InvalidSamplingTime si Ts <= 0
      * 
@@ -50,7 +90,9 @@ public:
     TransferFunctionSystem(const std::vector<double>& b,
                           const std::vector<double>& a,
                           double Ts,
-                          size_t bufferSize = 100);
+                          size_t bufferSize = 100,
+                          FilterStructure structure = FilterStructure::DirectForm,
+                          RecordingPolicy recording = RecordingPolicy());
 
     /**
      * @brief Obtiene los coeficientes del numerador
@@ -64,6 +106,45 @@ public:
      */
     const std::vector<double>& getDenominator() const { return a_; }
 
+    /**
+     * @brief Obtiene la estructura de realización
+     * @return DirectForm o SecondOrderSections
+     */
+    FilterStructure getStructure() const { return structure_; }
+
+    /**
+     * @brief Número de coeficientes a partir del cual un FIR usa la convolución FFT en process()
+     *
+     * Medido con bench (grupo discretesystems, bloques de 256): con 64
+     * coeficientes la forma directa cuesta ~65 ns/muestra y la FFT ~31.
+     */
+    static const size_t kFftMinTaps = 64;
+
+    /**
+     * @brief Tamaño de bloque de la convolución FFT
+     * @return P (0 si el sistema no usa la convolución FFT)
+     */
+    size_t getFftPartition() const { return fir_.partitionSize(); }
+
+    /**
+     * @brief Obtiene los coeficientes de las secciones de segundo orden
+     * @return Vector plano con 5 coeficientes por sección [b0, b1, b2, a1, a2]
+     *         (vacío en modo DirectForm; la ganancia va incluida en la primera sección)
+     */
+    const std::vector<double>& getSections() const { return sos_; }
+
+    /**
+     * @brief Núcleo de cálculo: avanza la ecuación en diferencias un paso
+     *
+     * No es virtual y no registra la muestra en el buffer ni avanza k: es el
+     * punto de entrada para bucles que conocen el tipo concreto (p. ej.
+     * Lazo::LoopRunner). next() equivale a step() más el registro.
+     *
+     * @param uk Entrada en el paso k
+     * @return Salida y(k)
+     */
+    double step(double uk);
+
 protected:
     /**
      * @brief Calcula la salida del sistema mediante la ecuación en diferencias
@@ -72,16 +153,76 @@ protected:
      */
     double compute(double uk) override;
 
+    /**
+     * @brief Procesa un bloque de muestras sin despacho virtual por muestra
+     * @param u Entradas del bloque
+     * @param y Salidas del bloque
+     * @param n Número de muestras
+     */
+    void computeBlock(const double* u, double* y, size_t n) override;
+
     /**
      * @brief Reinicia el estado interno (historiales de entrada y salida)
      */
     void resetState() override;
 
+    /**
+     * @brief Salto con entrada constante mediante potencias de la forma compañera
+     * @param u Entrada mantenida
+     * @param steps Pasos (> 0)
+     * @return Salida del último paso
+     */
+    double computeHold(double u, size_t steps) override;
+
+    /**
+     * @brief Guarda los historiales (o el estado de las secciones) en la sección 'TFS '
+     */
+    void saveState(CheckpointWriter& w) const override;
+
+    /**
+     * @brief Restaura el estado guardado por saveState()
+     * @throws CheckpointError si la estructura o el orden no coinciden
+     */
+    void loadState(CheckpointReader& r) override;
+
 private:
+    /**
+     * @brief Construye la matriz de transición aumentada (rellena holdPowers_)
+     */
+    void buildHoldMatrix();
+
+    /**
+     * @brief Factoriza b_ y a_ en secciones de segundo orden (rellena sos_)
+     * @throws InvalidCoefficients si la factorización no reproduce H(z)
+     */
+    void buildSections();
+
+    /**
+     * @brief Paso de la cascada de biquads
+     * @param uk Entrada en el paso k
+     * @return Salida y(k)
+     */
+    double computeSections(double uk);
+
+    /**
+     * @brief Bloques de P muestras por FFT; devuelve las muestras procesadas
+     */
+    size_t computeFir(const double* u, double* y, size_t n);
+
     std::vector<double> b_;       ///< Coeficientes del numerador (normalizados)
     std::vector<double> a_;       ///< Coeficientes del denominador (normalizados, a[0] = 1)
-    std::vector<double> uHist_;   ///< Historial de entradas [u(k), u(k-1), ..., u(k-m)]
-    std::vector<double> yHist_;   ///< Historial de salidas [y(k-1), y(k-2), ..., y(k-n)]
+    std::vector<double> uHist_;   ///< Historial espejo de entradas: ventana [u(k), u(k-1), ..., u(k-m)] en uPos_
+    std::vector<double> yHist_;   ///< Historial espejo de salidas: ventana [y(k-1), ..., y(k-n)] en yPos_
+    size_t uPos_;                 ///< Inicio de la ventana de entradas en uHist_
+    size_t yPos_;                 ///< Inicio de la ventana de salidas en yHist_
+    FilterStructure structure_;   ///< Estructura de realización
+    std::vector<double> sos_;     ///< Secciones [b0, b1, b2, a1, a2] por biquad (modo SOS)
+    std::vector<double> sosState_;///< Estado DF-II transpuesta [s1, s2] por biquad (modo SOS)
+    MatrixPowers holdPowers_;     ///< Potencias de la transición aumentada (se crean en el primer salto)
+    std::vector<double> z_;       ///< Estado aumentado del salto
+    PartitionedConvolver fir_;    ///< Convolución FFT (FIR largos; vacío en otro caso)
+    std::vector<double> firPast_; ///< Entradas pasadas para PartitionedConvolver::prime()
+    bool firPrimed_;              ///< La línea de retardo de fir_ está al día con uHist_
 };
 
 /**
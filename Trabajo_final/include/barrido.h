@@ -0,0 +1,395 @@
+/**
+ * @file barrido.h
+ * @brief Barridos de parámetros y Monte Carlo del lazo en paralelo
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef BARRIDO_H
+#define BARRIDO_H
+
+#include <lazo.h>
+#include <metricas.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @defgroup Barrido Barridos de Parámetros
+ * @brief Evaluación de muchas configuraciones independientes del lazo
+ *
+ * Cada configuración (p. ej. unas ganancias del PID) se simula durante un
+ * número fijo de ticks, o hasta superar una cota de Metricas::Limits, y se
+ * resume en una fila de Metrics. Las
+ * configuraciones se reparten entre hilos con robo de trabajo
+ * (WorkStealingPool): cada hilo tiene su propia copia del lazo, creada una
+ * sola vez, que se reinicia con reset() entre configuraciones. El bucle
+ * interno no comparte nada mutable entre hilos: las métricas se acumulan en
+ * variables locales y se escriben una vez, en la fila de su configuración.
+ *
+ * @{
+ */
+
+namespace Barrido {
+
+/// Límite de índices por barrido (los rangos se empaquetan en 64 bits)
+static const std::size_t kMaxPoints = 0xFFFFFFFFu;
+
+/**
+ * @class WorkStealingPool
+ * @brief Reparto de índices [0, n) entre hilos con robo de trabajo
+ *
+ * Cada hilo empieza con un tramo contiguo de índices y los consume por el
+ * principio. Al agotarlo roba la mitad final del tramo más largo de otro
+ * hilo. El tramo de cada hilo es un par (inicio, fin) empaquetado en un
+ * único atómico de 64 bits: tomar un índice o robar un tramo es un
+ * compare-exchange, sin mutex. Cada índice se procesa exactamente una vez.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief Constructor
+     * @param threads Número de hilos (0: std::thread::hardware_concurrency())
+     */
+    explicit WorkStealingPool(unsigned threads = 0)
+        : threads_(threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency())),
+          steals_(0) {}
+
+    /**
+     * @brief Ejecuta fn(worker, i) para cada i en [0, n)
+     *
+     * El hilo llamante actúa como worker 0. Vuelve cuando se han procesado
+     * todos los índices. fn no debe lanzar: una excepción en otro hilo
+     * termina el programa.
+     *
+     * @param n Número de índices (<= kMaxPoints)
+     * @param fn Callable void(unsigned worker, std::size_t i)
+     * @throws std::invalid_argument si n > kMaxPoints
+     */
+    template <class Fn>
+    void parallelFor(std::size_t n, Fn fn) {
+        if (n > kMaxPoints) {
+            throw std::invalid_argument("WorkStealingPool: demasiados índices");
+        }
+        const unsigned workers = static_cast<unsigned>(std::min<std::size_t>(threads_, std::max<std::size_t>(n, 1)));
+        std::vector<Range> ranges(workers);
+        for (unsigned w = 0; w < workers; ++w) {
+            ranges[w].span.store(pack(n * w / workers, n * (w + 1) / workers), std::memory_order_relaxed);
+        }
+        std::vector<uint64_t> steals(workers, 0);
+
+        std::vector<std::thread> pool;
+        pool.reserve(workers - 1);
+        for (unsigned w = 1; w < workers; ++w) {
+            pool.push_back(std::thread([&ranges, &steals, &fn, w]() { work(ranges, w, steals[w], fn); }));
+        }
+        work(ranges, 0, steals[0], fn);
+        for (std::size_t t = 0; t < pool.size(); ++t) {
+            pool[t].join();
+        }
+
+        steals_ = 0;
+        for (unsigned w = 0; w < workers; ++w) {
+            steals_ += steals[w];
+        }
+    }
+
+    /** @name Getters */
+    ///@{
+    unsigned threads() const { return threads_; }
+    uint64_t lastSteals() const { return steals_; }   ///< Robos en el último parallelFor()
+    ///@}
+
+private:
+    /**
+     * @struct Range
+     * @brief Tramo de un hilo, en su propia línea de caché
+     */
+    struct Range {
+        Range() : span(0) {}
+        Range(const Range& other) : span(other.span.load(std::memory_order_relaxed)) {}
+        std::atomic<uint64_t> span;                       ///< (inicio << 32) | fin
+        char pad[64 - sizeof(std::atomic<uint64_t>)];     ///< Relleno hasta 64 bytes
+    };
+
+    static uint64_t pack(std::size_t begin, std::size_t end) {
+        return (static_cast<uint64_t>(begin) << 32) | static_cast<uint64_t>(end);
+    }
+    static std::size_t beginOf(uint64_t v) { return static_cast<std::size_t>(v >> 32); }
+    static std::size_t endOf(uint64_t v) { return static_cast<std::size_t>(v & 0xFFFFFFFFu); }
+
+    /**
+     * @brief Toma el primer índice del tramo propio
+     */
+    static bool pop(Range& r, std::size_t& i) {
+        uint64_t v = r.span.load(std::memory_order_relaxed);
+        for (;;) {
+            const std::size_t b = beginOf(v);
+            const std::size_t e = endOf(v);
+            if (b >= e) {
+                return false;
+            }
+            if (r.span.compare_exchange_weak(v, pack(b + 1, e), std::memory_order_acq_rel)) {
+                i = b;
+                return true;
+            }
+        }
+    }
+
+    /**
+     * @brief Roba la mitad final (redondeada hacia arriba) del tramo más largo
+     * @return false si todos los tramos ajenos están vacíos
+     */
+    static bool steal(std::vector<Range>& ranges, unsigned self) {
+        for (;;) {
+            unsigned victim = self;
+            std::size_t longest = 0;
+            uint64_t seen = 0;
+            for (unsigned w = 0; w < ranges.size(); ++w) {
+                if (w == self) {
+                    continue;
+                }
+                const uint64_t v = ranges[w].span.load(std::memory_order_relaxed);
+                const std::size_t len = endOf(v) > beginOf(v) ? endOf(v) - beginOf(v) : 0;
+                if (len > longest) {
+                    longest = len;
+                    victim = w;
+                    seen = v;
+                }
+            }
+            if (victim == self) {
+                return false;
+            }
+            const std::size_t b = beginOf(seen);
+            const std::size_t e = endOf(seen);
+            const std::size_t mid = b + (e - b) / 2;
+            if (ranges[victim].span.compare_exchange_strong(seen, pack(b, mid), std::memory_order_acq_rel)) {
+                // Nadie más escribe un tramo vacío: basta un store
+                ranges[self].span.store(pack(mid, e), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+
+    template <class Fn>
+    static void work(std::vector<Range>& ranges, unsigned self, uint64_t& steals, Fn& fn) {
+        uint64_t localSteals = 0;
+        std::size_t i = 0;
+        for (;;) {
+            while (pop(ranges[self], i)) {
+                fn(self, i);
+            }
+            if (!steal(ranges, self)) {
+                break;
+            }
+            ++localSteals;
+        }
+        steals = localSteals;
+    }
+
+    unsigned threads_;     ///< Hilos por parallelFor()
+    uint64_t steals_;      ///< Robos del último parallelFor()
+};
+
+/**
+ * @struct GainPoint
+ * @brief Configuración del PID a evaluar
+ */
+struct GainPoint {
+    double Kp;   ///< Ganancia proporcional
+    double Ki;   ///< Ganancia integral
+    double Kd;   ///< Ganancia derivativa
+};
+
+/**
+ * @struct ApplyGains
+ * @brief Configurador por defecto: pid().setGains(Kp, Ki, Kd)
+ *
+ * Sirve para PIDController y FixedPID. Para perturbar otros bloques (la
+ * planta, la referencia) se pasa a runSweep() un punto y un configurador
+ * propios con la misma forma.
+ */
+struct ApplyGains {
+    template <class Loop>
+    void operator()(Loop& loop, const GainPoint& p) const { loop.pid().setGains(p.Kp, p.Ki, p.Kd); }
+};
+
+/**
+ * @brief Rejilla completa Kp × Ki × Kd (Kd varía más rápido)
+ * @param Kp Valores de Kp
+ * @param Ki Valores de Ki
+ * @param Kd Valores de Kd
+ * @return Kp.size() * Ki.size() * Kd.size() puntos
+ */
+inline std::vector<GainPoint> gridPoints(const std::vector<double>& Kp,
+                                         const std::vector<double>& Ki,
+                                         const std::vector<double>& Kd) {
+    std::vector<GainPoint> points;
+    points.reserve(Kp.size() * Ki.size() * Kd.size());
+    for (std::size_t a = 0; a < Kp.size(); ++a) {
+        for (std::size_t b = 0; b < Ki.size(); ++b) {
+            for (std::size_t c = 0; c < Kd.size(); ++c) {
+                GainPoint p = {Kp[a], Ki[b], Kd[c]};
+                points.push_back(p);
+            }
+        }
+    }
+    return points;
+}
+
+/**
+ * @brief Muestreo Monte Carlo uniforme dentro de la caja [lo, hi]
+ *
+ * Reproducible: la misma semilla da los mismos puntos. Los puntos se
+ * generan aquí, antes del barrido, de modo que el resultado no depende del
+ * número de hilos ni del orden de ejecución.
+ *
+ * @param n Número de puntos
+ * @param lo Esquina inferior (Kp, Ki, Kd)
+ * @param hi Esquina superior (Kp, Ki, Kd)
+ * @param seed Semilla
+ */
+inline std::vector<GainPoint> randomPoints(std::size_t n, const GainPoint& lo, const GainPoint& hi,
+                                           uint64_t seed = 1) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> kp(lo.Kp, hi.Kp);
+    std::uniform_real_distribution<double> ki(lo.Ki, hi.Ki);
+    std::uniform_real_distribution<double> kd(lo.Kd, hi.Kd);
+    std::vector<GainPoint> points(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        points[i].Kp = kp(gen);
+        points[i].Ki = ki(gen);
+        points[i].Kd = kd(gen);
+    }
+    return points;
+}
+
+/**
+ * @typedef Metrics
+ * @brief Resumen de la simulación de una configuración (Metricas::Summary)
+ */
+typedef Metricas::Summary Metrics;
+
+/**
+ * @struct SweepOptions
+ * @brief Parámetros de runSweep()
+ */
+struct SweepOptions {
+    std::size_t ticks;          ///< Ticks por configuración
+    unsigned threads;           ///< Hilos (0: todos los núcleos)
+    double band;                ///< Banda de establecimiento relativa
+    Metricas::Limits limits;    ///< Cotas de aborto anticipado
+    bool warm;                  ///< Partir del estado del prototipo en lugar de reset() (default: false)
+
+    /**
+     * @param ticks_ Ticks por configuración
+     * @param threads_ Hilos (0: todos los núcleos)
+     * @param divergenceLimit |y| a partir del cual se aborta (limits.maxAbsOutput)
+     */
+    explicit SweepOptions(std::size_t ticks_ = 1000, unsigned threads_ = 0, double divergenceLimit = 1e6)
+        : ticks(ticks_), threads(threads_), band(0.02), limits(), warm(false) {
+        limits.maxAbsOutput = divergenceLimit;
+    }
+};
+
+/**
+ * @brief Simula una configuración sobre un lazo ya reiniciado y configurado
+ *
+ * y0 es la salida anterior al primer tick (la del ADC en un lazo en
+ * marcha). Se detiene en cuanto se supera una de opt.limits: las configuraciones
+ * descartadas cuestan sólo los ticks hasta el aborto.
+ */
+template <class Loop>
+Metrics simulate(Loop& loop, const SweepOptions& opt, double y0 = 0.0) {
+    Metricas::StepResponse eval(loop.ref().T(), opt.band, opt.limits, y0);
+    loop.run(opt.ticks, eval.observer());
+    return eval.summary();
+}
+
+/**
+ * @brief Evalúa cada punto sobre una copia del lazo prototipo
+ *
+ * Cada hilo copia el prototipo una vez (en modo rápido) y, por cada punto,
+ * llama a reset(), a configure(loop, punto) y simula opt.ticks ticks. El
+ * resultado i corresponde a points[i] y no depende del número de hilos.
+ *
+ * Con opt.warm cada punto parte en cambio de una copia del prototipo tal
+ * como está (p. ej. tras un transitorio de arranque común, o restaurado con
+ * LoopRunner::restore()): el calentamiento se simula una vez y no por
+ * punto. Las métricas se miden desde la bifurcación, con y0 la salida del
+ * ADC del prototipo. La copia incluye los buffers de registro; un
+ * prototipo con buffers pequeños bifurca más barato.
+ *
+ * @param prototype Lazo de partida (no se modifica)
+ * @param points Configuraciones
+ * @param opt Opciones del barrido
+ * @param configure Callable void(Loop&, const Point&)
+ * @param pool Pool a usar (nullptr: uno con opt.threads hilos)
+ * @return Una fila de Metrics por punto
+ */
+template <class Loop, class Point, class Configure>
+std::vector<Metrics> runSweep(const Loop& prototype, const std::vector<Point>& points,
+                              const SweepOptions& opt, Configure configure,
+                              WorkStealingPool* pool = nullptr) {
+    WorkStealingPool local(opt.threads);
+    WorkStealingPool& p = pool != nullptr ? *pool : local;
+
+    // Un lazo por hilo; se crean fuera del bucle interno
+    const unsigned workers = p.threads();
+    std::vector<Loop> loops(workers, prototype);
+    for (unsigned w = 0; w < workers; ++w) {
+        loops[w].setRecording(false);
+    }
+
+    std::vector<Metrics> results(points.size());
+    p.parallelFor(points.size(), [&](unsigned w, std::size_t i) {
+        Loop& loop = loops[w];
+        if (opt.warm) {
+            loop = prototype;
+            loop.setRecording(false);
+        } else {
+            loop.reset();
+        }
+        configure(loop, points[i]);
+        results[i] = simulate(loop, opt, opt.warm ? loop.adc().delayed() : 0.0);
+    });
+    return results;
+}
+
+/**
+ * @brief runSweep() con el configurador por defecto (ganancias del PID)
+ */
+template <class Loop>
+std::vector<Metrics> runSweep(const Loop& prototype, const std::vector<GainPoint>& points,
+                              const SweepOptions& opt, WorkStealingPool* pool = nullptr) {
+    return runSweep(prototype, points, opt, ApplyGains(), pool);
+}
+
+/**
+ * @brief Índice de la fila con menor IAE entre las no abortadas
+ * @return results.size() si todas se abortaron
+ */
+inline std::size_t bestByIae(const std::vector<Metrics>& results) {
+    std::size_t best = results.size();
+    double iae = std::numeric_limits<double>::infinity();
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        if (results[i].abort == Metricas::Abort::None && results[i].iae < iae) {
+            iae = results[i].iae;
+            best = i;
+        }
+    }
+    return best;
+}
+
+} // namespace Barrido
+
+/** @} */ // fin del grupo Barrido
+
+#endif // BARRIDO_H
@@ -9,6 +9,9 @@
 #define CONTROLADOR_H
 
 #include <DiscreteSystems/DiscreteSystem.h>
+#include <DiscreteSystems/ScalarSystems.h>
+#include <atomic>
+#include <cstdint>
 #include <vector>
 
 /**
@@ -42,26 +45,77 @@ namespace Controlador {
  * - Mejor comportamiento numérico
  * - Recomendado para sistemas embebidos
  * 
+ * **Sintonización concurrente:** los setters publican un juego completo
+ * {Kp, Ki, Kd, a0, a1, a2} en un doble buffer con número de secuencia y el
+ * hilo de control lo adopta al principio del siguiente step(), nunca a mitad
+ * de una muestra. Ningún lado espera: si una publicación coincide con la
+ * lectura, el juego se adopta en el tick siguiente. Los setters pueden
+ * llamarse desde cualquier hilo; si varios hilos sintonizan a la vez deben
+ * serializarse entre ellos.
+ *
+ * La forma incremental no salta al cambiar las ganancias (u[k-1] se
+ * conserva), pero Δu sí cambia de golpe en el tick del cambio. Con
+ * setBumpless(N) los coeficientes pasan del juego activo al nuevo en N ticks.
+ * 
  * @note La señal de entrada debe ser el error: e[k] = r[k] - y[k]
  */
 class PIDController : public DiscreteSystems::DiscreteSystem {
 private:
-    double Kp_;        ///< Ganancia proporcional
-    double Ki_;        ///< Ganancia integral
-    double Kd_;        ///< Ganancia derivativa
-    
-    double a0_;        ///< Coeficiente a0 = Kp + Ki*Ts + Kd/Ts
+    /**
+     * @struct CoefficientSlot
+     * @brief Juego publicado de ganancias y coeficientes
+     *
+     * Campos atómicos con acceso relaxed: una lectura concurrente con la
+     * escritura está definida y el número de secuencia la descarta.
+     */
+    struct CoefficientSlot {
+        std::atomic<double> Kp, Ki, Kd;     ///< Ganancias
+        std::atomic<double> a0, a1, a2;     ///< Coeficientes
+        std::atomic<uint64_t> ramp;         ///< Ticks de transición
+    };
+
+    double a0_;        ///< Coeficiente a0 = Kp + Ki*Ts + Kd/Ts (en uso)
     double a1_;        ///< Coeficiente a1 = -Kp - 2*Kd/Ts
     double a2_;        ///< Coeficiente a2 = Kd/Ts
     
     double e_k1_;      ///< Error en k-1
     double e_k2_;      ///< Error en k-2
     double u_k1_;      ///< Salida en k-1
-    
+
+    CoefficientSlot slots_[2];           ///< Doble buffer (slots_[seq & 1] es el publicado)
+    std::atomic<uint64_t> seq_;          ///< Publicaciones realizadas
+    uint64_t applied_;                   ///< Última secuencia adoptada (hilo de control)
+    uint64_t watch_;                     ///< applied_, o kRamping durante una transición
+    std::atomic<uint64_t> bumpless_;     ///< Ticks de transición de los setters
+
+    double rampFrom_[3];     ///< Coeficientes al empezar la transición
+    double rampTo_[3];       ///< Coeficientes de destino
+    uint64_t rampTotal_;     ///< Duración de la transición
+    uint64_t rampLeft_;      ///< Ticks restantes (0: sin transición)
+
+    /// watch_ durante una transición: ninguna secuencia llega a este valor
+    static const uint64_t kRamping = ~static_cast<uint64_t>(0);
+
+    /**
+     * @brief Publica un juego nuevo (cualquier hilo)
+     */
+    void publish(double Kp, double Ki, double Kd, uint64_t ramp);
+
     /**
-     * @brief Recalcula los coeficientes a0, a1, a2 a partir de Kp, Ki, Kd y Ts
+     * @brief Adopta el juego publicado o avanza la transición (hilo de control)
      */
-    void updateCoefficients();
+    void refreshCoefficients();
+
+    /**
+     * @brief Copia coeficientes, historiales, juegos publicados y transición
+     */
+    void copyTuning(const PIDController& other);
+
+    /**
+     * @brief Lee las ganancias del último juego publicado (cualquier hilo)
+     * @param gains Destino {Kp, Ki, Kd}
+     */
+    void publishedGains(double* gains) const;
 
 protected:
     /**
@@ -70,12 +124,36 @@ protected:
      * @return Acción de control u[k]
      */
     double compute(double ek) override;
+
+    /**
+     * @brief Calcula la acción de control para un bloque de errores
+     * 
+     * Mantiene coeficientes e historiales en variables locales durante
+     * todo el bloque; el resultado es idéntico a n llamadas a compute().
+     * 
+     * @param e Errores e[k], ..., e[k+n-1]
+     * @param u Acciones de control u[k], ..., u[k+n-1]
+     * @param n Número de muestras
+     */
+    void computeBlock(const double* e, double* u, size_t n) override;
     
     /**
      * @brief Reinicia el estado interno del controlador
      */
     void resetState() override;
 
+    /**
+     * @brief Guarda historiales, coeficientes en uso, juegos publicados y transición en la sección 'PID '
+     */
+    void saveState(DiscreteSystems::CheckpointWriter& w) const override;
+
+    /**
+     * @brief Restaura el estado guardado por saveState(), ganancias incluidas
+     *
+     * No debe coincidir con una publicación de ganancias desde otro hilo.
+     */
+    void loadState(DiscreteSystems::CheckpointReader& r) override;
+
 public:
     /**
      * @brief Constructor del controlador PID
@@ -86,8 +164,20 @@ public:
      * @param bufferSize Tamaño del buffer de muestras (default: 1024)
      */
     PIDController(double Kp, double Ki, double Kd, double Ts, size_t bufferSize = 1024);
+
+    /**
+     * @brief Constructor de copia: copia también el juego publicado y la transición
+     *
+     * No debe coincidir con una publicación en other.
+     */
+    PIDController(const PIDController& other);
+
+    /**
+     * @brief Asignación de copia (mismas condiciones que la copia)
+     */
+    PIDController& operator=(const PIDController& other);
     
-    /** @name Setters para sintonización on-line */
+    /** @name Setters para sintonización on-line (cualquier hilo) */
     ///@{
     /**
      * @brief Establece ganancia proporcional y recalcula coeficientes
@@ -114,14 +204,317 @@ public:
      * @param Kd Ganancia derivativa
      */
     void setGains(double Kp, double Ki, double Kd);
+
+    /**
+     * @brief Establece las ganancias con una transición de ramp ticks
+     * @param ramp Ticks de transición (0: cambio inmediato)
+     */
+    void setGains(double Kp, double Ki, double Kd, uint64_t ramp);
+
+    /**
+     * @brief Transición por defecto de los setters
+     * @param ramp Ticks de transición (0: cambio inmediato, por defecto)
+     */
+    void setBumpless(uint64_t ramp) { bumpless_.store(ramp, std::memory_order_relaxed); }
     ///@}
+
+    /**
+     * @brief Núcleo de cálculo inline: acción de control sin registro
+     * 
+     * No es virtual y no almacena la muestra en el buffer ni avanza k;
+     * next() equivale a step() más el registro.
+     * 
+     * @param ek Error de control e[k]
+     * @return Acción de control u[k]
+     */
+    double step(double ek) {
+        // Frontera de tick: adoptar un juego nuevo o seguir la transición.
+        // Lectura relaxed: una acquire obligaría a recargar el estado de
+        // memoria en cada tick; refreshCoefficients() sincroniza
+        if (seq_.load(std::memory_order_relaxed) != watch_) {
+            refreshCoefficients();
+        }
+
+        // Forma incremental del PID
+        // Δu[k] = a0*e[k] + a1*e[k-1] + a2*e[k-2]
+        double delta_u = a0_ * ek + a1_ * e_k1_ + a2_ * e_k2_;
+
+        // u[k] = u[k-1] + Δu[k]
+        double uk = u_k1_ + delta_u;
+
+        // Actualizar historiales
+        e_k2_ = e_k1_;
+        e_k1_ = ek;
+        u_k1_ = uk;
+
+        return uk;
+    }
     
+    /** @name Getters de las últimas ganancias publicadas (cualquier hilo) */
+    ///@{
+    double getKp() const;
+    double getKi() const;
+    double getKd() const;
+    uint64_t getBumpless() const { return bumpless_.load(std::memory_order_relaxed); }
+    ///@}
+
+    /**
+     * @brief Función de transferencia de las últimas ganancias publicadas
+     *
+     * \f$ C(z) = \frac{a_0 + a_1 z^{-1} + a_2 z^{-2}}{1 - z^{-1}} \f$, para
+     * DiscreteSystems::Analysis (ver Lazo::analyzeLoop()).
+     *
+     * @param b Numerador {a0, a1, a2} (salida)
+     * @param a Denominador {1, -1} (salida)
+     */
+    void getTransferFunction(std::vector<double>& b, std::vector<double>& a) const;
+
+    /**
+     * @brief Indica si los coeficientes en uso difieren de los publicados (hilo de control)
+     */
+    bool gainsPending() const {
+        return seq_.load(std::memory_order_acquire) != watch_;
+    }
+
+    /**
+     * @brief Secuencia del último juego adoptado (hilo de control)
+     *
+     * Cambia una sola vez por juego, en el tick en que empieza su transición;
+     * una lectura descartada o los ticks de la rampa no la modifican.
+     */
+    uint64_t appliedSequence() const { return applied_; }
+
+    /**
+     * @brief Kp del último juego adoptado, el destino de la transición en curso (hilo de control)
+     *
+     * Se deduce de los coeficientes: a1 + 2·a2 = -Kp.
+     */
+    double appliedKp() const {
+        return rampLeft_ != 0 ? -(rampTo_[1] + 2.0 * rampTo_[2]) : -(a1_ + 2.0 * a2_);
+    }
+};
+
+/**
+ * @class BasicPID
+ * @brief Núcleo PID incremental header-only sobre el tipo T, sin despacho virtual
+ * 
+ * Misma ecuación y mismo orden de operaciones que PIDController, pero sin
+ * buffer circular ni herencia de DiscreteSystem: step() es inline y puede
+ * expandirse en el bucle del lazo. Para usarlo donde se necesite la interfaz
+ * polimórfica, envolverlo en DiscreteSystems::FixedSystemAdapter<FixedPID>.
+ * 
+ * Las ganancias se dan en double y los coeficientes a0, a1, a2 se cuantizan
+ * con Traits::coef(). Δu[k] y u[k-1] se suman en el acumulador y u[k] se
+ * redondea una sola vez: en punto fijo la salida se satura en el fondo de
+ * escala de la palabra (p. ej. la del DAC con Q15).
+ * 
+ * @tparam T Tipo de las muestras (double, float, Q15, Q31)
+ * @tparam Tr Rasgos del tipo (por defecto DiscreteSystems::ScalarTraits<T>)
+ */
+template <class T, class Tr = DiscreteSystems::ScalarTraits<T> >
+class BasicPID {
+public:
+    typedef Tr Traits;                        ///< Rasgos del tipo
+    typedef typename Traits::Value Value;     ///< Muestra
+    typedef typename Traits::Coef Coef;       ///< Coeficiente
+    typedef typename Traits::Acc Acc;         ///< Acumulador
+
+    /**
+     * @brief Constructor
+     * @param Kp Ganancia proporcional
+     * @param Ki Ganancia integral
+     * @param Kd Ganancia derivativa
+     * @param Ts Período de muestreo [s]
+     * @throws InvalidCoefficients si algún coeficiente no es representable en Coef
+     */
+    BasicPID(double Kp, double Ki, double Kd, double Ts)
+        : Ts_(Ts), a0_(), a1_(), a2_()
+    {
+        setGains(Kp, Ki, Kd);
+        reset();
+    }
+
+    /**
+     * @brief Calcula la acción de control para el error actual
+     * @param ek Error de control e[k]
+     * @return Acción de control u[k]
+     */
+    Value step(Value ek) {
+        Acc delta_u = Traits::mac(Traits::mac(Traits::mac(Traits::zero(), a0_, ek), a1_, e_k1_), a2_, e_k2_);
+        Value uk = Traits::narrow(Traits::widen(u_k1_) + delta_u);
+        e_k2_ = e_k1_;
+        e_k1_ = ek;
+        u_k1_ = uk;
+        return uk;
+    }
+
+    /**
+     * @brief Procesa un bloque de errores
+     * @param e Errores
+     * @param u Acciones de control
+     * @param n Número de muestras
+     */
+    void process(const Value* e, Value* u, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            u[i] = step(e[i]);
+        }
+    }
+
+    /**
+     * @brief Reinicia los historiales a cero
+     */
+    void reset() {
+        e_k1_ = Traits::fromDouble(0.0);
+        e_k2_ = e_k1_;
+        u_k1_ = e_k1_;
+    }
+
+    /**
+     * @brief Establece las ganancias y recalcula los coeficientes
+     * @param Kp Ganancia proporcional
+     * @param Ki Ganancia integral
+     * @param Kd Ganancia derivativa
+     * @throws InvalidCoefficients si algún coeficiente no es representable en Coef
+     */
+    void setGains(double Kp, double Ki, double Kd) {
+        const Coef a0 = Traits::coef(Kp + Ki * Ts_ + Kd / Ts_);
+        const Coef a1 = Traits::coef(-Kp - 2.0 * Kd / Ts_);
+        const Coef a2 = Traits::coef(Kd / Ts_);
+        a0_ = a0;
+        a1_ = a1;
+        a2_ = a2;
+    }
+
+private:
+    double Ts_;        ///< Período de muestreo
+    Coef a0_;          ///< Coeficiente a0 = Kp + Ki*Ts + Kd/Ts
+    Coef a1_;          ///< Coeficiente a1 = -Kp - 2*Kd/Ts
+    Coef a2_;          ///< Coeficiente a2 = Kd/Ts
+    Value e_k1_;       ///< Error en k-1
+    Value e_k2_;       ///< Error en k-2
+    Value u_k1_;       ///< Salida en k-1
+};
+
+/**
+ * @typedef FixedPID
+ * @brief Núcleo PID en double: mismas salidas que PIDController, bit a bit
+ */
+typedef BasicPID<double> FixedPID;
+
+/**
+ * @class PIDBank
+ * @brief N controladores PID incrementales independientes avanzados en bloque
+ * 
+ * Coeficientes e historiales se guardan como estructura de arrays (SoA):
+ * a0, a1, a2, e[k-1], e[k-2] y u[k-1] de todos los canales son contiguos, y
+ * step() es un único bucle sobre canales que el compilador vectoriza. Cada
+ * canal produce exactamente la misma salida que un PIDController con las
+ * mismas ganancias. El número de canales se redondea internamente a
+ * múltiplo de 8; los canales de relleno tienen ganancias nulas.
+ */
+class PIDBank {
+public:
+    /**
+     * @class Channel
+     * @brief Vista de un canal para leer y escribir ganancias y estado
+     */
+    class Channel {
+    public:
+        /**
+         * @brief Establece las ganancias del canal y recalcula sus coeficientes
+         * @param Kp Ganancia proporcional
+         * @param Ki Ganancia integral
+         * @param Kd Ganancia derivativa
+         */
+        void setGains(double Kp, double Ki, double Kd);
+
+        /** @name Getters de ganancias */
+        ///@{
+        double getKp() const;
+        double getKi() const;
+        double getKd() const;
+        ///@}
+
+        /** @name Estado: e[k-1], e[k-2], u[k-1] */
+        ///@{
+        double errorK1() const;
+        double errorK2() const;
+        double outputK1() const;
+        void setState(double e_k1, double e_k2, double u_k1);
+        ///@}
+
+        /**
+         * @brief Reinicia a cero el estado del canal
+         */
+        void reset();
+
+    private:
+        friend class PIDBank;
+        Channel(PIDBank& bank, size_t index) : bank_(&bank), index_(index) {}
+
+        PIDBank* bank_;    ///< Banco al que pertenece
+        size_t index_;     ///< Índice del canal
+    };
+
+    /**
+     * @brief Constructor: todos los canales con las mismas ganancias iniciales
+     * @param channels Número de canales (debe ser > 0)
+     * @param Kp Ganancia proporcional inicial
+     * @param Ki Ganancia integral inicial
+     * @param Kd Ganancia derivativa inicial
+     * @param Ts Período de muestreo común [s] (debe ser > 0)
+     * @throws DiscreteSystems::InvalidSamplingTime si Ts <= 0
+     * @throws DiscreteSystems::InvalidDimensions si channels == 0
+     */
+    PIDBank(size_t channels, double Kp, double Ki, double Kd, double Ts);
+
+    /**
+     * @brief Avanza un paso todos los canales
+     * @param e Errores e_c[k], uno por canal
+     * @param u Acciones de control u_c[k], una por canal
+     */
+    void step(const double* e, double* u);
+
+    /**
+     * @brief Avanza n pasos todos los canales
+     * @param e Errores entrelazados por paso: e[t * channels() + c]
+     * @param u Acciones de control con la misma disposición
+     * @param n Número de pasos
+     */
+    void process(const double* e, double* u, size_t n);
+
+    /**
+     * @brief Reinicia a cero el estado de todos los canales
+     */
+    void reset();
+
+    /**
+     * @brief Obtiene una vista de un canal
+     * @param c Índice del canal
+     * @return Vista del canal
+     * @throws std::out_of_range si c >= channels()
+     */
+    Channel channel(size_t c);
+
     /** @name Getters */
     ///@{
-    double getKp() const { return Kp_; }
-    double getKi() const { return Ki_; }
-    double getKd() const { return Kd_; }
+    size_t channels() const { return channels_; }
+    double getSamplingTime() const { return Ts_; }
     ///@}
+
+private:
+    double Ts_;                 ///< Período de muestreo común
+    size_t channels_;           ///< Número de canales útiles
+    size_t stride_;             ///< Canales reservados (múltiplo de 8)
+    std::vector<double> Kp_;    ///< Ganancias proporcionales
+    std::vector<double> Ki_;    ///< Ganancias integrales
+    std::vector<double> Kd_;    ///< Ganancias derivativas
+    std::vector<double> a0_;    ///< Coeficientes a0 por canal
+    std::vector<double> a1_;    ///< Coeficientes a1 por canal
+    std::vector<double> a2_;    ///< Coeficientes a2 por canal
+    std::vector<double> e_k1_;  ///< Errores en k-1 por canal
+    std::vector<double> e_k2_;  ///< Errores en k-2 por canal
+    std::vector<double> u_k1_;  ///< Salidas en k-1 por canal
 };
 
 } // namespace Controlador
@@ -37,6 +37,10 @@ namespace Convertidores {
  * 
  * Este retardo evita dependencias algebraicas directas en el lazo
  * de control y representa el comportamiento real de los conversores.
+ * 
+ * Como diezmador basta con llamar a step() sólo en los instantes de
+ * muestreo: delayed() retiene la última muestra entre ellos (muestreo y
+ * retención), que es lo que hace Lazo::MultirateLoop.
  */
 class ADConverter : public DiscreteSystems::DiscreteSystem {
 private:
@@ -49,12 +53,30 @@ protected:
      * @return Señal digital retardada y[k-1]
      */
     double compute(double yk) override;
+
+    /**
+     * @brief Retarda un bloque completo una muestra
+     * @param u Señal analógica de entrada (bloque)
+     * @param y Señal digital retardada: y[0] = y[k-1], y[i] = u[i-1]
+     * @param n Número de muestras
+     */
+    void computeBlock(const double* u, double* y, size_t n) override;
     
     /**
      * @brief Reinicia el estado del conversor
      */
     void resetState() override;
 
+    /**
+     * @brief Guarda y[k-1] en la sección 'ADC '
+     */
+    void saveState(DiscreteSystems::CheckpointWriter& w) const override;
+
+    /**
+     * @brief Restaura y[k-1]
+     */
+    void loadState(DiscreteSystems::CheckpointReader& r) override;
+
 public:
     /**
      * @brief Constructor del ADC
@@ -62,6 +84,30 @@ public:
      * @param bufferSize Tamaño del buffer (default: 1024)
      */
     ADConverter(double Ts, size_t bufferSize = 1024);
+
+    /**
+     * @brief Núcleo de cálculo inline: retardo sin registro
+     * 
+     * No es virtual y no almacena la muestra en el buffer ni avanza k;
+     * next() equivale a step() más el registro.
+     * 
+     * @param yk Señal analógica de entrada
+     * @return Señal digital retardada y[k-1]
+     */
+    double step(double yk) {
+        double output = y_k1_;
+        y_k1_ = yk;
+        return output;
+    }
+
+    /**
+     * @brief Muestra que devolverá el próximo paso, sin avanzar
+     * 
+     * Permite cerrar el lazo: s(k) = y(k-1) se conoce antes de calcular y(k).
+     * 
+     * @return y[k-1]
+     */
+    double delayed() const { return y_k1_; }
 };
 
 /**
@@ -76,8 +122,9 @@ public:
  * En términos de función de transferencia discreta:
  * \f$ H(z) = 1 \f$
  * 
- * El comportamiento ZOH (Zero-Order Hold) se gestiona externamente
- * mediante el método nextAt() cuando se requiere simulación multi-tasa.
+ * El comportamiento ZOH (Zero-Order Hold) se gestiona externamente: en
+ * simulación multi-tasa Lazo::MultirateLoop llama a step() una vez por
+ * período del control y retiene u[k] durante los pasos finos de la planta.
  * 
  * @note Esta clase es principalmente un placeholder para mantener
  * consistencia arquitectónica. En simulaciones avanzadas, podría
@@ -91,12 +138,30 @@ protected:
      * @return Misma señal uk
      */
     double compute(double uk) override;
+
+    /**
+     * @brief Paso directo de un bloque completo (copia)
+     * @param u Señal digital de entrada (bloque)
+     * @param y Señal de salida, idéntica a u
+     * @param n Número de muestras
+     */
+    void computeBlock(const double* u, double* y, size_t n) override;
     
     /**
      * @brief Reinicia el estado (vacío para DAC)
      */
     void resetState() override;
 
+    /**
+     * @brief Sección 'DAC ' vacía (no hay estado interno)
+     */
+    void saveState(DiscreteSystems::CheckpointWriter& w) const override;
+
+    /**
+     * @brief Comprueba la sección 'DAC '
+     */
+    void loadState(DiscreteSystems::CheckpointReader& r) override;
+
 public:
     /**
      * @brief Constructor del DAC
@@ -104,6 +169,13 @@ public:
      * @param bufferSize Tamaño del buffer (default: 1024)
      */
     DAConverter(double Ts, size_t bufferSize = 1024);
+
+    /**
+     * @brief Núcleo de cálculo inline: paso directo sin registro
+     * @param uk Señal digital de entrada
+     * @return Misma señal uk
+     */
+    double step(double uk) { return uk; }
 };
 
 } // namespace Convertidores
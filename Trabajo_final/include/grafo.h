@@ -0,0 +1,470 @@
+/**
+ * @file grafo.h
+ * @brief Diagramas de bloques: declaración, validación y compilación a un plan plano
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef GRAFO_H
+#define GRAFO_H
+
+#include <DiscreteSystems/TransferFunctionSystem.h>
+#include <controlador.h>
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @defgroup Grafo Diagramas de Bloques
+ * @brief Lazos arbitrarios compilados a un plan de ejecución con el estado contiguo
+ *
+ * SystemGraph declara bloques SISO (entradas externas, ganancias, uniones
+ * sumadoras, funciones de transferencia y retardos) y sus conexiones.
+ * compile() valida el grafo, lo ordena topológicamente y produce un
+ * CompiledGraph: una lista plana de operaciones y un único arena de
+ * doubles con los coeficientes y el estado de todos los bloques, dispuestos
+ * en el orden en que se ejecutan. Un tick recorre ambos secuencialmente,
+ * sin objetos por bloque, sin despacho virtual y sin punteros entre
+ * reservas dispersas.
+ *
+ * Cada tick tiene dos fases. Los bloques sin paso directo (retardos y
+ * funciones de transferencia con b[0] = 0) publican primero su salida, que
+ * sólo depende del estado; después se ejecutan los demás bloques en orden
+ * topológico y, en cuanto su entrada está disponible, se actualiza el estado
+ * de los primeros. Así un lazo sólo es algebraico si todos sus bloques
+ * tienen paso directo, y compile() lo rechaza.
+ *
+ * fuse() es un paso previo opcional: reduce cada cadena serie de bloques
+ * lineales (ganancias, funciones de transferencia y retardos) al producto de
+ * sus funciones de transferencia, y cada paralelo que converge en una unión
+ * sumadora a su suma, de modo que p. ej. DAC → planta → ADC queda en una sola
+ * operación. Los bloques no lineales (Saturation) delimitan las cadenas.
+ *
+ * @{
+ */
+
+namespace Grafo {
+
+/// Identificador de bloque: índice en el orden de declaración
+typedef std::size_t BlockId;
+
+/**
+ * @class InvalidGraph
+ * @brief Excepción lanzada por conexiones inválidas, bloques sin entrada o lazos algebraicos
+ */
+class InvalidGraph : public std::invalid_argument {
+public:
+    /**
+     * @brief Constructor
+     * @param message Mensaje descriptivo del error
+     */
+    explicit InvalidGraph(const std::string& message)
+        : std::invalid_argument(message) {}
+};
+
+/**
+ * @enum BlockKind
+ * @brief Tipos de bloque de SystemGraph
+ */
+enum class BlockKind {
+    Input,              ///< Entrada externa, fijada en cada tick
+    Gain,               ///< y = k·u
+    Sum,                ///< y = Σ w_i·u_i (unión sumadora)
+    TransferFunction,   ///< b(z^-1) / a(z^-1) en forma directa I
+    Delay,              ///< y(k) = u(k-1)
+    Saturation          ///< y = min(max(u, lo), hi), no lineal
+};
+
+/**
+ * @struct Frame
+ * @brief Salidas de todos los bloques en un tick
+ */
+struct Frame {
+    std::size_t k;           ///< Índice del tick
+    const double* values;    ///< values[id]: salida del bloque id
+
+    double operator[](BlockId id) const { return values[id]; }
+};
+
+class CompiledGraph;
+struct Fusion;
+
+/**
+ * @class SystemGraph
+ * @brief Declaración de un diagrama de bloques de tiempo discreto
+ *
+ * Todos los bloques comparten el período de muestreo del grafo. Los bloques
+ * salvo Input y Sum tienen exactamente una entrada; las uniones sumadoras,
+ * una o más con su peso (p. ej. +1 para r y -1 para s en e = r - s).
+ *
+ * @code
+ * Grafo::SystemGraph g(Ts);
+ * const Grafo::BlockId r = g.addInput("r");
+ * const Grafo::BlockId pid = g.addPID("pid", Controlador::PIDController(Kp, Ki, Kd, Ts));
+ * const Grafo::BlockId planta = g.addSystem("planta", Planta::Sistema(Ts));
+ * const Grafo::BlockId adc = g.addDelay("adc");
+ * g.feedback("e", r, pid, adc);            // e = r - adc, e → pid
+ * g.series(g.series(pid, planta), adc);     // pid → planta → adc
+ * Grafo::CompiledGraph lazo = g.compile();
+ * @endcode
+ */
+class SystemGraph {
+public:
+    /**
+     * @brief Constructor
+     * @param Ts Período de muestreo [s]
+     * @throws InvalidSamplingTime si Ts <= 0
+     */
+    explicit SystemGraph(double Ts);
+
+    /** @name Declaración de bloques */
+    ///@{
+    /**
+     * @brief Entrada externa; su valor se da en cada tick, en orden de declaración
+     */
+    BlockId addInput(const std::string& name);
+
+    /**
+     * @brief Ganancia y = k·u
+     */
+    BlockId addGain(const std::string& name, double k);
+
+    /**
+     * @brief Unión sumadora; las entradas se añaden con connect(from, sum, peso)
+     */
+    BlockId addSum(const std::string& name);
+
+    /**
+     * @brief Función de transferencia b(z^-1) / a(z^-1)
+     *
+     * Se evalúa en forma directa I con los historiales en el arena y el mismo
+     * orden de operaciones que TransferFunctionSystem::step().
+     *
+     * @throws InvalidCoefficients si b o a están vacíos o a[0] == 0
+     */
+    BlockId addTransferFunction(const std::string& name, const std::vector<double>& b,
+                                const std::vector<double>& a);
+
+    /**
+     * @brief Función de transferencia con los coeficientes de un sistema (su estado no se copia)
+     * @throws InvalidSamplingTime si el período no coincide con el del grafo
+     */
+    BlockId addSystem(const std::string& name, const DiscreteSystems::TransferFunctionSystem& sys);
+
+    /**
+     * @brief Regulador con la función de transferencia de sus últimas ganancias publicadas
+     *
+     * C(z) = (a0 + a1 z^-1 + a2 z^-2) / (1 - z^-1): coincide bit a bit con
+     * PIDController::step() mientras no cambien las ganancias.
+     *
+     * @throws InvalidSamplingTime si el período no coincide con el del grafo
+     */
+    BlockId addPID(const std::string& name, const Controlador::PIDController& pid);
+
+    /**
+     * @brief Retardo de una muestra (el ADC del lazo)
+     * @param initial Salida en el primer tick (default: 0)
+     */
+    BlockId addDelay(const std::string& name, double initial = 0.0);
+
+    /**
+     * @brief Saturación y = min(max(u, lo), hi) (p. ej. el límite del actuador)
+     * @throws InvalidCoefficients si lo > hi
+     */
+    BlockId addSaturation(const std::string& name, double lo, double hi);
+    ///@}
+
+    /** @name Conexiones */
+    ///@{
+    /**
+     * @brief Conecta la salida de from a la entrada de to
+     * @param weight Peso en la unión sumadora (sólo Sum; en los demás bloques debe ser 1)
+     * @throws InvalidGraph si algún id no existe, to es una entrada externa,
+     *         to ya tiene entrada (salvo Sum) o el peso no es 1 fuera de una Sum
+     */
+    void connect(BlockId from, BlockId to, double weight = 1.0);
+
+    /**
+     * @brief Serie: a → b
+     * @return b, para encadenar
+     */
+    BlockId series(BlockId a, BlockId b) {
+        connect(a, b);
+        return b;
+    }
+
+    /**
+     * @brief Paralelo: in → a, in → b y una unión nueva a + b
+     * @return La unión sumadora
+     */
+    BlockId parallel(const std::string& name, BlockId in, BlockId a, BlockId b);
+
+    /**
+     * @brief Realimentación: unión nueva reference + sign·back conectada a forward
+     *
+     * La salida del camino directo se lleva a back por separado (series()).
+     *
+     * @param sign Signo de la realimentación (default: -1, negativa)
+     * @return La unión sumadora
+     */
+    BlockId feedback(const std::string& name, BlockId reference, BlockId forward, BlockId back,
+                     double sign = -1.0);
+    ///@}
+
+    /**
+     * @brief Valida, ordena y compila el grafo
+     * @throws InvalidGraph si algún bloque no tiene entrada o hay un lazo algebraico
+     */
+    CompiledGraph compile() const;
+
+    /** @name Getters */
+    ///@{
+    double getSamplingTime() const { return Ts_; }
+    std::size_t size() const { return blocks_.size(); }
+    const std::string& name(BlockId id) const { return blocks_.at(id).name; }
+    BlockKind kind(BlockId id) const { return blocks_.at(id).kind; }
+    /** Sin paso directo: la salida del tick sólo depende del estado */
+    bool isDelayed(BlockId id) const;
+    /** SISO lineal e invariante con estado inicial nulo: Gain, TransferFunction o Delay con salida inicial 0 */
+    bool isLTI(BlockId id) const;
+
+    /**
+     * @brief Función de transferencia de un bloque LTI (coeficientes en z^-1, a[0] = 1)
+     * @throws InvalidGraph si el bloque no es LTI (isLTI())
+     */
+    void transferFunction(BlockId id, std::vector<double>& b, std::vector<double>& a) const;
+    ///@}
+
+private:
+    friend Fusion fuse(const SystemGraph& graph, const std::vector<BlockId>& observe, std::size_t maxOrder);
+
+    /**
+     * @struct Block
+     * @brief Declaración de un bloque
+     */
+    struct Block {
+        BlockKind kind;                                   ///< Tipo
+        std::string name;                                 ///< Nombre (mensajes de error)
+        std::vector<double> b, a;                         ///< Coeficientes normalizados (TransferFunction); b = {lo, hi} (Saturation)
+        double value;                                     ///< Ganancia (Gain) o salida inicial (Delay)
+        std::vector<std::pair<BlockId, double> > inputs;  ///< Entradas y pesos
+    };
+
+    BlockId add(BlockKind kind, const std::string& name);
+    void checkId(BlockId id) const;
+
+    double Ts_;                   ///< Período de muestreo [s]
+    std::vector<Block> blocks_;   ///< Bloques en orden de declaración
+};
+
+/**
+ * @class CompiledGraph
+ * @brief Plan de ejecución plano de un SystemGraph
+ *
+ * El estado de todos los bloques vive en arena(), uno tras otro en el orden
+ * del plan: primero los bloques sin paso directo (fase de salida) y después
+ * el resto en orden topológico. Cada bloque ocupa un tramo contiguo
+ * [coeficientes | historiales], de modo que un tick lee el arena de
+ * principio a fin. Las salidas del tick están en un vector aparte de un
+ * double por bloque (values()).
+ *
+ * execute(), latch() y setInputs() operan sobre un vector de salidas
+ * externo para que TiempoReal::GraphPipeline reparta el plan entre hilos:
+ * cada tramo [first, last) del plan sólo toca el estado de sus bloques.
+ */
+class CompiledGraph {
+public:
+    /**
+     * @enum OpCode
+     * @brief Operaciones del plan
+     */
+    enum class OpCode : unsigned char {
+        Gain,          ///< y = k·u
+        Sum,           ///< y = Σ w_i·u_i
+        Tf,            ///< Función de transferencia con paso directo
+        TfOutput,      ///< Salida de una función de transferencia con b[0] = 0
+        TfUpdate,      ///< Actualización de sus historiales
+        DelayOutput,   ///< Salida del retardo
+        DelayUpdate,   ///< Actualización del retardo
+        Saturation     ///< y = min(max(u, lo), hi)
+    };
+
+    /**
+     * @struct Operation
+     * @brief Una operación del plan
+     */
+    struct Operation {
+        OpCode code;          ///< Operación
+        BlockId block;        ///< Bloque (índice de su salida)
+        std::size_t in;       ///< Entrada (Sum: primer operando en operands_)
+        std::size_t count;    ///< Operandos (Sum) o coeficientes del numerador (Tf*)
+        std::size_t order;    ///< Orden del denominador (Tf*)
+        std::size_t data;     ///< Desplazamiento en el arena
+        std::size_t output;   ///< Update: índice de su operación de salida en outputs()
+    };
+
+    /**
+     * @brief Ejecuta un tick
+     * @param inputs Valores de las entradas externas en orden de declaración
+     *        (nullptr si el grafo no tiene entradas)
+     */
+    void tick(const double* inputs = nullptr);
+
+    /**
+     * @brief Ejecuta K ticks
+     * @param source Callable void(std::size_t k, double* inputs) que rellena las entradas del tick k
+     */
+    template <class Source>
+    void run(std::size_t K, Source source) {
+        std::vector<double> in(inputs_.size() + 1, 0.0);
+        for (std::size_t i = 0; i < K; ++i) {
+            source(k_, &in[0]);
+            tick(&in[0]);
+        }
+    }
+
+    /**
+     * @brief Ejecuta hasta K ticks llamando al observador tras cada uno
+     * @param observer Callable bool(const Frame&); false detiene la simulación
+     * @return Número de ticks ejecutados
+     */
+    template <class Source, class Observer>
+    std::size_t run(std::size_t K, Source source, Observer observer) {
+        std::vector<double> in(inputs_.size() + 1, 0.0);
+        for (std::size_t i = 0; i < K; ++i) {
+            source(k_, &in[0]);
+            tick(&in[0]);
+            const Frame f = {k_ - 1, &signals_[0]};
+            if (!observer(f)) {
+                return i + 1;
+            }
+        }
+        return K;
+    }
+
+    /**
+     * @brief Restaura el estado inicial de todos los bloques y k = 0
+     */
+    void reset();
+
+    /** @name Fases del tick sobre un vector de salidas externo */
+    ///@{
+    /** Salidas de los bloques sin paso directo, a partir de su estado */
+    void latch(double* values) const;
+    /** Ídem, sólo de los bloques actualizados en el tramo [first, last) del plan */
+    void latch(std::size_t first, std::size_t last, double* values) const;
+    /** Copia las entradas externas en sus bloques */
+    void setInputs(const double* inputs, double* values) const;
+    /** Ejecuta el tramo [first, last) del plan */
+    void execute(std::size_t first, std::size_t last, double* values);
+    ///@}
+
+    /** @name Getters */
+    ///@{
+    double getSamplingTime() const { return Ts_; }
+    std::size_t getK() const { return k_; }
+    std::size_t size() const { return signals_.size(); }                 ///< Bloques
+    double value(BlockId id) const { return signals_.at(id); }           ///< Salida en el último tick
+    const std::vector<double>& values() const { return signals_; }
+    const std::vector<BlockId>& inputs() const { return inputs_; }       ///< Entradas externas
+    const std::vector<Operation>& schedule() const { return schedule_; } ///< Plan (fase de cálculo)
+    const std::vector<Operation>& outputs() const { return outputs_; }   ///< Fase de salida
+    const std::vector<double>& arena() const { return arena_; }
+    /** Inicio del tramo del bloque en el arena (SIZE_MAX para entradas externas) */
+    std::size_t arenaOffset(BlockId id) const { return offsets_.at(id); }
+    /** Bloque por nombre (SIZE_MAX si no existe) */
+    BlockId find(const std::string& name) const;
+    ///@}
+
+private:
+    friend class SystemGraph;
+
+    CompiledGraph() : Ts_(0.0), k_(0) {}
+
+    double Ts_;                              ///< Período de muestreo [s]
+    std::size_t k_;                          ///< Tick actual
+    std::vector<Operation> outputs_;         ///< Fase de salida (bloques sin paso directo)
+    std::vector<Operation> schedule_;        ///< Fase de cálculo en orden topológico
+    std::vector<double> arena_;              ///< Coeficientes y estado de todos los bloques
+    std::vector<double> initial_;            ///< arena_ recién compilado (reset())
+    std::vector<std::size_t> operands_;      ///< Operandos de las uniones sumadoras
+    std::vector<double> signals_;            ///< Salidas del último tick
+    std::vector<BlockId> inputs_;            ///< Entradas externas en orden de declaración
+    std::vector<std::size_t> offsets_;       ///< Tramo de cada bloque en el arena
+    std::vector<std::string> names_;         ///< Nombres de los bloques
+};
+
+/**
+ * @brief Grafo del lazo de Lazo::LoopRunner: r → e → PID → DAC → planta → ADC → e
+ *
+ * Bloques "r", "e", "pid", "dac" (ganancia 1), "planta" y "adc" (retardo).
+ * Compilado y alimentado con r(k) = Ref::computeAt(k·Ts), coincide bit a bit
+ * con LoopRunner en modo rápido.
+ *
+ * @throws InvalidSamplingTime si los períodos no coinciden
+ */
+SystemGraph makeLoopGraph(const Controlador::PIDController& pid,
+                          const DiscreteSystems::TransferFunctionSystem& plant);
+
+/**
+ * @struct Fusion
+ * @brief Resultado de fuse(): grafo reducido y correspondencia de bloques
+ */
+struct Fusion {
+    explicit Fusion(double Ts) : graph(Ts), merged(0) {}
+
+    SystemGraph graph;             ///< Grafo fusionado
+    std::vector<BlockId> map;      ///< map[id original]: bloque de graph con su señal (SIZE_MAX si se absorbió)
+    std::vector<BlockId> probes;   ///< Bloques de graph que reconstruyen señales absorbidas observadas
+    std::size_t merged;            ///< Bloques originales absorbidos
+};
+
+/**
+ * @brief Fusiona las cadenas serie y los paralelos de bloques LTI
+ *
+ * - Serie: u → v, ambos LTI (SystemGraph::isLTI()) y v el único consumidor
+ *   de u, se reemplaza por un bloque H_u·H_v con la entrada de u.
+ * - Paralelo: una unión sumadora cuyas entradas son todas bloques LTI
+ *   alimentados por el mismo bloque x y sin otros consumidores se reemplaza
+ *   por Σ w_i·H_i con entrada x.
+ *
+ * Se repite hasta que no quede nada que fusionar. El bloque resultante
+ * conserva el nombre y la señal del bloque de salida (el último de la serie
+ * o la unión sumadora); los absorbidos desaparecen salvo los que figuran en
+ * observe, cuya señal se reconstruye con un bloque sonda fuera del lazo: el
+ * producto de las funciones de transferencia desde la entrada de la cadena
+ * hasta él. Los bloques no LTI (Saturation, Sum fuera del caso paralelo,
+ * retardos con salida inicial no nula) no se tocan.
+ *
+ * El resultado coincide con el grafo original salvo el redondeo de los
+ * productos de polinomios. Como los bloques fusionados se evalúan en forma
+ * directa, maxOrder limita el orden de cada producto; para cadenas largas
+ * conviene toSystem() con FilterStructure::SecondOrderSections.
+ *
+ * @param graph Grafo a fusionar (no se modifica)
+ * @param observe Bloques cuya señal debe seguir disponible
+ * @param maxOrder Orden máximo de un bloque fusionado (default: 8)
+ * @throws InvalidGraph si algún id de observe no existe
+ */
+Fusion fuse(const SystemGraph& graph, const std::vector<BlockId>& observe = std::vector<BlockId>(),
+            std::size_t maxOrder = 8);
+
+/**
+ * @brief TransferFunctionSystem equivalente a un bloque LTI (p. ej. uno fusionado)
+ * @param structure Realización (default: forma directa)
+ * @param bufferSize Tamaño del buffer de historial del sistema
+ * @throws InvalidGraph si el bloque no es LTI
+ */
+DiscreteSystems::TransferFunctionSystem toSystem(
+    const SystemGraph& graph, BlockId id,
+    DiscreteSystems::FilterStructure structure = DiscreteSystems::FilterStructure::DirectForm,
+    std::size_t bufferSize = 100);
+
+} // namespace Grafo
+
+/** @} */ // fin del grupo Grafo
+
+#endif // GRAFO_H
@@ -0,0 +1,398 @@
+/**
+ * @file instrumentacion.h
+ * @brief Medida de latencia por bloque: histogramas log-lineales y plazos perdidos
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef INSTRUMENTACION_H
+#define INSTRUMENTACION_H
+
+#include <DiscreteSystems/DiscreteSystem.h>
+#include <ref.h>
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @defgroup Instrumentacion Instrumentación
+ * @brief Tiempo de ejecución, retraso de activación y plazos perdidos por bloque
+ *
+ * Instrumented<Block, Policy> envuelve un DiscreteSystem o una
+ * RefSignal::Signal concretos y mide cada llamada:
+ * - Tiempo de ejecución de next() / step() (o computeAt() en señales)
+ * - Retraso de activación: instante de inicio respecto al ideal
+ *   t0 + n * Ts, donde t0 es la primera llamada tras construir o reset()
+ * - Plazos perdidos: llamadas que terminan después de t0 + (n + 1) * Ts
+ *
+ * La política se elige en compilación: con Disabled las sondas son funciones
+ * vacías inline y una base vacía, de modo que el bloque instrumentado genera
+ * el mismo código y ocupa lo mismo que el original.
+ *
+ * @{
+ */
+
+namespace Instrumentacion {
+
+/**
+ * @class LatencyHistogram
+ * @brief Histograma log-lineal de duraciones en nanosegundos (estilo HDR)
+ *
+ * Los valores menores que 16 tienen cubeta propia; a partir de ahí cada
+ * potencia de 2 se divide en 16 cubetas lineales, con un error relativo
+ * máximo de 1/16. Las 976 cubetas cubren todo el rango de 64 bits en un
+ * std::array: no hay reservas de memoria.
+ */
+class LatencyHistogram {
+public:
+    static const unsigned kSubBits = 4;                                     ///< Bits de mantisa
+    static const std::size_t kSubBuckets = std::size_t(1) << kSubBits;     ///< Cubetas por octava
+    static const std::size_t kBuckets = (64 - kSubBits + 1) * kSubBuckets; ///< Total de cubetas
+
+    LatencyHistogram() : counts_(), total_(0), max_(0) { counts_.fill(0); }
+
+    /**
+     * @brief Registra una duración
+     * @param ns Duración [ns]
+     */
+    void record(std::uint64_t ns) {
+        ++counts_[index(ns)];
+        ++total_;
+        if (ns > max_) {
+            max_ = ns;
+        }
+    }
+
+    /**
+     * @brief Vacía el histograma
+     */
+    void clear() {
+        counts_.fill(0);
+        total_ = 0;
+        max_ = 0;
+    }
+
+    /**
+     * @brief Percentil de las duraciones registradas
+     * @param p Fracción en [0, 1] (0.5 = mediana)
+     * @return Cota superior de la cubeta que contiene el percentil [ns]
+     *         (0 si el histograma está vacío)
+     */
+    std::uint64_t percentile(double p) const {
+        if (total_ == 0) {
+            return 0;
+        }
+        std::uint64_t rank = static_cast<std::uint64_t>(std::ceil(p * static_cast<double>(total_)));
+        rank = rank < 1 ? 1 : (rank > total_ ? total_ : rank);
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i) {
+            seen += counts_[i];
+            if (seen >= rank) {
+                const std::uint64_t hi = upperBound(i);
+                return hi < max_ ? hi : max_;
+            }
+        }
+        return max_;
+    }
+
+    /** @name Resumen */
+    ///@{
+    std::uint64_t count() const { return total_; }
+    std::uint64_t max() const { return max_; }
+    std::uint64_t p50() const { return percentile(0.5); }
+    std::uint64_t p99() const { return percentile(0.99); }
+    std::uint64_t p999() const { return percentile(0.999); }
+    ///@}
+
+    /**
+     * @brief Cubeta de un valor
+     */
+    static std::size_t index(std::uint64_t v) {
+        if (v < kSubBuckets) {
+            return static_cast<std::size_t>(v);
+        }
+        const unsigned shift = msb(v) - kSubBits;
+        return (shift + 1) * kSubBuckets + static_cast<std::size_t>((v >> shift) - kSubBuckets);
+    }
+
+    /**
+     * @brief Mayor valor que cae en la cubeta i
+     */
+    static std::uint64_t upperBound(std::size_t i) {
+        if (i < kSubBuckets) {
+            return i;
+        }
+        const unsigned shift = static_cast<unsigned>(i / kSubBuckets - 1);
+        const std::uint64_t lower = static_cast<std::uint64_t>(kSubBuckets + i % kSubBuckets) << shift;
+        return lower + ((std::uint64_t(1) << shift) - 1);
+    }
+
+private:
+    static unsigned msb(std::uint64_t v) {
+#if defined(__GNUC__)
+        return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#else
+        unsigned n = 0;
+        while (v >>= 1) {
+            ++n;
+        }
+        return n;
+#endif
+    }
+
+    std::array<std::uint64_t, kBuckets> counts_;  ///< Cuentas por cubeta
+    std::uint64_t total_;                          ///< Valores registrados
+    std::uint64_t max_;                            ///< Mayor valor registrado
+};
+
+/**
+ * @class BlockStats
+ * @brief Estadísticas de un bloque: ejecución, retraso de activación y plazos perdidos
+ */
+class BlockStats {
+public:
+    /**
+     * @brief Constructor
+     * @param period Período de muestreo del bloque [s]
+     */
+    explicit BlockStats(double period = 0.0)
+        : exec_(), jitter_(), misses_(0),
+          periodNs_(static_cast<std::int64_t>(period * 1e9 + 0.5)) {}
+
+    /**
+     * @brief Registra una llamada
+     * @param latenessNs Retraso del inicio respecto al instante ideal [ns]
+     * @param execNs Tiempo de ejecución [ns]
+     */
+    void record(std::int64_t latenessNs, std::uint64_t execNs) {
+        exec_.record(execNs);
+        jitter_.record(latenessNs > 0 ? static_cast<std::uint64_t>(latenessNs) : 0);
+        if (periodNs_ > 0 && latenessNs + static_cast<std::int64_t>(execNs) > periodNs_) {
+            ++misses_;
+        }
+    }
+
+    /**
+     * @brief Vacía histogramas y contadores
+     */
+    void clear() {
+        exec_.clear();
+        jitter_.clear();
+        misses_ = 0;
+    }
+
+    /** @name Getters */
+    ///@{
+    const LatencyHistogram& execution() const { return exec_; }
+    const LatencyHistogram& jitter() const { return jitter_; }
+    std::uint64_t deadlineMisses() const { return misses_; }
+    std::uint64_t calls() const { return exec_.count(); }
+    std::int64_t periodNs() const { return periodNs_; }
+    ///@}
+
+private:
+    LatencyHistogram exec_;     ///< Tiempo de ejecución
+    LatencyHistogram jitter_;   ///< Retraso de activación
+    std::uint64_t misses_;      ///< Plazos perdidos
+    std::int64_t periodNs_;     ///< Período de referencia [ns]
+};
+
+/**
+ * @brief Resumen en una línea: llamadas, p50/p99/p99.9/máx de ejecución y retraso, plazos perdidos
+ */
+inline std::ostream& operator<<(std::ostream& os, const BlockStats& s) {
+    const LatencyHistogram& x = s.execution();
+    const LatencyHistogram& j = s.jitter();
+    os << "llamadas=" << s.calls()
+       << "  ejec[ns] p50=" << x.p50() << " p99=" << x.p99()
+       << " p99.9=" << x.p999() << " max=" << x.max()
+       << "  retraso[ns] p50=" << j.p50() << " p99=" << j.p99()
+       << " p99.9=" << j.p999() << " max=" << j.max()
+       << "  plazos perdidos=" << s.deadlineMisses();
+    return os;
+}
+
+/// Política: medir cada llamada
+struct Enabled {};
+/// Política: sin medida (coste nulo)
+struct Disabled {};
+
+/**
+ * @class Probe
+ * @brief Sonda de la política elegida
+ */
+template <class Policy>
+class Probe;
+
+/**
+ * @brief Sonda activa: steady_clock al inicio y al final de cada llamada
+ */
+template <>
+class Probe<Enabled> {
+public:
+    typedef std::chrono::steady_clock Clock;   ///< Reloj monótono
+    typedef Clock::time_point Stamp;           ///< Marca de inicio
+
+    static const bool enabled = true;
+
+    explicit Probe(double period)
+        : stats_(period), origin_(), lateness_(0), n_(0), armed_(false) {}
+
+    Stamp begin() {
+        const Stamp now = Clock::now();
+        if (!armed_) {
+            origin_ = now;
+            n_ = 0;
+            armed_ = true;
+        }
+        lateness_ = nanoseconds(now - origin_) - static_cast<std::int64_t>(n_) * stats_.periodNs();
+        ++n_;
+        return now;
+    }
+
+    void end(Stamp t0) {
+        const std::int64_t exec = nanoseconds(Clock::now() - t0);
+        stats_.record(lateness_, static_cast<std::uint64_t>(exec > 0 ? exec : 0));
+    }
+
+    /**
+     * @brief Toma la próxima llamada como nuevo origen del calendario ideal
+     */
+    void rearm() { armed_ = false; }
+
+    const BlockStats& stats() const { return stats_; }
+    BlockStats& stats() { return stats_; }
+
+private:
+    static std::int64_t nanoseconds(Clock::duration d) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    }
+
+    BlockStats stats_;       ///< Estadísticas acumuladas
+    Stamp origin_;           ///< Inicio de la primera llamada
+    std::int64_t lateness_;  ///< Retraso de la llamada en curso [ns]
+    std::uint64_t n_;        ///< Llamadas desde el origen
+    bool armed_;             ///< Origen fijado
+};
+
+/**
+ * @brief Sonda inactiva: funciones vacías que el compilador elimina
+ */
+template <>
+class Probe<Disabled> {
+public:
+    struct Stamp {};
+
+    static const bool enabled = false;
+
+    explicit Probe(double) {}
+    Stamp begin() { return Stamp(); }
+    void end(Stamp) {}
+    void rearm() {}
+};
+
+/**
+ * @class Instrumented
+ * @brief Bloque con sondas de latencia alrededor de su cálculo
+ *
+ * - DiscreteSystem: se miden next() y step() (las sobrecargas ocultan a las
+ *   del bloque, de modo que Lazo::LoopRunner y TiempoReal::Pipeline las usan
+ *   al instanciarse con el tipo instrumentado)
+ * - RefSignal::Signal: se mide computeAt(), al que llegan next(), compute()
+ *   y la evaluación cualificada de LoopRunner
+ *
+ * La sonda es una base privada, de modo que con Disabled no añade tamaño.
+ *
+ * @tparam Block Bloque concreto (DiscreteSystem o Signal)
+ * @tparam Policy Enabled o Disabled
+ */
+template <class Block, class Policy = Enabled,
+          bool IsSignal = std::is_base_of<RefSignal::Signal, Block>::value>
+class Instrumented;
+
+/**
+ * @brief Especialización para bloques DiscreteSystem
+ */
+template <class Block, class Policy>
+class Instrumented<Block, Policy, false> : public Block, private Probe<Policy> {
+    static_assert(std::is_base_of<DiscreteSystems::DiscreteSystem, Block>::value,
+                  "Instrumented: Block debe derivar de DiscreteSystem o de RefSignal::Signal");
+
+public:
+    /**
+     * @brief Constructor: reenvía los argumentos al bloque
+     */
+    template <class... Args>
+    explicit Instrumented(Args&&... args)
+        : Block(std::forward<Args>(args)...), Probe<Policy>(this->getSamplingTime()) {}
+
+    double next(double x) {
+        typename Probe<Policy>::Stamp t0 = probe().begin();
+        const double y = Block::next(x);
+        probe().end(t0);
+        return y;
+    }
+
+    double step(double x) {
+        typename Probe<Policy>::Stamp t0 = probe().begin();
+        const double y = Block::step(x);
+        probe().end(t0);
+        return y;
+    }
+
+    /**
+     * @brief Reinicia el bloque y el calendario ideal (conserva las estadísticas)
+     */
+    void reset() {
+        Block::reset();
+        probe().rearm();
+    }
+
+    Probe<Policy>& probe() { return *this; }
+    const Probe<Policy>& probe() const { return *this; }
+};
+
+/**
+ * @brief Especialización para señales de referencia
+ */
+template <class Block, class Policy>
+class Instrumented<Block, Policy, true> : public Block, private Probe<Policy> {
+public:
+    /**
+     * @brief Constructor: reenvía los argumentos a la señal
+     */
+    template <class... Args>
+    explicit Instrumented(Args&&... args)
+        : Block(std::forward<Args>(args)...), Probe<Policy>(this->T()) {}
+
+    double computeAt(double time) const override {
+        Probe<Policy>& p = const_cast<Instrumented*>(this)->probe();
+        typename Probe<Policy>::Stamp t0 = p.begin();
+        const double v = Block::computeAt(time);
+        p.end(t0);
+        return v;
+    }
+
+    /**
+     * @brief Reinicia la señal y el calendario ideal (conserva las estadísticas)
+     */
+    void reset() override {
+        Block::reset();
+        probe().rearm();
+    }
+
+    Probe<Policy>& probe() { return *this; }
+    const Probe<Policy>& probe() const { return *this; }
+};
+
+} // namespace Instrumentacion
+
+/** @} */ // fin del grupo Instrumentacion
+
+#endif // INSTRUMENTACION_H
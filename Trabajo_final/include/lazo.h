@@ -0,0 +1,823 @@
+/**
+ * @file lazo.h
+ * @brief Motor de simulación del lazo cerrado Ref → PID → DAC → Planta → ADC
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef LAZO_H
+#define LAZO_H
+
+#include <DiscreteSystems/Analysis.h>
+#include <DiscreteSystems/Checkpoint.h>
+#include <DiscreteSystems/DiscreteSystem.h>
+#include <DiscreteSystems/Exceptions.h>
+#include <DiscreteSystems/Polynomial.h>
+#include <controlador.h>
+#include <convertidores.h>
+#include <planta.h>
+#include <ref.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @defgroup Lazo Lazo de Control
+ * @brief Composición de los cinco bloques en el lazo realimentado
+ *
+ * En cada tick k:
+ *
+ *     r(k) = Ref(k)
+ *     s(k) = y(k-1)            (salida retardada del ADC)
+ *     e(k) = r(k) - s(k)
+ *     u(k) = PID(e(k))
+ *     y(k) = Planta(DAC(u(k)))
+ *     ADC(y(k))
+ *
+ * El retardo del ADC rompe el lazo algebraico: s(k) se lee con
+ * ADConverter::delayed() antes de calcular y(k), y el paso del ADC al final
+ * del tick devuelve exactamente ese mismo valor.
+ *
+ * MultirateLoop integra la planta con un paso N veces más fino que el del
+ * control; el DAC mantiene u(k) durante los N pasos (ZOH) y el ADC muestrea
+ * la salida a su propia tasa.
+ *
+ * @{
+ */
+
+namespace Lazo {
+
+/**
+ * @struct TickData
+ * @brief Señales del lazo en un tick
+ */
+struct TickData {
+    std::size_t k;  ///< Índice del tick
+    double r;       ///< Referencia r(k)
+    double e;       ///< Error e(k) = r(k) - s(k)
+    double u;       ///< Acción de control u(k)
+    double y;       ///< Salida de la planta y(k)
+    double s;       ///< Salida del ADC s(k) = y(k-1)
+};
+
+namespace detail {
+
+/**
+ * @brief Avance con registro: next() para DiscreteSystem, step() para núcleos
+ */
+template <class Block>
+double record(Block& b, double x, std::true_type) { return b.next(x); }
+
+template <class Block>
+double record(Block& b, double x, std::false_type) { return b.step(x); }
+
+template <class Block>
+double record(Block& b, double x) {
+    return record(b, x, typename std::is_base_of<DiscreteSystems::DiscreteSystem, Block>::type());
+}
+
+/**
+ * @brief Cambia la política de registro de un DiscreteSystem (los núcleos no registran)
+ */
+template <class Block>
+void setPolicy(Block& b, DiscreteSystems::RecordingPolicy p, std::true_type) { b.setRecordingPolicy(p); }
+
+template <class Block>
+void setPolicy(Block&, DiscreteSystems::RecordingPolicy, std::false_type) {}
+
+template <class Block>
+void setPolicy(Block& b, DiscreteSystems::RecordingPolicy p) {
+    setPolicy(b, p, typename std::is_base_of<DiscreteSystems::DiscreteSystem, Block>::type());
+}
+
+/**
+ * @brief Registra un tramo en reposo en un DiscreteSystem (los núcleos no registran)
+ */
+template <class Block>
+void hold(Block& b, std::size_t n, double in, double out, std::true_type) { b.hold(n, in, out); }
+
+template <class Block>
+void hold(Block&, std::size_t, double, double, std::false_type) {}
+
+template <class Block>
+void hold(Block& b, std::size_t n, double in, double out) {
+    hold(b, n, in, out, typename std::is_base_of<DiscreteSystems::DiscreteSystem, Block>::type());
+}
+
+/**
+ * @brief Instantánea de un bloque: sólo los DiscreteSystem la admiten
+ *
+ * Los núcleos (FixedPID, SistemaFijo...) no tienen formato de instantánea;
+ * un lazo con núcleos se bifurca copiándolo.
+ */
+template <class Block>
+void checkpoint(const Block& b, DiscreteSystems::CheckpointWriter& w, std::true_type) { b.checkpoint(w); }
+
+template <class Block>
+void checkpoint(const Block&, DiscreteSystems::CheckpointWriter&, std::false_type) {
+    static_assert(sizeof(Block) == 0, "Lazo: las instantáneas sólo admiten bloques DiscreteSystem");
+}
+
+template <class Block>
+void checkpoint(const Block& b, DiscreteSystems::CheckpointWriter& w) {
+    checkpoint(b, w, typename std::is_base_of<DiscreteSystems::DiscreteSystem, Block>::type());
+}
+
+template <class Block>
+void restore(Block& b, DiscreteSystems::CheckpointReader& r, std::true_type) { b.restore(r); }
+
+template <class Block>
+void restore(Block&, DiscreteSystems::CheckpointReader&, std::false_type) {
+    static_assert(sizeof(Block) == 0, "Lazo: las instantáneas sólo admiten bloques DiscreteSystem");
+}
+
+template <class Block>
+void restore(Block& b, DiscreteSystems::CheckpointReader& r) {
+    restore(b, r, typename std::is_base_of<DiscreteSystems::DiscreteSystem, Block>::type());
+}
+
+} // namespace detail
+
+/**
+ * @struct SteadyState
+ * @brief Detector de reposo de LoopRunner::run(K)
+ *
+ * El lazo está en reposo cuando, durante window ticks seguidos, r no cambia
+ * y u e y no varían más de tolerance entre ticks. Entonces run(K) salta
+ * hasta el próximo cambio posible de la referencia (Signal::constantUntil())
+ * en tramos de como mucho maxSkip ticks, sin ejecutar los bloques.
+ *
+ * Con tolerance = 0 y window mayor que el orden de todos los bloques, el
+ * lazo está en un punto fijo exacto y el salto es idéntico bit a bit a
+ * ejecutar los ticks. Con tolerance > 0 se desprecia la deriva residual
+ * (p. ej. de la integral del PID).
+ */
+struct SteadyState {
+    std::size_t window;     ///< Ticks en reposo antes de saltar (0: desactivado)
+    double tolerance;       ///< Cota de |Δu| y |Δy| entre ticks consecutivos
+    std::size_t maxSkip;    ///< Ticks máximos por salto
+
+    /**
+     * @param window Ticks en reposo antes de saltar (default: 0, desactivado)
+     * @param tolerance Cota de |Δu| y |Δy| (default: 0, punto fijo exacto)
+     * @param maxSkip Ticks máximos por salto (default: sin límite)
+     */
+    explicit SteadyState(std::size_t window = 0, double tolerance = 0.0,
+                         std::size_t maxSkip = static_cast<std::size_t>(-1))
+        : window(window), tolerance(tolerance), maxSkip(maxSkip) {}
+};
+
+/**
+ * @class LoopRunner
+ * @brief Propietario de los cinco bloques y ejecutor del lazo cerrado
+ *
+ * Los tipos de los bloques son parámetros de plantilla, de modo que en el
+ * modo rápido (por defecto) cada tick es una secuencia de llamadas directas
+ * a step() de los tipos concretos: sin despacho virtual, sin escritura en
+ * los buffers circulares y sin E/S. La referencia se evalúa como
+ * Ref::computeAt(k * Ts) con llamada cualificada, también sin despacho.
+ * El bucle corre tan rápido como permite la CPU (sin esperas).
+ *
+ * En modo registro (setRecording(true)) cada bloque avanza con next(), de
+ * modo que sus buffers contienen el historial para bufferDump(). La
+ * referencia avanza entonces con Signal::next(), que evalúa en t = k·Ts igual
+ * que el modo rápido, de modo que ambos modos dan la misma referencia bit a
+ * bit (salvo que t() o T() de la señal se modifiquen desde fuera).
+ *
+ * Todos los bloques deben compartir el mismo período de muestreo.
+ *
+ * Con setSteadyState() run(K) salta los tramos en reposo (ver SteadyState).
+ * En modo registro los bloques DiscreteSystem reciben hold() en lugar de K
+ * muestras iguales, y la referencia avanza con Signal::hold().
+ *
+ * @tparam Ref   Señal de referencia concreta (p. ej. RefSignal::StepSignal)
+ * @tparam Pid   Regulador con step(e) (PIDController o FixedPID)
+ * @tparam Dac   Conversor D/A con step(u)
+ * @tparam Plant Planta con step(u) (Planta::Sistema o Planta::SistemaFijo)
+ * @tparam Adc   Conversor A/D con step(y) y delayed()
+ */
+template <class Ref,
+          class Pid = Controlador::PIDController,
+          class Dac = Convertidores::DAConverter,
+          class Plant = Planta::Sistema,
+          class Adc = Convertidores::ADConverter>
+class LoopRunner {
+    static_assert(!std::is_abstract<Ref>::value,
+                  "LoopRunner: Ref debe ser una señal concreta");
+
+public:
+    /** @name Tipos de los bloques */
+    ///@{
+    typedef Ref RefType;
+    typedef Pid PidType;
+    typedef Dac DacType;
+    typedef Plant PlantType;
+    typedef Adc AdcType;
+    ///@}
+
+    /**
+     * @brief Constructor: copia los cinco bloques
+     * @param ref Señal de referencia
+     * @param pid Regulador
+     * @param dac Conversor D/A
+     * @param plant Planta
+     * @param adc Conversor A/D
+     */
+    LoopRunner(const Ref& ref, const Pid& pid, const Dac& dac,
+               const Plant& plant, const Adc& adc)
+        : ref_(ref), pid_(pid), dac_(dac), plant_(plant), adc_(adc),
+          k_(0), recording_(false), steady_(), skipped_(0) {}
+
+    /**
+     * @brief Ejecuta un tick del lazo
+     * @return Señales del tick
+     */
+    TickData tick() { return recording_ ? tickRecorded() : tickFast(); }
+
+    /**
+     * @brief Ejecuta K ticks seguidos sin observador
+     *
+     * Con el detector de reposo activo, los tramos en reposo se saltan
+     * (cuentan en K y en skipped()).
+     *
+     * @param K Número de ticks
+     */
+    void run(std::size_t K) {
+        if (steady_.window != 0) {
+            runSkipping(K);
+        } else if (recording_) {
+            for (std::size_t i = 0; i < K; ++i) {
+                tickRecorded();
+            }
+        } else {
+            for (std::size_t i = 0; i < K; ++i) {
+                tickFast();
+            }
+        }
+    }
+
+    /**
+     * @brief Ejecuta hasta K ticks llamando al observador tras cada uno
+     *
+     * El observador recibe const TickData& y devuelve true para continuar o
+     * false para detener la simulación (p. ej. al detectar inestabilidad).
+     * Se instancia con el tipo concreto, por lo que se expande inline.
+     *
+     * @param K Número máximo de ticks
+     * @param observer Callable bool(const TickData&)
+     * @return Número de ticks ejecutados
+     */
+    template <class Observer>
+    std::size_t run(std::size_t K, Observer observer) {
+        for (std::size_t i = 0; i < K; ++i) {
+            const TickData d = recording_ ? tickRecorded() : tickFast();
+            if (!observer(d)) {
+                return i + 1;
+            }
+        }
+        return K;
+    }
+
+    /**
+     * @brief Reinicia el tick y el estado de los cinco bloques
+     */
+    void reset() {
+        ref_.reset();
+        pid_.reset();
+        dac_.reset();
+        plant_.reset();
+        adc_.reset();
+        k_ = 0;
+        skipped_ = 0;
+    }
+
+    /**
+     * @brief Configura el detector de reposo de run(K) (window = 0 lo desactiva)
+     */
+    void setSteadyState(const SteadyState& steady) { steady_ = steady; }
+
+    /**
+     * @brief Guarda el estado completo del lazo en la sección 'LOOP'
+     *
+     * Contiene el tick, el modo, el detector de reposo y, anidadas, las
+     * secciones de la referencia, el PID, el DAC, la planta y el ADC.
+     * Restaurada sobre un lazo construido con los mismos bloques, la
+     * simulación continúa bit a bit como el lazo original. Para bifurcar en
+     * memoria basta copiar el lazo (ver Barrido::SweepOptions::warm).
+     *
+     * @param w Escritor (p. ej. CheckpointWriter(false) para omitir los buffers)
+     */
+    void checkpoint(DiscreteSystems::CheckpointWriter& w) const {
+        w.begin(DiscreteSystems::checkpointTag('L', 'O', 'O', 'P'), 1);
+        w.writeU64(k_);
+        w.writeU64(recording_ ? 1 : 0);
+        w.writeU64(skipped_);
+        w.writeU64(steady_.window);
+        w.writeF64(steady_.tolerance);
+        w.writeU64(steady_.maxSkip);
+        ref_.checkpoint(w);
+        detail::checkpoint(pid_, w);
+        detail::checkpoint(dac_, w);
+        detail::checkpoint(plant_, w);
+        detail::checkpoint(adc_, w);
+        w.end();
+    }
+
+    /**
+     * @brief Restaura el estado guardado por checkpoint()
+     *
+     * Las ganancias del PID se restauran; el resto de coeficientes deben ser
+     * los del lazo guardado. Si lanza, el lazo puede quedar a medio
+     * restaurar y debe reiniciarse con reset().
+     *
+     * @throws DiscreteSystems::CheckpointError si la instantánea no corresponde a este lazo
+     */
+    void restore(DiscreteSystems::CheckpointReader& r) {
+        r.begin(DiscreteSystems::checkpointTag('L', 'O', 'O', 'P'), 1);
+        const std::size_t k = static_cast<std::size_t>(r.readU64());
+        const bool recording = r.readU64() != 0;
+        const std::size_t skipped = static_cast<std::size_t>(r.readU64());
+        SteadyState steady;
+        steady.window = static_cast<std::size_t>(r.readU64());
+        steady.tolerance = r.readF64();
+        steady.maxSkip = static_cast<std::size_t>(r.readU64());
+        ref_.restore(r);
+        detail::restore(pid_, r);
+        detail::restore(dac_, r);
+        detail::restore(plant_, r);
+        detail::restore(adc_, r);
+        r.end();
+        k_ = k;
+        recording_ = recording;
+        skipped_ = skipped;
+        steady_ = steady;
+    }
+
+    /**
+     * @brief Activa o desactiva el registro en los buffers de los bloques
+     * @param on true para avanzar con next(), false para el modo rápido
+     */
+    void setRecording(bool on) { recording_ = on; }
+
+    /**
+     * @brief Aplica la misma política de registro a los buffers de los bloques
+     *
+     * Sólo afecta al modo registro. Con RecordFields::Output o precisión
+     * Float cada tick mueve menos memoria; vacía los buffers.
+     *
+     * @param policy Política para el PID, el DAC, la planta y el ADC
+     */
+    void setRecordingPolicy(DiscreteSystems::RecordingPolicy policy) {
+        detail::setPolicy(pid_, policy);
+        detail::setPolicy(dac_, policy);
+        detail::setPolicy(plant_, policy);
+        detail::setPolicy(adc_, policy);
+    }
+
+    /** @name Getters */
+    ///@{
+    bool recording() const { return recording_; }
+    std::size_t getK() const { return k_; }
+    const SteadyState& steadyState() const { return steady_; }
+    std::size_t skipped() const { return skipped_; }   ///< Ticks saltados en reposo desde reset()
+    Ref& ref() { return ref_; }
+    Pid& pid() { return pid_; }
+    Dac& dac() { return dac_; }
+    Plant& plant() { return plant_; }
+    Adc& adc() { return adc_; }
+    ///@}
+
+private:
+    /**
+     * @brief Tick sin registro: llamadas directas a step()
+     */
+    TickData tickFast() {
+        TickData d;
+        d.k = k_;
+        d.r = ref_.Ref::computeAt(static_cast<double>(k_) * ref_.T());
+        d.s = adc_.delayed();
+        d.e = d.r - d.s;
+        d.u = pid_.step(d.e);
+        d.y = plant_.step(dac_.step(d.u));
+        adc_.step(d.y);
+        ++k_;
+        return d;
+    }
+
+    /**
+     * @brief Tick con registro en los buffers de cada bloque
+     */
+    TickData tickRecorded() {
+        TickData d;
+        d.k = k_;
+        d.r = ref_.next();
+        d.s = adc_.delayed();
+        d.e = d.r - d.s;
+        d.u = detail::record(pid_, d.e);
+        d.y = detail::record(plant_, detail::record(dac_, d.u));
+        detail::record(adc_, d.y);
+        ++k_;
+        return d;
+    }
+
+    /**
+     * @brief run(K) con el detector de reposo
+     */
+    void runSkipping(std::size_t K) {
+        std::size_t quiet = 0;
+        TickData prev = TickData();
+        for (std::size_t i = 0; i < K;) {
+            const TickData d = recording_ ? tickRecorded() : tickFast();
+            ++i;
+            // !(a <= b) también es cierto con NaN
+            const bool still = i > 1 && d.r == prev.r
+                            && std::fabs(d.u - prev.u) <= steady_.tolerance
+                            && std::fabs(d.y - prev.y) <= steady_.tolerance;
+            quiet = still ? quiet + 1 : 0;
+            prev = d;
+            if (quiet >= steady_.window && i < K) {
+                const std::size_t n = std::min(std::min(K - i, steady_.maxSkip), referenceHorizon());
+                if (n > 0) {
+                    skip(n, d);
+                    i += n;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Ticks desde k_ en los que la referencia sigue valiendo lo mismo
+     */
+    std::size_t referenceHorizon() const {
+        const double T = ref_.T();
+        const double until = ref_.Ref::constantUntil(static_cast<double>(k_ - 1) * T);
+        const double ticks = until / T;
+        if (!(ticks < 1e18)) {
+            return static_cast<std::size_t>(-1);
+        }
+        // Primer j con j*T >= until, con la misma aritmética que tickFast()
+        std::size_t j = static_cast<std::size_t>(ticks);
+        while (j > 0 && static_cast<double>(j - 1) * T >= until) {
+            --j;
+        }
+        while (static_cast<double>(j) * T < until) {
+            ++j;
+        }
+        return j > k_ ? j - k_ : 0;
+    }
+
+    /**
+     * @brief Salta n ticks manteniendo las señales del último
+     */
+    void skip(std::size_t n, const TickData& d) {
+        if (recording_) {
+            ref_.hold(n, d.r);
+            detail::hold(pid_, n, d.e, d.u);
+            detail::hold(dac_, n, d.u, d.u);
+            detail::hold(plant_, n, d.u, d.y);
+            detail::hold(adc_, n, d.y, d.s);
+        }
+        k_ += n;
+        skipped_ += n;
+    }
+
+    Ref ref_;                 ///< Señal de referencia
+    Pid pid_;                 ///< Regulador
+    Dac dac_;                 ///< Conversor D/A
+    Plant plant_;             ///< Planta
+    Adc adc_;                 ///< Conversor A/D
+    std::size_t k_;           ///< Tick actual
+    bool recording_;          ///< Modo registro activo
+    SteadyState steady_;      ///< Detector de reposo de run(K)
+    std::size_t skipped_;     ///< Ticks saltados en reposo
+};
+
+/**
+ * @struct Rates
+ * @brief Grupos de tasa de MultirateLoop, en pasos de planta
+ *
+ * La planta avanza en cada paso fino Tp. El control (referencia, PID y DAC)
+ * avanza cada plantPerControl pasos (Ts = plantPerControl·Tp) y el ADC
+ * muestrea cada plantPerAdc pasos, que debe dividir a plantPerControl.
+ */
+struct Rates {
+    std::size_t plantPerControl;   ///< Pasos de planta por tick del control
+    std::size_t plantPerAdc;       ///< Pasos de planta por muestra del ADC
+
+    /**
+     * @param control Pasos de planta por tick del control (el ADC a la misma tasa)
+     */
+    explicit Rates(std::size_t control = 1) : plantPerControl(control), plantPerAdc(control) {}
+
+    /**
+     * @param control Pasos de planta por tick del control
+     * @param adc Pasos de planta por muestra del ADC (divisor de control)
+     */
+    Rates(std::size_t control, std::size_t adc) : plantPerControl(control), plantPerAdc(adc) {}
+};
+
+/**
+ * @class MultirateLoop
+ * @brief Lazo cerrado con la planta a una tasa entera más rápida que el control
+ *
+ * Cada tick() es un período del control Ts y contiene N = plantPerControl
+ * pasos de planta Tp = Ts / N:
+ *
+ *     r(k) = Ref(k)                   s(k) = última muestra del ADC
+ *     u(k) = PID(r(k) - s(k))         DAC(u(k)): retenido N pasos (ZOH)
+ *     y(kN + j) = Planta(u(k)),  j = 0..N-1
+ *     ADC(y) al final de cada grupo de plantPerAdc pasos (muestreo y retención)
+ *
+ * Los bloques lentos no se tocan en los pasos intermedios: el bucle interno
+ * sólo llama a la planta y, en el paso de muestreo, al ADC. Con N = 1
+ * coincide bit a bit con LoopRunner.
+ *
+ * La referencia, el PID y el DAC se construyen con el período del control
+ * Ts, la planta con Tp (p. ej. Planta::Sistema::tustin(Ts / N)) y el ADC con
+ * su propio período Tp·plantPerAdc: step() se llama plantPerControl /
+ * plantPerAdc veces por tick, de modo que con otro período sus instantes
+ * (y su buffer) no corresponderían al tiempo de planta.
+ *
+ * @tparam Ref, Pid, Dac, Plant, Adc Como en LoopRunner
+ */
+template <class Ref,
+          class Pid = Controlador::PIDController,
+          class Dac = Convertidores::DAConverter,
+          class Plant = Planta::Sistema,
+          class Adc = Convertidores::ADConverter>
+class MultirateLoop {
+    static_assert(!std::is_abstract<Ref>::value,
+                  "MultirateLoop: Ref debe ser una señal concreta");
+
+public:
+    /** @name Tipos de los bloques */
+    ///@{
+    typedef Ref RefType;
+    typedef Pid PidType;
+    typedef Dac DacType;
+    typedef Plant PlantType;
+    typedef Adc AdcType;
+    ///@}
+
+    /**
+     * @brief Constructor: copia los cinco bloques
+     * @param rates Pasos de planta por tick del control y por muestra del ADC
+     * @throws InvalidSamplingTime si alguna razón es 0 o plantPerAdc no divide a plantPerControl
+     */
+    MultirateLoop(const Ref& ref, const Pid& pid, const Dac& dac,
+                  const Plant& plant, const Adc& adc, const Rates& rates)
+        : ref_(ref), pid_(pid), dac_(dac), plant_(plant), adc_(adc),
+          rates_(rates), samplesPerTick_(0), k_(0), recording_(false) {
+        if (rates.plantPerControl == 0 || rates.plantPerAdc == 0
+            || rates.plantPerControl % rates.plantPerAdc != 0) {
+            throw DiscreteSystems::InvalidSamplingTime(
+                "MultirateLoop: plantPerAdc debe ser no nulo y dividir a plantPerControl");
+        }
+        samplesPerTick_ = rates.plantPerControl / rates.plantPerAdc;
+    }
+
+    /**
+     * @brief Ejecuta un período del control (plantPerControl pasos de planta)
+     * @return Señales del tick; y es la salida del último paso de planta
+     */
+    TickData tick() { return recording_ ? tickRecorded() : tickFast(); }
+
+    /**
+     * @brief Ejecuta K períodos del control sin observador
+     */
+    void run(std::size_t K) {
+        if (recording_) {
+            for (std::size_t i = 0; i < K; ++i) {
+                tickRecorded();
+            }
+        } else {
+            for (std::size_t i = 0; i < K; ++i) {
+                tickFast();
+            }
+        }
+    }
+
+    /**
+     * @brief Ejecuta hasta K períodos llamando al observador tras cada uno
+     * @see LoopRunner::run(std::size_t, Observer)
+     */
+    template <class Observer>
+    std::size_t run(std::size_t K, Observer observer) {
+        for (std::size_t i = 0; i < K; ++i) {
+            const TickData d = recording_ ? tickRecorded() : tickFast();
+            if (!observer(d)) {
+                return i + 1;
+            }
+        }
+        return K;
+    }
+
+    /**
+     * @brief Reinicia el tick y el estado de los cinco bloques
+     */
+    void reset() {
+        ref_.reset();
+        pid_.reset();
+        dac_.reset();
+        plant_.reset();
+        adc_.reset();
+        k_ = 0;
+    }
+
+    /**
+     * @brief Activa o desactiva el registro (next() en cada bloque, a su tasa)
+     */
+    void setRecording(bool on) { recording_ = on; }
+
+    /**
+     * @brief Guarda el estado del lazo en la sección 'MRLP'
+     * @see LoopRunner::checkpoint()
+     */
+    void checkpoint(DiscreteSystems::CheckpointWriter& w) const {
+        w.begin(DiscreteSystems::checkpointTag('M', 'R', 'L', 'P'), 1);
+        w.writeU64(k_);
+        w.writeU64(recording_ ? 1 : 0);
+        w.writeU64(rates_.plantPerControl);
+        w.writeU64(rates_.plantPerAdc);
+        ref_.checkpoint(w);
+        detail::checkpoint(pid_, w);
+        detail::checkpoint(dac_, w);
+        detail::checkpoint(plant_, w);
+        detail::checkpoint(adc_, w);
+        w.end();
+    }
+
+    /**
+     * @brief Restaura el estado guardado por checkpoint()
+     * @throws DiscreteSystems::CheckpointError si las tasas o los bloques no coinciden
+     * @see LoopRunner::restore()
+     */
+    void restore(DiscreteSystems::CheckpointReader& r) {
+        r.begin(DiscreteSystems::checkpointTag('M', 'R', 'L', 'P'), 1);
+        const std::size_t k = static_cast<std::size_t>(r.readU64());
+        const bool recording = r.readU64() != 0;
+        const uint64_t control = r.readU64();
+        const uint64_t adc = r.readU64();
+        if (control != rates_.plantPerControl || adc != rates_.plantPerAdc) {
+            throw DiscreteSystems::CheckpointError("MultirateLoop: las tasas de la instantánea no coinciden");
+        }
+        ref_.restore(r);
+        detail::restore(pid_, r);
+        detail::restore(dac_, r);
+        detail::restore(plant_, r);
+        detail::restore(adc_, r);
+        r.end();
+        k_ = k;
+        recording_ = recording;
+    }
+
+    /**
+     * @brief Aplica la misma política de registro a los buffers de los bloques
+     */
+    void setRecordingPolicy(DiscreteSystems::RecordingPolicy policy) {
+        detail::setPolicy(pid_, policy);
+        detail::setPolicy(dac_, policy);
+        detail::setPolicy(plant_, policy);
+        detail::setPolicy(adc_, policy);
+    }
+
+    /** @name Getters */
+    ///@{
+    bool recording() const { return recording_; }
+    const Rates& rates() const { return rates_; }
+    std::size_t getK() const { return k_; }                                    ///< Ticks del control
+    std::size_t getPlantK() const { return k_ * rates_.plantPerControl; }      ///< Pasos de planta
+    Ref& ref() { return ref_; }
+    Pid& pid() { return pid_; }
+    Dac& dac() { return dac_; }
+    Plant& plant() { return plant_; }
+    Adc& adc() { return adc_; }
+    ///@}
+
+private:
+    TickData tickFast() {
+        TickData d;
+        d.k = k_;
+        d.r = ref_.Ref::computeAt(static_cast<double>(k_) * ref_.T());
+        d.s = adc_.delayed();
+        d.e = d.r - d.s;
+        d.u = pid_.step(d.e);
+        const double held = dac_.step(d.u);
+        double y = 0.0;
+        for (std::size_t a = 0; a < samplesPerTick_; ++a) {
+            for (std::size_t j = 0; j < rates_.plantPerAdc; ++j) {
+                y = plant_.step(held);
+            }
+            adc_.step(y);
+        }
+        d.y = y;
+        ++k_;
+        return d;
+    }
+
+    TickData tickRecorded() {
+        TickData d;
+        d.k = k_;
+        d.r = ref_.next();
+        d.s = adc_.delayed();
+        d.e = d.r - d.s;
+        d.u = detail::record(pid_, d.e);
+        const double held = detail::record(dac_, d.u);
+        double y = 0.0;
+        for (std::size_t a = 0; a < samplesPerTick_; ++a) {
+            for (std::size_t j = 0; j < rates_.plantPerAdc; ++j) {
+                y = detail::record(plant_, held);
+            }
+            detail::record(adc_, y);
+        }
+        d.y = y;
+        ++k_;
+        return d;
+    }
+
+    Ref ref_;                      ///< Señal de referencia (período del control)
+    Pid pid_;                      ///< Regulador
+    Dac dac_;                      ///< Conversor D/A
+    Plant plant_;                  ///< Planta (paso fino)
+    Adc adc_;                      ///< Conversor A/D
+    Rates rates_;                  ///< Grupos de tasa
+    std::size_t samplesPerTick_;   ///< Muestras del ADC por tick del control
+    std::size_t k_;                ///< Tick del control
+    bool recording_;               ///< Modo registro activo
+};
+
+/**
+ * @brief Construye un LoopRunner deduciendo los tipos de los bloques
+ */
+template <class Ref, class Pid, class Dac, class Plant, class Adc>
+LoopRunner<Ref, Pid, Dac, Plant, Adc>
+makeLoop(const Ref& ref, const Pid& pid, const Dac& dac, const Plant& plant, const Adc& adc) {
+    return LoopRunner<Ref, Pid, Dac, Plant, Adc>(ref, pid, dac, plant, adc);
+}
+
+/**
+ * @brief Construye un MultirateLoop deduciendo los tipos de los bloques
+ */
+template <class Ref, class Pid, class Dac, class Plant, class Adc>
+MultirateLoop<Ref, Pid, Dac, Plant, Adc>
+makeMultirateLoop(const Ref& ref, const Pid& pid, const Dac& dac, const Plant& plant, const Adc& adc,
+                  const Rates& rates) {
+    return MultirateLoop<Ref, Pid, Dac, Plant, Adc>(ref, pid, dac, plant, adc, rates);
+}
+
+/**
+ * @struct LoopAnalysis
+ * @brief Lazo abierto, polos en lazo cerrado y márgenes (ver analyzeLoop())
+ */
+struct LoopAnalysis {
+    std::vector<double> b;                                    ///< Numerador de L(z) en potencias de z^-1
+    std::vector<double> a;                                    ///< Denominador de L(z)
+    std::vector<DiscreteSystems::Analysis::Complex> poles;    ///< Polos de L / (1 + L)
+    bool stable;                                              ///< Todos los polos con |p| < 1
+    DiscreteSystems::Analysis::Margins margins;               ///< Márgenes de L
+};
+
+/**
+ * @brief Analiza el lazo de LoopRunner sin simularlo
+ *
+ * Con el DAC ideal y el retardo de un tick del ADC, el lazo abierto es
+ * L(z) = C(z) G(z) z^-1, con C de PIDController::getTransferFunction() y G
+ * los coeficientes de la planta; el lazo cerrado r → y es L / (1 + L).
+ *
+ * @param pid Regulador (últimas ganancias publicadas)
+ * @param plant Planta al mismo período que el regulador
+ * @param points Puntos de la rejilla de búsqueda de los márgenes (default: 4096)
+ * @throws InvalidSamplingTime si los períodos no coinciden
+ */
+inline LoopAnalysis analyzeLoop(const Controlador::PIDController& pid,
+                                const DiscreteSystems::TransferFunctionSystem& plant,
+                                std::size_t points = 4096) {
+    namespace An = DiscreteSystems::Analysis;
+    if (pid.getSamplingTime() != plant.getSamplingTime()) {
+        throw DiscreteSystems::InvalidSamplingTime("analyzeLoop: el PID y la planta deben tener el mismo Ts");
+    }
+    std::vector<double> bc, ac;
+    pid.getTransferFunction(bc, ac);
+    const std::vector<double> delay = {0.0, 1.0};
+    LoopAnalysis r;
+    r.b = DiscreteSystems::Polynomial::multiply(DiscreteSystems::Polynomial::multiply(bc, plant.getNumerator()), delay);
+    r.a = DiscreteSystems::Polynomial::multiply(ac, plant.getDenominator());
+    // 1 + L = (a + b) / a
+    std::vector<double> closed(std::max(r.a.size(), r.b.size()), 0.0);
+    for (std::size_t i = 0; i < closed.size(); ++i) {
+        closed[i] = (i < r.a.size() ? r.a[i] : 0.0) + (i < r.b.size() ? r.b[i] : 0.0);
+    }
+    r.poles = An::poles(r.b, closed);
+    r.stable = An::isStable(r.poles);
+    r.margins = An::margins(r.b, r.a, plant.getSamplingTime(), points);
+    return r;
+}
+
+} // namespace Lazo
+
+/** @} */ // fin del grupo Lazo
+
+#endif // LAZO_H
@@ -0,0 +1,317 @@
+/**
+ * @file metricas.h
+ * @brief Métricas de respuesta calculadas en línea: IAE/ISE/ITAE, sobreoscilación, subida y establecimiento
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef METRICAS_H
+#define METRICAS_H
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <ostream>
+
+/**
+ * @defgroup Metricas Métricas de Respuesta
+ * @brief Evaluación incremental de la respuesta sin guardar la traza
+ *
+ * StepResponse recibe en cada tick la referencia r(k) y la salida y(k) de
+ * cualquier bloque (el lazo, un DiscreteSystem, una Signal) y actualiza en
+ * O(1), sin memoria adicional:
+ * - Criterios integrales sobre e(k) = r(k) - y(k): IAE, ISE e ITAE
+ * - Del último escalón de la referencia: sobreoscilación, tiempo de subida
+ *   (10 % → 90 %), tiempo de establecimiento en una banda y error
+ *   estacionario
+ *
+ * Con Limits se puede abortar la simulación en cuanto una cota se supera:
+ * update() devuelve false, igual que un observador de LoopRunner::run().
+ *
+ * @{
+ */
+
+namespace Metricas {
+
+/**
+ * @enum Abort
+ * @brief Cota que detuvo la evaluación
+ */
+enum class Abort {
+    None,        ///< Ninguna: la evaluación sigue
+    Iae,         ///< IAE > Limits::maxIae
+    Ise,         ///< ISE > Limits::maxIse
+    Itae,        ///< ITAE > Limits::maxItae
+    Overshoot,   ///< Sobreoscilación > Limits::maxOvershoot
+    Output       ///< |y| > Limits::maxAbsOutput o y no finita
+};
+
+/**
+ * @brief Nombre legible de la causa de aborto
+ */
+inline const char* toString(Abort a) {
+    switch (a) {
+        case Abort::None:      return "ninguna";
+        case Abort::Iae:       return "IAE";
+        case Abort::Ise:       return "ISE";
+        case Abort::Itae:      return "ITAE";
+        case Abort::Overshoot: return "sobreoscilación";
+        case Abort::Output:    return "salida";
+    }
+    return "";
+}
+
+/**
+ * @struct Limits
+ * @brief Cotas de aborto anticipado (infinitas por defecto: sin aborto)
+ */
+struct Limits {
+    double maxIae;         ///< Cota de IAE
+    double maxIse;         ///< Cota de ISE
+    double maxItae;        ///< Cota de ITAE
+    double maxOvershoot;   ///< Cota de sobreoscilación [%]
+    double maxAbsOutput;   ///< Cota de |y|
+
+    Limits()
+        : maxIae(std::numeric_limits<double>::infinity()),
+          maxIse(std::numeric_limits<double>::infinity()),
+          maxItae(std::numeric_limits<double>::infinity()),
+          maxOvershoot(std::numeric_limits<double>::infinity()),
+          maxAbsOutput(std::numeric_limits<double>::infinity()) {}
+};
+
+/**
+ * @struct Summary
+ * @brief Valores de las métricas en un instante
+ *
+ * Los tiempos se miden desde el último escalón de la referencia y valen NaN
+ * mientras no están definidos (umbral no alcanzado o salida fuera de banda).
+ */
+struct Summary {
+    double iae;                ///< Σ |e|·Ts
+    double ise;                ///< Σ e²·Ts
+    double itae;               ///< Σ t·|e|·Ts, con t desde reset()
+    double overshoot;          ///< Pico sobre la referencia [% del salto]
+    double riseTime;           ///< Del 10 % al 90 % del salto [s]
+    double settlingTime;       ///< Entrada definitiva en la banda [s]
+    double steadyStateError;   ///< e del último tick
+    double stepTime;           ///< Instante del último escalón [s]
+    std::size_t ticks;         ///< Ticks evaluados
+    Abort abort;               ///< Cota superada (None si ninguna)
+};
+
+/**
+ * @class StepResponse
+ * @brief Evaluador incremental de la respuesta a escalones
+ *
+ * Cada cambio del valor de r(k) inicia un escalón nuevo: las métricas de
+ * escalón se reinician con el salto r(k) - y(k-1) y la banda de
+ * establecimiento es ±band·|salto| alrededor de r(k). Para referencias que
+ * varían en cada tick (rampa, seno) sólo tienen sentido las integrales.
+ *
+ * Los criterios integrales se acumulan desde reset() (o la construcción).
+ */
+class StepResponse {
+public:
+    /**
+     * @class Observer
+     * @brief Adaptador para LoopRunner::run(K, observador), que copia el observador
+     */
+    class Observer {
+    public:
+        explicit Observer(StepResponse* m) : m_(m) {}
+        template <class Tick>
+        bool operator()(const Tick& d) const { return m_->update(d.r, d.y); }
+    private:
+        StepResponse* m_;
+    };
+
+    /**
+     * @brief Constructor
+     * @param Ts Período de muestreo [s]
+     * @param band Semianchura relativa de la banda de establecimiento (default: 2 %)
+     * @param limits Cotas de aborto anticipado
+     * @param y0 Salida anterior al primer tick (default: 0, planta en reposo)
+     */
+    explicit StepResponse(double Ts, double band = 0.02, const Limits& limits = Limits(), double y0 = 0.0)
+        : Ts_(Ts), band_(band), limits_(limits) {
+        reset(y0);
+    }
+
+    /**
+     * @brief Procesa la muestra de un tick
+     * @param r Referencia r(k)
+     * @param y Salida y(k)
+     * @return false si alguna cota se ha superado (en este tick o antes)
+     */
+    bool update(double r, double y) {
+        if (abort_ != Abort::None) {
+            return false;
+        }
+        if (k_ == 0 || r != target_) {
+            startStep(r);
+        }
+
+        const double e = r - y;
+        const double ae = std::fabs(e);
+        const double t = static_cast<double>(k_) * Ts_;
+        iae_ += ae * Ts_;
+        ise_ += e * e * Ts_;
+        itae_ += t * ae * Ts_;
+        lastError_ = e;
+
+        const std::size_t i = k_ - stepK_;
+        if (span_ != 0.0) {
+            const double p = (y - y0_) / span_;
+            if (p > peak_) {
+                peak_ = p;
+            }
+            if (riseLow_ == kNone && p >= 0.1) {
+                riseLow_ = i;
+            }
+            if (riseHigh_ == kNone && p >= 0.9) {
+                riseHigh_ = i;
+            }
+        }
+        // !(a <= b) también es cierto con NaN
+        outside_ = !(ae <= band_ * std::fabs(span_));
+        if (outside_) {
+            lastOutside_ = i;
+        }
+
+        yPrev_ = y;
+        ++k_;
+        return check(y);
+    }
+
+    /**
+     * @brief Forma de observador: update(d.r, d.y)
+     */
+    template <class Tick>
+    bool operator()(const Tick& d) { return update(d.r, d.y); }
+
+    /**
+     * @brief Observador por referencia para LoopRunner::run() y Pipeline::run()
+     */
+    Observer observer() { return Observer(this); }
+
+    /**
+     * @brief Reinicia todas las métricas
+     * @param y0 Salida anterior al primer tick
+     */
+    void reset(double y0 = 0.0) {
+        k_ = 0;
+        iae_ = ise_ = itae_ = 0.0;
+        lastError_ = 0.0;
+        yPrev_ = y0;
+        abort_ = Abort::None;
+        target_ = 0.0;
+        y0_ = y0;
+        span_ = 0.0;
+        stepK_ = 0;
+        peak_ = 0.0;
+        riseLow_ = riseHigh_ = lastOutside_ = kNone;
+        outside_ = false;
+    }
+
+    /**
+     * @brief Métricas en el último tick procesado
+     */
+    Summary summary() const {
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        Summary s;
+        s.iae = iae_;
+        s.ise = ise_;
+        s.itae = itae_;
+        s.overshoot = peak_ > 1.0 ? (peak_ - 1.0) * 100.0 : 0.0;
+        s.riseTime = (riseLow_ != kNone && riseHigh_ != kNone)
+                   ? static_cast<double>(riseHigh_ - riseLow_) * Ts_ : nan;
+        s.settlingTime = (k_ == 0 || outside_) ? nan
+                       : lastOutside_ == kNone ? 0.0
+                       : static_cast<double>(lastOutside_ + 1) * Ts_;
+        s.steadyStateError = lastError_;
+        s.stepTime = static_cast<double>(stepK_) * Ts_;
+        s.ticks = k_;
+        s.abort = abort_;
+        return s;
+    }
+
+    /** @name Getters */
+    ///@{
+    std::size_t ticks() const { return k_; }
+    bool aborted() const { return abort_ != Abort::None; }
+    Abort abortReason() const { return abort_; }
+    const Limits& limits() const { return limits_; }
+    void setLimits(const Limits& limits) { limits_ = limits; }
+    ///@}
+
+private:
+    /// Marca de "umbral no alcanzado"
+    static const std::size_t kNone = static_cast<std::size_t>(-1);
+
+    void startStep(double r) {
+        target_ = r;
+        y0_ = yPrev_;
+        span_ = r - yPrev_;
+        stepK_ = k_;
+        peak_ = 0.0;
+        riseLow_ = riseHigh_ = lastOutside_ = kNone;
+    }
+
+    bool check(double y) {
+        if (!(std::fabs(y) <= limits_.maxAbsOutput)) {
+            abort_ = Abort::Output;
+        } else if (iae_ > limits_.maxIae) {
+            abort_ = Abort::Iae;
+        } else if (ise_ > limits_.maxIse) {
+            abort_ = Abort::Ise;
+        } else if (itae_ > limits_.maxItae) {
+            abort_ = Abort::Itae;
+        } else if ((peak_ - 1.0) * 100.0 > limits_.maxOvershoot) {
+            abort_ = Abort::Overshoot;
+        } else {
+            return true;
+        }
+        return false;
+    }
+
+    double Ts_;                 ///< Período de muestreo
+    double band_;               ///< Banda de establecimiento relativa
+    Limits limits_;             ///< Cotas de aborto
+
+    std::size_t k_;             ///< Ticks procesados
+    double iae_, ise_, itae_;   ///< Criterios integrales
+    double lastError_;          ///< e del último tick
+    double yPrev_;              ///< y del último tick
+    Abort abort_;               ///< Causa de aborto
+
+    // Escalón en curso
+    double target_;             ///< Valor de r del escalón
+    double y0_;                 ///< Salida al iniciarse
+    double span_;               ///< Salto r - y0
+    std::size_t stepK_;         ///< Tick de inicio
+    double peak_;               ///< Máximo de (y - y0) / salto
+    std::size_t riseLow_;       ///< Primer tick (relativo) al 10 %
+    std::size_t riseHigh_;      ///< Primer tick (relativo) al 90 %
+    std::size_t lastOutside_;   ///< Último tick (relativo) fuera de banda
+    bool outside_;              ///< El último tick quedó fuera de banda
+};
+
+/**
+ * @brief Escribe el resumen en una línea
+ */
+inline std::ostream& operator<<(std::ostream& os, const Summary& s) {
+    os << "IAE=" << s.iae << " ISE=" << s.ise << " ITAE=" << s.itae
+       << " Mp=" << s.overshoot << "% tr=" << s.riseTime << "s ts=" << s.settlingTime
+       << "s ess=" << s.steadyStateError;
+    if (s.abort != Abort::None) {
+        os << " (abortado: " << toString(s.abort) << ")";
+    }
+    return os;
+}
+
+} // namespace Metricas
+
+/** @} */ // fin del grupo Metricas
+
+#endif // METRICAS_H
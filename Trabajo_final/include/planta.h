@@ -9,6 +9,7 @@
 #define PLANTA_H
 
 #include <DiscreteSystems/TransferFunctionSystem.h>
+#include <DiscreteSystems/FixedSystems.h>
 
 /**
  * @defgroup Planta Sistema/Planta de Control
@@ -46,8 +47,50 @@ public:
      * @param bufferSize Tamaño del buffer (default: 1024)
      */
     Sistema(double Tp = 0.01, size_t bufferSize = 1024);
+
+    /**
+     * @brief Planta discretizada con Tustin al período indicado
+     * 
+     * \f$ b_0 = b_1 = \frac{T_p}{T_p + 2\tau}, \quad a_1 = \frac{T_p - 2\tau}{T_p + 2\tau}, \quad \tau = 0.5 \f$
+     * 
+     * A diferencia del constructor, que usa siempre los coeficientes
+     * redondeados de Tp = 0.01s, sirve para integrar la planta a un paso
+     * más fino que el control (Lazo::MultirateLoop).
+     * 
+     * @param Tp Período de muestreo de la planta [s]
+     * @param bufferSize Tamaño del buffer (default: 1024)
+     * @throws InvalidSamplingTime si Tp <= 0
+     */
+    static Sistema tustin(double Tp, size_t bufferSize = 1024);
+
+private:
+    Sistema(const std::vector<double>& b, const std::vector<double>& a, double Tp, size_t bufferSize);
 };
 
+/**
+ * @struct CoeficientesPlanta
+ * @brief Coeficientes constexpr de la planta para StaticTransferFunction
+ * 
+ * b = [0.0099, 0.0099], a = [1.0, -0.9802]
+ */
+struct CoeficientesPlanta {
+    static const std::size_t M = 1;   ///< Orden del numerador
+    static const std::size_t N = 1;   ///< Orden del denominador
+
+    static constexpr double b(std::size_t i) { return i == 0 ? 0.0099 : 0.0099; }
+    static constexpr double a(std::size_t i) { return i == 0 ? 1.0 : -0.9802; }
+};
+
+/**
+ * @typedef SistemaFijo
+ * @brief Núcleo de la planta con orden y coeficientes fijados en compilación
+ * 
+ * Misma respuesta que Sistema (bit a bit) pero sin vectores, sin bucles de
+ * cota variable y sin despacho virtual. Para usarlo como DiscreteSystem:
+ * DiscreteSystems::FixedSystemAdapter<SistemaFijo>.
+ */
+typedef DiscreteSystems::StaticTransferFunction<CoeficientesPlanta> SistemaFijo;
+
 } // namespace Planta
 
 /** @} */ // fin del grupo Planta
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <vector>
-#include <deque>
 #include <memory>
+#include <string>
 #include <ostream>
 #include <cstddef>
 #include <cmath>
 
+namespace DiscreteSystems {
+class CheckpointWriter;
+class CheckpointReader;
+}
+
 /**
  * @defgroup RefSignal Generador de Señal de Referencia
  * @brief Módulo para generar señales de referencia discretas para el sistema de control.
@@ -15,11 +20,13 @@
  * - Escalón (step)
  * - Rampa (ramp)
  * - Senoidal (sine)
+ * - Tabla reproducida desde fichero proyectado en memoria (TableSignal)
+ * - Suma y concatenación de las anteriores (SumSignal, PiecewiseSignal)
  *
  * Diseño:
  * - Clase base abstracta Signal con interfaz común
  * - Subclases concretas para cada tipo de señal
- * - Buffers circulares para almacenar historial de tiempos y valores
+ * - Buffers circulares preasignados para el historial de tiempos y valores
  * - Separación entre computación pura (compute) y muestreo (next)
  *
  * @{
@@ -27,6 +34,34 @@
 
 namespace RefSignal {
 
+/**
+ * @brief Vista contigua de sólo lectura sobre el historial de una señal.
+ *
+ * Apunta directamente al almacenamiento de la señal: no copia y deja de ser
+ * válida en la siguiente llamada a next() o reset().
+ */
+class BufferView {
+    const double* data_;    /**< Primer elemento (el más antiguo) */
+    std::size_t size_;      /**< Número de elementos */
+
+public:
+    typedef const double* const_iterator;
+
+    BufferView() : data_(nullptr), size_(0) {}
+    BufferView(const double* data, std::size_t size) : data_(data), size_(size) {}
+
+    const double* data() const { return data_; }
+    std::size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    const double& operator[](std::size_t i) const { return data_[i]; }
+    const double& front() const { return data_[0]; }
+    const double& back() const { return data_[size_ - 1]; }
+
+    const_iterator begin() const { return data_; }
+    const_iterator end() const { return data_ + size_; }
+};
+
 /**
  * @brief Clase base para señales temporizadas discretas de referencia.
  *
@@ -43,18 +78,36 @@ protected:
     double Ts_;             /**< Período de muestreo [s] */
     double offset_;         /**< Desplazamiento vertical */
     double t_;              /**< Tiempo actual [s] */
+    std::size_t k_;         /**< Índice de la próxima muestra (t_ == k_ * Ts_) */
     std::size_t buffer_size_;  /**< Tamaño máximo del buffer circular */
 
-    std::deque<double> time_buffer_;     /**< Buffer circular de tiempos */
-    std::deque<double> value_buffer_;    /**< Buffer circular de valores */
+    /*
+     * Anillos espejados de 2 * capacity_ elementos: cada muestra se escribe
+     * en head_ y en head_ + capacity_, de modo que las últimas count_
+     * muestras son siempre contiguas y se sirven como BufferView sin copiar.
+     */
+    std::vector<double> time_buffer_;    /**< Buffer circular de tiempos */
+    std::vector<double> value_buffer_;   /**< Buffer circular de valores */
+    std::size_t capacity_;  /**< Capacidad reservada (sigue a buffer_size_) */
+    std::size_t head_;      /**< Próxima posición de escritura en [0, capacity_) */
+    std::size_t count_;     /**< Muestras almacenadas (<= capacity_) */
 
     /**
      * @brief Añade un par (time, value) al buffer circular.
+     *
+     * No reserva memoria salvo que se haya cambiado bufferSize() desde la
+     * última muestra.
      * @param time Tiempo a almacenar.
      * @param value Valor de la señal a almacenar.
      */
     void addToBuffer(double time, double value);
 
+    /**
+     * @brief Ajusta los anillos a buffer_size_ conservando las muestras más recientes.
+     * @throw std::invalid_argument si buffer_size_ == 0.
+     */
+    void resizeBuffer();
+
 public:
     /**
      * @brief Constructor de la clase Signal.
@@ -89,17 +142,73 @@ public:
      * Realiza:
      * 1. Computa el valor en t_ actual
      * 2. Almacena (t_, value) en los buffers
-     * 3. Avanza t_ += Ts
+     * 3. Avanza t_ = k * Ts (sin acumular error de redondeo)
+     *
+     * Si t() o T() se modifican desde fuera, el avance vuelve a ser t_ += Ts
+     * hasta el siguiente reset().
      *
      * @return Valor calculado antes de avanzar el tiempo.
      */
     virtual double next();
 
+    /**
+     * @brief Avanza n muestras de valor conocido sin calcularlas.
+     *
+     * Deja t_ donde lo dejarían n llamadas a next() (salvo redondeo si t()
+     * o T() se modificaron desde fuera) y almacena las últimas
+     * min(n, buffer_size) con el valor dado. Lo usa Lazo::LoopRunner al
+     * saltar tramos en reposo.
+     * @param n Número de muestras.
+     * @param value Valor de la señal en todo el tramo.
+     */
+    void hold(std::size_t n, double value);
+
+    /**
+     * @brief Fin del intervalo en que la señal es constante a partir de time.
+     *
+     * La señal vale computeAt(time) en todo [time, constantUntil(time)). La
+     * implementación por defecto no da ninguna garantía y devuelve time;
+     * infinito indica que la señal ya no cambia.
+     * @param time Tiempo en segundos.
+     * @return Tiempo del próximo cambio posible [s].
+     */
+    virtual double constantUntil(double time) const;
+
+    /**
+     * @brief Genera un bloque de muestras sin modificar estado.
+     *
+     * out[i] = valor en time = (k0 + i) * Ts. Las subclases lo implementan
+     * con bucles sin saltos que el compilador vectoriza; no pasa por los
+     * buffers ni por computeAt().
+     *
+     * @param out Destino (al menos n elementos).
+     * @param n Número de muestras.
+     * @param k0 Índice de la primera muestra (default: 0).
+     */
+    virtual void generate(double* out, std::size_t n, std::size_t k0 = 0) const;
+
     /**
      * @brief Reinicia la señal: pone t_ a 0 y limpia los buffers.
      */
     virtual void reset();
 
+    /**
+     * @brief Guarda el instante actual y el historial en la sección 'SIGN'.
+     *
+     * Los parámetros de la señal (amplitud, tabla, offset...) no forman parte
+     * del estado: se restaura sobre una señal construida igual. Con una
+     * instantánea sin buffers sólo se guarda el instante.
+     * @param w Escritor de la instantánea.
+     */
+    void checkpoint(DiscreteSystems::CheckpointWriter& w) const;
+
+    /**
+     * @brief Restaura el estado guardado por checkpoint().
+     * @param r Lector posicionado en la sección 'SIGN'.
+     * @throw DiscreteSystems::CheckpointError si la sección no es válida o Ts no coincide.
+     */
+    void restore(DiscreteSystems::CheckpointReader& r);
+
     /** @name Getters y Setters */
     ///@{
     double& T();
@@ -114,8 +223,10 @@ public:
     std::size_t& bufferSize();
     const std::size_t& bufferSize() const;
 
-    const std::deque<double>& timeBuffer() const;
-    const std::deque<double>& valueBuffer() const;
+    /** @brief Tiempos almacenados, del más antiguo al más reciente. */
+    BufferView timeBuffer() const;
+    /** @brief Valores almacenados, del más antiguo al más reciente. */
+    BufferView valueBuffer() const;
     ///@}
 
     /**
@@ -164,6 +275,16 @@ public:
      */
     double computeAt(double time) const override;
 
+    /**
+     * @brief Bloque de muestras; coincide bit a bit con compute(k).
+     */
+    void generate(double* out, std::size_t n, std::size_t k0 = 0) const override;
+
+    /**
+     * @brief step_time antes del escalón; infinito después.
+     */
+    double constantUntil(double time) const override;
+
     /** @name Getters y Setters */
     ///@{
     double& amplitude();
@@ -203,6 +324,11 @@ public:
      */
     double computeAt(double time) const override;
 
+    /**
+     * @brief Bloque de muestras; coincide bit a bit con compute(k).
+     */
+    void generate(double* out, std::size_t n, std::size_t k0 = 0) const override;
+
     /** @name Getters y Setters */
     ///@{
     double& slope();
@@ -244,6 +370,16 @@ public:
      */
     double computeAt(double time) const override;
 
+    /**
+     * @brief Bloque de muestras mediante oscilador de rotación.
+     *
+     * Ocho osciladores desfasados una muestra avanzan por multiplicación
+     * compleja (sin llamadas a std::sin); cada 256 muestras se reanclan con
+     * la fase exacta de compute(k), de modo que el error no crece con n
+     * (|error| del orden de 1e-12 * amplitude).
+     */
+    void generate(double* out, std::size_t n, std::size_t k0 = 0) const override;
+
     /** @name Getters y Setters */
     ///@{
     double& amplitude();
@@ -257,6 +393,227 @@ public:
     ///@}
 };
 
+/**
+ * @brief Interpolación de TableSignal entre muestras de la tabla.
+ */
+enum class Interpolation {
+    Hold,       /**< Mantiene la muestra anterior */
+    Linear      /**< Interpola linealmente entre muestras vecinas */
+};
+
+/**
+ * @brief Señal reproducida desde una tabla de muestras.
+ *
+ * La tabla es un vector de double muestreado cada tableTs, en memoria o
+ * proyectado con mmap desde un fichero binario crudo (double nativos, sin
+ * cabecera): construir la señal no lee el fichero, las páginas se cargan al
+ * reproducirlas, y las copias de la señal comparten la proyección.
+ *
+ * Antes del inicio devuelve la primera muestra y tras el final la última.
+ * Si tableTs == Ts, compute(k) devuelve exactamente la muestra k.
+ */
+class TableSignal : public Signal {
+    std::shared_ptr<const void> storage_;   /**< Propietario de los datos (vector o proyección) */
+    const double* data_;                    /**< Muestras */
+    std::size_t size_;                      /**< Número de muestras */
+    double table_ts_;                       /**< Período de la tabla [s] */
+    Interpolation interp_;                  /**< Interpolación entre muestras */
+
+    friend class SignalTerms;
+
+public:
+    /**
+     * @brief Proyecta un fichero binario de double.
+     * @param Ts Período de muestreo [s].
+     * @param path Fichero con las muestras.
+     * @param table_ts Período de la tabla [s] (default: 0, igual a Ts).
+     * @param interp Interpolación si table_ts != Ts (default: Linear).
+     * @param offset Desplazamiento vertical (default: 0.0).
+     * @param buffer_size Tamaño del buffer (default: 1024).
+     * @throw std::runtime_error si el fichero no se puede abrir o proyectar.
+     * @throw std::invalid_argument si está vacío o su tamaño no es múltiplo de 8.
+     */
+    TableSignal(double Ts, const std::string& path, double table_ts = 0.0,
+                Interpolation interp = Interpolation::Linear,
+                double offset = 0.0, std::size_t buffer_size = 1024);
+
+    /**
+     * @brief Usa una tabla en memoria (p. ej. calculada con generate()).
+     * @param samples Muestras (se mueven a la señal).
+     * @throw std::invalid_argument si samples está vacío.
+     */
+    TableSignal(double Ts, std::vector<double> samples, double table_ts = 0.0,
+                Interpolation interp = Interpolation::Linear,
+                double offset = 0.0, std::size_t buffer_size = 1024);
+
+    double computeAt(double time) const override;
+
+    /**
+     * @brief Bloque de muestras; con table_ts == Ts es una copia directa.
+     */
+    void generate(double* out, std::size_t n, std::size_t k0 = 0) const override;
+
+    /**
+     * @brief Escribe muestras en el formato que lee el constructor de fichero.
+     * @throw std::runtime_error si no se puede escribir.
+     */
+    static void writeFile(const std::string& path, const double* data, std::size_t n);
+
+    /** @name Getters */
+    ///@{
+    const double* data() const;
+    std::size_t size() const;
+    double tableTs() const;
+    Interpolation interpolation() const;
+    double duration() const;    /**< (size - 1) * tableTs [s] */
+    ///@}
+
+private:
+    void init(double table_ts);
+};
+
+/**
+ * @brief Conjunto aplanado de términos de señal.
+ *
+ * Guarda los parámetros de escalones, rampas, senos y tablas en arrays
+ * separados por tipo (SoA), de modo que evaluar la suma no hace ninguna
+ * llamada virtual y generar un bloque es un bucle vectorizable por término.
+ * Los offsets de los hijos se acumulan en una sola constante.
+ *
+ * El orden de las sumas es el mismo en eval() y en accumulate(), de modo
+ * que ambos coinciden bit a bit salvo en los senos (oscilador de rotación).
+ */
+class SignalTerms {
+    /** @brief Término de tabla (comparte la tabla con la TableSignal original) */
+    struct Table {
+        std::shared_ptr<const void> storage;
+        const double* data;
+        std::size_t size;
+        double tableTs;
+        Interpolation interp;
+    };
+
+    double constant_;                   /**< Suma de offsets */
+    std::vector<double> step_time_;     /**< Escalones: instante */
+    std::vector<double> step_amp_;      /**< Escalones: amplitud */
+    std::vector<double> ramp_start_;    /**< Rampas: inicio */
+    std::vector<double> ramp_slope_;    /**< Rampas: pendiente */
+    std::vector<double> sine_amp_;      /**< Senos: amplitud */
+    std::vector<double> sine_freq_;     /**< Senos: frecuencia [Hz] */
+    std::vector<double> sine_phase_;    /**< Senos: fase [rad] */
+    std::vector<Table> tables_;         /**< Tablas */
+
+public:
+    SignalTerms();
+
+    /** @name Añadir términos (se copian los parámetros, no la señal) */
+    ///@{
+    void add(const StepSignal& s);
+    void add(const RampSignal& s);
+    void add(const SineSignal& s);
+    void add(const TableSignal& s);
+    void add(const SignalTerms& terms);
+    void addConstant(double c);
+    ///@}
+
+    /**
+     * @brief Suma de todos los términos en time.
+     * @param time Tiempo [s].
+     * @param init Valor inicial al que se suman los términos.
+     */
+    double eval(double time, double init = 0.0) const;
+
+    /**
+     * @brief out[i] += suma de términos en time = (k0 + i) * Ts - shift.
+     */
+    void accumulate(double* out, std::size_t n, std::size_t k0, double Ts, double shift = 0.0) const;
+
+    /** @brief Número de términos (sin contar la constante). */
+    std::size_t size() const;
+    /** @brief Suma de offsets. */
+    double constant() const;
+};
+
+/**
+ * @brief Suma de señales aplanada en un solo paso.
+ *
+ * r(t) = offset + Σ hijos(t). Los hijos se copian como parámetros en un
+ * SignalTerms; el Ts de cada hijo se ignora y manda el de la suma.
+ */
+class SumSignal : public Signal {
+    SignalTerms terms_;     /**< Términos aplanados */
+
+public:
+    /**
+     * @brief Constructor de suma vacía (vale offset).
+     * @param Ts Período de muestreo [s].
+     * @param offset Desplazamiento vertical (default: 0.0).
+     * @param buffer_size Tamaño del buffer (default: 1024).
+     */
+    explicit SumSignal(double Ts, double offset = 0.0, std::size_t buffer_size = 1024);
+
+    /** @name Añadir sumandos */
+    ///@{
+    SumSignal& add(const StepSignal& s);
+    SumSignal& add(const RampSignal& s);
+    SumSignal& add(const SineSignal& s);
+    SumSignal& add(const TableSignal& s);
+    SumSignal& add(const SumSignal& s);
+    ///@}
+
+    double computeAt(double time) const override;
+    void generate(double* out, std::size_t n, std::size_t k0 = 0) const override;
+
+    const SignalTerms& terms() const;
+};
+
+/**
+ * @brief Concatenación de tramos, cada uno evaluado en su tiempo local.
+ *
+ * El tramo i empieza cuando acaba el i-1 (el primero en t = 0) y se evalúa
+ * en t - inicio_i; el último se prolonga indefinidamente. Cada tramo es un
+ * SignalTerms, de modo que tampoco hay llamadas virtuales por muestra.
+ */
+class PiecewiseSignal : public Signal {
+    std::vector<double> start_;         /**< Inicio de cada tramo [s] */
+    std::vector<SignalTerms> segments_; /**< Términos de cada tramo */
+    double end_;                        /**< Fin del último tramo [s] */
+
+public:
+    /**
+     * @brief Constructor sin tramos (vale offset).
+     * @param Ts Período de muestreo [s].
+     * @param offset Desplazamiento vertical (default: 0.0).
+     * @param buffer_size Tamaño del buffer (default: 1024).
+     */
+    explicit PiecewiseSignal(double Ts, double offset = 0.0, std::size_t buffer_size = 1024);
+
+    /** @name Añadir tramos
+     *  @param duration Duración del tramo [s] (> 0).
+     *  @throw std::invalid_argument si duration <= 0.
+     */
+    ///@{
+    PiecewiseSignal& append(double duration, const StepSignal& s);
+    PiecewiseSignal& append(double duration, const RampSignal& s);
+    PiecewiseSignal& append(double duration, const SineSignal& s);
+    PiecewiseSignal& append(double duration, const TableSignal& s);
+    PiecewiseSignal& append(double duration, const SumSignal& s);
+    ///@}
+
+    double computeAt(double time) const override;
+    void generate(double* out, std::size_t n, std::size_t k0 = 0) const override;
+
+    /** @name Getters */
+    ///@{
+    std::size_t segments() const;
+    double duration() const;    /**< Fin del último tramo [s] */
+    ///@}
+
+private:
+    PiecewiseSignal& appendTerms(double duration, const SignalTerms& terms);
+    std::size_t segmentAt(double time) const;
+};
+
 } // namespace RefSignal
 
 /** @} */ // fin del grupo RefSignal
@@ -0,0 +1,283 @@
+/**
+ * @file telemetria.h
+ * @brief Telemetría en memoria compartida POSIX para procesos de UI, registro o grabación
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef TELEMETRIA_H
+#define TELEMETRIA_H
+
+#include <lazo.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @defgroup Telemetria Telemetría
+ * @brief Segmento de memoria compartida con anillo de ticks y buzón de comandos
+ *
+ * Disposición del segmento (binaria y fija, sin serialización):
+ *
+ *     SegmentHeader   magic, versión, tamaños, Ts, secuencia de escritura
+ *     CommandMailbox  cola acotada sin bloqueo UI → control
+ *     TelemetrySlot[capacity]
+ *
+ * El proceso de control (TelemetryWriter) es el único escritor del anillo:
+ * sobrescribe siempre la ranura más antigua, sin mirar a los lectores, de
+ * modo que un lector lento nunca le frena. Cada ranura lleva su propio
+ * número de secuencia (impar mientras se escribe) y el lector descarta las
+ * lecturas que el escritor pisó durante la copia. Los lectores
+ * (TelemetryReader) abren el segmento en sólo lectura.
+ *
+ * Los comandos (ganancias, referencia) viajan en sentido contrario por el
+ * buzón; CommandSender abre el segmento en lectura/escritura y puede haber
+ * varios emisores a la vez.
+ *
+ * @{
+ */
+
+namespace Telemetria {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2,
+              "Telemetria: se necesitan atómicos de 64 bits sin bloqueo entre procesos");
+
+/// Identificador del segmento ("CTLT")
+static const std::uint32_t kMagic = 0x544C5443u;
+/// Versión de la disposición del segmento
+static const std::uint32_t kVersion = 1;
+/// Capacidad del buzón de comandos
+static const std::size_t kMailboxSize = 64;
+
+/**
+ * @struct TelemetryRecord
+ * @brief Registro binario de un tick
+ */
+struct TelemetryRecord {
+    std::uint64_t k;         ///< Índice del tick
+    std::int64_t stampNs;    ///< Instante de publicación (CLOCK_MONOTONIC) [ns]
+    double t;                ///< Tiempo simulado k * Ts [s]
+    double r;                ///< Referencia r(k)
+    double e;                ///< Error e(k)
+    double u;                ///< Acción de control u(k)
+    double y;                ///< Salida de la planta y(k)
+    double s;                ///< Salida del ADC s(k)
+};
+
+/**
+ * @enum CommandType
+ * @brief Comandos del proceso de UI al de control
+ */
+enum class CommandType : std::uint32_t {
+    SetGains = 1,            ///< values = {Kp, Ki, Kd}
+    SetReferenceOffset = 2   ///< values[0] = nuevo offset de la referencia
+};
+
+/**
+ * @struct Command
+ * @brief Comando de tamaño fijo
+ */
+struct Command {
+    CommandType type;        ///< Tipo de comando
+    std::uint32_t reserved;  ///< Relleno (0)
+    double values[3];        ///< Argumentos
+};
+
+/**
+ * @struct TelemetrySlot
+ * @brief Ranura del anillo con su secuencia (2i+1 escribiendo, 2i+2 lista)
+ */
+struct TelemetrySlot {
+    std::atomic<std::uint64_t> seq;   ///< Estado de la ranura
+    TelemetryRecord record;           ///< Contenido
+};
+
+/**
+ * @struct CommandCell
+ * @brief Celda del buzón (secuencia por celda, cola acotada de Vyukov)
+ */
+struct CommandCell {
+    std::atomic<std::uint64_t> seq;   ///< Estado de la celda
+    Command command;                  ///< Contenido
+};
+
+/**
+ * @struct CommandMailbox
+ * @brief Cola acotada de varios emisores y un receptor
+ */
+struct CommandMailbox {
+    alignas(64) std::atomic<std::uint64_t> enqueuePos;  ///< Siguiente posición de escritura
+    alignas(64) std::atomic<std::uint64_t> dequeuePos;  ///< Siguiente posición de lectura
+    alignas(64) CommandCell cells[kMailboxSize];        ///< Celdas
+};
+
+/**
+ * @struct SegmentHeader
+ * @brief Cabecera del segmento
+ */
+struct SegmentHeader {
+    std::atomic<std::uint32_t> magic;  ///< kMagic una vez inicializado
+    std::uint32_t version;             ///< kVersion
+    std::uint32_t recordSize;          ///< sizeof(TelemetryRecord)
+    std::uint32_t capacity;            ///< Ranuras del anillo (potencia de 2)
+    double Ts;                         ///< Período de muestreo del lazo [s]
+    alignas(64) std::atomic<std::uint64_t> writeSeq;   ///< Registros publicados
+    CommandMailbox mailbox;            ///< Buzón de comandos
+};
+
+/**
+ * @class TelemetryWriter
+ * @brief Crea el segmento y publica un registro por tick (proceso de control)
+ *
+ * publish() es O(1), sin llamadas al sistema salvo clock_gettime (vDSO) y
+ * sin esperar a ningún lector. El segmento se elimina (shm_unlink) al
+ * destruir el escritor.
+ */
+class TelemetryWriter {
+public:
+    /**
+     * @brief Crea (o recrea) el segmento
+     * @param name Nombre POSIX del segmento (p. ej. "/control")
+     * @param Ts Período de muestreo del lazo [s]
+     * @param capacity Ranuras del anillo (se redondea a potencia de 2)
+     * @throws std::runtime_error si no se puede crear o proyectar
+     */
+    TelemetryWriter(const std::string& name, double Ts, std::size_t capacity = 4096);
+
+    ~TelemetryWriter();
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+    /**
+     * @brief Publica un tick
+     * @param d Señales del tick
+     */
+    void publish(const Lazo::TickData& d);
+
+    /**
+     * @brief Extrae el siguiente comando pendiente
+     * @param cmd Destino
+     * @return false si el buzón está vacío
+     */
+    bool pollCommand(Command& cmd);
+
+    /** @name Getters */
+    ///@{
+    std::size_t capacity() const { return mask_ + 1; }
+    std::uint64_t published() const { return next_; }
+    const std::string& name() const { return name_; }
+    ///@}
+
+private:
+    std::string name_;          ///< Nombre del segmento
+    void* base_;                ///< Proyección
+    std::size_t size_;          ///< Tamaño del segmento
+    SegmentHeader* header_;     ///< Cabecera
+    TelemetrySlot* slots_;      ///< Anillo
+    std::size_t mask_;          ///< capacity - 1
+    std::uint64_t next_;        ///< Próximo registro
+    double Ts_;                 ///< Período de muestreo
+};
+
+/**
+ * @class TelemetryReader
+ * @brief Lector del anillo con el segmento en sólo lectura
+ */
+class TelemetryReader {
+public:
+    /**
+     * @brief Abre un segmento existente
+     * @param name Nombre POSIX del segmento
+     * @throws std::runtime_error si no existe, no está inicializado o su versión no coincide
+     */
+    explicit TelemetryReader(const std::string& name);
+
+    ~TelemetryReader();
+
+    TelemetryReader(const TelemetryReader&) = delete;
+    TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+    /**
+     * @brief Número de registros publicados hasta ahora
+     */
+    std::uint64_t latest() const;
+
+    /**
+     * @brief Lee el registro de secuencia i
+     * @param i Secuencia (0-based)
+     * @param out Destino
+     * @return false si aún no se ha publicado o ya se ha sobrescrito
+     */
+    bool read(std::uint64_t i, TelemetryRecord& out) const;
+
+    /**
+     * @brief Lee los registros nuevos desde cursor
+     * @param cursor Próxima secuencia a leer; se actualiza
+     * @param out Destino (al menos max elementos)
+     * @param max Máximo de registros
+     * @param lost Si no es nulo, se le suman los registros ya sobrescritos
+     * @return Registros leídos
+     */
+    std::size_t readSince(std::uint64_t& cursor, TelemetryRecord* out, std::size_t max,
+                          std::uint64_t* lost = nullptr) const;
+
+    /** @name Getters */
+    ///@{
+    std::size_t capacity() const { return mask_ + 1; }
+    double getSamplingTime() const { return Ts_; }
+    ///@}
+
+private:
+    void* base_;                    ///< Proyección (sólo lectura)
+    std::size_t size_;              ///< Tamaño del segmento
+    const SegmentHeader* header_;   ///< Cabecera
+    const TelemetrySlot* slots_;    ///< Anillo
+    std::size_t mask_;              ///< capacity - 1
+    double Ts_;                     ///< Período de muestreo
+};
+
+/**
+ * @class CommandSender
+ * @brief Emisor de comandos hacia el proceso de control
+ */
+class CommandSender {
+public:
+    /**
+     * @brief Abre un segmento existente en lectura/escritura
+     * @param name Nombre POSIX del segmento
+     * @throws std::runtime_error si no existe o no es compatible
+     */
+    explicit CommandSender(const std::string& name);
+
+    ~CommandSender();
+
+    CommandSender(const CommandSender&) = delete;
+    CommandSender& operator=(const CommandSender&) = delete;
+
+    /**
+     * @brief Encola un comando sin bloquear
+     * @param cmd Comando
+     * @return false si el buzón está lleno
+     */
+    bool send(const Command& cmd);
+
+    /** @name Atajos */
+    ///@{
+    bool setGains(double Kp, double Ki, double Kd);
+    bool setReferenceOffset(double offset);
+    ///@}
+
+private:
+    void* base_;                ///< Proyección
+    std::size_t size_;          ///< Tamaño del segmento
+    SegmentHeader* header_;     ///< Cabecera
+};
+
+} // namespace Telemetria
+
+/** @} */ // fin del grupo Telemetria
+
+#endif // TELEMETRIA_H
@@ -0,0 +1,1439 @@
+/**
+ * @file tiempo_real.h
+ * @brief Ejecución en tiempo real del lazo: canales SPSC, temporizador periódico y hilos
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef TIEMPO_REAL_H
+#define TIEMPO_REAL_H
+
+#include <grafo.h>
+#include <lazo.h>
+#include <traza.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <time.h>
+#include <vector>
+
+/**
+ * @defgroup TiempoReal Ejecución en Tiempo Real
+ * @brief Un hilo por bloque enlazados por canales sin bloqueo
+ *
+ * Los enlaces entre bloques (Ref→PID, PID→DAC, DAC→Planta, Planta→ADC y
+ * ADC→unión sumadora) son colas circulares acotadas de un productor y un
+ * consumidor (SpscRing): no hay mutex ni llamadas al sistema en el camino
+ * de cada muestra. El hilo de la referencia marca el ritmo con un
+ * PeriodicTimer de plazos absolutos; el resto de hilos avanza al llegar
+ * los datos.
+ *
+ * GraphPipeline hace lo mismo con un Grafo::CompiledGraph: el plan se parte
+ * en tramos consecutivos, uno por hilo.
+ *
+ * RuntimeConfig reúne el endurecimiento de arranque (mlockall, pila
+ * prefallada, afinidad, SCHED_FIFO y ticks de calentamiento) y
+ * AllocationTripwire vigila que los hilos de control no reserven memoria
+ * una vez arrancados.
+ *
+ * setTracer() conecta un Traza::Tracer: cada hilo registra el inicio y el
+ * fin de su tick, cada paso por un canal y los plazos perdidos.
+ *
+ * @{
+ */
+
+namespace TiempoReal {
+
+/// Tamaño de línea de caché supuesto para separar índices
+static const std::size_t kCacheLine = 64;
+
+/**
+ * @class SpscRing
+ * @brief Cola circular acotada sin bloqueo para un productor y un consumidor
+ *
+ * head_ (consumidor) y tail_ (productor) están en líneas de caché distintas,
+ * y cada lado guarda una copia local del índice del otro para no leer la
+ * línea compartida en cada operación.
+ *
+ * @tparam T Tipo de elemento (copiable)
+ * @tparam N Capacidad (potencia de 2)
+ */
+template <class T, std::size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N debe ser potencia de 2");
+
+public:
+    SpscRing() : head_(0), tailCache_(0), tail_(0), headCache_(0), buf_() {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Inserta un elemento (sólo desde el hilo productor)
+     * @param v Elemento a insertar
+     * @return false si la cola está llena
+     */
+    bool push(const T& v) {
+        const std::size_t t = tail_.load(std::memory_order_relaxed);
+        if (t - headCache_ == N) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (t - headCache_ == N) {
+                return false;
+            }
+        }
+        buf_[t & (N - 1)] = v;
+        tail_.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Extrae un elemento (sólo desde el hilo consumidor)
+     * @param v Destino del elemento extraído
+     * @return false si la cola está vacía
+     */
+    bool pop(T& v) {
+        const std::size_t h = head_.load(std::memory_order_relaxed);
+        if (h == tailCache_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (h == tailCache_) {
+                return false;
+            }
+        }
+        v = buf_[h & (N - 1)];
+        head_.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Vacía la cola (sólo con productor y consumidor detenidos)
+     */
+    void clear() {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        tailCache_ = 0;
+        headCache_ = 0;
+    }
+
+    /**
+     * @brief Número aproximado de elementos (exacto si no hay concurrencia)
+     */
+    std::size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    static std::size_t capacity() { return N; }
+
+private:
+    alignas(kCacheLine) std::atomic<std::size_t> head_;  ///< Índice de lectura (consumidor)
+    std::size_t tailCache_;                               ///< Copia de tail_ del consumidor
+    alignas(kCacheLine) std::atomic<std::size_t> tail_;  ///< Índice de escritura (productor)
+    std::size_t headCache_;                               ///< Copia de head_ del productor
+    alignas(kCacheLine) std::array<T, N> buf_;           ///< Almacenamiento
+};
+
+namespace detail {
+
+/**
+ * @brief Destructor de los objetos de makeAligned()
+ */
+template <class T>
+struct AlignedDelete {
+    void operator()(T* p) const {
+        p->~T();
+        std::free(p);
+    }
+};
+
+/**
+ * @brief Reserva T en memoria dinámica respetando su alineación
+ *
+ * new no garantiza alineaciones mayores que la de max_align_t antes de
+ * C++17, y SpscRing separa sus índices en líneas de caché.
+ */
+template <class T>
+std::unique_ptr<T, AlignedDelete<T> > makeAligned() {
+    void* p = nullptr;
+    if (posix_memalign(&p, alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T), sizeof(T)) != 0) {
+        throw std::bad_alloc();
+    }
+    return std::unique_ptr<T, AlignedDelete<T> >(new (p) T());
+}
+
+} // namespace detail
+
+/**
+ * @class PeriodicTimer
+ * @brief Temporizador periódico de plazos absolutos (CLOCK_MONOTONIC)
+ *
+ * wait() duerme con clock_nanosleep(TIMER_ABSTIME) hasta el siguiente plazo
+ * y lo adelanta exactamente un período, de modo que los retrasos de un tick
+ * no se acumulan en los siguientes (a diferencia de un sleep relativo).
+ * Con período 0 wait() vuelve inmediatamente (más rápido que tiempo real).
+ */
+class PeriodicTimer {
+public:
+    /**
+     * @brief Constructor
+     * @param period Período [s] (0: sin esperas)
+     */
+    explicit PeriodicTimer(double period)
+        : periodNs_(static_cast<long long>(period * 1e9 + 0.5)),
+          next_(), overruns_(0), maxLatenessNs_(0), lastLatenessNs_(0) {}
+
+    /**
+     * @brief Fija el primer plazo un período después del instante actual
+     */
+    void start() {
+        clock_gettime(CLOCK_MONOTONIC, &next_);
+        advance();
+        overruns_ = 0;
+        maxLatenessNs_ = 0;
+        lastLatenessNs_ = 0;
+    }
+
+    /**
+     * @brief Espera al siguiente plazo absoluto
+     *
+     * Si el plazo ya ha pasado al entrar (el tick anterior se excedió) se
+     * cuenta un desbordamiento y se vuelve sin dormir.
+     *
+     * @return true si el plazo ya había pasado (lastLatenessNs() da el retraso)
+     */
+    bool wait() {
+        if (periodNs_ <= 0) {
+            return false;
+        }
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        const bool missed = diffNs(now, next_) > 0;
+        if (missed) {
+            ++overruns_;
+        } else {
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next_, nullptr) == EINTR) {
+            }
+            clock_gettime(CLOCK_MONOTONIC, &now);
+        }
+        lastLatenessNs_ = diffNs(now, next_);
+        if (lastLatenessNs_ > maxLatenessNs_) {
+            maxLatenessNs_ = lastLatenessNs_;
+        }
+        advance();
+        return missed;
+    }
+
+    /** @name Estadísticas */
+    ///@{
+    std::size_t overruns() const { return overruns_; }
+    long long maxLatenessNs() const { return maxLatenessNs_; }
+    long long lastLatenessNs() const { return lastLatenessNs_; }   ///< Retraso del último wait()
+    ///@}
+
+private:
+    void advance() {
+        next_.tv_nsec += periodNs_ % 1000000000LL;
+        next_.tv_sec += static_cast<time_t>(periodNs_ / 1000000000LL);
+        if (next_.tv_nsec >= 1000000000L) {
+            next_.tv_nsec -= 1000000000L;
+            ++next_.tv_sec;
+        }
+    }
+
+    static long long diffNs(const timespec& a, const timespec& b) {
+        return (static_cast<long long>(a.tv_sec) - b.tv_sec) * 1000000000LL
+               + (a.tv_nsec - b.tv_nsec);
+    }
+
+    long long periodNs_;         ///< Período [ns]
+    timespec next_;              ///< Siguiente plazo absoluto
+    std::size_t overruns_;       ///< Plazos perdidos
+    long long maxLatenessNs_;    ///< Mayor retraso al despertar [ns]
+    long long lastLatenessNs_;   ///< Retraso del último despertar [ns]
+};
+
+/**
+ * @enum Mode
+ * @brief Reparto de los bloques entre hilos
+ */
+enum class Mode {
+    Threaded,      ///< Un hilo por bloque, enlazados por SpscRing
+    SingleThread   ///< Toda la cadena en un único hilo temporizado
+};
+
+/**
+ * @struct Stats
+ * @brief Resultado de una ejecución de Pipeline::run()
+ */
+struct Stats {
+    std::size_t ticks;          ///< Ticks entregados al observador
+    std::size_t overruns;       ///< Plazos perdidos por el hilo temporizado
+    long long maxLatenessNs;    ///< Mayor retraso al despertar [ns]
+    std::size_t dropped;        ///< Ticks descartados por monitor lleno
+    std::size_t allocations;    ///< Reservas detectadas en los hilos de control (RuntimeConfig::tripwire)
+    unsigned rejected;          ///< Pasos de RuntimeConfig que el sistema rechazó (kRejected*)
+};
+
+/** @name Bits de Stats::rejected */
+///@{
+static const unsigned kRejectedLockMemory = 1;   ///< mlockall() falló (p. ej. sin CAP_IPC_LOCK)
+static const unsigned kRejectedAffinity = 2;     ///< Alguna CPU de RuntimeConfig::cpus no es válida
+static const unsigned kRejectedPriority = 4;     ///< SCHED_FIFO denegado (p. ej. sin CAP_SYS_NICE)
+static const unsigned kRejectedTripwire = 8;     ///< Vigilancia pedida pero no compilada (ENABLE_ALLOC_TRIPWIRE)
+///@}
+
+/**
+ * @enum Tripwire
+ * @brief Reacción de AllocationTripwire a una reserva en un hilo vigilado
+ */
+enum class Tripwire {
+    Off,      ///< Sin vigilancia
+    Count,    ///< Sólo contar (AllocationTripwire::trips())
+    Report,   ///< Contar y escribir la pila en stderr (las primeras reservas)
+    Abort     ///< Escribir la pila y abortar el proceso
+};
+
+/**
+ * @struct RuntimeConfig
+ * @brief Endurecimiento de tiempo real que Pipeline y GraphPipeline aplican al arrancar
+ *
+ * El constructor no cambia nada (los valores de siempre); hardened() da la
+ * configuración de producción. Los pasos que el sistema rechaza (falta de
+ * privilegios, CPU inexistente) no detienen la ejecución: se indican en
+ * Stats::rejected.
+ *
+ * Cada hilo de control, antes del primer tick: se fija a su CPU, pasa a
+ * SCHED_FIFO, toca stackPrefault bytes de su pila, ejecuta warmupTicks
+ * pasos en vacío de sus bloques (y restaura su estado copiándolo, de modo
+ * que el resultado no cambia) y activa la vigilancia de reservas. El hilo
+ * temporizado no arranca el temporizador hasta que todos están listos.
+ */
+struct RuntimeConfig {
+    bool lockMemory;            ///< mlockall(MCL_CURRENT | MCL_FUTURE) antes de crear los hilos
+    std::size_t stackPrefault;  ///< Bytes de pila que toca cada hilo de control
+    int priority;               ///< Prioridad SCHED_FIFO (1-99; 0: política del proceso)
+    /// CPU de cada hilo de control: Pipeline Threaded {Ref, PID, DAC, Planta, ADC},
+    /// SingleThread {cadena}, GraphPipeline un elemento por tramo (-1 o ausente: sin fijar)
+    std::vector<int> cpus;
+    std::size_t warmupTicks;    ///< Pasos en vacío por bloque para calentar las cachés
+    Tripwire tripwire;          ///< Vigilancia de reservas tras el arranque
+
+    RuntimeConfig()
+        : lockMemory(false), stackPrefault(0), priority(0), cpus(), warmupTicks(0),
+          tripwire(Tripwire::Off) {}
+
+    /**
+     * @brief Configuración de producción
+     * @param priority Prioridad SCHED_FIFO (default: 80)
+     * @param cpus CPU de cada hilo (default: sin fijar)
+     */
+    static RuntimeConfig hardened(int priority = 80, const std::vector<int>& cpus = std::vector<int>()) {
+        RuntimeConfig c;
+        c.lockMemory = true;
+        c.stackPrefault = 256 * 1024;
+        c.priority = priority;
+        c.cpus = cpus;
+        c.warmupTicks = 64;
+        c.tripwire = Tripwire::Report;
+        return c;
+    }
+};
+
+/**
+ * @class AllocationTripwire
+ * @brief Vigilancia de reservas de memoria en los hilos de control
+ *
+ * Con ENABLE_ALLOC_TRIPWIRE (CMake, activo por defecto) y glibc,
+ * tiempo_real.cpp sustituye malloc, calloc, realloc, posix_memalign y
+ * aligned_alloc; operator new pasa por malloc. En un hilo armado cada
+ * reserva se cuenta, guarda su pila (la primera del proceso queda en
+ * firstTrip()) y, según Tripwire, se escribe en stderr o aborta. Fuera de
+ * los hilos armados el coste es la lectura de una variable thread_local.
+ * free() no se vigila: liberar no bloquea en el asignador de glibc salvo
+ * al devolver memoria al sistema, y sólo puede ocurrir tras una reserva
+ * que ya se ha detectado.
+ */
+class AllocationTripwire {
+public:
+    /** @brief true si la sustitución de malloc está compilada */
+    static bool installed();
+
+    /** @brief Arma la vigilancia en el hilo actual */
+    static void arm(Tripwire action = Tripwire::Report);
+
+    /** @brief Desarma la vigilancia en el hilo actual */
+    static void disarm();
+
+    /** @brief true si el hilo actual está armado */
+    static bool armed();
+
+    /** @brief Reservas detectadas en el proceso desde el arranque */
+    static std::size_t trips();
+
+    /**
+     * @brief Pila de la primera reserva detectada (backtrace_symbols_fd() para imprimirla)
+     * @param frames Destino (al menos n elementos)
+     * @param n Marcos máximos
+     * @return Marcos copiados (0 si no ha habido ninguna)
+     */
+    static std::size_t firstTrip(void** frames, std::size_t n);
+};
+
+namespace detail {
+
+/**
+ * @brief mlockall(MCL_CURRENT | MCL_FUTURE)
+ * @return false si el sistema lo rechaza
+ */
+bool lockMemory();
+
+/**
+ * @brief Afinidad, SCHED_FIFO y pila prefallada del hilo actual
+ * @param index Hilo de control (índice en RuntimeConfig::cpus)
+ * @return Bits kRejected* de los pasos rechazados
+ */
+unsigned configureThread(const RuntimeConfig& config, std::size_t index);
+
+/**
+ * @brief Pasos de RuntimeConfig previos a crear los hilos
+ * @param rejected Recibe kRejectedLockMemory y kRejectedTripwire
+ * @return AllocationTripwire::trips() al arrancar
+ */
+inline std::size_t startRuntime(const RuntimeConfig& config, std::atomic<unsigned>& rejected) {
+    if (config.lockMemory && !lockMemory()) {
+        rejected.fetch_or(kRejectedLockMemory, std::memory_order_relaxed);
+    }
+    if (config.tripwire != Tripwire::Off && !AllocationTripwire::installed()) {
+        rejected.fetch_or(kRejectedTripwire, std::memory_order_relaxed);
+    }
+    return AllocationTripwire::trips();
+}
+
+/**
+ * @brief Pasos en vacío de un bloque que deshace restaurando una copia
+ *
+ * La asignación de vuelta reutiliza la memoria del bloque (los vectores
+ * tienen ya su tamaño), de modo que las líneas calientes son las suyas.
+ */
+template <class Block>
+void warmBlock(Block& b, std::size_t n) {
+    if (n == 0) {
+        return;
+    }
+    const Block saved(b);
+    for (std::size_t i = 0; i < n; ++i) {
+        b.step(0.0);
+    }
+    b = saved;
+}
+
+/**
+ * @brief Secuencia del juego de ganancias adoptado (reguladores con appliedSequence())
+ *
+ * Cambia en el tick en que se adopta un juego nuevo: es el instante que
+ * marca Traza::EventKind::GainChange. Sin ganancias en línea vale siempre 0.
+ */
+template <class Pid>
+auto appliedSequence(const Pid& pid, int) -> decltype(static_cast<std::uint64_t>(pid.appliedSequence())) {
+    return static_cast<std::uint64_t>(pid.appliedSequence());
+}
+
+template <class Pid>
+std::uint64_t appliedSequence(const Pid&, long) {
+    return 0;
+}
+
+template <class Pid>
+auto appliedKp(const Pid& pid, int) -> decltype(static_cast<double>(pid.appliedKp())) {
+    return static_cast<double>(pid.appliedKp());
+}
+
+template <class Pid>
+double appliedKp(const Pid&, long) {
+    return 0.0;
+}
+
+/**
+ * @brief Buffer de trazas del hilo index (nulo sin Tracer o con las trazas desactivadas)
+ */
+inline Traza::TraceBuffer* traceBuffer(Traza::Tracer* tracer, std::size_t index) {
+    return Traza::kEnabled && tracer != nullptr ? &tracer->buffer(index) : nullptr;
+}
+
+/**
+ * @brief Arranque de un hilo de control: configureThread() y, con arm(), la vigilancia
+ *
+ * Desarma la vigilancia al salir del hilo por cualquier camino.
+ */
+class ControlThread {
+public:
+    ControlThread(const RuntimeConfig& config, std::size_t index, std::atomic<unsigned>& rejected)
+        : action_(config.tripwire) {
+        rejected.fetch_or(configureThread(config, index), std::memory_order_relaxed);
+    }
+
+    ControlThread(const ControlThread&) = delete;
+    ControlThread& operator=(const ControlThread&) = delete;
+
+    ~ControlThread() { AllocationTripwire::disarm(); }
+
+    /**
+     * @brief Arma la vigilancia (terminado el calentamiento) y se cuenta como listo
+     */
+    void arm(std::atomic<std::size_t>& ready) {
+        if (action_ != Tripwire::Off) {
+            AllocationTripwire::arm(action_);
+        }
+        ready.fetch_add(1, std::memory_order_release);
+    }
+
+private:
+    Tripwire action_;
+};
+
+} // namespace detail
+
+/**
+ * @class Pipeline
+ * @brief Ejecuta un Lazo::LoopRunner en tiempo real
+ *
+ * En modo Threaded cada bloque corre en su hilo y sólo ese hilo toca el
+ * bloque. Cada mensaje es un Lazo::TickData que se va completando a lo
+ * largo de la cadena; el ADC entrega s(k+1) = y(k) a la unión sumadora
+ * (hilo del PID) y el tick completo al canal de monitorización. El canal
+ * ADC→PID se ceba con ADConverter::delayed(), por lo que los resultados son
+ * idénticos a LoopRunner::tick().
+ *
+ * En modo SingleThread un único hilo temporizado ejecuta LoopRunner::tick().
+ *
+ * En ambos modos el hilo llamante de run() consume el canal de
+ * monitorización y llama al observador; si el observador se retrasa y el
+ * canal se llena, los ticks se descartan (Stats::dropped) en lugar de
+ * bloquear la cadena.
+ *
+ * setRuntimeConfig() endurece los hilos de control (ver RuntimeConfig):
+ * cada hilo calienta su propio bloque y el temporizador no arranca hasta
+ * que todos han terminado.
+ *
+ * setTracer() traza la ejecución: en Threaded cada hilo i (kRefTrack...
+ * kAdcTrack) escribe en tracer.buffer(i) el inicio y fin de su bloque en
+ * cada tick y cada push/pop de sus canales (kRefToPid... kAdcToPid); el
+ * hilo de la referencia añade los plazos perdidos y el del PID la adopción
+ * de ganancias nuevas (una marca por juego, en el tick en que empieza su
+ * transición, con el Kp adoptado). En SingleThread el hilo 0 traza el tick completo
+ * (kLoopTrack).
+ *
+ * @tparam Loop Instancia de Lazo::LoopRunner
+ */
+template <class Loop>
+class Pipeline {
+    typedef typename Loop::RefType Ref;
+    typedef typename Loop::PidType Pid;
+    typedef typename Loop::DacType Dac;
+    typedef typename Loop::PlantType Plant;
+    typedef typename Loop::AdcType Adc;
+
+public:
+    /** @name Pistas de las trazas (id de Begin/End) */
+    ///@{
+    static const std::uint16_t kRefTrack = 0;
+    static const std::uint16_t kPidTrack = 1;
+    static const std::uint16_t kDacTrack = 2;
+    static const std::uint16_t kPlantTrack = 3;
+    static const std::uint16_t kAdcTrack = 4;
+    static const std::uint16_t kLoopTrack = 5;   ///< Tick completo en SingleThread
+    ///@}
+
+    /** @name Canales de las trazas (id de Push/Pop) */
+    ///@{
+    static const std::uint16_t kRefToPid = 0;
+    static const std::uint16_t kPidToDac = 1;
+    static const std::uint16_t kDacToPlant = 2;
+    static const std::uint16_t kPlantToAdc = 3;
+    static const std::uint16_t kAdcToPid = 4;    ///< s(k) llega al PID en el tick k
+    ///@}
+
+    /**
+     * @brief Constructor
+     * @param loop Lazo con los cinco bloques (se copia)
+     * @param period Período real de cada tick [s] (0: sin esperas)
+     * @param mode Reparto de bloques entre hilos
+     */
+    Pipeline(const Loop& loop, double period, Mode mode = Mode::Threaded)
+        : loop_(loop), period_(period), mode_(mode), k_(0), config_(), tracer_(nullptr), stop_(false),
+          done_(false), dropped_(0), rejected_(0), ready_(0) {}
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief Endurecimiento de los hilos de control en las siguientes llamadas a run()
+     */
+    void setRuntimeConfig(const RuntimeConfig& config) { config_ = config; }
+
+    /**
+     * @brief Traza las siguientes llamadas a run() (nullptr: sin trazas)
+     *
+     * Da nombre a los hilos, pistas y canales del Tracer, que debe seguir
+     * vivo y tener un buffer por hilo de control (5 en Threaded, 1 en
+     * SingleThread). Los buffers se vacían con Tracer::collect(), p. ej.
+     * desde el observador.
+     *
+     * @throws std::invalid_argument si el Tracer tiene menos buffers que hilos
+     */
+    void setTracer(Traza::Tracer* tracer) {
+        if (tracer != nullptr) {
+            if (tracer->threads() < (mode_ == Mode::SingleThread ? 1u : 5u)) {
+                throw std::invalid_argument("Pipeline: el Tracer necesita un buffer por hilo de control");
+            }
+            if (mode_ == Mode::SingleThread) {
+                tracer->nameThread(0, "Lazo");
+                tracer->nameTrack(kLoopTrack, "tick");
+            } else {
+                const char* blocks[] = {"Ref", "PID", "DAC", "Planta", "ADC"};
+                const char* channels[] = {"Ref→PID", "PID→DAC", "DAC→Planta", "Planta→ADC", "ADC→PID"};
+                for (std::uint16_t i = 0; i < 5; ++i) {
+                    tracer->nameThread(i, blocks[i]);
+                    tracer->nameTrack(i, blocks[i]);
+                    tracer->nameChannel(i, channels[i]);
+                }
+            }
+        }
+        tracer_ = tracer;
+    }
+
+    /**
+     * @brief Ejecuta K ticks sin observador
+     * @param K Número de ticks
+     * @return Estadísticas de la ejecución
+     */
+    Stats run(std::size_t K) {
+        return run(K, [](const Lazo::TickData&) { return true; });
+    }
+
+    /**
+     * @brief Ejecuta K ticks y entrega cada uno al observador
+     * @param K Número de ticks
+     * @param observer Callable bool(const Lazo::TickData&); false detiene la ejecución
+     * @return Estadísticas de la ejecución
+     */
+    template <class Observer>
+    Stats run(std::size_t K, Observer observer) {
+        clearChannels();
+        PeriodicTimer timer(period_);
+        const std::size_t trips0 = detail::startRuntime(config_, rejected_);
+
+        std::thread workers[5];
+        std::size_t nWorkers = 0;
+        if (mode_ == Mode::SingleThread) {
+            workers[nWorkers++] = std::thread(&Pipeline::singleThread, this, K, &timer);
+        } else {
+            sToPid_.push(loop_.adc().delayed());
+            workers[nWorkers++] = std::thread(&Pipeline::refThread, this, K, k_, &timer);
+            workers[nWorkers++] = std::thread(&Pipeline::pidThread, this, K);
+            workers[nWorkers++] = std::thread(&Pipeline::dacThread, this, K);
+            workers[nWorkers++] = std::thread(&Pipeline::plantThread, this, K);
+            workers[nWorkers++] = std::thread(&Pipeline::adcThread, this, K);
+        }
+
+        Stats st = Stats();
+        Lazo::TickData d;
+        for (;;) {
+            if (monitor_.pop(d)) {
+                ++st.ticks;
+                if (!observer(d)) {
+                    stop_.store(true, std::memory_order_relaxed);
+                    break;
+                }
+            } else if (done_.load(std::memory_order_acquire)) {
+                if (!monitor_.pop(d)) {
+                    break;
+                }
+                ++st.ticks;
+                if (!observer(d)) {
+                    break;
+                }
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        stop_.store(true, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < nWorkers; ++i) {
+            workers[i].join();
+        }
+
+        st.overruns = timer.overruns();
+        st.maxLatenessNs = timer.maxLatenessNs();
+        st.dropped = dropped_.load(std::memory_order_relaxed);
+        st.allocations = AllocationTripwire::trips() - trips0;
+        st.rejected = rejected_.load(std::memory_order_relaxed);
+        return st;
+    }
+
+    /** @name Getters */
+    ///@{
+    Loop& loop() { return loop_; }
+    const RuntimeConfig& runtimeConfig() const { return config_; }
+    Traza::Tracer* tracer() const { return tracer_; }
+    Mode mode() const { return mode_; }
+    /// Ticks ejecutados por la cadena (en SingleThread coincide con loop().getK())
+    std::size_t getK() const { return mode_ == Mode::SingleThread ? loop_.getK() : k_; }
+    ///@}
+
+private:
+    /// Capacidad de los enlaces entre bloques
+    static const std::size_t kLinkSize = 64;
+    /// Capacidad del canal de monitorización
+    static const std::size_t kMonitorSize = 4096;
+
+    void clearChannels() {
+        refToPid_.clear();
+        pidToDac_.clear();
+        dacToPlant_.clear();
+        plantToAdc_.clear();
+        sToPid_.clear();
+        monitor_.clear();
+        stop_.store(false, std::memory_order_relaxed);
+        done_.store(false, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        rejected_.store(0, std::memory_order_relaxed);
+        ready_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Espera a que threads hilos de control estén listos (false si se pide parar)
+     */
+    bool waitReady(std::size_t threads) {
+        while (ready_.load(std::memory_order_acquire) < threads) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    /// Espera activa breve seguida de cesión del procesador
+    static void relax(unsigned& spins) {
+        if (++spins > 64) {
+            std::this_thread::yield();
+        }
+    }
+
+    template <class T, std::size_t N>
+    bool pushWait(SpscRing<T, N>& ring, const T& v) {
+        unsigned spins = 0;
+        while (!ring.push(v)) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            relax(spins);
+        }
+        return true;
+    }
+
+    template <class T, std::size_t N>
+    bool popWait(SpscRing<T, N>& ring, T& v) {
+        unsigned spins = 0;
+        while (!ring.pop(v)) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            relax(spins);
+        }
+        return true;
+    }
+
+    void publish(const Lazo::TickData& d) {
+        if (!monitor_.push(d)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void singleThread(std::size_t K, PeriodicTimer* timer) {
+        detail::ControlThread guard(config_, 0, rejected_);
+        if (config_.warmupTicks > 0) {
+            const Loop saved(loop_);
+            for (std::size_t i = 0; i < config_.warmupTicks; ++i) {
+                loop_.tick();
+            }
+            loop_ = saved;
+        }
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, 0);
+        guard.arm(ready_);
+        timer->start();
+        for (std::size_t i = 0; i < K && !stop_.load(std::memory_order_relaxed); ++i) {
+            const bool missed = timer->wait();
+            if (trace == nullptr) {
+                publish(loop_.tick());
+                continue;
+            }
+            const std::size_t k = loop_.getK();
+            if (missed) {
+                trace->record(Traza::EventKind::DeadlineMiss, kLoopTrack, k, static_cast<double>(timer->lastLatenessNs()));
+            }
+            const std::uint64_t applied = detail::appliedSequence(loop_.pid(), 0);
+            trace->record(Traza::EventKind::Begin, kLoopTrack, k);
+            publish(loop_.tick());
+            trace->record(Traza::EventKind::End, kLoopTrack, k);
+            if (detail::appliedSequence(loop_.pid(), 0) != applied) {
+                trace->record(Traza::EventKind::GainChange, kLoopTrack, k, detail::appliedKp(loop_.pid(), 0));
+            }
+        }
+        done_.store(true, std::memory_order_release);
+    }
+
+    void refThread(std::size_t K, std::size_t k0, PeriodicTimer* timer) {
+        Ref& ref = loop_.ref();
+        detail::ControlThread guard(config_, 0, rejected_);
+        volatile double sink = 0.0;
+        for (std::size_t i = 0; i < config_.warmupTicks; ++i) {
+            sink = ref.Ref::computeAt(static_cast<double>(k0 + i) * ref.T());
+        }
+        (void)sink;
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, kRefTrack);
+        guard.arm(ready_);
+        if (!waitReady(5)) {
+            return;
+        }
+        timer->start();
+        for (std::size_t i = 0; i < K && !stop_.load(std::memory_order_relaxed); ++i) {
+            const bool missed = timer->wait();
+            Lazo::TickData d = Lazo::TickData();
+            d.k = k0 + i;
+            if (trace) {
+                if (missed) {
+                    trace->record(Traza::EventKind::DeadlineMiss, kRefTrack, d.k, static_cast<double>(timer->lastLatenessNs()));
+                }
+                trace->record(Traza::EventKind::Begin, kRefTrack, d.k);
+            }
+            d.r = ref.Ref::computeAt(static_cast<double>(d.k) * ref.T());
+            if (trace) {
+                trace->record(Traza::EventKind::End, kRefTrack, d.k);
+            }
+            if (!pushWait(refToPid_, d)) {
+                break;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Push, kRefToPid, d.k);
+            }
+        }
+    }
+
+    void pidThread(std::size_t K) {
+        Pid& pid = loop_.pid();
+        detail::ControlThread guard(config_, 1, rejected_);
+        detail::warmBlock(pid, config_.warmupTicks);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, kPidTrack);
+        guard.arm(ready_);
+        Lazo::TickData d;
+        for (std::size_t i = 0; i < K; ++i) {
+            if (!popWait(refToPid_, d) || !popWait(sToPid_, d.s)) {
+                return;
+            }
+            if (trace == nullptr) {
+                d.e = d.r - d.s;
+                d.u = pid.step(d.e);
+            } else {
+                trace->record(Traza::EventKind::Pop, kRefToPid, d.k);
+                trace->record(Traza::EventKind::Pop, kAdcToPid, d.k);
+                const std::uint64_t applied = detail::appliedSequence(pid, 0);
+                trace->record(Traza::EventKind::Begin, kPidTrack, d.k);
+                d.e = d.r - d.s;
+                d.u = pid.step(d.e);
+                trace->record(Traza::EventKind::End, kPidTrack, d.k);
+                if (detail::appliedSequence(pid, 0) != applied) {
+                    trace->record(Traza::EventKind::GainChange, kPidTrack, d.k, detail::appliedKp(pid, 0));
+                }
+            }
+            if (!pushWait(pidToDac_, d)) {
+                return;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Push, kPidToDac, d.k);
+            }
+        }
+    }
+
+    void dacThread(std::size_t K) {
+        Dac& dac = loop_.dac();
+        detail::ControlThread guard(config_, 2, rejected_);
+        detail::warmBlock(dac, config_.warmupTicks);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, kDacTrack);
+        guard.arm(ready_);
+        Lazo::TickData d;
+        for (std::size_t i = 0; i < K; ++i) {
+            if (!popWait(pidToDac_, d)) {
+                return;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Pop, kPidToDac, d.k);
+                trace->record(Traza::EventKind::Begin, kDacTrack, d.k);
+            }
+            // La salida del DAC viaja en d.y hasta que la planta la sustituye
+            d.y = dac.step(d.u);
+            if (trace) {
+                trace->record(Traza::EventKind::End, kDacTrack, d.k);
+            }
+            if (!pushWait(dacToPlant_, d)) {
+                return;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Push, kDacToPlant, d.k);
+            }
+        }
+    }
+
+    void plantThread(std::size_t K) {
+        Plant& plant = loop_.plant();
+        detail::ControlThread guard(config_, 3, rejected_);
+        detail::warmBlock(plant, config_.warmupTicks);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, kPlantTrack);
+        guard.arm(ready_);
+        Lazo::TickData d;
+        for (std::size_t i = 0; i < K; ++i) {
+            if (!popWait(dacToPlant_, d)) {
+                return;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Pop, kDacToPlant, d.k);
+                trace->record(Traza::EventKind::Begin, kPlantTrack, d.k);
+            }
+            d.y = plant.step(d.y);
+            if (trace) {
+                trace->record(Traza::EventKind::End, kPlantTrack, d.k);
+            }
+            if (!pushWait(plantToAdc_, d)) {
+                return;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Push, kPlantToAdc, d.k);
+            }
+        }
+    }
+
+    void adcThread(std::size_t K) {
+        Adc& adc = loop_.adc();
+        detail::ControlThread guard(config_, 4, rejected_);
+        detail::warmBlock(adc, config_.warmupTicks);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, kAdcTrack);
+        guard.arm(ready_);
+        Lazo::TickData d;
+        for (std::size_t i = 0; i < K; ++i) {
+            if (!popWait(plantToAdc_, d)) {
+                break;
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Pop, kPlantToAdc, d.k);
+                trace->record(Traza::EventKind::Begin, kAdcTrack, d.k);
+            }
+            adc.step(d.y);
+            if (trace) {
+                trace->record(Traza::EventKind::End, kAdcTrack, d.k);
+            }
+            ++k_;
+            publish(d);
+            // El último s(k+1) no tiene consumidor: el PID ya ha procesado K ticks
+            if (i + 1 < K) {
+                if (!pushWait(sToPid_, adc.delayed())) {
+                    break;
+                }
+                if (trace) {
+                    trace->record(Traza::EventKind::Push, kAdcToPid, d.k + 1);
+                }
+            }
+        }
+        done_.store(true, std::memory_order_release);
+    }
+
+    Loop loop_;                                      ///< Bloques del lazo
+    double period_;                                  ///< Período real [s]
+    Mode mode_;                                      ///< Reparto entre hilos
+    std::size_t k_;                                  ///< Ticks completados (modo Threaded, hilo ADC)
+    RuntimeConfig config_;                           ///< Endurecimiento de los hilos de control
+    Traza::Tracer* tracer_;                          ///< Trazas (nulo: sin trazas)
+
+    SpscRing<Lazo::TickData, kLinkSize> refToPid_;   ///< Ref → PID
+    SpscRing<Lazo::TickData, kLinkSize> pidToDac_;   ///< PID → DAC
+    SpscRing<Lazo::TickData, kLinkSize> dacToPlant_; ///< DAC → Planta
+    SpscRing<Lazo::TickData, kLinkSize> plantToAdc_; ///< Planta → ADC
+    SpscRing<double, kLinkSize> sToPid_;             ///< ADC → unión sumadora
+    SpscRing<Lazo::TickData, kMonitorSize> monitor_; ///< Ticks completos → observador
+
+    std::atomic<bool> stop_;                         ///< Petición de parada
+    std::atomic<bool> done_;                         ///< El último hilo de la cadena terminó
+    std::atomic<std::size_t> dropped_;               ///< Ticks descartados
+    std::atomic<unsigned> rejected_;                 ///< Bits kRejected* de esta ejecución
+    std::atomic<std::size_t> ready_;                 ///< Hilos de control listos
+};
+
+/**
+ * @class GraphPipeline
+ * @brief Ejecuta un Grafo::CompiledGraph en tiempo real
+ *
+ * En modo Threaded el plan se parte en stages tramos consecutivos, cada uno
+ * en su hilo; cada hilo sólo toca el estado de los bloques de su tramo.
+ * Cada tick viaja de un tramo al siguiente como el vector completo de
+ * salidas (un double por bloque) por un SpscRing. Los bloques sin paso
+ * directo se actualizan en el tramo de su entrada, que devuelve su salida
+ * del tick siguiente al primer tramo por un canal de retorno cebado con
+ * CompiledGraph::latch(): es la generalización del canal ADC→PID de
+ * Pipeline. Los resultados son idénticos a CompiledGraph::tick().
+ *
+ * El primer tramo marca el ritmo con el PeriodicTimer y llama a la fuente
+ * de las entradas externas. En modo SingleThread un único hilo temporizado
+ * ejecuta CompiledGraph::tick(). La monitorización es la de Pipeline: el
+ * observador recibe un Grafo::Frame y los ticks que no caben se descartan.
+ *
+ * Con setRuntimeConfig() cada tramo se endurece como en Pipeline; el
+ * calentamiento se hace antes de crear los hilos, en el hilo llamante,
+ * porque los tramos comparten el arena del grafo.
+ *
+ * Con setTracer() el tramo s escribe en tracer.buffer(s) el inicio y fin
+ * de su parte de cada tick (pista s) y el traspaso al tramo siguiente
+ * (canal s); el primer tramo añade los plazos perdidos.
+ */
+class GraphPipeline {
+public:
+    /**
+     * @brief Constructor
+     * @param graph Grafo compilado (se copia)
+     * @param period Período real de cada tick [s] (0: sin esperas)
+     * @param mode Reparto de bloques entre hilos
+     * @param stages Hilos en modo Threaded (0: uno por operación del plan)
+     * @throws InvalidDimensions si el grafo no cabe en los canales
+     */
+    GraphPipeline(const Grafo::CompiledGraph& graph, double period, Mode mode = Mode::Threaded,
+                  std::size_t stages = 0)
+        : graph_(graph), period_(period), mode_(mode), k_(0), config_(), tracer_(nullptr),
+          monitor_(detail::makeAligned<Monitor>()), stop_(false), done_(false), dropped_(0),
+          rejected_(0), ready_(0) {
+        const std::size_t ops = graph_.schedule().size();
+        std::size_t S = stages == 0 || stages > ops ? ops : stages;
+        if (S == 0) {
+            S = 1;
+        }
+        if (graph_.size() + 1 > kMonitorSize) {
+            throw DiscreteSystems::InvalidDimensions("GraphPipeline: el grafo no cabe en el canal de monitorización");
+        }
+        for (std::size_t s = 0; s < S; ++s) {
+            Stage st;
+            st.first = s * ops / S;
+            st.last = (s + 1) * ops / S;
+            for (std::size_t i = st.first; i < st.last; ++i) {
+                const Grafo::CompiledGraph::Operation& op = graph_.schedule()[i];
+                if (op.output != static_cast<std::size_t>(-1)) {
+                    st.delayed.push_back(op.block);
+                }
+            }
+            if (st.delayed.size() > kLinkSize) {
+                throw DiscreteSystems::InvalidDimensions("GraphPipeline: demasiados retardos en un tramo");
+            }
+            stages_.push_back(st);
+            back_.push_back(detail::makeAligned<Link>());
+            if (s + 1 < S) {
+                forward_.push_back(detail::makeAligned<Link>());
+            }
+        }
+    }
+
+    GraphPipeline(const GraphPipeline&) = delete;
+    GraphPipeline& operator=(const GraphPipeline&) = delete;
+
+    /**
+     * @brief Endurecimiento de los hilos de control en las siguientes llamadas a run()
+     */
+    void setRuntimeConfig(const RuntimeConfig& config) { config_ = config; }
+
+    /**
+     * @brief Traza las siguientes llamadas a run() (nullptr: sin trazas)
+     * @throws std::invalid_argument si el Tracer tiene menos buffers que stages()
+     */
+    void setTracer(Traza::Tracer* tracer) {
+        if (tracer != nullptr) {
+            if (tracer->threads() < stages()) {
+                throw std::invalid_argument("GraphPipeline: el Tracer necesita un buffer por tramo");
+            }
+            for (std::size_t s = 0; s < stages(); ++s) {
+                const std::string name = "tramo " + std::to_string(s);
+                tracer->nameThread(s, name);
+                tracer->nameTrack(static_cast<std::uint16_t>(s), name);
+                tracer->nameChannel(static_cast<std::uint16_t>(s), name + "→" + std::to_string(s + 1));
+            }
+        }
+        tracer_ = tracer;
+    }
+
+    /**
+     * @brief Ejecuta K ticks sin observador
+     * @param source Callable void(std::size_t k, double* inputs) (ver CompiledGraph::run())
+     */
+    template <class Source>
+    Stats run(std::size_t K, Source source) {
+        return run(K, source, [](const Grafo::Frame&) { return true; });
+    }
+
+    /**
+     * @brief Ejecuta K ticks y entrega cada uno al observador
+     * @param source Callable void(std::size_t k, double* inputs)
+     * @param observer Callable bool(const Grafo::Frame&); false detiene la ejecución
+     */
+    template <class Source, class Observer>
+    Stats run(std::size_t K, Source source, Observer observer) {
+        clearChannels();
+        PeriodicTimer timer(period_);
+        const std::size_t n = graph_.size();
+        const std::size_t trips0 = detail::startRuntime(config_, rejected_);
+        if (config_.warmupTicks > 0) {
+            const std::vector<double> zeros(graph_.inputs().size() + 1, 0.0);
+            const Grafo::CompiledGraph saved(graph_);
+            for (std::size_t i = 0; i < config_.warmupTicks; ++i) {
+                graph_.tick(&zeros[0]);
+            }
+            graph_ = saved;
+        }
+
+        std::vector<std::thread> workers;
+        if (mode_ == Mode::SingleThread) {
+            workers.push_back(std::thread(&GraphPipeline::singleThread<Source>, this, K, &source, &timer));
+        } else {
+            std::vector<double> initial(n, 0.0);
+            graph_.latch(&initial[0]);
+            for (std::size_t s = 0; s < stages_.size(); ++s) {
+                for (std::size_t i = 0; i < stages_[s].delayed.size(); ++i) {
+                    back_[s]->push(initial[stages_[s].delayed[i]]);
+                }
+            }
+            workers.push_back(std::thread(&GraphPipeline::firstStage<Source>, this, K, k_, &source, &timer));
+            for (std::size_t s = 1; s < stages_.size(); ++s) {
+                workers.push_back(std::thread(&GraphPipeline::laterStage, this, s, K, k_));
+            }
+        }
+
+        Stats st = Stats();
+        std::vector<double> values(n, 0.0);
+        Grafo::Frame f = {0, &values[0]};
+        for (;;) {
+            if (popFrame(f, values)) {
+                ++st.ticks;
+                if (!observer(f)) {
+                    break;
+                }
+            } else if (done_.load(std::memory_order_acquire)) {
+                if (!popFrame(f, values)) {
+                    break;
+                }
+                ++st.ticks;
+                if (!observer(f)) {
+                    break;
+                }
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        stop_.store(true, std::memory_order_relaxed);
+        for (std::size_t i = 0; i < workers.size(); ++i) {
+            workers[i].join();
+        }
+
+        st.overruns = timer.overruns();
+        st.maxLatenessNs = timer.maxLatenessNs();
+        st.dropped = dropped_.load(std::memory_order_relaxed);
+        st.allocations = AllocationTripwire::trips() - trips0;
+        st.rejected = rejected_.load(std::memory_order_relaxed);
+        return st;
+    }
+
+    /** @name Getters */
+    ///@{
+    Grafo::CompiledGraph& graph() { return graph_; }
+    const RuntimeConfig& runtimeConfig() const { return config_; }
+    Traza::Tracer* tracer() const { return tracer_; }
+    Mode mode() const { return mode_; }
+    std::size_t stages() const { return mode_ == Mode::SingleThread ? 1 : stages_.size(); }
+    /// Ticks ejecutados (en SingleThread coincide con graph().getK())
+    std::size_t getK() const { return mode_ == Mode::SingleThread ? graph_.getK() : k_; }
+    ///@}
+
+private:
+    /// Capacidad de los enlaces entre tramos [doubles]
+    static const std::size_t kLinkSize = 1024;
+    /// Capacidad del canal de monitorización [doubles]
+    static const std::size_t kMonitorSize = 65536;
+
+    typedef SpscRing<double, kLinkSize> Link;
+    typedef SpscRing<double, kMonitorSize> Monitor;
+    typedef std::unique_ptr<Link, detail::AlignedDelete<Link> > LinkPtr;
+
+    /**
+     * @struct Stage
+     * @brief Tramo [first, last) del plan y bloques sin paso directo que actualiza
+     */
+    struct Stage {
+        std::size_t first;
+        std::size_t last;
+        std::vector<Grafo::BlockId> delayed;
+    };
+
+    void clearChannels() {
+        for (std::size_t i = 0; i < forward_.size(); ++i) {
+            forward_[i]->clear();
+        }
+        for (std::size_t i = 0; i < back_.size(); ++i) {
+            back_[i]->clear();
+        }
+        monitor_->clear();
+        stop_.store(false, std::memory_order_relaxed);
+        done_.store(false, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+        rejected_.store(0, std::memory_order_relaxed);
+        ready_.store(0, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Espera a que threads hilos de control estén listos (false si se pide parar)
+     */
+    bool waitReady(std::size_t threads) {
+        while (ready_.load(std::memory_order_acquire) < threads) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    static void relax(unsigned& spins) {
+        if (++spins > 64) {
+            std::this_thread::yield();
+        }
+    }
+
+    template <class Ring>
+    bool pushWait(Ring& ring, double v) {
+        unsigned spins = 0;
+        while (!ring.push(v)) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            relax(spins);
+        }
+        return true;
+    }
+
+    template <class Ring>
+    bool popWait(Ring& ring, double& v) {
+        unsigned spins = 0;
+        while (!ring.pop(v)) {
+            if (stop_.load(std::memory_order_relaxed)) {
+                return false;
+            }
+            relax(spins);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Publica k y las salidas del tick, o descarta el tick si no caben
+     */
+    void publish(std::size_t k, const double* values) {
+        const std::size_t n = graph_.size();
+        // size() sólo puede sobrestimar la ocupación desde el productor
+        if (Monitor::capacity() - monitor_->size() < n + 1) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        monitor_->push(static_cast<double>(k));
+        for (std::size_t i = 0; i < n; ++i) {
+            monitor_->push(values[i]);
+        }
+    }
+
+    /**
+     * @brief Extrae un tick del canal de monitorización (hilo llamante)
+     */
+    bool popFrame(Grafo::Frame& f, std::vector<double>& values) {
+        double k;
+        if (!monitor_->pop(k)) {
+            return false;
+        }
+        // El productor escribe el tick entero seguido: el resto está llegando
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            while (!monitor_->pop(values[i])) {
+                std::this_thread::yield();
+            }
+        }
+        f.k = static_cast<std::size_t>(k);
+        return true;
+    }
+
+    template <class Source>
+    void singleThread(std::size_t K, Source* source, PeriodicTimer* timer) {
+        std::vector<double> in(graph_.inputs().size() + 1, 0.0);
+        detail::ControlThread guard(config_, 0, rejected_);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, 0);
+        guard.arm(ready_);
+        timer->start();
+        for (std::size_t i = 0; i < K && !stop_.load(std::memory_order_relaxed); ++i) {
+            const bool missed = timer->wait();
+            const std::size_t k = graph_.getK();
+            if (trace) {
+                if (missed) {
+                    trace->record(Traza::EventKind::DeadlineMiss, 0, k, static_cast<double>(timer->lastLatenessNs()));
+                }
+                trace->record(Traza::EventKind::Begin, 0, k);
+            }
+            (*source)(k, &in[0]);
+            graph_.tick(&in[0]);
+            if (trace) {
+                trace->record(Traza::EventKind::End, 0, k);
+            }
+            publish(k, &graph_.values()[0]);
+        }
+        done_.store(true, std::memory_order_release);
+    }
+
+    /**
+     * @brief Fin de tramo: entrega el tick al siguiente (o al observador) y
+     *        devuelve las salidas del tick siguiente de sus bloques sin paso directo
+     */
+    bool handOff(std::size_t s, std::size_t k, bool last, std::vector<double>& values,
+                 Traza::TraceBuffer* trace) {
+        const Stage& st = stages_[s];
+        if (s + 1 < stages_.size()) {
+            for (std::size_t j = 0; j < values.size(); ++j) {
+                if (!pushWait(*forward_[s], values[j])) {
+                    return false;
+                }
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Push, static_cast<std::uint16_t>(s), k);
+            }
+        } else {
+            publish(k, &values[0]);
+        }
+        // La última salida no tiene consumidor: el primer tramo ya ha hecho K ticks
+        if (!last && !st.delayed.empty()) {
+            graph_.latch(st.first, st.last, &values[0]);
+            for (std::size_t j = 0; j < st.delayed.size(); ++j) {
+                if (!pushWait(*back_[s], values[st.delayed[j]])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template <class Source>
+    void firstStage(std::size_t K, std::size_t k0, Source* source, PeriodicTimer* timer) {
+        const Stage& st = stages_[0];
+        std::vector<double> values(graph_.size(), 0.0);
+        std::vector<double> in(graph_.inputs().size() + 1, 0.0);
+        const bool alone = stages_.size() == 1;
+        detail::ControlThread guard(config_, 0, rejected_);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, 0);
+        guard.arm(ready_);
+        if (!waitReady(stages_.size())) {
+            return;
+        }
+        timer->start();
+        for (std::size_t i = 0; i < K && !stop_.load(std::memory_order_relaxed); ++i) {
+            if (timer->wait() && trace) {
+                trace->record(Traza::EventKind::DeadlineMiss, 0, k0 + i, static_cast<double>(timer->lastLatenessNs()));
+            }
+            for (std::size_t s = 0; s < stages_.size(); ++s) {
+                for (std::size_t j = 0; j < stages_[s].delayed.size(); ++j) {
+                    if (!popWait(*back_[s], values[stages_[s].delayed[j]])) {
+                        return;
+                    }
+                }
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Begin, 0, k0 + i);
+            }
+            (*source)(k0 + i, &in[0]);
+            graph_.setInputs(&in[0], &values[0]);
+            graph_.execute(st.first, st.last, &values[0]);
+            if (trace) {
+                trace->record(Traza::EventKind::End, 0, k0 + i);
+            }
+            if (alone) {
+                ++k_;
+            }
+            if (!handOff(0, k0 + i, i + 1 == K, values, trace)) {
+                break;
+            }
+        }
+        if (alone) {
+            done_.store(true, std::memory_order_release);
+        }
+    }
+
+    void laterStage(std::size_t s, std::size_t K, std::size_t k0) {
+        const Stage& st = stages_[s];
+        std::vector<double> values(graph_.size(), 0.0);
+        const bool lastStage = s + 1 == stages_.size();
+        detail::ControlThread guard(config_, s, rejected_);
+        Traza::TraceBuffer* trace = detail::traceBuffer(tracer_, s);
+        const std::uint16_t track = static_cast<std::uint16_t>(s);
+        guard.arm(ready_);
+        for (std::size_t i = 0; i < K; ++i) {
+            for (std::size_t j = 0; j < values.size(); ++j) {
+                if (!popWait(*forward_[s - 1], values[j])) {
+                    if (lastStage) {
+                        done_.store(true, std::memory_order_release);
+                    }
+                    return;
+                }
+            }
+            if (trace) {
+                trace->record(Traza::EventKind::Pop, static_cast<std::uint16_t>(s - 1), k0 + i);
+                trace->record(Traza::EventKind::Begin, track, k0 + i);
+            }
+            graph_.execute(st.first, st.last, &values[0]);
+            if (trace) {
+                trace->record(Traza::EventKind::End, track, k0 + i);
+            }
+            if (lastStage) {
+                ++k_;
+            }
+            if (!handOff(s, k0 + i, i + 1 == K, values, trace)) {
+                break;
+            }
+        }
+        if (lastStage) {
+            done_.store(true, std::memory_order_release);
+        }
+    }
+
+    Grafo::CompiledGraph graph_;                    ///< Plan y arena
+    double period_;                                 ///< Período real [s]
+    Mode mode_;                                     ///< Reparto entre hilos
+    std::size_t k_;                                 ///< Ticks completados (modo Threaded, último tramo)
+    RuntimeConfig config_;                          ///< Endurecimiento de los hilos de control
+    Traza::Tracer* tracer_;                         ///< Trazas (nulo: sin trazas)
+    std::vector<Stage> stages_;                     ///< Tramos del plan (modo Threaded)
+
+    std::vector<LinkPtr> forward_;                  ///< Tramo s → s+1
+    std::vector<LinkPtr> back_;                     ///< Tramo s → primer tramo (retardos)
+    std::unique_ptr<Monitor, detail::AlignedDelete<Monitor> > monitor_;   ///< Ticks completos → observador
+
+    std::atomic<bool> stop_;                        ///< Petición de parada
+    std::atomic<bool> done_;                        ///< El último tramo terminó
+    std::atomic<std::size_t> dropped_;              ///< Ticks descartados
+    std::atomic<unsigned> rejected_;                ///< Bits kRejected* de esta ejecución
+    std::atomic<std::size_t> ready_;                ///< Hilos de control listos
+};
+
+} // namespace TiempoReal
+
+/** @} */ // fin del grupo TiempoReal
+
+#endif // TIEMPO_REAL_H
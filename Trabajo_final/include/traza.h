@@ -0,0 +1,287 @@
+/**
+ * @file traza.h
+ * @brief Trazas binarias de eventos por hilo, exportables a Chrome JSON / Perfetto
+ * @author Manuel Gutiérrez
+ * @date 2026-10-14
+ */
+
+#ifndef TRAZA_H
+#define TRAZA_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TRAZA_HAVE_TSC 1
+#else
+#define TRAZA_HAVE_TSC 0
+#endif
+
+/**
+ * @defgroup Traza Trazas de eventos
+ * @brief Cuándo ocurre cada cosa: ticks por bloque, traspasos entre hilos, plazos perdidos
+ *
+ * Cada hilo escribe en su TraceBuffer, una cola acotada de un productor y
+ * un consumidor con eventos binarios de 32 bytes; escribir un evento es
+ * leer el reloj, copiar el evento y publicar el índice, sin bloqueos ni
+ * reservas de memoria. Si la cola se llena el evento se descarta y se
+ * cuenta (TraceBuffer::dropped()): quien traza nunca espera.
+ *
+ * Tracer agrupa los buffers de una ejecución, guarda los nombres de hilos
+ * y pistas y convierte los eventos al formato JSON de Chrome
+ * (chrome://tracing, ui.perfetto.dev). collect() vacía los buffers desde
+ * un único hilo consumidor, durante la ejecución (p. ej. desde el
+ * observador de TiempoReal::Pipeline) o al terminar.
+ *
+ * El reloj es el TSC en x86 (calibrado contra steady_clock al exportar) y
+ * steady_clock en otras arquitecturas. Los instantes exportados son
+ * nanosegundos de CLOCK_MONOTONIC, de modo que las trazas de varios
+ * procesos se pueden superponer.
+ *
+ * Con la opción de CMake ENABLE_TRACING=OFF (TRAZA_DISABLED) kEnabled es
+ * false y record() es una función vacía: las sondas desaparecen del código.
+ *
+ * @{
+ */
+
+namespace Traza {
+
+#if defined(TRAZA_DISABLED)
+static const bool kEnabled = false;   ///< Trazas compiladas
+#else
+static const bool kEnabled = true;    ///< Trazas compiladas
+#endif
+
+/**
+ * @enum EventKind
+ * @brief Tipo de evento
+ */
+enum class EventKind : std::uint16_t {
+    Begin,          ///< Inicio del tick k de la pista id
+    End,            ///< Fin del tick k de la pista id
+    Push,           ///< Tick k entregado al canal id
+    Pop,            ///< Tick k recogido del canal id
+    DeadlineMiss,   ///< Plazo del tick k perdido (value: retraso [ns])
+    GainChange,     ///< Ganancias nuevas adoptadas en el tick k (value: Kp)
+    Instant         ///< Marca genérica de la pista id (value: dato libre)
+};
+
+/**
+ * @struct Event
+ * @brief Evento binario de tamaño fijo (dos por línea de caché)
+ */
+struct Event {
+    std::uint64_t stamp;   ///< Marca de Clock::now() (sin convertir)
+    std::uint64_t k;       ///< Tick
+    double value;          ///< Dato del evento
+    EventKind kind;        ///< Tipo
+    std::uint16_t id;      ///< Pista o canal
+    std::uint32_t pad;     ///< Relleno
+};
+
+static_assert(sizeof(Event) == 32, "Traza: Event debe ocupar 32 bytes");
+
+/**
+ * @class Clock
+ * @brief Reloj de las trazas: TSC en x86, steady_clock en otro caso
+ */
+class Clock {
+public:
+    /** @brief Marca actual (ticks del TSC o ns de steady_clock) */
+    static std::uint64_t now() {
+#if TRAZA_HAVE_TSC
+        return __rdtsc();
+#else
+        return steadyNs();
+#endif
+    }
+
+    /** @brief steady_clock en ns (la referencia de la calibración) */
+    static std::uint64_t steadyNs() {
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+};
+
+/**
+ * @class TraceBuffer
+ * @brief Cola de eventos de un hilo: un productor (el hilo trazado) y un consumidor
+ *
+ * La memoria se reserva en el constructor. El productor guarda una copia
+ * del índice del consumidor y sólo la relee cuando la cola parece llena,
+ * de modo que en régimen normal no toca la línea de caché del consumidor.
+ */
+class TraceBuffer {
+public:
+    /**
+     * @brief Constructor
+     * @param capacity Eventos (se redondea a potencia de 2)
+     * @throws std::invalid_argument si capacity es 0
+     */
+    explicit TraceBuffer(std::size_t capacity);
+
+    TraceBuffer(const TraceBuffer&) = delete;
+    TraceBuffer& operator=(const TraceBuffer&) = delete;
+
+    /**
+     * @brief Registra un evento (sólo el hilo productor)
+     * @param kind Tipo
+     * @param id Pista o canal
+     * @param k Tick
+     * @param value Dato del evento
+     */
+    void record(EventKind kind, std::uint16_t id, std::uint64_t k, double value = 0.0) {
+        if (!kEnabled) {
+            return;
+        }
+        const std::uint64_t h = head_.load(std::memory_order_relaxed);
+        if (h - tailCache_ > mask_) {
+            tailCache_ = tail_.load(std::memory_order_acquire);
+            if (h - tailCache_ > mask_) {
+                dropped_.store(dropped_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        Event& e = events_[h & mask_];
+        e.stamp = Clock::now();
+        e.k = k;
+        e.value = value;
+        e.kind = kind;
+        e.id = id;
+        e.pad = 0;
+        head_.store(h + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Mueve los eventos pendientes al final de out (sólo el consumidor)
+     * @return Eventos movidos
+     */
+    std::size_t drain(std::vector<Event>& out);
+
+    /**
+     * @brief Vacía la cola y el contador de descartes (sin productor activo)
+     */
+    void clear();
+
+    /** @name Getters */
+    ///@{
+    std::size_t capacity() const { return static_cast<std::size_t>(mask_ + 1); }
+    std::size_t size() const {
+        return static_cast<std::size_t>(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+    }
+    std::size_t dropped() const { return static_cast<std::size_t>(dropped_.load(std::memory_order_relaxed)); }
+    ///@}
+
+private:
+    static const std::size_t kLine = 64;   ///< Línea de caché
+
+    std::uint64_t mask_;                               ///< Capacidad - 1
+    std::unique_ptr<Event[]> events_;                  ///< Anillo
+    char pad0_[kLine];
+    std::atomic<std::uint64_t> head_;                  ///< Siguiente escritura (productor)
+    std::uint64_t tailCache_;                          ///< Última tail_ vista por el productor
+    std::atomic<std::uint64_t> dropped_;               ///< Eventos descartados (productor)
+    char pad1_[kLine];
+    std::atomic<std::uint64_t> tail_;                  ///< Siguiente lectura (consumidor)
+    char pad2_[kLine - sizeof(std::atomic<std::uint64_t>)];
+};
+
+/**
+ * @class Tracer
+ * @brief Buffers de una ejecución, nombres y exportación a Chrome JSON
+ *
+ * Cada hilo trazado usa buffer(i), con i fijo por hilo. Las pistas (id de
+ * Begin/End/DeadlineMiss/GainChange/Instant) y los canales (id de
+ * Push/Pop) tienen nombres separados. En la exportación, Begin/End son
+ * tramos ("B"/"E") en la fila de su hilo, cada Push/Pop del mismo canal y
+ * tick se une con una flecha de flujo y el resto son marcas instantáneas.
+ */
+class Tracer {
+public:
+    /// Eventos por hilo por defecto (2 MiB por buffer)
+    static const std::size_t kDefaultCapacity = 65536;
+
+    /**
+     * @brief Constructor
+     * @param threads Hilos trazados (un buffer por hilo)
+     * @param capacity Eventos por buffer
+     * @throws std::invalid_argument si threads o capacity es 0
+     */
+    explicit Tracer(std::size_t threads, std::size_t capacity = kDefaultCapacity);
+
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    /** @brief Buffer del hilo i */
+    TraceBuffer& buffer(std::size_t i) { return *buffers_[i]; }
+
+    /** @name Nombres en la exportación */
+    ///@{
+    void nameThread(std::size_t i, const std::string& name);
+    void nameTrack(std::uint16_t id, const std::string& name);
+    void nameChannel(std::uint16_t id, const std::string& name);
+    ///@}
+
+    /**
+     * @brief Vacía los buffers en la memoria del Tracer (un único hilo consumidor)
+     * @return Eventos recogidos en esta llamada
+     */
+    std::size_t collect();
+
+    /**
+     * @brief Descarta los eventos recogidos y pendientes (sin productores activos)
+     */
+    void clear();
+
+    /**
+     * @brief collect() y escribe la traza en formato JSON de Chrome
+     */
+    void writeChromeJson(std::ostream& os);
+
+    /**
+     * @brief collect() y guarda la traza en un fichero
+     * @throws std::runtime_error si el fichero no se puede escribir
+     */
+    void save(const std::string& path);
+
+    /**
+     * @brief Instante de una marca en ns de steady_clock (calibración actual)
+     */
+    double toNs(std::uint64_t stamp) const;
+
+    /** @name Getters */
+    ///@{
+    std::size_t threads() const { return buffers_.size(); }
+    /// Eventos recogidos del hilo i, en orden
+    const std::vector<Event>& events(std::size_t i) const { return collected_[i]; }
+    /// Eventos recogidos de todos los hilos
+    std::size_t size() const;
+    /// Eventos descartados por buffers llenos
+    std::size_t dropped() const;
+    ///@}
+
+private:
+    void calibrate();
+
+    std::vector<std::unique_ptr<TraceBuffer> > buffers_;   ///< Un buffer por hilo
+    std::vector<std::vector<Event> > collected_;           ///< Eventos recogidos por hilo
+    std::vector<std::string> threadNames_;                 ///< Nombre de cada hilo
+    std::vector<std::string> trackNames_;                  ///< Nombre de cada pista
+    std::vector<std::string> channelNames_;                ///< Nombre de cada canal
+    std::uint64_t stamp0_;                                 ///< Clock::now() al construir
+    std::uint64_t ns0_;                                    ///< steady_clock al construir [ns]
+    double nsPerTick_;                                     ///< ns por marca de Clock
+};
+
+} // namespace Traza
+
+/** @} */ // fin del grupo Traza
+
+#endif // TRAZA_H
@@ -0,0 +1,542 @@
+/**
+ * @file Analysis.cpp
+ * @brief Implementación del análisis sin simulación
+ */
+
+#include "DiscreteSystems/Analysis.h"
+#include "DiscreteSystems/Exceptions.h"
+#include "DiscreteSystems/Polynomial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+namespace DiscreteSystems {
+namespace Analysis {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+/// Frecuencias por bloque del núcleo de Horner (cabe de sobra en L1)
+const size_t kBlock = 64;
+
+/// Trabajo (productos complejos) a partir del cual el modo automático usa varios hilos
+const size_t kParallelWork = size_t(1) << 20;
+
+unsigned resolveThreads(unsigned threads, size_t work)
+{
+    if (threads != 0) {
+        return threads;
+    }
+    if (work < kParallelWork) {
+        return 1;
+    }
+    const unsigned hw = std::thread::hardware_concurrency();
+    return hw == 0 ? 1 : hw;
+}
+
+/**
+ * @brief Reparte [0, n) en tramos contiguos, uno por hilo (el llamador hace el primero)
+ */
+template <class F>
+void parallelFor(size_t n, unsigned threads, F fn)
+{
+    const size_t t = std::min<size_t>(threads, n);
+    if (t <= 1) {
+        fn(size_t(0), n);
+        return;
+    }
+    const size_t chunk = (n + t - 1) / t;
+    std::vector<std::thread> pool;
+    pool.reserve(t - 1);
+    for (size_t begin = chunk; begin < n; begin += chunk) {
+        pool.push_back(std::thread(fn, begin, std::min(n, begin + chunk)));
+    }
+    fn(size_t(0), chunk);
+    for (size_t i = 0; i < pool.size(); ++i) {
+        pool[i].join();
+    }
+}
+
+void checkDenominator(const std::vector<double>& a)
+{
+    if (a.empty() || a[0] == 0.0) {
+        throw InvalidCoefficients("Analysis: a[0] debe ser distinto de 0");
+    }
+}
+
+/**
+ * @brief p(q) = c[0] + c[1] q + ... para m valores de q, con Re/Im en arrays separados
+ */
+void hornerBlock(const std::vector<double>& c, const double* qr, const double* qi,
+                 double* pr, double* pi, size_t m)
+{
+    const size_t L = c.size();
+    const double top = L == 0 ? 0.0 : c[L - 1];
+    for (size_t i = 0; i < m; ++i) {
+        pr[i] = top;
+        pi[i] = 0.0;
+    }
+    for (size_t j = L == 0 ? 0 : L - 1; j-- > 0;) {
+        const double cj = c[j];
+        for (size_t i = 0; i < m; ++i) {
+            const double r = pr[i] * qr[i] - pi[i] * qi[i] + cj;
+            pi[i] = pr[i] * qi[i] + pi[i] * qr[i];
+            pr[i] = r;
+        }
+    }
+}
+
+void frequencyRange(const std::vector<double>& b, const std::vector<double>& a, double Ts,
+                    const double* omega, Complex* H, size_t begin, size_t end)
+{
+    double qr[kBlock], qi[kBlock], nr[kBlock], ni[kBlock], dr[kBlock], di[kBlock];
+    for (size_t k0 = begin; k0 < end; k0 += kBlock) {
+        const size_t m = std::min(kBlock, end - k0);
+        // q = z^-1 = e^{-jωTs}
+        for (size_t i = 0; i < m; ++i) {
+            const double theta = omega[k0 + i] * Ts;
+            qr[i] = std::cos(theta);
+            qi[i] = -std::sin(theta);
+        }
+        hornerBlock(b, qr, qi, nr, ni, m);
+        hornerBlock(a, qr, qi, dr, di, m);
+        for (size_t i = 0; i < m; ++i) {
+            const double den = dr[i] * dr[i] + di[i] * di[i];
+            H[k0 + i] = Complex((nr[i] * dr[i] + ni[i] * di[i]) / den,
+                                (ni[i] * dr[i] - nr[i] * di[i]) / den);
+        }
+    }
+}
+
+/// b(q) / a(q) en un solo punto q = z^-1
+Complex evaluateAt(const std::vector<double>& b, const std::vector<double>& a, Complex q)
+{
+    Complex num = 0.0, den = 0.0;
+    for (size_t j = b.size(); j-- > 0;) {
+        num = num * q + b[j];
+    }
+    for (size_t j = a.size(); j-- > 0;) {
+        den = den * q + a[j];
+    }
+    return num / den;
+}
+
+/// L(e^{jωTs}) en una sola frecuencia
+Complex evaluateAt(const std::vector<double>& b, const std::vector<double>& a, double Ts, double w)
+{
+    return evaluateAt(b, a, std::polar(1.0, -w * Ts));
+}
+
+/**
+ * @struct HessenbergForm
+ * @brief (Q^T A Q, Q^T B, C Q, D) con Q^T A Q de Hessenberg superior, por filas
+ */
+struct HessenbergForm {
+    size_t n;
+    std::vector<double> H;
+    std::vector<double> B;
+    std::vector<double> C;
+    double D;
+};
+
+HessenbergForm hessenberg(const StateSpaceSystem& sys)
+{
+    HessenbergForm f;
+    const std::vector<std::vector<double> >& A = sys.getA();
+    const size_t n = A.size();
+    f.n = n;
+    f.H.resize(n * n);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            f.H[i * n + j] = A[i][j];
+        }
+    }
+    f.B = sys.getB();
+    f.C = sys.getC();
+    f.D = sys.getD();
+
+    std::vector<double> v(n);
+    for (size_t k = 0; k + 2 < n; ++k) {
+        // Reflexión P = I - 2 v v^T / (v^T v) que anula H[k+2..n-1][k]
+        const size_t m = n - k - 1;
+        double norm = 0.0;
+        for (size_t i = 0; i < m; ++i) {
+            v[i] = f.H[(k + 1 + i) * n + k];
+            norm += v[i] * v[i];
+        }
+        norm = std::sqrt(norm);
+        if (norm == 0.0) {
+            continue;
+        }
+        v[0] += v[0] >= 0.0 ? norm : -norm;
+        double vv = 0.0;
+        for (size_t i = 0; i < m; ++i) {
+            vv += v[i] * v[i];
+        }
+        const double beta = 2.0 / vv;
+        for (size_t j = 0; j < n; ++j) {           // H <- P H
+            double s = 0.0;
+            for (size_t i = 0; i < m; ++i) {
+                s += v[i] * f.H[(k + 1 + i) * n + j];
+            }
+            s *= beta;
+            for (size_t i = 0; i < m; ++i) {
+                f.H[(k + 1 + i) * n + j] -= s * v[i];
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {           // H <- H P
+            double s = 0.0;
+            for (size_t j = 0; j < m; ++j) {
+                s += f.H[i * n + k + 1 + j] * v[j];
+            }
+            s *= beta;
+            for (size_t j = 0; j < m; ++j) {
+                f.H[i * n + k + 1 + j] -= s * v[j];
+            }
+        }
+        double sb = 0.0, sc = 0.0;                 // B <- P B, C <- C P
+        for (size_t i = 0; i < m; ++i) {
+            sb += v[i] * f.B[k + 1 + i];
+            sc += v[i] * f.C[k + 1 + i];
+        }
+        for (size_t i = 0; i < m; ++i) {
+            f.B[k + 1 + i] -= beta * sb * v[i];
+            f.C[k + 1 + i] -= beta * sc * v[i];
+        }
+        for (size_t i = 1; i < m; ++i) {           // Ceros exactos bajo la subdiagonal
+            f.H[(k + 1 + i) * n + k] = 0.0;
+        }
+    }
+    return f;
+}
+
+void stateSpaceRange(const HessenbergForm& f, double Ts, const double* omega, Complex* out,
+                     size_t begin, size_t end)
+{
+    const size_t n = f.n;
+    std::vector<Complex> M(n * n), x(n);
+    for (size_t w = begin; w < end; ++w) {
+        const Complex z = std::polar(1.0, omega[w] * Ts);
+        for (size_t i = 0; i < n; ++i) {
+            // Por debajo de la subdiagonal H es nula: no hace falta copiarla
+            for (size_t j = i == 0 ? 0 : i - 1; j < n; ++j) {
+                M[i * n + j] = -f.H[i * n + j];
+            }
+            M[i * n + i] += z;
+            x[i] = f.B[i];
+        }
+        // Eliminación de la subdiagonal con pivoteo entre filas vecinas: O(n²)
+        for (size_t k = 0; k + 1 < n; ++k) {
+            Complex* rk = &M[k * n];
+            Complex* rn = &M[(k + 1) * n];
+            if (std::norm(rn[k]) > std::norm(rk[k])) {
+                for (size_t j = k; j < n; ++j) {
+                    std::swap(rk[j], rn[j]);
+                }
+                std::swap(x[k], x[k + 1]);
+            }
+            const Complex factor = rn[k] / rk[k];
+            for (size_t j = k + 1; j < n; ++j) {
+                rn[j] -= factor * rk[j];
+            }
+            x[k + 1] -= factor * x[k];
+        }
+        Complex y = f.D;
+        for (size_t i = n; i-- > 0;) {
+            Complex s = x[i];
+            for (size_t j = i + 1; j < n; ++j) {
+                s -= M[i * n + j] * x[j];
+            }
+            x[i] = s / M[i * n + i];
+            y += f.C[i] * x[i];
+        }
+        out[w] = y;
+    }
+}
+
+std::vector<double> differenceEquation(const std::vector<double>& b, const std::vector<double>& a,
+                                       size_t N, bool unitStep)
+{
+    checkDenominator(a);
+    std::vector<double> y(N, 0.0);
+    const double a0 = a[0];
+    for (size_t k = 0; k < N; ++k) {
+        double acc = 0.0;
+        const size_t mb = std::min(k + 1, b.size());
+        if (unitStep) {
+            for (size_t i = 0; i < mb; ++i) {
+                acc += b[i];
+            }
+        } else if (k < b.size()) {
+            acc = b[k];
+        }
+        const size_t ma = std::min(k + 1, a.size());
+        for (size_t i = 1; i < ma; ++i) {
+            acc -= a[i] * y[k - i];
+        }
+        y[k] = acc / a0;
+    }
+    return y;
+}
+
+void checkSamplingTime(double Ts)
+{
+    if (!(Ts > 0.0)) {
+        throw InvalidSamplingTime("Analysis: Ts debe ser > 0");
+    }
+}
+
+} // namespace
+
+std::vector<double> logspace(double wMin, double wMax, size_t n)
+{
+    if (!(wMin > 0.0) || !(wMax >= wMin)) {
+        throw std::invalid_argument("Analysis: logspace requiere 0 < wMin <= wMax");
+    }
+    std::vector<double> w(n);
+    const double ratio = std::log(wMax / wMin);
+    for (size_t i = 0; i < n; ++i) {
+        w[i] = n == 1 ? wMin : wMin * std::exp(ratio * static_cast<double>(i) / static_cast<double>(n - 1));
+    }
+    if (n > 1) {
+        w[n - 1] = wMax;
+    }
+    return w;
+}
+
+void frequencyResponse(const std::vector<double>& b, const std::vector<double>& a, double Ts,
+                       const double* omega, Complex* H, size_t n, unsigned threads)
+{
+    checkDenominator(a);
+    checkSamplingTime(Ts);
+    const unsigned t = resolveThreads(threads, n * (b.size() + a.size()));
+    parallelFor(n, t, [&](size_t begin, size_t end) {
+        frequencyRange(b, a, Ts, omega, H, begin, end);
+    });
+}
+
+std::vector<Complex> frequencyResponse(const TransferFunctionSystem& sys, const std::vector<double>& omega,
+                                       unsigned threads)
+{
+    std::vector<Complex> H(omega.size());
+    if (!omega.empty()) {
+        frequencyResponse(sys.getNumerator(), sys.getDenominator(), sys.getSamplingTime(),
+                          &omega[0], &H[0], omega.size(), threads);
+    }
+    return H;
+}
+
+std::vector<Complex> frequencyResponse(const StateSpaceSystem& sys, const std::vector<double>& omega,
+                                       unsigned threads)
+{
+    std::vector<Complex> H(omega.size());
+    if (omega.empty()) {
+        return H;
+    }
+    const HessenbergForm f = hessenberg(sys);
+    const double Ts = sys.getSamplingTime();
+    const unsigned t = resolveThreads(threads, omega.size() * f.n * f.n);
+    parallelFor(omega.size(), t, [&](size_t begin, size_t end) {
+        stateSpaceRange(f, Ts, &omega[0], &H[0], begin, end);
+    });
+    return H;
+}
+
+Bode bode(const std::vector<double>& omega, const std::vector<Complex>& H)
+{
+    if (omega.size() != H.size()) {
+        throw InvalidDimensions("Analysis: omega y H deben tener el mismo tamaño");
+    }
+    Bode out;
+    out.omega = omega;
+    out.magnitudeDb.resize(H.size());
+    out.phaseDeg.resize(H.size());
+    const double toDeg = 180.0 / kPi;
+    double offset = 0.0, prev = 0.0;
+    for (size_t i = 0; i < H.size(); ++i) {
+        out.magnitudeDb[i] = 20.0 * std::log10(std::abs(H[i]));
+        const double p = std::arg(H[i]) * toDeg;
+        if (i > 0) {
+            // Salto de más de 180° entre puntos vecinos: vuelta completa
+            offset -= 360.0 * std::floor((p + offset - prev) / 360.0 + 0.5);
+        }
+        out.phaseDeg[i] = p + offset;
+        prev = out.phaseDeg[i];
+    }
+    return out;
+}
+
+std::vector<double> impulse(const std::vector<double>& b, const std::vector<double>& a, size_t N)
+{
+    return differenceEquation(b, a, N, false);
+}
+
+std::vector<double> step(const std::vector<double>& b, const std::vector<double>& a, size_t N)
+{
+    return differenceEquation(b, a, N, true);
+}
+
+std::vector<double> impulse(const TransferFunctionSystem& sys, size_t N)
+{
+    return impulse(sys.getNumerator(), sys.getDenominator(), N);
+}
+
+std::vector<double> step(const TransferFunctionSystem& sys, size_t N)
+{
+    return step(sys.getNumerator(), sys.getDenominator(), N);
+}
+
+std::vector<double> impulse(const StateSpaceSystem& sys, size_t N)
+{
+    const std::vector<std::vector<double> >& A = sys.getA();
+    const std::vector<double>& C = sys.getC();
+    const size_t n = A.size();
+    std::vector<double> h(N, 0.0), v(sys.getB()), next(n);
+    for (size_t k = 0; k < N; ++k) {
+        if (k == 0) {
+            h[k] = sys.getD();
+            continue;
+        }
+        double y = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            y += C[i] * v[i];
+        }
+        h[k] = y;
+        for (size_t i = 0; i < n; ++i) {
+            double s = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                s += A[i][j] * v[j];
+            }
+            next[i] = s;
+        }
+        v.swap(next);
+    }
+    return h;
+}
+
+std::vector<double> step(const StateSpaceSystem& sys, size_t N)
+{
+    const std::vector<std::vector<double> >& A = sys.getA();
+    const std::vector<double>& B = sys.getB();
+    const std::vector<double>& C = sys.getC();
+    const size_t n = A.size();
+    std::vector<double> y(N, 0.0), x(n, 0.0), next(n);
+    for (size_t k = 0; k < N; ++k) {
+        double yk = sys.getD();
+        for (size_t i = 0; i < n; ++i) {
+            yk += C[i] * x[i];
+        }
+        y[k] = yk;
+        for (size_t i = 0; i < n; ++i) {
+            double s = B[i];
+            for (size_t j = 0; j < n; ++j) {
+                s += A[i][j] * x[j];
+            }
+            next[i] = s;
+        }
+        x.swap(next);
+    }
+    return y;
+}
+
+std::vector<Complex> poles(const std::vector<double>& b, const std::vector<double>& a)
+{
+    checkDenominator(a);
+    // H = b(z^-1)/a(z^-1) = z^(L-m) b(z) / (z^(L-n) a(z)) con L = max(m, n)
+    std::vector<double> p(a);
+    p.resize(std::max(a.size(), b.size()), 0.0);
+    return Polynomial::roots(p);
+}
+
+std::vector<Complex> poles(const TransferFunctionSystem& sys)
+{
+    return poles(sys.getNumerator(), sys.getDenominator());
+}
+
+std::vector<Complex> poles(const StateSpaceSystem& sys)
+{
+    // QR directamente sobre la forma de Hessenberg: sin pasar por el
+    // polinomio característico, mal condicionado en órdenes altos
+    const HessenbergForm f = hessenberg(sys);
+    return Polynomial::hessenbergEigenvalues(f.H, f.n);
+}
+
+bool isStable(const std::vector<Complex>& poles)
+{
+    for (size_t i = 0; i < poles.size(); ++i) {
+        if (!(std::abs(poles[i]) < 1.0)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Margins margins(const std::vector<double>& b, const std::vector<double>& a, double Ts, size_t points)
+{
+    checkDenominator(a);
+    checkSamplingTime(Ts);
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    Margins m = {inf, nan, inf, nan};
+
+    const double nyquist = kPi / Ts;
+    const std::vector<double> w = logspace(1e-5 * nyquist, nyquist, std::max<size_t>(points, 2));
+    std::vector<Complex> L(w.size());
+    frequencyResponse(b, a, Ts, &w[0], &L[0], w.size(), 1);
+    L.back() = evaluateAt(b, a, Complex(-1.0, 0.0));     // Im L(-1) = 0 exacto
+
+    // Bisección sobre [lo, hi] con cambio de signo de f(L(ω))
+    auto refine = [&](double lo, double hi, double (*f)(Complex)) {
+        const bool low = f(evaluateAt(b, a, Ts, lo)) < 0.0;
+        for (int it = 0; it < 60; ++it) {
+            const double mid = 0.5 * (lo + hi);
+            if ((f(evaluateAt(b, a, Ts, mid)) < 0.0) == low) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+        return 0.5 * (lo + hi);
+    };
+    double (*gain)(Complex) = [](Complex l) { return std::abs(l) - 1.0; };
+    double (*imag)(Complex) = [](Complex l) { return l.imag(); };
+
+    for (size_t i = 0; i < w.size(); ++i) {
+        const bool last = i + 1 == w.size();
+        // Cruce de fase: L real negativo
+        double wp = nan;
+        Complex l = L[i];
+        if (L[i].imag() == 0.0) {
+            wp = w[i];
+        } else if (!last && L[i + 1].imag() != 0.0 && (L[i].imag() < 0.0) != (L[i + 1].imag() < 0.0)) {
+            wp = refine(w[i], w[i + 1], imag);
+            l = evaluateAt(b, a, Ts, wp);
+        }
+        if (!std::isnan(wp)) {
+            if (l.real() < 0.0 && 1.0 / std::abs(l) < m.gainMargin) {
+                m.gainMargin = 1.0 / std::abs(l);
+                m.phaseCrossover = wp;
+            }
+        }
+        // Cruce de ganancia: |L| = 1
+        if (!last && (gain(L[i]) < 0.0) != (gain(L[i + 1]) < 0.0)) {
+            const double wg = refine(w[i], w[i + 1], gain);
+            double pm = 180.0 + std::arg(evaluateAt(b, a, Ts, wg)) * 180.0 / kPi;
+            if (pm > 180.0) {
+                pm -= 360.0;
+            }
+            if (pm < m.phaseMargin) {
+                m.phaseMargin = pm;
+                m.gainCrossover = wg;
+            }
+        }
+    }
+    return m;
+}
+
+} // namespace Analysis
+} // namespace DiscreteSystems
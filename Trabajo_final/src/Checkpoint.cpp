@@ -0,0 +1,335 @@
+/**
+ * @file Checkpoint.cpp
+ * @brief Implementación de CheckpointWriter y CheckpointReader
+ */
+
+#include "DiscreteSystems/Checkpoint.h"
+#include "DiscreteSystems/Exceptions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace DiscreteSystems {
+
+namespace {
+
+const char kMagic[8] = {'D', 'S', 'C', 'K', 'P', '0', '0', '1'};
+const uint32_t kContainerVersion = 1;
+const uint32_t kFlagBuffers = 1;
+const std::size_t kHeaderBytes = 16;
+const std::size_t kSectionBytes = 16;
+
+bool hostIsLittleEndian()
+{
+    const uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+const bool kLittle = hostIsLittleEndian();
+
+/** @brief Copia n valores de size bytes invirtiendo cada uno si el host es big-endian */
+void copyLE(char* dst, const void* src, std::size_t n, std::size_t size)
+{
+    std::memcpy(dst, src, n * size);
+    if (!kLittle) {
+        for (std::size_t i = 0; i < n; ++i) {
+            std::reverse(dst + i * size, dst + (i + 1) * size);
+        }
+    }
+}
+
+void putLE(char* dst, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        dst[i] = static_cast<char>((v >> (8 * i)) & 0xFF);
+    }
+}
+
+uint64_t getLE(const char* src, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(src[i])) << (8 * i);
+    }
+    return v;
+}
+
+/** @brief Bytes rellenados hasta múltiplo de 8 */
+inline std::size_t padded(std::size_t bytes)
+{
+    return (bytes + 7) / 8 * 8;
+}
+
+std::string tagName(uint32_t tag)
+{
+    std::string s(4, ' ');
+    for (int i = 0; i < 4; ++i) {
+        const char c = static_cast<char>((tag >> (8 * i)) & 0xFF);
+        s[static_cast<std::size_t>(i)] = (c >= 32 && c < 127) ? c : '?';
+    }
+    return "'" + s + "'";
+}
+
+/**
+ * @brief Libera la proyección de un fichero de instantánea
+ */
+struct MappingDeleter {
+    std::size_t bytes;
+    void operator()(const void* addr) const {
+        munmap(const_cast<void*>(addr), bytes);
+    }
+};
+
+} // namespace
+
+/*========================================================================*/
+/*                              ESCRITOR                                  */
+/*========================================================================*/
+
+CheckpointWriter::CheckpointWriter(bool buffers)
+    : buffers_(buffers), data_(kHeaderBytes, 0), open_()
+{
+    std::memcpy(&data_[0], kMagic, sizeof(kMagic));
+    putLE(&data_[8], kContainerVersion, 4);
+    putLE(&data_[12], buffers_ ? kFlagBuffers : 0, 4);
+}
+
+void CheckpointWriter::append(const void* p, std::size_t bytes)
+{
+    const char* c = static_cast<const char*>(p);
+    data_.insert(data_.end(), c, c + bytes);
+}
+
+void CheckpointWriter::begin(uint32_t tag, uint32_t version)
+{
+    open_.push_back(data_.size());
+    data_.resize(data_.size() + kSectionBytes, 0);
+    char* h = &data_[open_.back()];
+    putLE(h, tag, 4);
+    putLE(h + 4, version, 4);
+}
+
+void CheckpointWriter::end()
+{
+    if (open_.empty()) {
+        throw CheckpointError("CheckpointWriter: end() sin begin()");
+    }
+    const std::size_t at = open_.back();
+    open_.pop_back();
+    putLE(&data_[at + 8], data_.size() - at - kSectionBytes, 8);
+}
+
+void CheckpointWriter::writeU64(uint64_t v)
+{
+    char b[8];
+    putLE(b, v, 8);
+    append(b, 8);
+}
+
+void CheckpointWriter::writeF64(double v)
+{
+    uint64_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    writeU64(bits);
+}
+
+void CheckpointWriter::writeArray(const double* p, std::size_t n)
+{
+    writeU64(n);
+    const std::size_t at = data_.size();
+    data_.resize(at + n * sizeof(double));
+    if (n > 0) {
+        copyLE(&data_[at], p, n, sizeof(double));
+    }
+}
+
+void CheckpointWriter::writeArray(const float* p, std::size_t n)
+{
+    writeU64(n);
+    const std::size_t at = data_.size();
+    data_.resize(at + padded(n * sizeof(float)), 0);
+    if (n > 0) {
+        copyLE(&data_[at], p, n, sizeof(float));
+    }
+}
+
+void CheckpointWriter::save(const std::string& path) const
+{
+    if (!open_.empty()) {
+        throw CheckpointError("CheckpointWriter: quedan secciones abiertas");
+    }
+    std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+    if (!os) {
+        throw CheckpointError("CheckpointWriter: no se pudo crear '" + path + "'");
+    }
+    os.write(&data_[0], static_cast<std::streamsize>(data_.size()));
+    os.flush();
+    if (!os) {
+        throw CheckpointError("CheckpointWriter: no se pudo escribir '" + path + "'");
+    }
+}
+
+/*========================================================================*/
+/*                               LECTOR                                   */
+/*========================================================================*/
+
+CheckpointReader::CheckpointReader(const std::string& path)
+    : storage_(), base_(nullptr), size_(0), pos_(0), buffers_(false), ends_()
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw CheckpointError("CheckpointReader: no se pudo abrir '" + path + "': " + std::strerror(errno));
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(kHeaderBytes)) {
+        ::close(fd);
+        throw CheckpointError("CheckpointReader: '" + path + "' no es una instantánea");
+    }
+    const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+    void* addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw CheckpointError("CheckpointReader: no se pudo proyectar '" + path + "': " + std::strerror(errno));
+    }
+    MappingDeleter deleter = {bytes};
+    storage_ = std::shared_ptr<const void>(addr, deleter);
+    base_ = static_cast<const char*>(addr);
+    size_ = bytes;
+    open();
+}
+
+CheckpointReader::CheckpointReader(const char* data, std::size_t size)
+    : storage_(), base_(data), size_(size), pos_(0), buffers_(false), ends_()
+{
+    open();
+}
+
+CheckpointReader::CheckpointReader(const CheckpointWriter& writer)
+    : storage_(), base_(writer.data().data()), size_(writer.size()), pos_(0), buffers_(false), ends_()
+{
+    open();
+}
+
+void CheckpointReader::open()
+{
+    if (size_ < kHeaderBytes || std::memcmp(base_, kMagic, sizeof(kMagic)) != 0) {
+        throw CheckpointError("CheckpointReader: cabecera de instantánea no válida");
+    }
+    if (getLE(base_ + 8, 4) != kContainerVersion) {
+        throw CheckpointError("CheckpointReader: versión de instantánea no soportada");
+    }
+    buffers_ = (getLE(base_ + 12, 4) & kFlagBuffers) != 0;
+    pos_ = kHeaderBytes;
+}
+
+void CheckpointReader::rewind()
+{
+    pos_ = kHeaderBytes;
+    ends_.clear();
+}
+
+void CheckpointReader::need(std::size_t bytes) const
+{
+    const std::size_t limit = ends_.empty() ? size_ : ends_.back();
+    if (bytes > limit - pos_) {
+        throw CheckpointError("CheckpointReader: instantánea truncada");
+    }
+}
+
+uint32_t CheckpointReader::begin(uint32_t tag, uint32_t maxVersion)
+{
+    need(kSectionBytes);
+    const uint32_t found = static_cast<uint32_t>(getLE(base_ + pos_, 4));
+    const uint32_t version = static_cast<uint32_t>(getLE(base_ + pos_ + 4, 4));
+    const uint64_t bytes = getLE(base_ + pos_ + 8, 8);
+    if (found != tag) {
+        throw CheckpointError("CheckpointReader: se esperaba la sección " + tagName(tag)
+                              + " y hay " + tagName(found));
+    }
+    if (version > maxVersion) {
+        throw CheckpointError("CheckpointReader: la sección " + tagName(tag) + " tiene la versión "
+                              + std::to_string(version) + ", posterior a la soportada");
+    }
+    pos_ += kSectionBytes;
+    need(static_cast<std::size_t>(bytes));
+    ends_.push_back(pos_ + static_cast<std::size_t>(bytes));
+    return version;
+}
+
+void CheckpointReader::end()
+{
+    if (ends_.empty()) {
+        throw CheckpointError("CheckpointReader: end() sin begin()");
+    }
+    pos_ = ends_.back();
+    ends_.pop_back();
+}
+
+uint64_t CheckpointReader::readU64()
+{
+    need(8);
+    const uint64_t v = getLE(base_ + pos_, 8);
+    pos_ += 8;
+    return v;
+}
+
+double CheckpointReader::readF64()
+{
+    const uint64_t bits = readU64();
+    double v;
+    std::memcpy(&v, &bits, sizeof(v));
+    return v;
+}
+
+uint64_t CheckpointReader::arrayLength(std::size_t bytesPerValue)
+{
+    const uint64_t n = readU64();
+    const std::size_t limit = ends_.empty() ? size_ : ends_.back();
+    if (n > (limit - pos_) / bytesPerValue) {
+        throw CheckpointError("CheckpointReader: instantánea truncada");
+    }
+    need(padded(static_cast<std::size_t>(n) * bytesPerValue));
+    return n;
+}
+
+void CheckpointReader::readArray(std::vector<double>& out)
+{
+    const std::size_t n = static_cast<std::size_t>(arrayLength(sizeof(double)));
+    out.resize(n);
+    if (n > 0) {
+        copyLE(reinterpret_cast<char*>(&out[0]), base_ + pos_, n, sizeof(double));
+    }
+    pos_ += n * sizeof(double);
+}
+
+void CheckpointReader::readArray(std::vector<float>& out)
+{
+    const std::size_t n = static_cast<std::size_t>(arrayLength(sizeof(float)));
+    out.resize(n);
+    if (n > 0) {
+        copyLE(reinterpret_cast<char*>(&out[0]), base_ + pos_, n, sizeof(float));
+    }
+    pos_ += padded(n * sizeof(float));
+}
+
+void CheckpointReader::readArray(double* dst, std::size_t n)
+{
+    if (arrayLength(sizeof(double)) != n) {
+        throw CheckpointError("CheckpointReader: longitud de vector distinta de la esperada");
+    }
+    if (n > 0) {
+        copyLE(reinterpret_cast<char*>(dst), base_ + pos_, n, sizeof(double));
+    }
+    pos_ += n * sizeof(double);
+}
+
+} // namespace DiscreteSystems
@@ -4,14 +4,247 @@
  */
 
 #include "DiscreteSystems/DiscreteSystem.h"
+#include "DiscreteSystems/Checkpoint.h"
 #include "DiscreteSystems/Exceptions.h"
+#include "DiscreteSystems/StreamRecorder.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <ostream>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
 namespace DiscreteSystems {
 
-DiscreteSystem::DiscreteSystem(double Ts, size_t bufferSize)
-    : Ts_(Ts), k_(0), bufferSize_(bufferSize), writeIndex_(0), count_(0), buffer_()
+namespace {
+
+bool hostIsLittleEndian()
+{
+    const uint16_t one = 1;
+    unsigned char first;
+    std::memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+/** @brief Representación little-endian de v (identidad en x86/ARM) */
+double toLittleEndian(double v)
+{
+    static const bool little = hostIsLittleEndian();
+    if (little) {
+        return v;
+    }
+    unsigned char b[sizeof(double)];
+    std::memcpy(b, &v, sizeof(double));
+    std::reverse(b, b + sizeof(double));
+    std::memcpy(&v, b, sizeof(double));
+    return v;
+}
+
+void putLE(std::string& s, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) {
+        s.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+    }
+}
+
+/**
+ * @brief Cabecera de los formatos binarios para count filas de 3 columnas
+ * 
+ * Siempre mide un múltiplo de 8 bytes para que los datos queden alineados.
+ */
+std::string exportHeader(ExportFormat format, size_t count)
+{
+    std::string h;
+    if (format == ExportFormat::NPY) {
+        // Formato .npy 1.0: magic, versión, longitud de la cabecera y un
+        // diccionario Python rellenado con espacios hasta múltiplo de 64
+        std::string dict = "{'descr': '<f8', 'fortran_order': True, 'shape': ("
+                         + std::to_string(count) + ", 3), }";
+        const size_t pre = 10;
+        size_t padded = pre + dict.size() + 1;
+        padded = (padded + 63) / 64 * 64;
+        dict.append(padded - pre - dict.size() - 1, ' ');
+        dict.push_back('\n');
+        h.append("\x93NUMPY", 6);
+        h.push_back(1);
+        h.push_back(0);
+        putLE(h, dict.size(), 2);
+        h += dict;
+    } else if (format == ExportFormat::MAT) {
+        // MAT-file Level 5: texto descriptivo (116), offset de subsistema
+        // (8), versión 0x0100 e indicador de endianness "IM"
+        std::string text = "MATLAB 5.0 MAT-file, Created by: DiscreteSystems::bufferDump";
+        text.resize(116, ' ');
+        h += text;
+        h.append(8, '\0');
+        putLE(h, 0x0100, 2);
+        h.push_back('I');
+        h.push_back('M');
+
+        const uint64_t dataBytes = 3 * static_cast<uint64_t>(count) * sizeof(double);
+        if (dataBytes + 56 > 0xFFFFFFFFull) {
+            throw ExportError("DiscreteSystem: el buffer es demasiado grande para MAT Level 5");
+        }
+        const uint32_t miINT8 = 1, miINT32 = 5, miUINT32 = 6, miDOUBLE = 9, miMATRIX = 14;
+        const uint32_t mxDOUBLE_CLASS = 6;
+        putLE(h, miMATRIX, 4);
+        putLE(h, 48 + 8 + dataBytes, 4);
+        // Array flags
+        putLE(h, miUINT32, 4);
+        putLE(h, 8, 4);
+        putLE(h, mxDOUBLE_CLASS, 4);
+        putLE(h, 0, 4);
+        // Dimensiones: count x 3
+        putLE(h, miINT32, 4);
+        putLE(h, 8, 4);
+        putLE(h, count, 4);
+        putLE(h, 3, 4);
+        // Nombre "data" (rellenado a 8 bytes)
+        putLE(h, miINT8, 4);
+        putLE(h, 4, 4);
+        h.append("data", 4);
+        h.append(4, '\0');
+        // Parte real, por columnas
+        putLE(h, miDOUBLE, 4);
+        putLE(h, dataBytes, 4);
+    }
+    return h;
+}
+
+/** @brief Convierte n valores a float32 */
+void narrow(const double* src, size_t n, float* dst)
+{
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<float>(src[i]);
+    }
+}
+
+/**
+ * @brief Reconstruye muestras desde las columnas (in nulo: entrada no registrada)
+ */
+template <class T>
+void gather(const T* in, const T* out, size_t n, int64_t k0, Sample* dst)
+{
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    for (size_t i = 0; i < n; ++i) {
+        dst[i].in = in != nullptr ? static_cast<double>(in[i]) : nan;
+        dst[i].out = static_cast<double>(out[i]);
+        dst[i].k = static_cast<int>(k0 + static_cast<int64_t>(i));
+    }
+}
+
+/** @brief pwrite completo (reintenta escrituras parciales) */
+bool writeAt(int fd, const void* data, size_t bytes, off_t& offset)
+{
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        const ssize_t w = ::pwrite(fd, p, bytes, offset);
+        if (w < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        p += w;
+        bytes -= static_cast<size_t>(w);
+        offset += w;
+    }
+    return true;
+}
+
+/**
+ * @brief Formateador de texto con buffer propio
+ * 
+ * Formatea con snprintf el mismo texto que operator<< (según precisión y
+ * modo de os) y lo entrega a os en bloques de 64 KiB, evitando el coste por
+ * número del centinela y de la faceta num_put de iostream.
+ */
+class TextWriter {
+public:
+    explicit TextWriter(std::ostream& os)
+        : os_(os), n_(0), precision_(static_cast<int>(os.precision())), fmt_("%.*g")
+    {
+        const std::ios_base::fmtflags ff = os.flags() & std::ios_base::floatfield;
+        if (ff == std::ios_base::fixed) {
+            fmt_ = "%.*f";
+        } else if (ff == std::ios_base::scientific) {
+            fmt_ = "%.*e";
+        }
+    }
+
+    ~TextWriter() { flush(); }
+
+    void put(char c)
+    {
+        reserve(1);
+        buf_[n_++] = c;
+    }
+
+    void text(const char* s)
+    {
+        const size_t len = std::strlen(s);
+        reserve(len);
+        std::memcpy(buf_ + n_, s, len);
+        n_ += len;
+    }
+
+    void integer(int v)
+    {
+        reserve(kMaxNumber);
+        n_ += static_cast<size_t>(std::snprintf(buf_ + n_, kMaxNumber, "%d", v));
+    }
+
+    void number(double v)
+    {
+        reserve(kMaxNumber);
+        const int w = std::snprintf(buf_ + n_, kMaxNumber, fmt_, precision_, v);
+        if (w >= 0 && static_cast<size_t>(w) < kMaxNumber) {
+            n_ += static_cast<size_t>(w);
+        } else {
+            // Números enormes en modo fixed: se delega en el stream
+            flush();
+            os_ << v;
+        }
+    }
+
+    void flush()
+    {
+        if (n_ > 0) {
+            os_.write(buf_, static_cast<std::streamsize>(n_));
+            n_ = 0;
+        }
+    }
+
+private:
+    static const size_t kCapacity = 65536;
+    static const size_t kMaxNumber = 64;
+
+    void reserve(size_t bytes)
+    {
+        if (n_ + bytes > kCapacity) {
+            flush();
+        }
+    }
+
+    std::ostream& os_;
+    size_t n_;
+    int precision_;
+    const char* fmt_;
+    char buf_[kCapacity];
+};
+
+} // namespace
+
+DiscreteSystem::DiscreteSystem(double Ts, size_t bufferSize, RecordingPolicy recording)
+    : Ts_(Ts), k_(0), bufferSize_(bufferSize), writeIndex_(0), count_(0), recording_(recording),
+      in_(), out_(), inF_(), outF_(), writing_(0), published_(0), resetMark_(0), kOffset_(0),
+      recorder_(nullptr)
 {
     if (Ts_ <= 0.0) {
         throw InvalidSamplingTime("DiscreteSystem: el período de muestreo Ts debe ser > 0");
@@ -20,73 +253,610 @@ DiscreteSystem::DiscreteSystem(double Ts, size_t bufferSize)
         // Permitimos bufferSize_ == 0? Preferible lanzar excepción para evitar edge raro.
         throw InvalidDimensions("DiscreteSystem: el tamaño del buffer debe ser > 0");
     }
-    buffer_.resize(bufferSize_);
+    allocateColumns();
+}
+
+DiscreteSystem::DiscreteSystem(const DiscreteSystem& other)
+    : Ts_(other.Ts_), k_(other.k_), bufferSize_(other.bufferSize_),
+      writeIndex_(other.writeIndex_), count_(other.count_), recording_(other.recording_),
+      in_(other.in_), out_(other.out_), inF_(other.inF_), outF_(other.outF_),
+      writing_(other.published_.load(std::memory_order_relaxed)),
+      published_(other.published_.load(std::memory_order_relaxed)),
+      resetMark_(other.resetMark_.load(std::memory_order_relaxed)),
+      kOffset_(other.kOffset_.load(std::memory_order_relaxed)),
+      recorder_(nullptr)
+{}
+
+DiscreteSystem& DiscreteSystem::operator=(const DiscreteSystem& other)
+{
+    if (this != &other) {
+        Ts_ = other.Ts_;
+        k_ = other.k_;
+        bufferSize_ = other.bufferSize_;
+        writeIndex_ = other.writeIndex_;
+        count_ = other.count_;
+        recording_ = other.recording_;
+        in_ = other.in_;
+        out_ = other.out_;
+        inF_ = other.inF_;
+        outF_ = other.outF_;
+        const uint64_t seq = other.published_.load(std::memory_order_relaxed);
+        writing_.store(seq, std::memory_order_relaxed);
+        published_.store(seq, std::memory_order_relaxed);
+        resetMark_.store(other.resetMark_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        kOffset_.store(other.kOffset_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    return *this;
 }
 
 double DiscreteSystem::next(double uk)
 {
     double yk = compute(uk);      // Hook virtual implementado por derivadas
-    storeSample(uk, yk);          // Gestiona el buffer circular
+    if (recording_.fields != RecordFields::None) {
+        storeSample(uk, yk);      // Gestiona el buffer circular
+    }
+    if (recorder_ != nullptr) {
+        recorder_->append(k_, uk, yk);
+    }
     ++k_;                         // Avanza el tiempo discreto
     return yk;
 }
 
+void DiscreteSystem::process(const double* u, double* y, size_t n)
+{
+    if (n == 0) {
+        return;
+    }
+    computeBlock(u, y, n);        // Una sola llamada virtual por bloque
+    if (recording_.fields != RecordFields::None) {
+        storeBlock(u, y, n);      // Copia en bloque al buffer circular
+    }
+    if (recorder_ != nullptr) {
+        recorder_->appendBlock(u, y, n, k_);
+    }
+    k_ += static_cast<int>(n);    // Avanza el tiempo discreto n pasos
+}
+
+double DiscreteSystem::advance(size_t steps, double u)
+{
+    if (steps == 0) {
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+    double yk = computeHold(u, steps);
+    if (recording_.fields != RecordFields::None) {
+        storeJump(steps, 1, u, yk);
+    }
+    if (recorder_ != nullptr) {
+        recorder_->append(k_ + static_cast<int>(steps) - 1, u, yk);
+    }
+    k_ += static_cast<int>(steps);
+    return yk;
+}
+
+void DiscreteSystem::hold(size_t steps, double u, double y)
+{
+    if (steps == 0) {
+        return;
+    }
+    if (recording_.fields != RecordFields::None) {
+        storeJump(steps, std::min(steps, bufferSize_), u, y);
+    }
+    if (recorder_ != nullptr) {
+        recorder_->appendHold(k_, steps, u, y);
+    }
+    k_ += static_cast<int>(steps);
+}
+
+double DiscreteSystem::computeHold(double u, size_t steps)
+{
+    double yk = 0.0;
+    for (size_t i = 0; i < steps; ++i) {
+        yk = compute(u);
+    }
+    return yk;
+}
+
+void DiscreteSystem::computeBlock(const double* u, double* y, size_t n)
+{
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = compute(u[i]);
+    }
+}
+
 void DiscreteSystem::reset()
 {
     k_ = 0;
-    writeIndex_ = 0;
     count_ = 0;
+    // writeIndex_ no vuelve a 0: sigue ligado a la secuencia de publicación.
+    // Los lectores descartan todo lo anterior a resetMark_, que se anuncia
+    // (junto con el nuevo origen de k) antes de limpiar el buffer.
+    const uint64_t seq = published_.load(std::memory_order_relaxed);
+    kOffset_.store(-static_cast<int64_t>(seq), std::memory_order_relaxed);
+    resetMark_.store(seq, std::memory_order_release);
+    std::atomic_thread_fence(std::memory_order_release);
     // No es necesario reinicializar todo el buffer, basta con ignorar muestras previas
     // pero lo dejamos con valores por defecto por claridad
-    for (auto & s : buffer_) {
-        s = Sample{0.0, 0.0, 0};
-    }
+    std::fill(in_.begin(), in_.end(), 0.0);
+    std::fill(out_.begin(), out_.end(), 0.0);
+    std::fill(inF_.begin(), inF_.end(), 0.0f);
+    std::fill(outF_.begin(), outF_.end(), 0.0f);
     resetState(); // Hook para clases derivadas
 }
 
+void DiscreteSystem::checkpoint(CheckpointWriter& w) const
+{
+    w.begin(checkpointTag('D', 'S', 'Y', 'S'), 1);
+    w.writeF64(Ts_);
+    w.writeU64(static_cast<uint64_t>(static_cast<int64_t>(k_)));
+    w.writeU64(bufferSize_);
+    w.writeU64(static_cast<uint64_t>(recording_.fields));
+    w.writeU64(static_cast<uint64_t>(recording_.precision));
+    w.writeU64(published_.load(std::memory_order_relaxed));
+    if (w.buffers()) {
+        w.writeU64(writeIndex_);
+        w.writeU64(count_);
+        w.writeU64(resetMark_.load(std::memory_order_relaxed));
+        w.writeU64(static_cast<uint64_t>(kOffset_.load(std::memory_order_relaxed)));
+    }
+    saveState(w);
+    // Las columnas al final: una instantánea sin buffers no las lleva
+    if (w.buffers()) {
+        w.writeArray(in_);
+        w.writeArray(out_);
+        w.writeArray(inF_);
+        w.writeArray(outF_);
+    }
+    w.end();
+}
+
+void DiscreteSystem::restore(CheckpointReader& r)
+{
+    r.begin(checkpointTag('D', 'S', 'Y', 'S'), 1);
+    const double Ts = r.readF64();
+    if (Ts != Ts_) {
+        throw CheckpointError("DiscreteSystem: el período de la instantánea no coincide con el del sistema");
+    }
+    const int k = static_cast<int>(static_cast<int64_t>(r.readU64()));
+    const size_t bufferSize = static_cast<size_t>(r.readU64());
+    const uint64_t fields = r.readU64();
+    const uint64_t precision = r.readU64();
+    const uint64_t published = r.readU64();
+    if (bufferSize == 0 || fields > static_cast<uint64_t>(RecordFields::InputOutput)
+        || precision > static_cast<uint64_t>(RecordPrecision::Float)) {
+        throw CheckpointError("DiscreteSystem: cabecera de instantánea no válida");
+    }
+    const RecordingPolicy recording(static_cast<RecordFields>(fields), static_cast<RecordPrecision>(precision));
+    size_t writeIndex = static_cast<size_t>(published % bufferSize);
+    size_t count = 0;
+    uint64_t resetMark = published;
+    int64_t kOffset = static_cast<int64_t>(k) - static_cast<int64_t>(published);
+    if (r.buffers()) {
+        writeIndex = static_cast<size_t>(r.readU64());
+        count = static_cast<size_t>(r.readU64());
+        resetMark = r.readU64();
+        kOffset = static_cast<int64_t>(r.readU64());
+    }
+    loadState(r);
+
+    // Con el mismo tamaño y política las columnas se reutilizan: sólo se leen las count_ primeras
+    const bool reshape = bufferSize != bufferSize_ || recording.fields != recording_.fields
+                      || recording.precision != recording_.precision;
+    k_ = k;
+    bufferSize_ = bufferSize;
+    recording_ = recording;
+    count_ = 0;
+    if (reshape) {
+        allocateColumns();
+    }
+    if (r.buffers()) {
+        r.readArray(in_);
+        r.readArray(out_);
+        r.readArray(inF_);
+        r.readArray(outF_);
+        const bool dbl = recording_.precision == RecordPrecision::Double;
+        const size_t rows = dbl ? out_.size() : outF_.size();
+        if (writeIndex >= bufferSize_ || count > bufferSize_
+            || (recording_.fields != RecordFields::None && rows != bufferSize_)) {
+            allocateColumns();
+            throw CheckpointError("DiscreteSystem: buffer de la instantánea no válido");
+        }
+        count_ = count;
+    }
+    writeIndex_ = writeIndex;
+    writing_.store(published, std::memory_order_relaxed);
+    published_.store(published, std::memory_order_relaxed);
+    kOffset_.store(kOffset, std::memory_order_relaxed);
+    resetMark_.store(resetMark, std::memory_order_release);
+    r.end();
+}
+
+void DiscreteSystem::saveState(CheckpointWriter&) const
+{
+    throw CheckpointError("DiscreteSystem: este sistema no admite instantáneas de estado");
+}
+
+void DiscreteSystem::loadState(CheckpointReader&)
+{
+    throw CheckpointError("DiscreteSystem: este sistema no admite instantáneas de estado");
+}
+
+void DiscreteSystem::setRecordingPolicy(RecordingPolicy recording)
+{
+    recording_ = recording;
+    count_ = 0;
+    const uint64_t seq = published_.load(std::memory_order_relaxed);
+    kOffset_.store(static_cast<int64_t>(k_) - static_cast<int64_t>(seq), std::memory_order_relaxed);
+    resetMark_.store(seq, std::memory_order_release);
+    allocateColumns();
+}
+
+void DiscreteSystem::allocateColumns()
+{
+    // Sólo se reservan las columnas que la política usa; el resto queda vacío
+    const bool in = recording_.fields == RecordFields::InputOutput;
+    const bool out = recording_.fields != RecordFields::None;
+    const bool dbl = recording_.precision == RecordPrecision::Double;
+    std::vector<double>(in && dbl ? bufferSize_ : 0, 0.0).swap(in_);
+    std::vector<double>(out && dbl ? bufferSize_ : 0, 0.0).swap(out_);
+    std::vector<float>(in && !dbl ? bufferSize_ : 0, 0.0f).swap(inF_);
+    std::vector<float>(out && !dbl ? bufferSize_ : 0, 0.0f).swap(outF_);
+}
+
+void DiscreteSystem::storeColumns(size_t start, const double* u, const double* y, size_t n)
+{
+    if (recording_.precision == RecordPrecision::Double) {
+        std::copy(y, y + n, out_.begin() + static_cast<std::ptrdiff_t>(start));
+        if (!in_.empty()) {
+            std::copy(u, u + n, in_.begin() + static_cast<std::ptrdiff_t>(start));
+        }
+    } else {
+        narrow(y, n, &outF_[start]);
+        if (!inF_.empty()) {
+            narrow(u, n, &inF_[start]);
+        }
+    }
+}
+
+void DiscreteSystem::loadColumns(size_t start, size_t n, int64_t k0, Sample* out) const
+{
+    if (recording_.precision == RecordPrecision::Double) {
+        gather(in_.empty() ? nullptr : &in_[start], &out_[start], n, k0, out);
+    } else {
+        gather(inF_.empty() ? nullptr : &inF_[start], &outF_[start], n, k0, out);
+    }
+}
+
+void DiscreteSystem::exportColumn(int c, size_t start, size_t n, int64_t k0, double* dst) const
+{
+    if (c == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = toLittleEndian(static_cast<double>(k0 + static_cast<int64_t>(i)));
+        }
+        return;
+    }
+    const bool dbl = recording_.precision == RecordPrecision::Double;
+    const bool present = (c == 2) || (dbl ? !in_.empty() : !inF_.empty());
+    if (!present) {
+        std::fill(dst, dst + n, std::numeric_limits<double>::quiet_NaN());
+    } else if (dbl) {
+        const double* src = (c == 1 ? in_.data() : out_.data()) + start;
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = toLittleEndian(src[i]);
+        }
+    } else {
+        const float* src = (c == 1 ? inF_.data() : outF_.data()) + start;
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = toLittleEndian(static_cast<double>(src[i]));
+        }
+    }
+}
+
+template <class Sink>
+void DiscreteSystem::writeColumns(Sink sink) const
+{
+    size_t start[2], len[2];
+    const int64_t k0 = orderedSegments(start, len);
+    const size_t chunk = 4096;
+    double buf[chunk];
+    for (int c = 0; c < 3; ++c) {
+        int64_t k = k0;
+        for (int s = 0; s < 2; ++s) {
+            for (size_t j = 0; j < len[s]; j += chunk) {
+                const size_t n = std::min(chunk, len[s] - j);
+                exportColumn(c, start[s] + j, n, k, buf);
+                k += static_cast<int64_t>(n);
+                sink(buf, n);
+            }
+        }
+    }
+}
+
+int64_t DiscreteSystem::orderedSegments(size_t start[2], size_t len[2]) const
+{
+    // El buffer es circular: la muestra más antigua está count_ posiciones
+    // por detrás de writeIndex_, y el historial ocupa como mucho dos tramos
+    const size_t oldestIndex = (writeIndex_ + bufferSize_ - count_) % bufferSize_;
+    len[0] = std::min(count_, bufferSize_ - oldestIndex);
+    len[1] = count_ - len[0];
+    start[0] = oldestIndex;
+    start[1] = 0;
+    const uint64_t oldest = published_.load(std::memory_order_relaxed) - count_;
+    return static_cast<int64_t>(oldest) + kOffset_.load(std::memory_order_relaxed);
+}
+
 void DiscreteSystem::bufferDump(std::ostream& os, ExportFormat format) const
 {
+    if (format == ExportFormat::RAW || format == ExportFormat::NPY || format == ExportFormat::MAT) {
+        const std::string header = exportHeader(format, count_);
+        os.write(header.data(), static_cast<std::streamsize>(header.size()));
+        writeColumns([&os](const double* p, size_t n) {
+            os.write(reinterpret_cast<const char*>(p), static_cast<std::streamsize>(n * sizeof(double)));
+        });
+        return;
+    }
+
     // Exportar en orden temporal: las count_ muestras más recientes
-    // El buffer es circular, así que debemos reconstruir orden desde la más antigua.
     if (count_ == 0) {
         os << "# Empty buffer" << '\n';
         return;
     }
 
-    // Determinar índice de la muestra más antigua
-    size_t oldestIndex = (count_ == bufferSize_) ? (writeIndex_) : 0;
-
+    size_t start[2], len[2];
+    int64_t k = orderedSegments(start, len);
+    TextWriter w(os);
     if (format == ExportFormat::TSV) {
-        os << "# k\tu(k)\ty(k)" << '\n';
-        for (size_t i = 0; i < count_; ++i) {
-            size_t idx = (oldestIndex + i) % bufferSize_;
-            const Sample& s = buffer_[idx];
-            os << s.k << '\t' << s.in << '\t' << s.out << '\n';
-        }
+        w.text("# k\tu(k)\ty(k)\n");
     } else if (format == ExportFormat::MATLAB) {
-        os << "% Export format: MATLAB compatible" << '\n';
-        os << "% Columns: k u y" << '\n';
-        os << "data = [";
-        for (size_t i = 0; i < count_; ++i) {
-            size_t idx = (oldestIndex + i) % bufferSize_;
-            const Sample& s = buffer_[idx];
-            os << s.k << ' ' << s.in << ' ' << s.out;
-            if (i + 1 < count_) os << ';';
+        w.text("% Export format: MATLAB compatible\n");
+        w.text("% Columns: k u y\n");
+        w.text("data = [");
+    }
+    // Las columnas se reconstruyen a muestras por bloques pequeños
+    const size_t chunk = 1024;
+    Sample buf[chunk];
+    size_t written = 0;
+    for (int s = 0; s < 2; ++s) {
+        for (size_t j = 0; j < len[s]; j += chunk) {
+            const size_t n = std::min(chunk, len[s] - j);
+            loadColumns(start[s] + j, n, k, buf);
+            k += static_cast<int64_t>(n);
+            for (size_t i = 0; i < n; ++i) {
+                const Sample& x = buf[i];
+                if (format == ExportFormat::TSV) {
+                    w.integer(x.k);
+                    w.put('\t');
+                    w.number(x.in);
+                    w.put('\t');
+                    w.number(x.out);
+                    w.put('\n');
+                } else if (format == ExportFormat::MATLAB) {
+                    w.integer(x.k);
+                    w.put(' ');
+                    w.number(x.in);
+                    w.put(' ');
+                    w.number(x.out);
+                    if (++written < count_) w.put(';');
+                }
+            }
         }
-        os << "];" << '\n';
-        os << "% Usage in MATLAB/Octave: load('file'); k = data(:,1); u = data(:,2); y = data(:,3);" << '\n';
+    }
+    if (format == ExportFormat::MATLAB) {
+        w.text("];\n");
+        w.text("% Usage in MATLAB/Octave: load('file'); k = data(:,1); u = data(:,2); y = data(:,3);\n");
+    }
+    w.flush();
+}
+
+void DiscreteSystem::bufferDump(const std::string& path, ExportFormat format) const
+{
+    if (format == ExportFormat::TSV || format == ExportFormat::MATLAB) {
+        std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+        if (!os) {
+            throw ExportError("DiscreteSystem: no se pudo crear '" + path + "'");
+        }
+        bufferDump(os, format);
+        os.flush();
+        if (!os) {
+            throw ExportError("DiscreteSystem: no se pudo escribir '" + path + "'");
+        }
+        return;
+    }
+
+    const std::string header = exportHeader(format, count_);
+    const size_t total = header.size() + 3 * count_ * sizeof(double);
+
+    const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw ExportError("DiscreteSystem: no se pudo crear '" + path + "': " + std::strerror(errno));
+    }
+    if (total == 0) {
+        ::close(fd);
+        return;
+    }
+    // Reservar los bloques antes de proyectar: con un fichero disperso, un
+    // disco lleno se manifestaría como SIGBUS al escribir en la proyección
+    const int err = posix_fallocate(fd, 0, static_cast<off_t>(total));
+    if (err != 0) {
+        ::close(fd);
+        throw ExportError("DiscreteSystem: no se pudo reservar '" + path + "': " + std::strerror(err));
+    }
+
+    void* addr = mmap(nullptr, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr != MAP_FAILED) {
+        char* base = static_cast<char*>(addr);
+        std::memcpy(base, header.data(), header.size());
+        // Las cabeceras miden un múltiplo de 8: las columnas quedan alineadas
+        // y cada una se copia directamente sobre la proyección
+        double* dst = reinterpret_cast<double*>(base + header.size());
+        size_t start[2], len[2];
+        const int64_t k0 = orderedSegments(start, len);
+        for (int c = 0; c < 3; ++c) {
+            exportColumn(c, start[0], len[0], k0, dst + c * count_);
+            exportColumn(c, start[1], len[1], k0 + static_cast<int64_t>(len[0]), dst + c * count_ + len[0]);
+        }
+        munmap(addr, total);
+        ::close(fd);
+        return;
+    }
+
+    // Sin mmap: pwrite por bloques desde un buffer de trasposición
+    off_t offset = 0;
+    bool ok = writeAt(fd, header.data(), header.size(), offset);
+    writeColumns([&](const double* p, size_t n) {
+        ok = ok && writeAt(fd, p, n * sizeof(double), offset);
+    });
+    ::close(fd);
+    if (!ok) {
+        throw ExportError("DiscreteSystem: no se pudo escribir '" + path + "'");
     }
 }
 
 void DiscreteSystem::storeSample(double uk, double yk)
 {
-    // Guardar muestra en posición writeIndex_
-    buffer_[writeIndex_] = Sample{uk, yk, k_};
+    // Anunciar la escritura a los lectores (seqlock), escribir y publicar
+    const uint64_t seq = published_.load(std::memory_order_relaxed) + 1;
+    writing_.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Guardar muestra en posición writeIndex_ (k se deduce de la secuencia)
+    if (recording_.precision == RecordPrecision::Double) {
+        out_[writeIndex_] = yk;
+        if (!in_.empty()) {
+            in_[writeIndex_] = uk;
+        }
+    } else {
+        outF_[writeIndex_] = static_cast<float>(yk);
+        if (!inF_.empty()) {
+            inF_[writeIndex_] = static_cast<float>(uk);
+        }
+    }
 
     if (count_ < bufferSize_) {
         ++count_;
     }
     writeIndex_ = (writeIndex_ + 1) % bufferSize_;
+    published_.store(seq, std::memory_order_release);
+}
+
+void DiscreteSystem::storeJump(size_t steps, size_t held, double u, double y)
+{
+    if (held < steps) {
+        // Mismo protocolo que reset(): nuevo origen de k y marca de descarte
+        count_ = 0;
+        const uint64_t seq = published_.load(std::memory_order_relaxed);
+        kOffset_.store(static_cast<int64_t>(k_) + static_cast<int64_t>(steps - held) - static_cast<int64_t>(seq),
+                       std::memory_order_relaxed);
+        resetMark_.store(seq, std::memory_order_release);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    for (size_t i = 0; i < held; ++i) {
+        storeSample(u, y);
+    }
+}
+
+void DiscreteSystem::storeBlock(const double* u, const double* y, size_t n)
+{
+    const uint64_t seq = published_.load(std::memory_order_relaxed) + n;
+    writing_.store(seq, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Sólo sobreviven las últimas bufferSize_ muestras del bloque
+    size_t skip = (n > bufferSize_) ? (n - bufferSize_) : 0;
+    size_t remaining = n - skip;
+
+    // Las muestras omitidas avanzan igualmente la posición de escritura
+    size_t start = (writeIndex_ + skip % bufferSize_) % bufferSize_;
+    size_t src = skip;
+
+    // Como máximo dos tramos contiguos: [start, bufferSize_) y [0, resto)
+    while (remaining > 0) {
+        size_t chunk = std::min(remaining, bufferSize_ - start);
+        storeColumns(start, u + src, y + src, chunk);
+        src += chunk;
+        remaining -= chunk;
+        start += chunk;
+        if (start == bufferSize_) {
+            start = 0;
+        }
+    }
+
+    writeIndex_ = start;
+    count_ = std::min(bufferSize_, count_ + n);
+    published_.store(seq, std::memory_order_release);
+}
+
+uint64_t DiscreteSystem::copyRange(uint64_t lo, uint64_t hi, Sample* out) const
+{
+    // El origen de k se lee con la marca de reset: si cambia durante la
+    // copia, ninguna muestra copiada es fiable
+    const uint64_t mark0 = resetMark_.load(std::memory_order_acquire);
+    const int64_t offset = kOffset_.load(std::memory_order_relaxed);
+
+    // Copia en como máximo dos tramos contiguos del buffer circular
+    const uint64_t N = bufferSize_;
+    uint64_t seq = lo;
+    while (seq < hi) {
+        size_t start = static_cast<size_t>(seq % N);
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(hi - seq, N - start));
+        loadColumns(start, chunk, static_cast<int64_t>(seq) + offset, out + (seq - lo));
+        seq += chunk;
+    }
+
+    // Lo que el escritor haya podido tocar durante la copia tiene secuencia
+    // < writing - N; lo anterior al último reset() tampoco es válido
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t writing = writing_.load(std::memory_order_relaxed);
+    const uint64_t mark = resetMark_.load(std::memory_order_relaxed);
+    if (mark != mark0) {
+        return hi;
+    }
+    uint64_t valid = std::max(lo, mark);
+    if (writing > N) {
+        valid = std::max(valid, writing - N);
+    }
+    return std::min(valid, hi);
+}
+
+size_t DiscreteSystem::snapshot(Sample* out, size_t n) const
+{
+    const uint64_t hi = published_.load(std::memory_order_acquire);
+    const uint64_t want = std::min<uint64_t>(std::min<uint64_t>(n, bufferSize_), hi);
+    const uint64_t lo = std::max(hi - want, resetMark_.load(std::memory_order_acquire));
+    if (lo >= hi) {
+        return 0;
+    }
+    const uint64_t valid = copyRange(lo, hi, out);
+    const size_t count = static_cast<size_t>(hi - valid);
+    if (valid > lo) {
+        std::copy(out + (valid - lo), out + (hi - lo), out);
+    }
+    return count;
+}
+
+uint64_t DiscreteSystem::readSince(uint64_t cursor, std::vector<Sample>& out, uint64_t* lost) const
+{
+    const uint64_t hi = published_.load(std::memory_order_acquire);
+    if (cursor > hi) {
+        cursor = hi;
+    }
+    uint64_t lo = std::max(cursor, resetMark_.load(std::memory_order_acquire));
+    if (hi - lo > bufferSize_) {
+        lo = hi - bufferSize_;
+    }
+    uint64_t valid = lo;
+    if (lo < hi) {
+        const size_t base = out.size();
+        out.resize(base + static_cast<size_t>(hi - lo));
+        valid = copyRange(lo, hi, &out[base]);
+        if (valid > lo) {
+            out.erase(out.begin() + static_cast<std::ptrdiff_t>(base),
+                      out.begin() + static_cast<std::ptrdiff_t>(base + (valid - lo)));
+        }
+    }
+    if (lost != nullptr) {
+        *lost = valid - cursor;
+    }
+    return hi;
 }
 
 } // namespace DiscreteSystems
@@ -0,0 +1,60 @@
+/**
+ * @file MatrixPowers.cpp
+ * @brief Implementación de MatrixPowers
+ */
+
+#include "DiscreteSystems/MatrixPowers.h"
+#include "DiscreteSystems/Exceptions.h"
+
+namespace DiscreteSystems {
+
+MatrixPowers::MatrixPowers(const std::vector<double>& T, size_t d)
+    : d_(d), powers_(1, T), tmp_(d, 0.0)
+{
+    if (T.size() != d * d) {
+        throw InvalidDimensions("MatrixPowers: T debe tener d*d elementos");
+    }
+}
+
+void MatrixPowers::apply(uint64_t k, double* z)
+{
+    // Caché vacía: no hay T^(2^0) del que partir
+    if (d_ == 0 || k == 0) {
+        return;
+    }
+    const size_t d = d_;
+    for (size_t level = 0; k != 0; ++level, k >>= 1) {
+        if (level == powers_.size()) {
+            // T^(2^level) = (T^(2^(level-1)))^2
+            const std::vector<double>& P = powers_[level - 1];
+            std::vector<double> Q(d * d, 0.0);
+            for (size_t i = 0; i < d; ++i) {
+                for (size_t l = 0; l < d; ++l) {
+                    const double pil = P[i * d + l];
+                    const double* row = &P[l * d];
+                    double* out = &Q[i * d];
+                    for (size_t j = 0; j < d; ++j) {
+                        out[j] += pil * row[j];
+                    }
+                }
+            }
+            powers_.push_back(Q);
+        }
+        if ((k & 1) == 0) {
+            continue;
+        }
+        const double* P = powers_[level].data();
+        for (size_t i = 0; i < d; ++i) {
+            double sum = 0.0;
+            for (size_t j = 0; j < d; ++j) {
+                sum += P[i * d + j] * z[j];
+            }
+            tmp_[i] = sum;
+        }
+        for (size_t i = 0; i < d; ++i) {
+            z[i] = tmp_[i];
+        }
+    }
+}
+
+} // namespace DiscreteSystems
@@ -0,0 +1,208 @@
+/**
+ * @file PartitionedConvolver.cpp
+ * @brief Implementación de PartitionedConvolver
+ */
+
+#include "DiscreteSystems/PartitionedConvolver.h"
+#include "DiscreteSystems/Exceptions.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace DiscreteSystems {
+
+namespace {
+
+const double kPi = 3.14159265358979323846;
+
+} // namespace
+
+PartitionedConvolver::PartitionedConvolver(const std::vector<double>& h, size_t partition)
+    : P_(partition), K_(0), head_(0)
+{
+    if (h.empty()) {
+        throw InvalidDimensions("PartitionedConvolver: h no debe estar vacío");
+    }
+    if (P_ < 2 || (P_ & (P_ - 1)) != 0) {
+        throw InvalidDimensions("PartitionedConvolver: la partición debe ser potencia de dos >= 2");
+    }
+    const size_t P = P_;
+    K_ = (h.size() + P - 1) / P;
+    const size_t bins = P + 1;
+
+    twr_.resize(P / 2);
+    twi_.resize(P / 2);
+    for (size_t t = 0; t < P / 2; ++t) {
+        twr_[t] = std::cos(2.0 * kPi * t / P);
+        twi_[t] = -std::sin(2.0 * kPi * t / P);
+    }
+    splitR_.resize(bins);
+    splitI_.resize(bins);
+    for (size_t k = 0; k <= P; ++k) {
+        splitR_[k] = std::cos(kPi * k / P);
+        splitI_[k] = -std::sin(kPi * k / P);
+    }
+    rev_.resize(P);
+    size_t bits = 0;
+    while ((size_t(1) << bits) < P) {
+        ++bits;
+    }
+    for (size_t i = 0; i < P; ++i) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            r |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        rev_[i] = r;
+    }
+
+    last_.assign(P, 0.0);
+    frame_.assign(2 * P, 0.0);
+    accRe_.assign(bins, 0.0);
+    accIm_.assign(bins, 0.0);
+    zr_.assign(P, 0.0);
+    zi_.assign(P, 0.0);
+    Xre_.assign(K_ * bins, 0.0);
+    Xim_.assign(K_ * bins, 0.0);
+
+    // H_k = FFT([h(kP..kP+P-1), 0...]) / P: la inversa queda sin escalar
+    Hre_.assign(K_ * bins, 0.0);
+    Him_.assign(K_ * bins, 0.0);
+    for (size_t k = 0; k < K_; ++k) {
+        std::fill(frame_.begin(), frame_.end(), 0.0);
+        for (size_t i = 0; i < P && k * P + i < h.size(); ++i) {
+            frame_[i] = h[k * P + i] / static_cast<double>(P);
+        }
+        forward(&frame_[0], &Hre_[k * bins], &Him_[k * bins]);
+    }
+}
+
+void PartitionedConvolver::fft(double* re, double* im, bool inverse) const
+{
+    const size_t M = P_;
+    for (size_t i = 0; i < M; ++i) {
+        const size_t r = rev_[i];
+        if (r > i) {
+            std::swap(re[i], re[r]);
+            std::swap(im[i], im[r]);
+        }
+    }
+    const double sign = inverse ? -1.0 : 1.0;
+    for (size_t len = 2; len <= M; len <<= 1) {
+        const size_t half = len / 2;
+        const size_t stride = M / len;
+        for (size_t i = 0; i < M; i += len) {
+            for (size_t j = 0; j < half; ++j) {
+                const double wr = twr_[j * stride];
+                const double wi = sign * twi_[j * stride];
+                const size_t a = i + j, b = a + half;
+                const double vr = re[b] * wr - im[b] * wi;
+                const double vi = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - vr;
+                im[b] = im[a] - vi;
+                re[a] += vr;
+                im[a] += vi;
+            }
+        }
+    }
+}
+
+void PartitionedConvolver::forward(const double* x, double* re, double* im)
+{
+    const size_t M = P_;
+    // z(n) = x(2n) + j x(2n+1)
+    for (size_t n = 0; n < M; ++n) {
+        zr_[n] = x[2 * n];
+        zi_[n] = x[2 * n + 1];
+    }
+    fft(&zr_[0], &zi_[0], false);
+    // X(k) = E(k) + W^k O(k), con E y O los espectros de las muestras pares e impares
+    for (size_t k = 0; k <= M; ++k) {
+        const size_t a = k % M, b = (M - k) % M;
+        const double er = 0.5 * (zr_[a] + zr_[b]);
+        const double ei = 0.5 * (zi_[a] - zi_[b]);
+        const double orr = 0.5 * (zi_[a] + zi_[b]);
+        const double oi = -0.5 * (zr_[a] - zr_[b]);
+        re[k] = er + splitR_[k] * orr - splitI_[k] * oi;
+        im[k] = ei + splitR_[k] * oi + splitI_[k] * orr;
+    }
+}
+
+void PartitionedConvolver::inverse(const double* re, const double* im, double* x)
+{
+    const size_t M = P_;
+    // Z(k) = E(k) + j O(k), E = (X(k) + X*(M-k)) / 2, O = (X(k) - X*(M-k)) W^-k / 2
+    for (size_t k = 0; k < M; ++k) {
+        const size_t c = M - k;
+        const double er = 0.5 * (re[k] + re[c]);
+        const double ei = 0.5 * (im[k] - im[c]);
+        const double dr = 0.5 * (re[k] - re[c]);
+        const double di = 0.5 * (im[k] + im[c]);
+        const double orr = dr * splitR_[k] + di * splitI_[k];
+        const double oi = di * splitR_[k] - dr * splitI_[k];
+        zr_[k] = er - oi;
+        zi_[k] = ei + orr;
+    }
+    fft(&zr_[0], &zi_[0], true);
+    for (size_t n = 0; n < M; ++n) {
+        x[2 * n] = zr_[n];
+        x[2 * n + 1] = zi_[n];
+    }
+}
+
+void PartitionedConvolver::pushSpectrum(const double* x)
+{
+    const size_t P = P_;
+    const size_t bins = P + 1;
+    std::copy(last_.begin(), last_.end(), frame_.begin());
+    std::copy(x, x + P, frame_.begin() + static_cast<std::ptrdiff_t>(P));
+    head_ = head_ + 1 == K_ ? 0 : head_ + 1;
+    forward(&frame_[0], &Xre_[head_ * bins], &Xim_[head_ * bins]);
+    std::copy(x, x + P, last_.begin());
+}
+
+void PartitionedConvolver::process(const double* x, double* y)
+{
+    const size_t P = P_;
+    const size_t bins = P + 1;
+    pushSpectrum(x);
+
+    // Σ_k H_k X_{j-k}: bucles sobre bins sin dependencias entre iteraciones
+    std::fill(accRe_.begin(), accRe_.end(), 0.0);
+    std::fill(accIm_.begin(), accIm_.end(), 0.0);
+    double* ar = &accRe_[0];
+    double* ai = &accIm_[0];
+    size_t slot = head_;
+    for (size_t k = 0; k < K_; ++k) {
+        const double* hr = &Hre_[k * bins];
+        const double* hi = &Him_[k * bins];
+        const double* xr = &Xre_[slot * bins];
+        const double* xi = &Xim_[slot * bins];
+        for (size_t i = 0; i < bins; ++i) {
+            ar[i] += hr[i] * xr[i] - hi[i] * xi[i];
+            ai[i] += hr[i] * xi[i] + hi[i] * xr[i];
+        }
+        slot = slot == 0 ? K_ - 1 : slot - 1;
+    }
+    inverse(ar, ai, &frame_[0]);
+    std::copy(frame_.begin() + static_cast<std::ptrdiff_t>(P), frame_.end(), y);
+}
+
+void PartitionedConvolver::prime(const double* past)
+{
+    reset();
+    // K bloques pasados: el primero sólo sirve de solape del segundo
+    std::copy(past, past + P_, last_.begin());
+    for (size_t k = 1; k < K_; ++k) {
+        pushSpectrum(past + k * P_);
+    }
+}
+
+void PartitionedConvolver::reset()
+{
+    std::fill(Xre_.begin(), Xre_.end(), 0.0);
+    std::fill(Xim_.begin(), Xim_.end(), 0.0);
+    std::fill(last_.begin(), last_.end(), 0.0);
+    head_ = 0;
+}
+
+} // namespace DiscreteSystems
@@ -0,0 +1,286 @@
+/**
+ * @file Polynomial.cpp
+ * @brief Implementación de las utilidades de polinomios
+ */
+
+#include "DiscreteSystems/Polynomial.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+
+namespace DiscreteSystems {
+namespace Polynomial {
+
+namespace {
+
+typedef std::complex<double> cplx;
+
+/**
+ * @brief Equilibrado de Parlett-Reinsch: escala filas y columnas por potencias de 2
+ *
+ * D^-1 H D tiene los mismos autovalores y normas de fila y columna parecidas,
+ * lo que reduce el error del QR en matrices tan desequilibradas como la
+ * compañera. La semejanza diagonal conserva la forma de Hessenberg y, al ser
+ * exacta en potencias de 2, no introduce redondeo.
+ */
+void balance(std::vector<double>& H, size_t n)
+{
+    const double radix = 2.0;
+    bool done = false;
+    while (!done) {
+        done = true;
+        for (size_t i = 0; i < n; ++i) {
+            double c = 0.0, r = 0.0;
+            for (size_t j = 0; j < n; ++j) {
+                if (j != i) {
+                    c += std::abs(H[j * n + i]);
+                    r += std::abs(H[i * n + j]);
+                }
+            }
+            if (c == 0.0 || r == 0.0) {
+                continue;
+            }
+            const double s = c + r;
+            double f = 1.0;
+            while (c < r / radix) {
+                f *= radix;
+                c *= radix * radix;
+            }
+            while (c > r * radix) {
+                f /= radix;
+                c /= radix * radix;
+            }
+            if ((c + r) / f < 0.95 * s) {
+                done = false;
+                for (size_t j = 0; j < n; ++j) {
+                    H[i * n + j] /= f;
+                    H[j * n + i] *= f;
+                }
+            }
+        }
+    }
+}
+
+} // namespace
+
+std::complex<double> evaluate(const std::vector<double>& p, std::complex<double> x)
+{
+    cplx value = 0.0;
+    for (size_t i = 0; i < p.size(); ++i) {
+        value = value * x + p[i];
+    }
+    return value;
+}
+
+std::vector<double> multiply(const std::vector<double>& p, const std::vector<double>& q)
+{
+    if (p.empty() || q.empty()) {
+        return std::vector<double>();
+    }
+    std::vector<double> r(p.size() + q.size() - 1, 0.0);
+    for (size_t i = 0; i < p.size(); ++i) {
+        for (size_t j = 0; j < q.size(); ++j) {
+            r[i + j] += p[i] * q[j];
+        }
+    }
+    return r;
+}
+
+std::vector<std::complex<double>> hessenbergEigenvalues(std::vector<double> H, size_t n)
+{
+    const double eps = std::numeric_limits<double>::epsilon();
+    std::vector<cplx> w(n);
+    balance(H, n);
+    double norm = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = (i == 0 ? 0 : i - 1); j < n; ++j) {
+            norm += std::abs(H[i * n + j]);
+        }
+    }
+    // QR de Francis con desplazamiento doble (hqr de EISPACK): cada paso es
+    // una semejanza ortogonal, de modo que el resultado es estable hacia atrás
+    std::ptrdiff_t nn = static_cast<std::ptrdiff_t>(n) - 1;
+    const std::ptrdiff_t N = static_cast<std::ptrdiff_t>(n);
+    double t = 0.0;
+#define Hm(i, j) H[static_cast<size_t>((i) * N + (j))]
+    while (nn >= 0) {
+        int its = 0;
+        std::ptrdiff_t l;
+        do {
+            // Subdiagonal despreciable: el problema se parte en dos
+            for (l = nn; l > 0; --l) {
+                double s = std::abs(Hm(l - 1, l - 1)) + std::abs(Hm(l, l));
+                if (s == 0.0) {
+                    s = norm;
+                }
+                if (std::abs(Hm(l, l - 1)) <= eps * s) {
+                    Hm(l, l - 1) = 0.0;
+                    break;
+                }
+            }
+            double x = Hm(nn, nn);
+            if (l == nn) {
+                w[static_cast<size_t>(nn--)] = cplx(x + t, 0.0);
+                continue;
+            }
+            double y = Hm(nn - 1, nn - 1);
+            double z, r, s, p, q;
+            double wprod = Hm(nn, nn - 1) * Hm(nn - 1, nn);
+            if (l == nn - 1) {
+                // Bloque 2x2: dos raíces reales o un par conjugado exacto
+                p = 0.5 * (y - x);
+                q = p * p + wprod;
+                z = std::sqrt(std::abs(q));
+                x += t;
+                if (q >= 0.0) {
+                    z = p + (p >= 0.0 ? z : -z);
+                    w[static_cast<size_t>(nn - 1)] = w[static_cast<size_t>(nn)] = cplx(x + z, 0.0);
+                    if (z != 0.0) {
+                        w[static_cast<size_t>(nn)] = cplx(x - wprod / z, 0.0);
+                    }
+                } else {
+                    w[static_cast<size_t>(nn - 1)] = cplx(x + p, z);
+                    w[static_cast<size_t>(nn)] = cplx(x + p, -z);
+                }
+                nn -= 2;
+                continue;
+            }
+            if (its == 100) {
+                throw std::runtime_error("Polynomial: el QR no converge");
+            }
+            if (its % 10 == 0 && its > 0) {
+                // Desplazamiento excepcional para salir de ciclos
+                t += x;
+                for (std::ptrdiff_t i = 0; i <= nn; ++i) {
+                    Hm(i, i) -= x;
+                }
+                s = std::abs(Hm(nn, nn - 1)) + std::abs(Hm(nn - 1, nn - 2));
+                y = x = 0.75 * s;
+                wprod = -0.4375 * s * s;
+            }
+            ++its;
+            // Buscar dos subdiagonales consecutivas pequeñas
+            std::ptrdiff_t m;
+            for (m = nn - 2; m >= l; --m) {
+                z = Hm(m, m);
+                r = x - z;
+                s = y - z;
+                p = (r * s - wprod) / Hm(m + 1, m) + Hm(m, m + 1);
+                q = Hm(m + 1, m + 1) - z - r - s;
+                r = Hm(m + 2, m + 1);
+                s = std::abs(p) + std::abs(q) + std::abs(r);
+                p /= s;
+                q /= s;
+                r /= s;
+                if (m == l) {
+                    break;
+                }
+                const double u = std::abs(Hm(m, m - 1)) * (std::abs(q) + std::abs(r));
+                const double v = std::abs(p) * (std::abs(Hm(m - 1, m - 1)) + std::abs(z) + std::abs(Hm(m + 1, m + 1)));
+                if (u <= eps * v) {
+                    break;
+                }
+            }
+            for (std::ptrdiff_t i = m; i < nn - 1; ++i) {
+                Hm(i + 2, i) = 0.0;
+                if (i != m) {
+                    Hm(i + 2, i - 1) = 0.0;
+                }
+            }
+            // Paso QR doble implícito con reflexiones de Householder de orden 3
+            for (std::ptrdiff_t k = m; k < nn; ++k) {
+                if (k != m) {
+                    p = Hm(k, k - 1);
+                    q = Hm(k + 1, k - 1);
+                    r = k + 1 != nn ? Hm(k + 2, k - 1) : 0.0;
+                    x = std::abs(p) + std::abs(q) + std::abs(r);
+                    if (x != 0.0) {
+                        p /= x;
+                        q /= x;
+                        r /= x;
+                    }
+                }
+                s = std::sqrt(p * p + q * q + r * r);
+                if (p < 0.0) {
+                    s = -s;
+                }
+                if (s == 0.0) {
+                    continue;
+                }
+                if (k == m) {
+                    if (l != m) {
+                        Hm(k, k - 1) = -Hm(k, k - 1);
+                    }
+                } else {
+                    Hm(k, k - 1) = -s * x;
+                }
+                p += s;
+                x = p / s;
+                y = q / s;
+                z = r / s;
+                q /= p;
+                r /= p;
+                for (std::ptrdiff_t j = k; j <= nn; ++j) {
+                    p = Hm(k, j) + q * Hm(k + 1, j);
+                    if (k + 1 != nn) {
+                        p += r * Hm(k + 2, j);
+                        Hm(k + 2, j) -= p * z;
+                    }
+                    Hm(k + 1, j) -= p * y;
+                    Hm(k, j) -= p * x;
+                }
+                const std::ptrdiff_t last = std::min(nn, k + 3);
+                for (std::ptrdiff_t i = l; i <= last; ++i) {
+                    p = x * Hm(i, k) + y * Hm(i, k + 1);
+                    if (k + 1 != nn) {
+                        p += z * Hm(i, k + 2);
+                        Hm(i, k + 2) -= p * r;
+                    }
+                    Hm(i, k + 1) -= p * q;
+                    Hm(i, k) -= p;
+                }
+            }
+        } while (l + 1 < nn);
+    }
+#undef Hm
+    return w;
+}
+
+std::vector<std::complex<double>> roots(const std::vector<double>& p)
+{
+    // Eliminar coeficientes nulos iniciales (no aportan grado)
+    size_t first = 0;
+    while (first < p.size() && p[first] == 0.0) {
+        ++first;
+    }
+    // Los coeficientes nulos finales son raíces exactas en 0
+    size_t last = p.size();
+    while (last > first && p[last - 1] == 0.0) {
+        --last;
+    }
+
+    std::vector<cplx> result(p.size() - last, cplx(0.0, 0.0));
+    if (last <= first + 1) {
+        return result;
+    }
+
+    // Matriz compañera del polinomio mónico: primera fila -q1..-qn, unos en la subdiagonal
+    const size_t n = last - first - 1;
+    const double lead = p[first];
+    std::vector<double> H(n * n, 0.0);
+    for (size_t j = 0; j < n; ++j) {
+        H[j] = -p[first + 1 + j] / lead;
+    }
+    for (size_t i = 1; i < n; ++i) {
+        H[i * n + i - 1] = 1.0;
+    }
+    const std::vector<cplx> z = hessenbergEigenvalues(H, n);
+    result.insert(result.end(), z.begin(), z.end());
+    return result;
+}
+
+} // namespace Polynomial
+} // namespace DiscreteSystems
@@ -4,6 +4,7 @@
  */
 
 #include "DiscreteSystems/StateSpaceSystem.h"
+#include "DiscreteSystems/Checkpoint.h"
 #include "DiscreteSystems/Exceptions.h"
 
 #include <algorithm>
@@ -15,8 +16,9 @@ StateSpaceSystem::StateSpaceSystem(const std::vector<std::vector<double>>& A,
                                    const std::vector<double>& C,
                                    double D,
                                    double Ts,
-                                   size_t bufferSize)
-    : DiscreteSystem(Ts, bufferSize), A_(A), B_(B), C_(C), D_(D), x_(), n_(A.size())
+                                   size_t bufferSize,
+                                   RecordingPolicy recording)
+    : DiscreteSystem(Ts, bufferSize, recording), A_(A), Acol_(), B_(B), C_(C), D_(D), x_(), xNext_(), n_(A.size())
 {
     // Validaciones de dimensiones
     if (n_ == 0) {
@@ -37,8 +39,17 @@ StateSpaceSystem::StateSpaceSystem(const std::vector<std::vector<double>>& A,
         throw InvalidDimensions("StateSpaceSystem: el tamaño de C debe coincidir con A (n)");
     }
 
-    // Estado inicial a cero
+    // Copia contigua por columnas: Acol_[j*n + i] = A(i, j)
+    Acol_.resize(n_ * n_);
+    for (size_t i = 0; i < n_; ++i) {
+        for (size_t j = 0; j < n_; ++j) {
+            Acol_[j * n_ + i] = A_[i][j];
+        }
+    }
+
+    // Estado inicial a cero y buffer ping-pong preasignado
     x_.assign(n_, 0.0);
+    xNext_.assign(n_, 0.0);
 }
 
 double StateSpaceSystem::compute(double uk)
@@ -50,25 +61,89 @@ double StateSpaceSystem::compute(double uk)
     }
     yk += D_ * uk;
 
-    // x(k+1) = A * x(k) + B * u(k)
-    std::vector<double> x_next(n_, 0.0);
-    for (size_t i = 0; i < n_; ++i) {
-        double sum = 0.0;
-        const std::vector<double>& Ai = A_[i];
-        for (size_t j = 0; j < n_; ++j) {
-            sum += Ai[j] * x_[j];
+    // x(k+1) = A * x(k) + B * u(k), como suma de columnas escaladas:
+    // x_next[i] acumula A(i,0)*x0, A(i,1)*x1, ... en el mismo orden que
+    // el producto fila por vector, y el bucle interno (sobre i) es contiguo
+    const size_t n = n_;
+    const double* x = x_.data();
+    const double* Acol = Acol_.data();
+    double* x_next = xNext_.data();
+
+    for (size_t i = 0; i < n; ++i) {
+        x_next[i] = 0.0;
+    }
+    for (size_t j = 0; j < n; ++j) {
+        const double xj = x[j];
+        const double* col = Acol + j * n;
+        for (size_t i = 0; i < n; ++i) {
+            x_next[i] += col[i] * xj;
         }
-        sum += B_[i] * uk;
-        x_next[i] = sum;
+    }
+    const double* B = B_.data();
+    for (size_t i = 0; i < n; ++i) {
+        x_next[i] += B[i] * uk;
     }
 
-    x_.swap(x_next);
+    x_.swap(xNext_);   // Intercambio de punteros, sin reservas de memoria
     return yk;
 }
 
+void StateSpaceSystem::computeBlock(const double* u, double* y, size_t n)
+{
+    // Llamada cualificada: se resuelve estáticamente y puede expandirse en línea
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = StateSpaceSystem::compute(u[i]);
+    }
+}
+
+double StateSpaceSystem::computeHold(double uk, size_t steps)
+{
+    if (steps > 1) {
+        if (holdPowers_.empty()) {
+            // M = [A B; 0 1], (n+1)×(n+1) por filas
+            const size_t d = n_ + 1;
+            std::vector<double> M(d * d, 0.0);
+            for (size_t i = 0; i < n_; ++i) {
+                for (size_t j = 0; j < n_; ++j) {
+                    M[i * d + j] = A_[i][j];
+                }
+                M[i * d + n_] = B_[i];
+            }
+            M[n_ * d + n_] = 1.0;
+            holdPowers_ = MatrixPowers(M, d);
+            z_.assign(d, 0.0);
+        }
+        std::copy(x_.begin(), x_.end(), z_.begin());
+        z_[n_] = uk;
+        holdPowers_.apply(steps - 1, z_.data());
+        std::copy(z_.begin(), z_.begin() + n_, x_.begin());
+    }
+    return StateSpaceSystem::compute(uk);
+}
+
 void StateSpaceSystem::resetState()
 {
     std::fill(x_.begin(), x_.end(), 0.0);
+    std::fill(xNext_.begin(), xNext_.end(), 0.0);
+}
+
+void StateSpaceSystem::saveState(CheckpointWriter& w) const
+{
+    w.begin(checkpointTag('S', 'S', 'S', ' '), 1);
+    w.writeArray(x_);
+    w.end();
+}
+
+void StateSpaceSystem::loadState(CheckpointReader& r)
+{
+    r.begin(checkpointTag('S', 'S', 'S', ' '), 1);
+    std::vector<double> x;
+    r.readArray(x);
+    if (x.size() != n_) {
+        throw CheckpointError("StateSpaceSystem: el orden de la instantánea no coincide con el del sistema");
+    }
+    x_.swap(x);
+    r.end();
 }
 
 std::ostream& operator<<(std::ostream& os, const StateSpaceSystem& sys)
@@ -0,0 +1,368 @@
+/**
+ * @file StreamRecorder.cpp
+ * @brief Implementación de StreamRecorder
+ */
+
+#include "DiscreteSystems/StreamRecorder.h"
+#include "DiscreteSystems/Exceptions.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace DiscreteSystems {
+
+namespace {
+
+/// Identificador del fichero de grabación
+const char kRecordMagic[8] = {'D', 'S', 'R', 'E', 'C', '0', '0', '1'};
+
+/**
+ * @struct FileHeader
+ * @brief Cabecera del fichero (16 bytes)
+ */
+struct FileHeader {
+    char magic[8];            ///< kRecordMagic
+    uint32_t recordSize;      ///< sizeof(StreamRecorder::Record)
+    uint32_t pageSamples;     ///< Muestras por página del grabador (informativo)
+};
+
+static_assert(sizeof(StreamRecorder::Record) == 24, "StreamRecorder: Record debe ocupar 24 bytes");
+static_assert(sizeof(FileHeader) == 16, "StreamRecorder: la cabecera debe ocupar 16 bytes");
+
+/// Espera del escritor cuando no hay páginas llenas
+const std::chrono::microseconds kWriterIdle(1000);
+
+/// Registros leídos por bloque en readFile()
+const size_t kReadChunk = 16384;
+
+/**
+ * @class RecordFile
+ * @brief Lectura secuencial de un fichero de grabación, comprimido o no
+ */
+class RecordFile {
+public:
+    explicit RecordFile(const std::string& path)
+        : file_(nullptr)
+    {
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+        // gzread lee también los ficheros sin comprimir
+        file_ = gzopen(path.c_str(), "rb");
+#else
+        file_ = std::fopen(path.c_str(), "rb");
+#endif
+        if (file_ == nullptr) {
+            throw ExportError("StreamRecorder: no se pudo abrir '" + path + "'");
+        }
+    }
+
+    ~RecordFile()
+    {
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+        gzclose(static_cast<gzFile>(file_));
+#else
+        std::fclose(static_cast<std::FILE*>(file_));
+#endif
+    }
+
+    RecordFile(const RecordFile&) = delete;
+    RecordFile& operator=(const RecordFile&) = delete;
+
+    /** @brief Lee hasta bytes; devuelve los leídos o -1 si hay error */
+    long read(void* data, size_t bytes)
+    {
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+        return gzread(static_cast<gzFile>(file_), data, static_cast<unsigned>(bytes));
+#else
+        std::FILE* f = static_cast<std::FILE*>(file_);
+        size_t n = std::fread(data, 1, bytes, f);
+        return (n < bytes && std::ferror(f)) ? -1 : static_cast<long>(n);
+#endif
+    }
+
+private:
+    void* file_;   ///< gzFile o FILE*
+};
+
+} // namespace
+
+StreamRecorder::StreamRecorder(const std::string& path, size_t pageSamples, size_t pages,
+                               DropPolicy policy, Compression compression)
+    : pageSamples_(pageSamples), pagesCount_(pages), policy_(policy), compression_(compression),
+      storage_(), pages_(), producerPage_(0), fill_(nullptr), end_(nullptr),
+      appended_local_(0), dropped_local_(0), closed_(false),
+      appended_(0), dropped_(0), written_(0), failed_(false), stop_(false),
+      fd_(-1), gz_(nullptr), writer_()
+{
+    if (pageSamples_ == 0 || pageSamples_ > UINT32_MAX) {
+        throw InvalidDimensions("StreamRecorder: las muestras por página deben estar en [1, 2^32)");
+    }
+    if (pagesCount_ < 2) {
+        throw InvalidDimensions("StreamRecorder: se necesitan al menos 2 páginas");
+    }
+
+    if (compression_ == Compression::Gzip) {
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+        // Nivel 1: el escritor debe ir por delante del lazo, no comprimir al máximo
+        gz_ = gzopen(path.c_str(), "wb1");
+        if (gz_ == nullptr) {
+            throw ExportError("StreamRecorder: no se pudo crear '" + path + "'");
+        }
+#else
+        throw ExportError("StreamRecorder: compresión no disponible (compilado sin zlib)");
+#endif
+    } else {
+        fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd_ < 0) {
+            throw ExportError("StreamRecorder: no se pudo crear '" + path + "': " + std::strerror(errno));
+        }
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, kRecordMagic, sizeof(header.magic));
+    header.recordSize = sizeof(Record);
+    header.pageSamples = static_cast<uint32_t>(pageSamples_);
+    if (!writeBytes(&header, sizeof(header))) {
+        close();
+        throw ExportError("StreamRecorder: no se pudo escribir '" + path + "'");
+    }
+
+    // El vector se inicializa a cero: las páginas quedan ya tocadas y el
+    // hilo de control no sufre fallos de página al llenarlas
+    storage_.assign(pagesCount_ * pageSamples_, Record());
+    std::vector<Page> states(pagesCount_);
+    pages_.swap(states);
+    for (size_t p = 0; p < pagesCount_; ++p) {
+        pages_[p].full.store(0, std::memory_order_relaxed);
+        pages_[p].count = 0;
+    }
+    acquirePage();
+
+    writer_ = std::thread(&StreamRecorder::writerLoop, this);
+}
+
+StreamRecorder::~StreamRecorder()
+{
+    close();
+}
+
+void StreamRecorder::appendBlock(const double* u, const double* y, size_t n, int k0)
+{
+    size_t i = 0;
+    while (i < n) {
+        if (fill_ == end_ && !advance()) {
+            // Sin página libre: el resto del bloque se descarta, igual que
+            // haría append() muestra a muestra
+            appended_local_ += n - i;
+            dropped_local_ += n - i;
+            appended_.store(appended_local_, std::memory_order_relaxed);
+            dropped_.store(dropped_local_, std::memory_order_relaxed);
+            return;
+        }
+        const size_t chunk = std::min(n - i, static_cast<size_t>(end_ - fill_));
+        for (size_t j = 0; j < chunk; ++j) {
+            fill_[j].k = k0 + static_cast<int>(i + j);
+            fill_[j].in = u[i + j];
+            fill_[j].out = y[i + j];
+        }
+        fill_ += chunk;
+        i += chunk;
+        appended_local_ += chunk;
+        appended_.store(appended_local_, std::memory_order_relaxed);
+    }
+}
+
+void StreamRecorder::flush()
+{
+    if (fill_ != nullptr && fill_ != pageBegin(producerPage_)) {
+        handOff();
+    }
+}
+
+void StreamRecorder::close()
+{
+    if (closed_) {
+        return;
+    }
+    flush();
+    closed_ = true;
+    fill_ = nullptr;
+    end_ = nullptr;
+
+    // Las páginas entregadas se publicaron antes que stop_: el escritor las
+    // vacía todas antes de terminar
+    stop_.store(true, std::memory_order_release);
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+    if (gz_ != nullptr && gzclose(static_cast<gzFile>(gz_)) != Z_OK) {
+        failed_.store(true, std::memory_order_relaxed);
+    }
+#endif
+    gz_ = nullptr;
+    if (fd_ >= 0 && ::close(fd_) != 0) {
+        failed_.store(true, std::memory_order_relaxed);
+    }
+    fd_ = -1;
+}
+
+bool StreamRecorder::compressionAvailable()
+{
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::vector<Sample> StreamRecorder::readFile(const std::string& path)
+{
+    RecordFile file(path);
+    FileHeader header;
+    if (file.read(&header, sizeof(header)) != static_cast<long>(sizeof(header))
+        || std::memcmp(header.magic, kRecordMagic, sizeof(header.magic)) != 0
+        || header.recordSize != sizeof(Record)) {
+        throw ExportError("StreamRecorder: '" + path + "' no es una grabación válida");
+    }
+
+    std::vector<Sample> samples;
+    std::vector<Record> chunk(kReadChunk);
+    for (;;) {
+        const long got = file.read(chunk.data(), chunk.size() * sizeof(Record));
+        if (got < 0) {
+            throw ExportError("StreamRecorder: error al leer '" + path + "'");
+        }
+        const size_t n = static_cast<size_t>(got) / sizeof(Record);
+        for (size_t i = 0; i < n; ++i) {
+            if (isHold(chunk[i])) {
+                const int k0 = holdStart(chunk[i]);
+                const size_t len = holdLength(chunk[i]);
+                for (size_t j = 0; j < len; ++j) {
+                    samples.push_back(Sample{chunk[i].in, chunk[i].out, k0 + static_cast<int>(j)});
+                }
+                continue;
+            }
+            samples.push_back(Sample{chunk[i].in, chunk[i].out, static_cast<int>(chunk[i].k)});
+        }
+        if (static_cast<size_t>(got) < chunk.size() * sizeof(Record)) {
+            break;
+        }
+    }
+    return samples;
+}
+
+bool StreamRecorder::advance()
+{
+    if (closed_) {
+        return false;
+    }
+    if (fill_ == nullptr) {
+        return acquirePage();
+    }
+    // La página en curso está llena. Se entrega al llegar la muestra
+    // siguiente y no antes, para que close() pueda entregar siempre la última
+    const size_t next = (producerPage_ + 1) % pagesCount_;
+    if (policy_ == DropPolicy::DropPage && pages_[next].full.load(std::memory_order_acquire) != 0) {
+        // El escritor va atrasado: se sacrifica la página llena y se vuelve
+        // a llenar, de modo que lo grabado después es lo más reciente
+        dropped_local_ += pageSamples_;
+        dropped_.store(dropped_local_, std::memory_order_relaxed);
+        fill_ = pageBegin(producerPage_);
+        return true;
+    }
+    handOff();
+    return fill_ != nullptr;
+}
+
+bool StreamRecorder::acquirePage()
+{
+    if (closed_ || pages_[producerPage_].full.load(std::memory_order_acquire) != 0) {
+        return false;
+    }
+    fill_ = pageBegin(producerPage_);
+    end_ = fill_ + pageSamples_;
+    return true;
+}
+
+void StreamRecorder::handOff()
+{
+    Page& page = pages_[producerPage_];
+    page.count = static_cast<size_t>(fill_ - pageBegin(producerPage_));
+    page.full.store(1, std::memory_order_release);
+    producerPage_ = (producerPage_ + 1) % pagesCount_;
+    fill_ = nullptr;
+    end_ = nullptr;
+    acquirePage();
+}
+
+void StreamRecorder::writerLoop()
+{
+    size_t p = 0;
+    for (;;) {
+        Page& page = pages_[p];
+        if (page.full.load(std::memory_order_acquire) != 0) {
+            if (writeBytes(pageBegin(p), page.count * sizeof(Record))) {
+                written_.fetch_add(page.count, std::memory_order_relaxed);
+            } else {
+                failed_.store(true, std::memory_order_relaxed);
+            }
+            page.full.store(0, std::memory_order_release);
+            p = (p + 1) % pagesCount_;
+            continue;
+        }
+        if (stop_.load(std::memory_order_acquire)) {
+            // stop_ se publicó después de la última entrega
+            if (page.full.load(std::memory_order_acquire) == 0) {
+                return;
+            }
+            continue;
+        }
+        // Sondeo en lugar de variable de condición: despertar al escritor
+        // costaría una llamada al sistema en el hilo de control
+        std::this_thread::sleep_for(kWriterIdle);
+    }
+}
+
+bool StreamRecorder::writeBytes(const void* data, size_t bytes)
+{
+    const char* src = static_cast<const char*>(data);
+#ifdef DISCRETESYSTEMS_HAVE_ZLIB
+    if (gz_ != nullptr) {
+        while (bytes > 0) {
+            const unsigned chunk = static_cast<unsigned>(std::min(bytes, static_cast<size_t>(1) << 30));
+            if (gzwrite(static_cast<gzFile>(gz_), src, chunk) != static_cast<int>(chunk)) {
+                return false;
+            }
+            src += chunk;
+            bytes -= chunk;
+        }
+        return true;
+    }
+#endif
+    while (bytes > 0) {
+        const ssize_t n = ::write(fd_, src, bytes);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        src += n;
+        bytes -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace DiscreteSystems
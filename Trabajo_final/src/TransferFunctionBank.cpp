@@ -0,0 +1,201 @@
+/**
+ * @file TransferFunctionBank.cpp
+ * @brief Implementación de TransferFunctionBank
+ */
+
+#include "DiscreteSystems/TransferFunctionBank.h"
+#include "DiscreteSystems/Exceptions.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace DiscreteSystems {
+
+/// Múltiplo al que se redondea el número de canales (8 doubles = 512 bits)
+static const std::size_t kChannelAlign = 8;
+
+TransferFunctionBank::TransferFunctionBank(std::size_t channels, std::size_t numOrder,
+                                           std::size_t denOrder, double Ts)
+    : Ts_(Ts), channels_(channels), stride_(0), Lu_(numOrder + 1), Ly_(denOrder),
+      uPos_(0), yPos_(0), b_(), a_(), uHist_(), yHist_(), num_(), den_()
+{
+    if (Ts_ <= 0.0) {
+        throw InvalidSamplingTime("TransferFunctionBank: el período de muestreo Ts debe ser > 0");
+    }
+    if (channels_ == 0) {
+        throw InvalidDimensions("TransferFunctionBank: el número de canales debe ser > 0");
+    }
+    stride_ = (channels_ + kChannelAlign - 1) / kChannelAlign * kChannelAlign;
+
+    b_.assign(Lu_ * stride_, 0.0);
+    a_.assign((Ly_ + 1) * stride_, 0.0);
+    std::fill(a_.begin(), a_.begin() + static_cast<std::ptrdiff_t>(stride_), 1.0);
+    uHist_.assign(2 * Lu_ * stride_, 0.0);
+    yHist_.assign(2 * Ly_ * stride_, 0.0);
+    num_.assign(stride_, 0.0);
+    den_.assign(stride_, 0.0);
+}
+
+void TransferFunctionBank::step(const double* u, double* y)
+{
+    const std::size_t S = stride_;
+    const std::size_t C = channels_;
+    double* num = num_.data();
+    double* den = den_.data();
+
+    // Insertar u(k) en el historial espejo (posición común a todos los canales)
+    uPos_ = (uPos_ == 0 ? Lu_ : uPos_) - 1;
+    double* u0 = &uHist_[uPos_ * S];
+    double* u1 = &uHist_[(uPos_ + Lu_) * S];
+    for (std::size_t c = 0; c < C; ++c) {
+        u0[c] = u[c];
+        u1[c] = u[c];
+    }
+
+    // Numerador: sum b[i] * u(k-i), vectorizado sobre canales
+    for (std::size_t c = 0; c < S; ++c) {
+        num[c] = 0.0;
+    }
+    for (std::size_t i = 0; i < Lu_; ++i) {
+        const double* bi = &b_[i * S];
+        const double* ui = &uHist_[(uPos_ + i) * S];
+        for (std::size_t c = 0; c < S; ++c) {
+            num[c] += bi[c] * ui[c];
+        }
+    }
+
+    // Denominador: sum a[j] * y(k-j) para j = 1..n
+    for (std::size_t c = 0; c < S; ++c) {
+        den[c] = 0.0;
+    }
+    if (Ly_ > 0) {
+        for (std::size_t j = 1; j <= Ly_; ++j) {
+            const double* aj = &a_[j * S];
+            const double* yj = &yHist_[(yPos_ + j - 1) * S];
+            for (std::size_t c = 0; c < S; ++c) {
+                den[c] += aj[c] * yj[c];
+            }
+        }
+        yPos_ = (yPos_ == 0 ? Ly_ : yPos_) - 1;
+    }
+
+    // y(k) = num - den; insertar en el historial espejo de salidas
+    for (std::size_t c = 0; c < S; ++c) {
+        num[c] -= den[c];
+    }
+    if (Ly_ > 0) {
+        std::copy(num, num + S, &yHist_[yPos_ * S]);
+        std::copy(num, num + S, &yHist_[(yPos_ + Ly_) * S]);
+    }
+    std::copy(num, num + C, y);
+}
+
+void TransferFunctionBank::process(const double* u, double* y, std::size_t n)
+{
+    for (std::size_t t = 0; t < n; ++t) {
+        step(u + t * channels_, y + t * channels_);
+    }
+}
+
+void TransferFunctionBank::reset()
+{
+    std::fill(uHist_.begin(), uHist_.end(), 0.0);
+    std::fill(yHist_.begin(), yHist_.end(), 0.0);
+    uPos_ = 0;
+    yPos_ = 0;
+}
+
+TransferFunctionBank::Channel TransferFunctionBank::channel(std::size_t c)
+{
+    if (c >= channels_) {
+        throw std::out_of_range("TransferFunctionBank: índice de canal fuera de rango");
+    }
+    return Channel(*this, c);
+}
+
+/*========================================================================*/
+/*                          VISTA DE CANAL                                */
+/*========================================================================*/
+
+void TransferFunctionBank::Channel::setCoefficients(const std::vector<double>& b,
+                                                    const std::vector<double>& a)
+{
+    TransferFunctionBank& k = *bank_;
+    if (b.size() != k.Lu_ || a.size() != k.Ly_ + 1) {
+        throw InvalidCoefficients("TransferFunctionBank: los órdenes de b y a deben coincidir con los del banco");
+    }
+    if (a[0] == 0.0) {
+        throw InvalidCoefficients("TransferFunctionBank: a[0] debe ser distinto de 0 para permitir la normalización");
+    }
+    const double a0 = a[0];
+    for (std::size_t j = 0; j < a.size(); ++j) {
+        k.a_[j * k.stride_ + index_] = a[j] / a0;
+    }
+    for (std::size_t i = 0; i < b.size(); ++i) {
+        k.b_[i * k.stride_ + index_] = b[i] / a0;
+    }
+}
+
+double TransferFunctionBank::Channel::numerator(std::size_t i) const
+{
+    return bank_->b_.at(i * bank_->stride_ + index_);
+}
+
+double TransferFunctionBank::Channel::denominator(std::size_t j) const
+{
+    return bank_->a_.at(j * bank_->stride_ + index_);
+}
+
+double TransferFunctionBank::Channel::input(std::size_t i) const
+{
+    const TransferFunctionBank& k = *bank_;
+    if (i >= k.Lu_) {
+        throw std::out_of_range("TransferFunctionBank: índice de entrada fuera de rango");
+    }
+    return k.uHist_[(k.uPos_ + i) * k.stride_ + index_];
+}
+
+double TransferFunctionBank::Channel::output(std::size_t j) const
+{
+    const TransferFunctionBank& k = *bank_;
+    if (j == 0 || j > k.Ly_) {
+        throw std::out_of_range("TransferFunctionBank: índice de salida fuera de rango");
+    }
+    return k.yHist_[(k.yPos_ + j - 1) * k.stride_ + index_];
+}
+
+void TransferFunctionBank::Channel::setInput(std::size_t i, double value)
+{
+    TransferFunctionBank& k = *bank_;
+    if (i >= k.Lu_) {
+        throw std::out_of_range("TransferFunctionBank: índice de entrada fuera de rango");
+    }
+    // Mantener coherentes las dos copias del almacenamiento espejo
+    std::size_t p = (k.uPos_ + i) % k.Lu_;
+    k.uHist_[p * k.stride_ + index_] = value;
+    k.uHist_[(p + k.Lu_) * k.stride_ + index_] = value;
+}
+
+void TransferFunctionBank::Channel::setOutput(std::size_t j, double value)
+{
+    TransferFunctionBank& k = *bank_;
+    if (j == 0 || j > k.Ly_) {
+        throw std::out_of_range("TransferFunctionBank: índice de salida fuera de rango");
+    }
+    std::size_t p = (k.yPos_ + j - 1) % k.Ly_;
+    k.yHist_[p * k.stride_ + index_] = value;
+    k.yHist_[(p + k.Ly_) * k.stride_ + index_] = value;
+}
+
+void TransferFunctionBank::Channel::reset()
+{
+    TransferFunctionBank& k = *bank_;
+    for (std::size_t i = 0; i < 2 * k.Lu_; ++i) {
+        k.uHist_[i * k.stride_ + index_] = 0.0;
+    }
+    for (std::size_t j = 0; j < 2 * k.Ly_; ++j) {
+        k.yHist_[j * k.stride_ + index_] = 0.0;
+    }
+}
+
+} // namespace DiscreteSystems
@@ -4,17 +4,24 @@
  */
 
 #include "DiscreteSystems/TransferFunctionSystem.h"
+#include "DiscreteSystems/Checkpoint.h"
 #include "DiscreteSystems/Exceptions.h"
+#include "DiscreteSystems/Polynomial.h"
 
 #include <algorithm>
+#include <cmath>
+#include <complex>
 
 namespace DiscreteSystems {
 
 TransferFunctionSystem::TransferFunctionSystem(const std::vector<double>& b,
 											   const std::vector<double>& a,
 											   double Ts,
-											   size_t bufferSize)
-	: DiscreteSystem(Ts, bufferSize), b_(), a_(), uHist_(), yHist_()
+											   size_t bufferSize,
+											   FilterStructure structure,
+											   RecordingPolicy recording)
+	: DiscreteSystem(Ts, bufferSize, recording), b_(), a_(), uHist_(), yHist_(),
+	  uPos_(0), yPos_(0), structure_(structure), sos_(), sosState_(), firPrimed_(false)
 {
 	// Validación de coeficientes básicos
 	if (a.empty()) {
@@ -38,50 +45,416 @@ TransferFunctionSystem::TransferFunctionSystem(const std::vector<double>& b,
 		b_[i] = b[i] / a0;
 	}
 
-	// Inicializar historiales
-	uHist_.assign(b_.size(), 0.0);              // [u(k), u(k-1), ..., u(k-m)]
-	yHist_.assign(a_.size() > 0 ? a_.size() - 1 : 0, 0.0); // [y(k-1), ..., y(k-n)]
+	// Inicializar historiales espejo (doble longitud)
+	uHist_.assign(2 * b_.size(), 0.0);          // ventana [u(k), u(k-1), ..., u(k-m)]
+	yHist_.assign(2 * (a_.size() - 1), 0.0);    // ventana [y(k-1), ..., y(k-n)]
+
+	if (structure_ == FilterStructure::SecondOrderSections) {
+		buildSections();
+	} else if (a_.size() == 1 && b_.size() >= kFftMinTaps) {
+		// Partición: la de menor coste medido con bloques de hasta 256 muestras
+		size_t P = 64;
+		while (P < 256 && 4 * P < b_.size()) {
+			P *= 2;
+		}
+		fir_ = PartitionedConvolver(b_, P);
+		firPast_.assign(fir_.partitions() * P, 0.0);
+	}
 }
 
-double TransferFunctionSystem::compute(double uk)
+const size_t TransferFunctionSystem::kFftMinTaps;
+
+namespace {
+
+/// Factor polinómico en z^-1 de orden <= 2: 1 + c1*z^-1 + c2*z^-2
+struct QuadFactor {
+	double c1;
+	double c2;
+	std::complex<double> root;  ///< Raíz representativa (para emparejar polos y ceros)
+};
+
+/**
+ * @brief Agrupa raíces en factores de segundo orden con coeficientes reales
+ *
+ * Los pares conjugados forman un factor cada uno; las raíces reales se
+ * ordenan por módulo y se emparejan consecutivamente (la última, si sobra,
+ * da un factor de primer orden).
+ */
+std::vector<QuadFactor> groupRoots(const std::vector<std::complex<double>>& r)
 {
-	// Desplazar historial de entradas: uHist_[0] será u(k)
-	if (!uHist_.empty()) {
-		for (size_t i = uHist_.size() - 1; i > 0; --i) {
-			uHist_[i] = uHist_[i - 1];
+	std::vector<QuadFactor> factors;
+	std::vector<double> reals;
+	for (size_t i = 0; i < r.size(); ++i) {
+		if (r[i].imag() > 0.0) {
+			QuadFactor f = {-2.0 * r[i].real(), std::norm(r[i]), r[i]};
+			factors.push_back(f);
+		} else if (r[i].imag() == 0.0) {
+			reals.push_back(r[i].real());
 		}
-		uHist_[0] = uk;
 	}
+	std::sort(reals.begin(), reals.end(), [](double x, double y) {
+		return std::abs(x) > std::abs(y);
+	});
+	for (size_t i = 0; i < reals.size(); i += 2) {
+		if (i + 1 < reals.size()) {
+			QuadFactor f = {-(reals[i] + reals[i + 1]), reals[i] * reals[i + 1], reals[i]};
+			factors.push_back(f);
+		} else {
+			QuadFactor f = {-reals[i], 0.0, reals[i]};
+			factors.push_back(f);
+		}
+	}
+	return factors;
+}
+
+} // namespace
+
+void TransferFunctionSystem::buildSections()
+{
+	// Retardo puro: coeficientes nulos iniciales del numerador (factor z^-d)
+	size_t d = 0;
+	while (d < b_.size() && b_[d] == 0.0) {
+		++d;
+	}
+	if (d == b_.size()) {
+		// Numerador idénticamente nulo: H(z) = 0
+		sos_.assign(5, 0.0);
+		sosState_.assign(2, 0.0);
+		return;
+	}
+	const double gain = b_[d];
+
+	std::vector<QuadFactor> poles = groupRoots(Polynomial::roots(a_));
+	std::vector<QuadFactor> zeros = groupRoots(
+		Polynomial::roots(std::vector<double>(b_.begin() + static_cast<std::ptrdiff_t>(d), b_.end())));
+
+	// Secciones ordenadas por módulo de polo creciente: las más resonantes al final
+	std::sort(poles.begin(), poles.end(), [](const QuadFactor& x, const QuadFactor& y) {
+		return std::abs(x.root) < std::abs(y.root);
+	});
+
+	const size_t nSections = std::max<size_t>(1, std::max(poles.size(), zeros.size()));
+	sos_.assign(5 * nSections, 0.0);
+	std::vector<bool> usedZero(zeros.size(), false);
+
+	// Emparejar: cada polo (del más resonante al menos) toma los ceros más cercanos
+	for (size_t ii = nSections; ii-- > 0;) {
+		double* sec = &sos_[5 * ii];
+		sec[0] = 1.0;
+		if (ii < poles.size()) {
+			sec[3] = poles[ii].c1;
+			sec[4] = poles[ii].c2;
+		}
+		size_t best = zeros.size();
+		for (size_t j = 0; j < zeros.size(); ++j) {
+			if (usedZero[j]) {
+				continue;
+			}
+			if (best == zeros.size() || ii >= poles.size() ||
+				std::abs(zeros[j].root - poles[ii].root) < std::abs(zeros[best].root - poles[ii].root)) {
+				best = j;
+			}
+		}
+		if (best < zeros.size()) {
+			usedZero[best] = true;
+			sec[1] = zeros[best].c1;
+			sec[2] = zeros[best].c2;
+		}
+	}
+	for (size_t i = 0; i < 3; ++i) {
+		sos_[i] *= gain;
+	}
+
+	// Plegar el retardo z^-d en numeradores de orden < 2, o añadir secciones de retardo
+	for (size_t r = 0; r < d; ++r) {
+		bool folded = false;
+		for (size_t i = 0; i < nSections && !folded; ++i) {
+			double* sec = &sos_[5 * i];
+			if (sec[2] == 0.0) {
+				sec[2] = sec[1];
+				sec[1] = sec[0];
+				sec[0] = 0.0;
+				folded = true;
+			}
+		}
+		if (!folded) {
+			const double delay[5] = {0.0, 1.0, 0.0, 0.0, 0.0};
+			sos_.insert(sos_.end(), delay, delay + 5);
+		}
+	}
+	sosState_.assign(2 * (sos_.size() / 5), 0.0);
+
+	// Verificar que el producto de secciones reproduce H(z)
+	std::vector<double> num(1, 1.0), den(1, 1.0);
+	for (size_t i = 0; i < sos_.size(); i += 5) {
+		num = Polynomial::multiply(num, std::vector<double>(sos_.begin() + i, sos_.begin() + i + 3));
+		const double di[3] = {1.0, sos_[i + 3], sos_[i + 4]};
+		den = Polynomial::multiply(den, std::vector<double>(di, di + 3));
+	}
+	double scale = 0.0, err = 0.0;
+	for (size_t i = 0; i < std::max(num.size(), den.size()); ++i) {
+		double bi = i < b_.size() ? b_[i] : 0.0;
+		double ai = i < a_.size() ? a_[i] : 0.0;
+		double ni = i < num.size() ? num[i] : 0.0;
+		double di = i < den.size() ? den[i] : 0.0;
+		scale = std::max(scale, std::max(std::abs(bi), std::abs(ai)));
+		err = std::max(err, std::max(std::abs(ni - bi), std::abs(di - ai)));
+	}
+	if (err > 1e-6 * std::max(1.0, scale)) {
+		throw InvalidCoefficients("TransferFunctionSystem: no se pudo factorizar H(z) en secciones de segundo orden");
+	}
+}
+
+double TransferFunctionSystem::compute(double uk)
+{
+	return step(uk);
+}
+
+double TransferFunctionSystem::step(double uk)
+{
+	if (structure_ == FilterStructure::SecondOrderSections) {
+		return computeSections(uk);
+	}
+
+	firPrimed_ = false;
+
+	// Insertar u(k) en el historial espejo: la ventana avanza una posición hacia atrás
+	const size_t Lu = b_.size();
+	uPos_ = (uPos_ == 0 ? Lu : uPos_) - 1;
+	uHist_[uPos_] = uk;
+	uHist_[uPos_ + Lu] = uk;
+	const double* uw = &uHist_[uPos_];    // uw[i] = u(k-i)
 
 	// Parte del numerador: sum b[i] * u(k-i)
 	double y_num = 0.0;
-	for (size_t i = 0; i < b_.size(); ++i) {
-		y_num += b_[i] * uHist_[i];
+	for (size_t i = 0; i < Lu; ++i) {
+		y_num += b_[i] * uw[i];
 	}
 
 	// Parte del denominador: sum a[j] * y(k-j) para j=1..n (a[0] == 1)
+	const size_t Ly = a_.size() - 1;
 	double y_den = 0.0;
-	for (size_t j = 1; j < a_.size(); ++j) {
-		y_den += a_[j] * yHist_[j - 1];
+	if (Ly > 0) {
+		const double* yw = &yHist_[yPos_]; // yw[j-1] = y(k-j)
+		for (size_t j = 1; j <= Ly; ++j) {
+			y_den += a_[j] * yw[j - 1];
+		}
 	}
 
 	const double yk = y_num - y_den;
 
-	// Desplazar historial de salidas e insertar y(k)
-	if (!yHist_.empty()) {
-		for (size_t i = yHist_.size() - 1; i > 0; --i) {
-			yHist_[i] = yHist_[i - 1];
-		}
-		yHist_[0] = yk;
+	// Insertar y(k) en el historial espejo de salidas
+	if (Ly > 0) {
+		yPos_ = (yPos_ == 0 ? Ly : yPos_) - 1;
+		yHist_[yPos_] = yk;
+		yHist_[yPos_ + Ly] = yk;
 	}
 
 	return yk;
 }
 
+double TransferFunctionSystem::computeSections(double uk)
+{
+	// Cascada de biquads en forma directa II transpuesta
+	double x = uk;
+	const size_t nSections = sosState_.size() / 2;
+	for (size_t i = 0; i < nSections; ++i) {
+		const double* c = &sos_[5 * i];
+		double* s = &sosState_[2 * i];
+		const double y = c[0] * x + s[0];
+		s[0] = c[1] * x - c[3] * y + s[1];
+		s[1] = c[2] * x - c[4] * y;
+		x = y;
+	}
+	return x;
+}
+
+void TransferFunctionSystem::computeBlock(const double* u, double* y, size_t n)
+{
+	// Llamadas cualificadas: se resuelven estáticamente y pueden expandirse en línea
+	if (structure_ == FilterStructure::SecondOrderSections) {
+		for (size_t i = 0; i < n; ++i) {
+			y[i] = TransferFunctionSystem::computeSections(u[i]);
+		}
+		return;
+	}
+	const size_t done = fir_.empty() ? 0 : computeFir(u, y, n);
+	for (size_t i = done; i < n; ++i) {
+		y[i] = step(u[i]);
+	}
+}
+
+size_t TransferFunctionSystem::computeFir(const double* u, double* y, size_t n)
+{
+	const size_t P = fir_.partitionSize();
+	if (n < P) {
+		return 0;
+	}
+	const size_t Lu = b_.size();
+	if (!firPrimed_) {
+		// Las entradas más antiguas que el historial sólo multiplican coeficientes nulos
+		const size_t past = firPast_.size();
+		const double* uw = &uHist_[uPos_];    // uw[i] = u(k-1-i)
+		for (size_t i = 0; i < past; ++i) {
+			firPast_[past - 1 - i] = i < Lu ? uw[i] : 0.0;
+		}
+		fir_.prime(&firPast_[0]);
+	}
+	size_t i = 0;
+	for (; i + P <= n; i += P) {
+		fir_.process(u + i, y + i);
+		// El historial de la forma directa sigue al día para next() y advance()
+		for (size_t j = 0; j < P; ++j) {
+			uPos_ = (uPos_ == 0 ? Lu : uPos_) - 1;
+			uHist_[uPos_] = u[i + j];
+			uHist_[uPos_ + Lu] = u[i + j];
+		}
+	}
+	firPrimed_ = true;
+	return i;
+}
+
+void TransferFunctionSystem::buildHoldMatrix()
+{
+	if (structure_ == FilterStructure::SecondOrderSections) {
+		// Transición de la cascada por columnas: un paso desde cada vector de la base
+		const size_t S = sosState_.size();
+		const size_t d = S + 1;
+		std::vector<double> T(d * d, 0.0);
+		const std::vector<double> saved = sosState_;
+		for (size_t c = 0; c < d; ++c) {
+			std::fill(sosState_.begin(), sosState_.end(), 0.0);
+			if (c < S) {
+				sosState_[c] = 1.0;
+			}
+			computeSections(c == S ? 1.0 : 0.0);
+			for (size_t r = 0; r < S; ++r) {
+				T[r * d + c] = sosState_[r];
+			}
+		}
+		T[S * d + S] = 1.0;
+		sosState_ = saved;
+		holdPowers_ = MatrixPowers(T, d);
+		z_.assign(d, 0.0);
+		return;
+	}
+
+	// Forma compañera sobre z = [y(k-1..k-N), u(k-1..k-M), u]
+	const size_t N = a_.size() - 1;
+	const size_t M = b_.size() - 1;
+	const size_t d = N + M + 1;
+	std::vector<double> T(d * d, 0.0);
+	if (N > 0) {
+		for (size_t j = 0; j < N; ++j) {
+			T[j] = -a_[j + 1];
+		}
+		for (size_t i = 0; i < M; ++i) {
+			T[N + i] = b_[i + 1];
+		}
+		T[N + M] = b_[0];
+		for (size_t r = 1; r < N; ++r) {
+			T[r * d + r - 1] = 1.0;
+		}
+	}
+	if (M > 0) {
+		T[N * d + N + M] = 1.0;
+		for (size_t i = 1; i < M; ++i) {
+			T[(N + i) * d + N + i - 1] = 1.0;
+		}
+	}
+	T[(d - 1) * d + d - 1] = 1.0;
+	holdPowers_ = MatrixPowers(T, d);
+	z_.assign(d, 0.0);
+}
+
+double TransferFunctionSystem::computeHold(double uk, size_t steps)
+{
+	if (steps > 1) {
+		if (holdPowers_.empty()) {
+			buildHoldMatrix();
+		}
+		if (structure_ == FilterStructure::SecondOrderSections) {
+			const size_t S = sosState_.size();
+			std::copy(sosState_.begin(), sosState_.end(), z_.begin());
+			z_[S] = uk;
+			holdPowers_.apply(steps - 1, z_.data());
+			std::copy(z_.begin(), z_.begin() + S, sosState_.begin());
+		} else {
+			const size_t N = a_.size() - 1;
+			const size_t Lu = b_.size();
+			const size_t M = Lu - 1;
+			const double* yw = N > 0 ? &yHist_[yPos_] : nullptr;
+			const double* uw = &uHist_[uPos_];
+			for (size_t j = 0; j < N; ++j) {
+				z_[j] = yw[j];
+			}
+			for (size_t i = 0; i < M; ++i) {
+				z_[N + i] = uw[i];
+			}
+			z_[N + M] = uk;
+			holdPowers_.apply(steps - 1, z_.data());
+
+			// Historiales reescritos con la ventana en la posición 0
+			uPos_ = 0;
+			yPos_ = 0;
+			for (size_t j = 0; j < N; ++j) {
+				yHist_[j] = yHist_[j + N] = z_[j];
+			}
+			for (size_t i = 0; i < M; ++i) {
+				uHist_[i] = uHist_[i + Lu] = z_[N + i];
+			}
+		}
+	}
+	return step(uk);
+}
+
 void TransferFunctionSystem::resetState()
 {
 	std::fill(uHist_.begin(), uHist_.end(), 0.0);
 	std::fill(yHist_.begin(), yHist_.end(), 0.0);
+	std::fill(sosState_.begin(), sosState_.end(), 0.0);
+	uPos_ = 0;
+	yPos_ = 0;
+	firPrimed_ = false;
+}
+
+void TransferFunctionSystem::saveState(CheckpointWriter& w) const
+{
+	w.begin(checkpointTag('T', 'F', 'S', ' '), 1);
+	w.writeU64(static_cast<uint64_t>(structure_));
+	w.writeU64(uPos_);
+	w.writeU64(yPos_);
+	w.writeArray(uHist_);
+	w.writeArray(yHist_);
+	w.writeArray(sosState_);
+	w.end();
+}
+
+void TransferFunctionSystem::loadState(CheckpointReader& r)
+{
+	r.begin(checkpointTag('T', 'F', 'S', ' '), 1);
+	const uint64_t structure = r.readU64();
+	const size_t uPos = static_cast<size_t>(r.readU64());
+	const size_t yPos = static_cast<size_t>(r.readU64());
+	std::vector<double> uHist, yHist, sosState;
+	r.readArray(uHist);
+	r.readArray(yHist);
+	r.readArray(sosState);
+	// Los historiales espejo miden el doble de la ventana: las posiciones
+	// deben caer en la primera mitad
+	if (structure != static_cast<uint64_t>(structure_) || uHist.size() != uHist_.size()
+		|| yHist.size() != yHist_.size() || sosState.size() != sosState_.size()
+		|| uPos >= b_.size() || (yPos != 0 && yPos >= a_.size() - 1)) {
+		throw CheckpointError("TransferFunctionSystem: la instantánea no corresponde a un sistema con la misma estructura y orden");
+	}
+	uHist_.swap(uHist);
+	yHist_.swap(yHist);
+	sosState_.swap(sosState);
+	uPos_ = uPos;
+	yPos_ = yPos;
+	// La línea de retardo de la convolución FFT se reconstruye desde uHist_
+	firPrimed_ = false;
+	r.end();
 }
 
 std::ostream& operator<<(std::ostream& os, const TransferFunctionSystem& sys)
@@ -108,6 +481,18 @@ std::ostream& operator<<(std::ostream& os, const TransferFunctionSystem& sys)
 	}
 	os << "]\n";
 
+	if (sys.getStructure() == FilterStructure::SecondOrderSections) {
+		const auto& sos = sys.getSections();
+		os << "sos = [";
+		for (size_t i = 0; i < sos.size(); i += 5) {
+			if (i) os << "       ";
+			os << "[" << sos[i] << ", " << sos[i + 1] << ", " << sos[i + 2]
+			   << " | 1, " << sos[i + 3] << ", " << sos[i + 4] << "]";
+			if (i + 5 < sos.size()) os << ",\n";
+		}
+		os << "]\n";
+	}
+
 	return os;
 }
 
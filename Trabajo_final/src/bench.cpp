@@ -0,0 +1,842 @@
+/**
+ * @file bench.cpp
+ * @brief Micro y macrobenchmarks de las librerías del lazo de control
+ *
+ * Uso: bench [-t ms] [-g grupo] [-q]
+ *
+ * - -t: tiempo mínimo de cada medida en milisegundos (por defecto 50)
+ * - -g: ejecuta sólo los grupos cuyo nombre contiene el texto indicado
+ *       (discretesystems, buffer, controlador, convertidores, refsignal,
+ *       export, lazo, barrido, analysis, grafo, traza)
+ * - -q: medidas cortas (5 ms), para comprobar que todo corre
+ *
+ * La tabla legible se escribe en stderr y el JSON en stdout, de modo que
+ * `bench > bench.json` guarda los resultados para comparar entre versiones.
+ *
+ * Cada medida repite el cuerpo hasta superar el tiempo mínimo, tres veces,
+ * y se queda con la mejor repetición (ns/muestra y muestras/s). Además
+ * cuenta las reservas de memoria por muestra (operator new sustituido en
+ * este ejecutable) y, si el núcleo permite perf_event_open, los fallos de
+ * caché por muestra; si no, el campo queda a null.
+ */
+
+#include <DiscreteSystems.h>
+#include <barrido.h>
+#include <controlador.h>
+#include <convertidores.h>
+#include <grafo.h>
+#include <lazo.h>
+#include <metricas.h>
+#include <planta.h>
+#include <ref.h>
+#include <traza.h>
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAVE_PERF 1
+#endif
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE ""
+#endif
+#ifndef BENCH_VERSION
+#define BENCH_VERSION ""
+#endif
+
+/*========================================================================*/
+/*                   CONTADOR DE RESERVAS DE MEMORIA                      */
+/*========================================================================*/
+
+namespace {
+std::atomic<unsigned long long> g_allocations(0);
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size != 0 ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+// Fuera de línea: inlinado junto a un new, GCC toma el free() por una
+// liberación con la función equivocada (-Wmismatched-new-delete)
+#if defined(__GNUC__)
+__attribute__((noinline))
+#endif
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+/*========================================================================*/
+/*                        FALLOS DE CACHÉ (PERF)                          */
+/*========================================================================*/
+
+/**
+ * @class CacheMissCounter
+ * @brief PERF_COUNT_HW_CACHE_MISSES del propio proceso, en espacio de usuario
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter() : fd_(-1) {
+#ifdef BENCH_HAVE_PERF
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef BENCH_HAVE_PERF
+        if (fd_ >= 0) {
+            close(fd_);
+        }
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const { return fd_ >= 0; }
+
+    void start() {
+#ifdef BENCH_HAVE_PERF
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /** @brief Detiene el contador y devuelve los fallos desde start() */
+    unsigned long long stop() {
+        unsigned long long count = 0;
+#ifdef BENCH_HAVE_PERF
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) {
+                count = 0;
+            }
+        }
+#endif
+        return count;
+    }
+
+private:
+    int fd_;   ///< Descriptor del evento (-1: no disponible)
+};
+
+/*========================================================================*/
+/*                             MEDIDAS                                    */
+/*========================================================================*/
+
+/// Impide que el compilador descarte los resultados
+volatile double g_sink = 0.0;
+
+/** @brief Parámetro de una medida, con su valor ya en JSON */
+typedef std::pair<std::string, std::string> Param;
+
+Param num(const char* key, double v) {
+    std::ostringstream os;
+    os << std::setprecision(15) << v;
+    return Param(key, os.str());
+}
+
+Param str(const char* key, const std::string& v) {
+    return Param(key, "\"" + v + "\"");
+}
+
+/**
+ * @struct Result
+ * @brief Resultado de una medida
+ */
+struct Result {
+    std::string group;            ///< Librería o área
+    std::string name;             ///< Bloque medido
+    std::vector<Param> params;    ///< Orden, método, tamaño de buffer...
+    double nsPerSample;           ///< Mejor repetición
+    double samplesPerSecond;      ///< 1e9 / nsPerSample
+    double allocsPerSample;       ///< Reservas de memoria por muestra
+    double missesPerSample;       ///< Fallos de caché por muestra (< 0: no disponible)
+};
+
+/**
+ * @class Bench
+ * @brief Ejecuta las medidas y acumula los resultados
+ */
+class Bench {
+public:
+    Bench(double minTimeMs, const std::string& filter)
+        : minTimeNs_(minTimeMs * 1e6), filter_(filter), misses_(), results_() {}
+
+    /** @brief Indica si el grupo pasa el filtro de -g */
+    bool enabled(const std::string& group) const {
+        return filter_.empty() || group.find(filter_) != std::string::npos;
+    }
+
+    /**
+     * @brief Mide body(), que procesa samplesPerCall muestras por llamada
+     */
+    template <class Body>
+    void run(const std::string& group, const std::string& name, const std::vector<Param>& params,
+             std::size_t samplesPerCall, Body body) {
+        typedef std::chrono::steady_clock Clock;
+
+        // Calentamiento y calibración: llamadas necesarias para el tiempo mínimo
+        std::size_t calls = 1;
+        for (;;) {
+            const Clock::time_point t0 = Clock::now();
+            for (std::size_t i = 0; i < calls; ++i) {
+                body();
+            }
+            const double ns = std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+            if (ns >= minTimeNs_ / 4 || calls >= (std::size_t(1) << 30)) {
+                calls = static_cast<std::size_t>(std::ceil(calls * minTimeNs_ / std::max(ns, 1.0)));
+                break;
+            }
+            calls *= 4;
+        }
+        calls = std::max<std::size_t>(calls, 1);
+
+        double best = 0.0;
+        unsigned long long allocs = 0, misses = 0;
+        const int reps = 3;
+        for (int r = 0; r < reps; ++r) {
+            const unsigned long long a0 = g_allocations.load(std::memory_order_relaxed);
+            misses_.start();
+            const Clock::time_point t0 = Clock::now();
+            for (std::size_t i = 0; i < calls; ++i) {
+                body();
+            }
+            const Clock::time_point t1 = Clock::now();
+            misses += misses_.stop();
+            allocs += g_allocations.load(std::memory_order_relaxed) - a0;
+            const double ns = std::chrono::duration<double, std::nano>(t1 - t0).count()
+                            / (static_cast<double>(calls) * samplesPerCall);
+            if (r == 0 || ns < best) {
+                best = ns;
+            }
+        }
+        const double samples = static_cast<double>(reps) * calls * samplesPerCall;
+
+        Result res;
+        res.group = group;
+        res.name = name;
+        res.params = params;
+        res.nsPerSample = best;
+        res.samplesPerSecond = best > 0.0 ? 1e9 / best : 0.0;
+        res.allocsPerSample = allocs / samples;
+        res.missesPerSample = misses_.available() ? misses / samples : -1.0;
+        results_.push_back(res);
+        print(res);
+    }
+
+    /** @brief Escribe todos los resultados en JSON */
+    void writeJson(std::ostream& os, double minTimeMs) const {
+        os << std::setprecision(6);
+        os << "{\n";
+        os << "  \"benchmark\": \"ControlSystem\",\n";
+        os << "  \"version\": \"" << BENCH_VERSION << "\",\n";
+        os << "  \"build_type\": \"" << BENCH_BUILD_TYPE << "\",\n";
+        os << "  \"compiler\": \"" << __VERSION__ << "\",\n";
+        os << "  \"min_time_ms\": " << minTimeMs << ",\n";
+        os << "  \"cache_misses_available\": " << (misses_.available() ? "true" : "false") << ",\n";
+        os << "  \"results\": [\n";
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const Result& r = results_[i];
+            os << "    {\"group\": \"" << r.group << "\", \"name\": \"" << r.name << "\", \"params\": {";
+            for (std::size_t p = 0; p < r.params.size(); ++p) {
+                os << (p ? ", " : "") << "\"" << r.params[p].first << "\": " << r.params[p].second;
+            }
+            os << "}, \"ns_per_sample\": " << r.nsPerSample
+               << ", \"samples_per_s\": " << r.samplesPerSecond
+               << ", \"allocs_per_sample\": " << r.allocsPerSample
+               << ", \"cache_misses_per_sample\": ";
+            if (r.missesPerSample < 0.0) {
+                os << "null";
+            } else {
+                os << r.missesPerSample;
+            }
+            os << "}" << (i + 1 < results_.size() ? "," : "") << "\n";
+        }
+        os << "  ]\n";
+        os << "}\n";
+    }
+
+private:
+    static void print(const Result& r) {
+        std::string params;
+        for (std::size_t p = 0; p < r.params.size(); ++p) {
+            std::string v = r.params[p].second;
+            if (!v.empty() && v[0] == '"') {
+                v = v.substr(1, v.size() - 2);
+            }
+            params += (p ? " " : "") + r.params[p].first + "=" + v;
+        }
+        std::cerr << std::left << std::setw(16) << r.group << std::setw(24) << r.name
+                  << std::setw(56) << params << std::right << std::fixed
+                  << std::setprecision(2) << std::setw(10) << r.nsPerSample << " ns"
+                  << std::setprecision(1) << std::setw(9) << r.samplesPerSecond / 1e6 << " M/s"
+                  << std::setprecision(3) << std::setw(9) << r.allocsPerSample << " alloc";
+        if (r.missesPerSample >= 0.0) {
+            std::cerr << std::setprecision(3) << std::setw(9) << r.missesPerSample << " miss";
+        }
+        std::cerr << "\n";
+    }
+
+    double minTimeNs_;              ///< Tiempo mínimo por repetición [ns]
+    std::string filter_;            ///< Filtro de grupos (-g)
+    mutable CacheMissCounter misses_;
+    std::vector<Result> results_;   ///< Resultados en orden de ejecución
+};
+
+/*========================================================================*/
+/*                          SISTEMAS DE PRUEBA                            */
+/*========================================================================*/
+
+const double Ts = 0.01;
+
+/** @brief Denominador de orden n con polos reales en (0.3, 0.9) y ganancia estática 1 */
+void makeTransferFunction(std::size_t order, std::vector<double>& b, std::vector<double>& a) {
+    a.assign(1, 1.0);
+    for (std::size_t i = 0; i < order; ++i) {
+        const double p = 0.3 + 0.6 * (i + 0.5) / order;
+        a.push_back(0.0);
+        for (std::size_t j = a.size() - 1; j > 0; --j) {
+            a[j] -= p * a[j - 1];
+        }
+    }
+    double dc = 0.0;
+    for (std::size_t j = 0; j < a.size(); ++j) {
+        dc += a[j];
+    }
+    b.assign(order + 1, dc / (order + 1));
+}
+
+/** @brief Sistema de n estados con A densa de radio espectral 0.9 */
+DiscreteSystems::StateSpaceSystem makeStateSpace(std::size_t n) {
+    std::vector<std::vector<double>> A(n, std::vector<double>(n, 0.9 / n));
+    std::vector<double> B(n, 1.0), C(n, 1.0 / n);
+    return DiscreteSystems::StateSpaceSystem(A, B, C, 0.0, Ts, 1024);
+}
+
+const std::size_t kBlock = 256;
+
+/*========================================================================*/
+/*                              GRUPOS                                    */
+/*========================================================================*/
+
+void benchDiscreteSystems(Bench& bench) {
+    using namespace DiscreteSystems;
+    const std::string g = "discretesystems";
+    std::vector<double> u(kBlock), y(kBlock);
+    for (std::size_t i = 0; i < kBlock; ++i) {
+        u[i] = std::sin(0.01 * i);
+    }
+
+    const std::size_t orders[] = {1, 2, 4, 8, 16, 32, 64};
+    for (std::size_t order : orders) {
+        std::vector<double> b, a;
+        makeTransferFunction(order, b, a);
+        TransferFunctionSystem tf(b, a, Ts, 1024);
+        double x = 0.0;
+        bench.run(g, "TransferFunctionSystem",
+                  {num("order", order), str("structure", "DirectForm"), str("method", "next")}, 1,
+                  [&]() { x = tf.next(1.0 - 0.5 * x); g_sink = x; });
+        bench.run(g, "TransferFunctionSystem",
+                  {num("order", order), str("structure", "DirectForm"), str("method", "process")}, kBlock,
+                  [&]() { tf.process(&u[0], &y[0], kBlock); g_sink = y[kBlock - 1]; });
+        if (order >= 2 && order <= 8) {
+            TransferFunctionSystem sos(b, a, Ts, 1024, FilterStructure::SecondOrderSections);
+            bench.run(g, "TransferFunctionSystem",
+                      {num("order", order), str("structure", "SecondOrderSections"), str("method", "process")},
+                      kBlock, [&]() { sos.process(&u[0], &y[0], kBlock); g_sink = y[kBlock - 1]; });
+        }
+    }
+
+    for (std::size_t n : orders) {
+        StateSpaceSystem ss = makeStateSpace(n);
+        double x = 0.0;
+        bench.run(g, "StateSpaceSystem", {num("n", n), str("method", "next")}, 1,
+                  [&]() { x = ss.next(1.0 - 0.5 * x); g_sink = x; });
+        bench.run(g, "StateSpaceSystem", {num("n", n), str("method", "process")}, kBlock,
+                  [&]() { ss.process(&u[0], &y[0], kBlock); g_sink = y[kBlock - 1]; });
+    }
+
+    // FIR: a = [1] usa la convolución FFT desde kFftMinTaps; a = [1, 0] fuerza la forma directa
+    const std::size_t firTaps[] = {32, 64, 128, 1024, 4096};
+    for (std::size_t taps : firTaps) {
+        std::vector<double> h(taps);
+        for (std::size_t i = 0; i < taps; ++i) {
+            h[i] = std::sin(0.05 * i) / (1.0 + i);
+        }
+        TransferFunctionSystem fft(h, {1.0}, Ts, 1024), direct(h, {1.0, 0.0}, Ts, 1024);
+        bench.run(g, "TransferFunctionSystem",
+                  {num("taps", taps), str("fir", "DirectForm"), str("method", "process")}, kBlock,
+                  [&]() { direct.process(&u[0], &y[0], kBlock); g_sink = y[kBlock - 1]; });
+        bench.run(g, "TransferFunctionSystem",
+                  {num("taps", taps), str("fir", fft.getFftPartition() ? "FFT" : "DirectForm"),
+                   num("partition", fft.getFftPartition()), str("method", "process")}, kBlock,
+                  [&]() { fft.process(&u[0], &y[0], kBlock); g_sink = y[kBlock - 1]; });
+    }
+
+    // ns por paso saltado: advance() con entrada constante, potencias ya cacheadas
+    const std::size_t kAdvance = 100000;
+    const std::size_t advanceOrders[] = {2, 8, 32};
+    for (std::size_t n : advanceOrders) {
+        StateSpaceSystem ss = makeStateSpace(n);
+        bench.run(g, "StateSpaceSystem", {num("n", n), str("method", "advance"), num("steps", kAdvance)}, kAdvance,
+                  [&]() { g_sink = ss.advance(kAdvance, 1.0); });
+        std::vector<double> b, a;
+        makeTransferFunction(n, b, a);
+        TransferFunctionSystem tf(b, a, Ts, 1024);
+        bench.run(g, "TransferFunctionSystem",
+                  {num("order", n), str("structure", "DirectForm"), str("method", "advance"), num("steps", kAdvance)},
+                  kAdvance, [&]() { g_sink = tf.advance(kAdvance, 1.0); });
+    }
+}
+
+void benchBuffer(Bench& bench) {
+    using namespace DiscreteSystems;
+    const std::string g = "buffer";
+    std::vector<double> b, a;
+    makeTransferFunction(2, b, a);
+
+    const RecordingPolicy policies[] = {
+        RecordingPolicy(),
+        RecordingPolicy(RecordFields::Output, RecordPrecision::Float),
+        RecordingPolicy(RecordFields::None)
+    };
+    const char* names[] = {"InputOutput/Double", "Output/Float", "None"};
+    const std::size_t sizes[] = {16, 1024, 65536, 1048576};
+    for (std::size_t size : sizes) {
+        for (int p = 0; p < 3; ++p) {
+            TransferFunctionSystem tf(b, a, Ts, size, FilterStructure::DirectForm, policies[p]);
+            double x = 0.0;
+            bench.run(g, "TransferFunctionSystem",
+                      {num("order", 2), num("buffer", size), str("recording", names[p]), str("method", "next")}, 1,
+                      [&]() { x = tf.next(1.0 - 0.5 * x); g_sink = x; });
+            if (policies[p].fields == RecordFields::None) {
+                break;   // sin buffer el tamaño no influye
+            }
+        }
+    }
+}
+
+/**
+ * @brief BasicPID<T> sobre un bloque de errores ya convertidos a T
+ */
+template <class T>
+void benchScalarPid(Bench& bench, const char* scalar) {
+    typedef Controlador::BasicPID<T> Pid;
+    Pid pid(2.0, 4.0, 0.01, Ts);
+    const std::size_t n = 256;
+    std::vector<typename Pid::Value> ev(n), uv(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        ev[i] = Pid::Traits::fromDouble(0.1 * std::sin(0.05 * static_cast<double>(i)));
+    }
+    bench.run("controlador", "BasicPID", {str("scalar", scalar), str("method", "process")}, n,
+              [&]() {
+                  pid.process(&ev[0], &uv[0], n);
+                  g_sink = Pid::Traits::toDouble(uv[n - 1]);
+              });
+}
+
+void benchControlador(Bench& bench) {
+    const std::string g = "controlador";
+    Controlador::PIDController pid(2.0, 4.0, 0.01, Ts);
+    Controlador::FixedPID fixed(2.0, 4.0, 0.01, Ts);
+    double e = 0.0;
+    bench.run(g, "PIDController", {str("method", "next")}, 1,
+              [&]() { e = 1.0 - 0.001 * pid.next(e); g_sink = e; });
+    bench.run(g, "PIDController", {str("method", "step")}, 1,
+              [&]() { e = 1.0 - 0.001 * pid.step(e); g_sink = e; });
+    bench.run(g, "FixedPID", {str("method", "step")}, 1,
+              [&]() { e = 1.0 - 0.001 * fixed.step(e); g_sink = e; });
+    benchScalarPid<double>(bench, "double");
+    benchScalarPid<float>(bench, "float");
+    benchScalarPid<DiscreteSystems::Q31>(bench, "Q31");
+    benchScalarPid<DiscreteSystems::Q15>(bench, "Q15");
+
+    const std::size_t channels = 64;
+    Controlador::PIDBank bank(channels, 2.0, 4.0, 0.01, Ts);
+    std::vector<double> ev(channels, 0.5), uv(channels);
+    bench.run(g, "PIDBank", {num("channels", channels), str("method", "step")}, channels,
+              [&]() { bank.step(&ev[0], &uv[0]); g_sink = uv[0]; });
+}
+
+void benchConvertidores(Bench& bench) {
+    const std::string g = "convertidores";
+    Convertidores::ADConverter adc(Ts);
+    Convertidores::DAConverter dac(Ts);
+    double x = 0.0;
+    bench.run(g, "ADConverter", {str("method", "next")}, 1,
+              [&]() { x = adc.next(x + 1.0); g_sink = x; });
+    bench.run(g, "ADConverter", {str("method", "step")}, 1,
+              [&]() { x = adc.step(x + 1.0); g_sink = x; });
+    bench.run(g, "DAConverter", {str("method", "next")}, 1,
+              [&]() { x = dac.next(x + 1.0); g_sink = x; });
+}
+
+void benchRefSignal(Bench& bench) {
+    const std::string g = "refsignal";
+    RefSignal::StepSignal step(Ts, 1.0, 0.5);
+    RefSignal::RampSignal ramp(Ts, 0.1, 0.5);
+    RefSignal::SineSignal sine(Ts, 1.0, 0.2);
+    RefSignal::Signal* signals[] = {&step, &ramp, &sine};
+    const char* names[] = {"StepSignal", "RampSignal", "SineSignal"};
+    std::vector<double> out(kBlock);
+    for (int s = 0; s < 3; ++s) {
+        RefSignal::Signal& sig = *signals[s];
+        bench.run(g, names[s], {str("method", "next")}, 1, [&]() { g_sink = sig.next(); });
+        std::size_t k0 = 0;
+        bench.run(g, names[s], {str("method", "generate")}, kBlock, [&]() {
+            sig.generate(&out[0], kBlock, k0);
+            k0 += kBlock;
+            g_sink = out[kBlock - 1];
+        });
+    }
+}
+
+void benchExport(Bench& bench) {
+    using namespace DiscreteSystems;
+    const std::string g = "export";
+    std::vector<double> b, a;
+    makeTransferFunction(2, b, a);
+    const std::size_t count = 100000;
+    TransferFunctionSystem tf(b, a, Ts, count);
+    std::vector<double> u(count, 1.0), y(count);
+    tf.process(&u[0], &y[0], count);
+
+    const ExportFormat formats[] = {ExportFormat::TSV, ExportFormat::MATLAB, ExportFormat::RAW,
+                                    ExportFormat::NPY, ExportFormat::MAT};
+    const char* names[] = {"TSV", "MATLAB", "RAW", "NPY", "MAT"};
+    const std::string path = "bench_export.tmp";
+    for (int f = 0; f < 5; ++f) {
+        bench.run(g, "bufferDump", {str("format", names[f]), str("target", "stream"), num("samples", count)},
+                  count, [&]() {
+                      std::ostringstream os;
+                      tf.bufferDump(os, formats[f]);
+                      g_sink = static_cast<double>(os.tellp());
+                  });
+        bench.run(g, "bufferDump", {str("format", names[f]), str("target", "file"), num("samples", count)},
+                  count, [&]() { tf.bufferDump(path, formats[f]); });
+    }
+    std::remove(path.c_str());
+}
+
+void benchLazo(Bench& bench) {
+    const std::string g = "lazo";
+    auto loop = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                               Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                               Convertidores::DAConverter(Ts),
+                               Planta::Sistema(Ts),
+                               Convertidores::ADConverter(Ts));
+    bench.run(g, "LoopRunner", {str("blocks", "dinamicos"), str("mode", "rapido")}, 1,
+              [&]() { g_sink = loop.tick().y; });
+    Metricas::StepResponse eval(Ts);
+    bench.run(g, "LoopRunner", {str("blocks", "dinamicos"), str("mode", "rapido"), str("metrics", "StepResponse")}, 1,
+              [&]() {
+                  const Lazo::TickData d = loop.tick();
+                  eval.update(d.r, d.y);
+                  g_sink = d.y;
+              });
+    loop.setRecording(true);
+    bench.run(g, "LoopRunner", {str("blocks", "dinamicos"), str("mode", "registro")}, 1,
+              [&]() { g_sink = loop.tick().y; });
+    loop.setRecordingPolicy(DiscreteSystems::RecordingPolicy(DiscreteSystems::RecordFields::Output,
+                                                             DiscreteSystems::RecordPrecision::Float));
+    bench.run(g, "LoopRunner", {str("blocks", "dinamicos"), str("mode", "registro"), str("recording", "Output/Float")},
+              1, [&]() { g_sink = loop.tick().y; });
+
+    auto fixed = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                Controlador::FixedPID(2.0, 4.0, 0.01, Ts),
+                                Convertidores::DAConverter(Ts),
+                                Planta::SistemaFijo(),
+                                Convertidores::ADConverter(Ts));
+    bench.run(g, "LoopRunner", {str("blocks", "fijos"), str("mode", "rapido")}, 1,
+              [&]() { g_sink = fixed.tick().y; });
+
+    // ns por paso de planta a Tp = Ts/10: todo el lazo a Tp frente al control a Ts
+    const std::size_t N = 10;
+    const double Tp = Ts / N;
+    auto allFast = Lazo::makeLoop(RefSignal::StepSignal(Tp, 1.0, 0.0),
+                                  Controlador::PIDController(2.0, 4.0, 0.01, Tp),
+                                  Convertidores::DAConverter(Tp),
+                                  Planta::Sistema::tustin(Tp),
+                                  Convertidores::ADConverter(Tp));
+    bench.run(g, "LoopRunner", {str("blocks", "dinamicos"), str("mode", "rapido"), num("plantPerControl", 1)}, 1,
+              [&]() { g_sink = allFast.tick().y; });
+    auto multi = Lazo::makeMultirateLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                         Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                                         Convertidores::DAConverter(Ts),
+                                         Planta::Sistema::tustin(Tp),
+                                         Convertidores::ADConverter(Ts),
+                                         Lazo::Rates(N));
+    bench.run(g, "MultirateLoop", {str("blocks", "dinamicos"), str("mode", "rapido"), num("plantPerControl", N)}, N,
+              [&]() { g_sink = multi.tick().y; });
+
+    // ns por tick de una simulación que se asienta en ~1500 de 100000 ticks
+    const std::size_t K = 100000;
+    const char* skipNames[] = {"no", "si"};
+    for (int skip = 0; skip < 2; ++skip) {
+        auto quiet = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                    Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                                    Convertidores::DAConverter(Ts),
+                                    Planta::Sistema(Ts),
+                                    Convertidores::ADConverter(Ts));
+        quiet.setSteadyState(Lazo::SteadyState(skip == 0 ? 0 : 8));
+        bench.run(g, "LoopRunner", {str("blocks", "dinamicos"), str("mode", "rapido"), str("steadySkip", skipNames[skip]),
+                                    num("ticks", K)},
+                  K, [&]() {
+                      quiet.reset();
+                      quiet.run(K);
+                      g_sink = static_cast<double>(quiet.skipped());
+                  });
+    }
+
+    // Instantánea del lazo en modo registro: con buffers y sólo el estado dinámico
+    const char* bufferNames[] = {"no", "si"};
+    for (int buffers = 0; buffers < 2; ++buffers) {
+        DiscreteSystems::CheckpointWriter snapshot(buffers == 1);
+        loop.checkpoint(snapshot);
+        bench.run(g, "LoopRunner", {str("method", "checkpoint"), str("buffers", bufferNames[buffers]),
+                                    num("bytes", snapshot.size())},
+                  1, [&]() {
+                      DiscreteSystems::CheckpointWriter w(buffers == 1);
+                      loop.checkpoint(w);
+                      g_sink = static_cast<double>(w.size());
+                  });
+        bench.run(g, "LoopRunner", {str("method", "restore"), str("buffers", bufferNames[buffers]),
+                                    num("bytes", snapshot.size())},
+                  1, [&]() {
+                      DiscreteSystems::CheckpointReader r(snapshot);
+                      loop.restore(r);
+                      g_sink = static_cast<double>(loop.getK());
+                  });
+    }
+}
+
+void benchBarrido(Bench& bench) {
+    const std::string g = "barrido";
+    auto proto = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                Controlador::PIDController(1.0, 0.0, 0.0, Ts),
+                                Convertidores::DAConverter(Ts),
+                                Planta::Sistema(Ts),
+                                Convertidores::ADConverter(Ts));
+    const std::vector<Barrido::GainPoint> points =
+        Barrido::randomPoints(64, Barrido::GainPoint{0.5, 0.0, 0.0}, Barrido::GainPoint{4.0, 5.0, 0.02});
+    const std::size_t ticks = 2000;
+
+    // ns por tick de lazo: con N hilos, el ideal es 1/N del valor con 1 hilo
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> counts;
+    for (unsigned t = 1; t < cores; t *= 2) {
+        counts.push_back(t);
+    }
+    counts.push_back(cores);
+    for (std::size_t c = 0; c < counts.size(); ++c) {
+        const unsigned threads = counts[c];
+        Barrido::WorkStealingPool pool(threads);
+        const Barrido::SweepOptions opt(ticks, threads);
+        bench.run(g, "runSweep", {num("threads", threads), num("points", points.size()), num("ticks", ticks)},
+                  points.size() * ticks,
+                  [&]() { g_sink = Barrido::runSweep(proto, points, opt, &pool)[0].iae; });
+    }
+}
+
+void benchAnalysis(Bench& bench) {
+    using namespace DiscreteSystems;
+    const std::string g = "analysis";
+    const double wN = 3.14159265358979323846 / Ts;
+
+    // ns por frecuencia de una rejilla de Bode; threads = 0 reparte sólo rejillas grandes
+    const std::size_t grids[] = {10000, 1000000};
+    const unsigned threadCounts[] = {1, 0};
+    const std::size_t orders[] = {2, 8};
+    for (std::size_t points : grids) {
+        const std::vector<double> w = Analysis::logspace(1e-4 * wN, wN, points);
+        for (unsigned threads : threadCounts) {
+            for (std::size_t order : orders) {
+                std::vector<double> b, a;
+                makeTransferFunction(order, b, a);
+                const TransferFunctionSystem tf(b, a, Ts);
+                bench.run(g, "frequencyResponse",
+                          {str("system", "TransferFunctionSystem"), num("order", order), num("points", points),
+                           str("threads", threads == 0 ? "auto" : "1")},
+                          points, [&]() { g_sink = Analysis::frequencyResponse(tf, w, threads)[points / 2].real(); });
+                const StateSpaceSystem ss = makeStateSpace(order);
+                bench.run(g, "frequencyResponse",
+                          {str("system", "StateSpaceSystem"), num("order", order), num("points", points),
+                           str("threads", threads == 0 ? "auto" : "1")},
+                          points, [&]() { g_sink = Analysis::frequencyResponse(ss, w, threads)[points / 2].real(); });
+            }
+        }
+    }
+
+    // ns por muestra de la respuesta al escalón y coste de analyzeLoop() completo
+    const Planta::Sistema planta(Ts);
+    const Controlador::PIDController pid(2.0, 4.0, 0.01, Ts);
+    bench.run(g, "step", {str("system", "TransferFunctionSystem"), num("order", 1), num("samples", kBlock)}, kBlock,
+              [&]() { g_sink = Analysis::step(planta, kBlock).back(); });
+    bench.run(g, "analyzeLoop", {str("blocks", "PIDController/Sistema"), num("points", 4096)}, 1,
+              [&]() { g_sink = Lazo::analyzeLoop(pid, planta).margins.gainMargin; });
+}
+
+void benchGrafo(Bench& bench) {
+    const std::string g = "grafo";
+
+    // ns por tick del lazo: bloques como miembros tipados frente al plan compilado
+    const Controlador::PIDController pid(2.0, 4.0, 0.01, Ts);
+    const Planta::Sistema planta(Ts);
+    auto loop = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0), pid, Convertidores::DAConverter(Ts), planta,
+                               Convertidores::ADConverter(Ts));
+    bench.run(g, "LoopRunner", {str("blocks", "dinamicos")}, 1,
+              [&]() { g_sink = loop.tick().y; });
+    Grafo::CompiledGraph lg = Grafo::makeLoopGraph(pid, planta).compile();
+    const double one = 1.0;
+    bench.run(g, "CompiledGraph", {str("graph", "makeLoopGraph")}, 1,
+              [&]() { lg.tick(&one); g_sink = lg.values()[3]; });
+    // Ídem con pid → dac → planta → adc fundidos en una sola función de transferencia
+    const Grafo::Fusion fused = Grafo::fuse(Grafo::makeLoopGraph(pid, planta));
+    Grafo::CompiledGraph fg = fused.graph.compile();
+    const Grafo::BlockId fe = fused.map[5];
+    bench.run(g, "CompiledGraph", {str("graph", "fuse(makeLoopGraph)")}, 1,
+              [&]() { fg.tick(&one); g_sink = fg.values()[fe]; });
+
+    // ns por tick de 32 secciones de orden 2 en serie: objetos con sus
+    // historiales en el montón (intercalados con otras reservas, como en un
+    // proceso de larga duración) frente al arena contiguo
+    const std::size_t sections = 32;
+    std::vector<double> b, a;
+    makeTransferFunction(2, b, a);
+    std::vector<DiscreteSystems::TransferFunctionSystem> chain;
+    chain.reserve(sections);
+    std::vector<std::vector<char> > clutter;
+    Grafo::SystemGraph sg(Ts);
+    Grafo::BlockId last = sg.addInput("u");
+    for (std::size_t i = 0; i < sections; ++i) {
+        chain.push_back(DiscreteSystems::TransferFunctionSystem(b, a, Ts));
+        clutter.push_back(std::vector<char>(4096));
+        last = sg.series(last, sg.addTransferFunction("h" + std::to_string(i), b, a));
+    }
+    double x = 0.0;
+    bench.run(g, "chain", {str("blocks", "TransferFunctionSystem"), num("sections", sections)}, 1, [&]() {
+        double v = 1.0 - 0.5 * x;
+        for (std::size_t i = 0; i < sections; ++i) {
+            v = chain[i].step(v);
+        }
+        x = v;
+        g_sink = v;
+    });
+    Grafo::CompiledGraph cg = sg.compile();
+    x = 0.0;
+    bench.run(g, "chain", {str("blocks", "CompiledGraph"), num("sections", sections)}, 1, [&]() {
+        const double u = 1.0 - 0.5 * x;
+        cg.tick(&u);
+        x = cg.values()[last];
+        g_sink = x;
+    });
+}
+
+void benchTraza(Bench& bench) {
+    const std::string g = "traza";
+    bench.run(g, "Clock", {str("method", "now")}, 1,
+              [&]() { g_sink = static_cast<double>(Traza::Clock::now()); });
+    // Bloques de kBlock eventos; clear() libera la cola sin copiar (el coste queda repartido)
+    Traza::TraceBuffer buf(kBlock);
+    std::uint64_t k = 0;
+    bench.run(g, "TraceBuffer", {str("method", "record")}, kBlock, [&]() {
+        for (std::size_t i = 0; i < kBlock; ++i) {
+            buf.record(Traza::EventKind::Begin, 1, k++);
+        }
+        buf.clear();
+    });
+    std::vector<Traza::Event> out;
+    out.reserve(kBlock);
+    bench.run(g, "TraceBuffer", {str("method", "record+drain")}, kBlock, [&]() {
+        for (std::size_t i = 0; i < kBlock; ++i) {
+            buf.record(Traza::EventKind::Begin, 1, k++);
+        }
+        out.clear();
+        buf.drain(out);
+        g_sink = static_cast<double>(out.back().k);
+    });
+}
+
+void usage(const char* prog) {
+    std::cerr << "Uso: " << prog << " [-t ms] [-g grupo] [-q]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double minTimeMs = 50.0;
+    std::string filter;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            minTimeMs = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "-q") == 0) {
+            minTimeMs = 5.0;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (minTimeMs <= 0.0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    Bench bench(minTimeMs, filter);
+    if (bench.enabled("discretesystems")) benchDiscreteSystems(bench);
+    if (bench.enabled("buffer")) benchBuffer(bench);
+    if (bench.enabled("controlador")) benchControlador(bench);
+    if (bench.enabled("convertidores")) benchConvertidores(bench);
+    if (bench.enabled("refsignal")) benchRefSignal(bench);
+    if (bench.enabled("export")) benchExport(bench);
+    if (bench.enabled("lazo")) benchLazo(bench);
+    if (bench.enabled("barrido")) benchBarrido(bench);
+    if (bench.enabled("analysis")) benchAnalysis(bench);
+    if (bench.enabled("grafo")) benchGrafo(bench);
+    if (bench.enabled("traza")) benchTraza(bench);
+
+    bench.writeJson(std::cout, minTimeMs);
+    return 0;
+}
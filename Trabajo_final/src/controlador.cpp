@@ -4,8 +4,11 @@
  */
 
 #include "controlador.h"
+#include <DiscreteSystems/Checkpoint.h>
 #include <DiscreteSystems/Exceptions.h>
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace Controlador {
 
@@ -13,64 +16,429 @@ namespace Controlador {
 /*                          PID CONTROLLER                                */
 /*========================================================================*/
 
+namespace {
+
+/** @brief Coeficientes de la forma incremental: {a0, a1, a2} */
+void pidCoefficients(double Kp, double Ki, double Kd, double Ts, double* a) {
+    a[0] = Kp + Ki * Ts + Kd / Ts;
+    a[1] = -Kp - 2.0 * Kd / Ts;
+    a[2] = Kd / Ts;
+}
+
+} // namespace
+
 PIDController::PIDController(double Kp, double Ki, double Kd, double Ts, size_t bufferSize)
     : DiscreteSystem(Ts, bufferSize),
-      Kp_(Kp), Ki_(Ki), Kd_(Kd),
       a0_(0.0), a1_(0.0), a2_(0.0),
-      e_k1_(0.0), e_k2_(0.0), u_k1_(0.0)
+      e_k1_(0.0), e_k2_(0.0), u_k1_(0.0),
+      seq_(0), applied_(0), watch_(0), bumpless_(0),
+      rampTotal_(0), rampLeft_(0)
 {
-    updateCoefficients();
+    double a[3];
+    pidCoefficients(Kp, Ki, Kd, getSamplingTime(), a);
+    a0_ = a[0];
+    a1_ = a[1];
+    a2_ = a[2];
+    for (int i = 0; i < 3; ++i) {
+        rampFrom_[i] = rampTo_[i] = a[i];
+    }
+    for (CoefficientSlot& slot : slots_) {
+        slot.Kp.store(Kp, std::memory_order_relaxed);
+        slot.Ki.store(Ki, std::memory_order_relaxed);
+        slot.Kd.store(Kd, std::memory_order_relaxed);
+        slot.a0.store(a[0], std::memory_order_relaxed);
+        slot.a1.store(a[1], std::memory_order_relaxed);
+        slot.a2.store(a[2], std::memory_order_relaxed);
+        slot.ramp.store(0, std::memory_order_relaxed);
+    }
+}
+
+PIDController::PIDController(const PIDController& other)
+    : DiscreteSystem(other),
+      seq_(0), applied_(0), watch_(0), bumpless_(0)
+{
+    copyTuning(other);
+}
+
+PIDController& PIDController::operator=(const PIDController& other) {
+    if (this != &other) {
+        DiscreteSystem::operator=(other);
+        copyTuning(other);
+    }
+    return *this;
+}
+
+void PIDController::copyTuning(const PIDController& other) {
+    a0_ = other.a0_;
+    a1_ = other.a1_;
+    a2_ = other.a2_;
+    e_k1_ = other.e_k1_;
+    e_k2_ = other.e_k2_;
+    u_k1_ = other.u_k1_;
+    for (int i = 0; i < 2; ++i) {
+        const CoefficientSlot& src = other.slots_[i];
+        CoefficientSlot& dst = slots_[i];
+        dst.Kp.store(src.Kp.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.Ki.store(src.Ki.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.Kd.store(src.Kd.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.a0.store(src.a0.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.a1.store(src.a1.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.a2.store(src.a2.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dst.ramp.store(src.ramp.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    seq_.store(other.seq_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    applied_ = other.applied_;
+    watch_ = other.watch_;
+    bumpless_.store(other.bumpless_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    for (int i = 0; i < 3; ++i) {
+        rampFrom_[i] = other.rampFrom_[i];
+        rampTo_[i] = other.rampTo_[i];
+    }
+    rampTotal_ = other.rampTotal_;
+    rampLeft_ = other.rampLeft_;
+}
+
+void PIDController::publish(double Kp, double Ki, double Kd, uint64_t ramp) {
+    double a[3];
+    pidCoefficients(Kp, Ki, Kd, getSamplingTime(), a);
+
+    // Se escribe el buffer no publicado. La barrera ordena estas escrituras
+    // tras la publicación anterior: un lector que vea alguna de ellas verá
+    // también la secuencia nueva y descartará su lectura
+    const uint64_t s = seq_.load(std::memory_order_relaxed);
+    CoefficientSlot& slot = slots_[(s + 1) & 1];
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.Kp.store(Kp, std::memory_order_relaxed);
+    slot.Ki.store(Ki, std::memory_order_relaxed);
+    slot.Kd.store(Kd, std::memory_order_relaxed);
+    slot.a0.store(a[0], std::memory_order_relaxed);
+    slot.a1.store(a[1], std::memory_order_relaxed);
+    slot.a2.store(a[2], std::memory_order_relaxed);
+    slot.ramp.store(ramp, std::memory_order_relaxed);
+    seq_.store(s + 1, std::memory_order_release);
 }
 
-void PIDController::updateCoefficients() {
-    double Ts = getSamplingTime();
-    a0_ = Kp_ + Ki_ * Ts + Kd_ / Ts;
-    a1_ = -Kp_ - 2.0 * Kd_ / Ts;
-    a2_ = Kd_ / Ts;
+void PIDController::refreshCoefficients() {
+    const uint64_t s = seq_.load(std::memory_order_acquire);
+    if (s != applied_) {
+        const CoefficientSlot& slot = slots_[s & 1];
+        const double a[3] = {slot.a0.load(std::memory_order_relaxed),
+                             slot.a1.load(std::memory_order_relaxed),
+                             slot.a2.load(std::memory_order_relaxed)};
+        const uint64_t ramp = slot.ramp.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        // Si entretanto se ha publicado otro juego la lectura puede estar
+        // mezclada: se descarta y se reintenta en el tick siguiente
+        if (seq_.load(std::memory_order_relaxed) == s) {
+            applied_ = s;
+            rampFrom_[0] = a0_;
+            rampFrom_[1] = a1_;
+            rampFrom_[2] = a2_;
+            for (int i = 0; i < 3; ++i) {
+                rampTo_[i] = a[i];
+            }
+            rampTotal_ = ramp != 0 ? ramp : 1;
+            rampLeft_ = rampTotal_;
+        }
+    }
+
+    if (rampLeft_ != 0) {
+        --rampLeft_;
+        if (rampLeft_ == 0) {
+            a0_ = rampTo_[0];
+            a1_ = rampTo_[1];
+            a2_ = rampTo_[2];
+        } else {
+            const double w = static_cast<double>(rampTotal_ - rampLeft_) / static_cast<double>(rampTotal_);
+            a0_ = rampFrom_[0] + (rampTo_[0] - rampFrom_[0]) * w;
+            a1_ = rampFrom_[1] + (rampTo_[1] - rampFrom_[1]) * w;
+            a2_ = rampFrom_[2] + (rampTo_[2] - rampFrom_[2]) * w;
+        }
+    }
+    watch_ = rampLeft_ != 0 ? kRamping : applied_;
+}
+
+void PIDController::publishedGains(double* gains) const {
+    for (;;) {
+        const uint64_t s = seq_.load(std::memory_order_acquire);
+        const CoefficientSlot& slot = slots_[s & 1];
+        gains[0] = slot.Kp.load(std::memory_order_relaxed);
+        gains[1] = slot.Ki.load(std::memory_order_relaxed);
+        gains[2] = slot.Kd.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq_.load(std::memory_order_relaxed) == s) {
+            return;
+        }
+    }
 }
 
 double PIDController::compute(double ek) {
-    // Forma incremental del PID
-    // Δu[k] = a0*e[k] + a1*e[k-1] + a2*e[k-2]
-    double delta_u = a0_ * ek + a1_ * e_k1_ + a2_ * e_k2_;
-    
-    // u[k] = u[k-1] + Δu[k]
-    double uk = u_k1_ + delta_u;
-    
-    // Actualizar historiales
-    e_k2_ = e_k1_;
-    e_k1_ = ek;
-    u_k1_ = uk;
-    
-    return uk;
+    return step(ek);
+}
+
+void PIDController::computeBlock(const double* e, double* u, size_t n) {
+    if (gainsPending()) {
+        // Juego nuevo o transición en curso: muestra a muestra, igual que next()
+        for (size_t i = 0; i < n; ++i) {
+            u[i] = step(e[i]);
+        }
+        return;
+    }
+
+    const double a0 = a0_, a1 = a1_, a2 = a2_;
+    double e_k1 = e_k1_, e_k2 = e_k2_, u_k1 = u_k1_;
+
+    for (size_t i = 0; i < n; ++i) {
+        const double ek = e[i];
+        const double delta_u = a0 * ek + a1 * e_k1 + a2 * e_k2;
+        const double uk = u_k1 + delta_u;
+        e_k2 = e_k1;
+        e_k1 = ek;
+        u_k1 = uk;
+        u[i] = uk;
+    }
+
+    e_k1_ = e_k1;
+    e_k2_ = e_k2;
+    u_k1_ = u_k1;
 }
 
 void PIDController::resetState() {
     e_k1_ = 0.0;
     e_k2_ = 0.0;
     u_k1_ = 0.0;
+    // Una transición en curso termina en su destino
+    if (rampLeft_ != 0) {
+        a0_ = rampTo_[0];
+        a1_ = rampTo_[1];
+        a2_ = rampTo_[2];
+        rampLeft_ = 0;
+        watch_ = applied_;
+    }
+}
+
+void PIDController::saveState(DiscreteSystems::CheckpointWriter& w) const {
+    w.begin(DiscreteSystems::checkpointTag('P', 'I', 'D', ' '), 1);
+    const double state[6] = {a0_, a1_, a2_, e_k1_, e_k2_, u_k1_};
+    w.writeArray(state, 6);
+    for (int i = 0; i < 2; ++i) {
+        const CoefficientSlot& slot = slots_[i];
+        const double gains[6] = {slot.Kp.load(std::memory_order_relaxed), slot.Ki.load(std::memory_order_relaxed),
+                                 slot.Kd.load(std::memory_order_relaxed), slot.a0.load(std::memory_order_relaxed),
+                                 slot.a1.load(std::memory_order_relaxed), slot.a2.load(std::memory_order_relaxed)};
+        w.writeArray(gains, 6);
+        w.writeU64(slot.ramp.load(std::memory_order_relaxed));
+    }
+    w.writeU64(seq_.load(std::memory_order_relaxed));
+    w.writeU64(applied_);
+    w.writeU64(watch_);
+    w.writeU64(bumpless_.load(std::memory_order_relaxed));
+    w.writeArray(rampFrom_, 3);
+    w.writeArray(rampTo_, 3);
+    w.writeU64(rampTotal_);
+    w.writeU64(rampLeft_);
+    w.end();
+}
+
+void PIDController::loadState(DiscreteSystems::CheckpointReader& r) {
+    r.begin(DiscreteSystems::checkpointTag('P', 'I', 'D', ' '), 1);
+    double state[6];
+    r.readArray(state, 6);
+    double gains[2][6];
+    uint64_t ramp[2];
+    for (int i = 0; i < 2; ++i) {
+        r.readArray(gains[i], 6);
+        ramp[i] = r.readU64();
+    }
+    const uint64_t seq = r.readU64();
+    const uint64_t applied = r.readU64();
+    const uint64_t watch = r.readU64();
+    const uint64_t bumpless = r.readU64();
+    double from[3], to[3];
+    r.readArray(from, 3);
+    r.readArray(to, 3);
+    const uint64_t rampTotal = r.readU64();
+    const uint64_t rampLeft = r.readU64();
+    r.end();
+
+    a0_ = state[0];
+    a1_ = state[1];
+    a2_ = state[2];
+    e_k1_ = state[3];
+    e_k2_ = state[4];
+    u_k1_ = state[5];
+    for (int i = 0; i < 2; ++i) {
+        CoefficientSlot& slot = slots_[i];
+        slot.Kp.store(gains[i][0], std::memory_order_relaxed);
+        slot.Ki.store(gains[i][1], std::memory_order_relaxed);
+        slot.Kd.store(gains[i][2], std::memory_order_relaxed);
+        slot.a0.store(gains[i][3], std::memory_order_relaxed);
+        slot.a1.store(gains[i][4], std::memory_order_relaxed);
+        slot.a2.store(gains[i][5], std::memory_order_relaxed);
+        slot.ramp.store(ramp[i], std::memory_order_relaxed);
+    }
+    applied_ = applied;
+    watch_ = watch;
+    bumpless_.store(bumpless, std::memory_order_relaxed);
+    for (int i = 0; i < 3; ++i) {
+        rampFrom_[i] = from[i];
+        rampTo_[i] = to[i];
+    }
+    rampTotal_ = rampTotal;
+    rampLeft_ = rampLeft;
+    seq_.store(seq, std::memory_order_release);
 }
 
 void PIDController::setKp(double Kp) {
-    Kp_ = Kp;
-    updateCoefficients();
+    double g[3];
+    publishedGains(g);
+    publish(Kp, g[1], g[2], getBumpless());
 }
 
 void PIDController::setKi(double Ki) {
-    Ki_ = Ki;
-    updateCoefficients();
+    double g[3];
+    publishedGains(g);
+    publish(g[0], Ki, g[2], getBumpless());
 }
 
 void PIDController::setKd(double Kd) {
-    Kd_ = Kd;
-    updateCoefficients();
+    double g[3];
+    publishedGains(g);
+    publish(g[0], g[1], Kd, getBumpless());
 }
 
 void PIDController::setGains(double Kp, double Ki, double Kd) {
-    Kp_ = Kp;
-    Ki_ = Ki;
-    Kd_ = Kd;
-    updateCoefficients();
+    publish(Kp, Ki, Kd, getBumpless());
+}
+
+void PIDController::setGains(double Kp, double Ki, double Kd, uint64_t ramp) {
+    publish(Kp, Ki, Kd, ramp);
+}
+
+double PIDController::getKp() const {
+    double g[3];
+    publishedGains(g);
+    return g[0];
+}
+
+double PIDController::getKi() const {
+    double g[3];
+    publishedGains(g);
+    return g[1];
+}
+
+double PIDController::getKd() const {
+    double g[3];
+    publishedGains(g);
+    return g[2];
+}
+
+void PIDController::getTransferFunction(std::vector<double>& b, std::vector<double>& a) const {
+    double g[3];
+    publishedGains(g);
+    const double Ts = getSamplingTime();
+    b.assign(3, 0.0);
+    b[0] = g[0] + g[1] * Ts + g[2] / Ts;
+    b[1] = -g[0] - 2.0 * g[2] / Ts;
+    b[2] = g[2] / Ts;
+    a.assign(2, 1.0);
+    a[1] = -1.0;
+}
+
+/*========================================================================*/
+/*                              PID BANK                                  */
+/*========================================================================*/
+
+PIDBank::PIDBank(size_t channels, double Kp, double Ki, double Kd, double Ts)
+    : Ts_(Ts), channels_(channels), stride_(0)
+{
+    if (Ts_ <= 0.0) {
+        throw DiscreteSystems::InvalidSamplingTime("PIDBank: el período de muestreo Ts debe ser > 0");
+    }
+    if (channels_ == 0) {
+        throw DiscreteSystems::InvalidDimensions("PIDBank: el número de canales debe ser > 0");
+    }
+    stride_ = (channels_ + 7) / 8 * 8;
+
+    Kp_.assign(stride_, 0.0);
+    Ki_.assign(stride_, 0.0);
+    Kd_.assign(stride_, 0.0);
+    a0_.assign(stride_, 0.0);
+    a1_.assign(stride_, 0.0);
+    a2_.assign(stride_, 0.0);
+    e_k1_.assign(stride_, 0.0);
+    e_k2_.assign(stride_, 0.0);
+    u_k1_.assign(stride_, 0.0);
+    for (size_t c = 0; c < channels_; ++c) {
+        Channel(*this, c).setGains(Kp, Ki, Kd);
+    }
+}
+
+void PIDBank::step(const double* e, double* u) {
+    const double* a0 = a0_.data();
+    const double* a1 = a1_.data();
+    const double* a2 = a2_.data();
+    double* e1 = e_k1_.data();
+    double* e2 = e_k2_.data();
+    double* u1 = u_k1_.data();
+
+    for (size_t c = 0; c < channels_; ++c) {
+        const double ek = e[c];
+        const double delta_u = a0[c] * ek + a1[c] * e1[c] + a2[c] * e2[c];
+        const double uk = u1[c] + delta_u;
+        e2[c] = e1[c];
+        e1[c] = ek;
+        u1[c] = uk;
+    }
+    std::copy(u1, u1 + channels_, u);
+}
+
+void PIDBank::process(const double* e, double* u, size_t n) {
+    for (size_t t = 0; t < n; ++t) {
+        step(e + t * channels_, u + t * channels_);
+    }
+}
+
+void PIDBank::reset() {
+    std::fill(e_k1_.begin(), e_k1_.end(), 0.0);
+    std::fill(e_k2_.begin(), e_k2_.end(), 0.0);
+    std::fill(u_k1_.begin(), u_k1_.end(), 0.0);
+}
+
+PIDBank::Channel PIDBank::channel(size_t c) {
+    if (c >= channels_) {
+        throw std::out_of_range("PIDBank: índice de canal fuera de rango");
+    }
+    return Channel(*this, c);
+}
+
+void PIDBank::Channel::setGains(double Kp, double Ki, double Kd) {
+    PIDBank& b = *bank_;
+    const double Ts = b.Ts_;
+    b.Kp_[index_] = Kp;
+    b.Ki_[index_] = Ki;
+    b.Kd_[index_] = Kd;
+    b.a0_[index_] = Kp + Ki * Ts + Kd / Ts;
+    b.a1_[index_] = -Kp - 2.0 * Kd / Ts;
+    b.a2_[index_] = Kd / Ts;
+}
+
+double PIDBank::Channel::getKp() const { return bank_->Kp_[index_]; }
+double PIDBank::Channel::getKi() const { return bank_->Ki_[index_]; }
+double PIDBank::Channel::getKd() const { return bank_->Kd_[index_]; }
+
+double PIDBank::Channel::errorK1() const { return bank_->e_k1_[index_]; }
+double PIDBank::Channel::errorK2() const { return bank_->e_k2_[index_]; }
+double PIDBank::Channel::outputK1() const { return bank_->u_k1_[index_]; }
+
+void PIDBank::Channel::setState(double e_k1, double e_k2, double u_k1) {
+    bank_->e_k1_[index_] = e_k1;
+    bank_->e_k2_[index_] = e_k2;
+    bank_->u_k1_[index_] = u_k1;
+}
+
+void PIDBank::Channel::reset() {
+    setState(0.0, 0.0, 0.0);
 }
 
 } // namespace Controlador
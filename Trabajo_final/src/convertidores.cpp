@@ -5,6 +5,10 @@
 
 #include "convertidores.h"
 
+#include <DiscreteSystems/Checkpoint.h>
+
+#include <algorithm>
+
 namespace Convertidores {
 
 /*========================================================================*/
@@ -18,15 +22,33 @@ ADConverter::ADConverter(double Ts, size_t bufferSize)
 
 double ADConverter::compute(double yk) {
     // Retardo de una muestra: y_d[k] = y[k-1]
-    double output = y_k1_;
-    y_k1_ = yk;
-    return output;
+    return step(yk);
+}
+
+void ADConverter::computeBlock(const double* u, double* y, size_t n) {
+    // y[0] = y[k-1] y el resto es la entrada desplazada una posición
+    y[0] = y_k1_;
+    std::copy(u, u + n - 1, y + 1);
+    y_k1_ = u[n - 1];
 }
 
 void ADConverter::resetState() {
     y_k1_ = 0.0;
 }
 
+void ADConverter::saveState(DiscreteSystems::CheckpointWriter& w) const {
+    w.begin(DiscreteSystems::checkpointTag('A', 'D', 'C', ' '), 1);
+    w.writeF64(y_k1_);
+    w.end();
+}
+
+void ADConverter::loadState(DiscreteSystems::CheckpointReader& r) {
+    r.begin(DiscreteSystems::checkpointTag('A', 'D', 'C', ' '), 1);
+    const double y = r.readF64();
+    r.end();
+    y_k1_ = y;
+}
+
 /*========================================================================*/
 /*                          DAC CONVERTER                                 */
 /*========================================================================*/
@@ -37,11 +59,25 @@ DAConverter::DAConverter(double Ts, size_t bufferSize)
 
 double DAConverter::compute(double uk) {
     // Paso directo: y[k] = u[k]
-    return uk;
+    return step(uk);
+}
+
+void DAConverter::computeBlock(const double* u, double* y, size_t n) {
+    std::copy(u, u + n, y);
 }
 
 void DAConverter::resetState() {
     // No hay estado interno
 }
 
+void DAConverter::saveState(DiscreteSystems::CheckpointWriter& w) const {
+    w.begin(DiscreteSystems::checkpointTag('D', 'A', 'C', ' '), 1);
+    w.end();
+}
+
+void DAConverter::loadState(DiscreteSystems::CheckpointReader& r) {
+    r.begin(DiscreteSystems::checkpointTag('D', 'A', 'C', ' '), 1);
+    r.end();
+}
+
 } // namespace Convertidores
@@ -0,0 +1,735 @@
+/**
+ * @file grafo.cpp
+ * @brief Implementación de SystemGraph y CompiledGraph
+ */
+
+#include "grafo.h"
+
+#include <DiscreteSystems/Exceptions.h>
+#include <DiscreteSystems/Polynomial.h>
+
+#include <algorithm>
+
+namespace Grafo {
+
+namespace {
+
+const std::size_t kNone = static_cast<std::size_t>(-1);
+
+/**
+ * @brief Salida de una función de transferencia en el arena
+ *
+ * Tramo d = [b0..b(nb-1) | a1..aN | u(k-1)..u(k-nb+1) | y(k-1)..y(k-N)].
+ * Mismo orden de sumas que TransferFunctionSystem::step(); sin paso directo
+ * (b0 = 0) el término b0·u(k) se omite.
+ */
+inline double tfResponse(const double* d, std::size_t nb, std::size_t N, double uk, bool direct) {
+    const double* b = d;
+    const double* a = d + nb;
+    const double* uh = a + N;
+    const double* yh = uh + (nb - 1);
+    double y_num = 0.0;
+    if (direct) {
+        y_num += b[0] * uk;
+    }
+    for (std::size_t i = 1; i < nb; ++i) {
+        y_num += b[i] * uh[i - 1];
+    }
+    double y_den = 0.0;
+    for (std::size_t j = 0; j < N; ++j) {
+        y_den += a[j] * yh[j];
+    }
+    return y_num - y_den;
+}
+
+/**
+ * @brief Desplaza u(k) e y(k) en los historiales de una función de transferencia
+ */
+inline void tfPush(double* d, std::size_t nb, std::size_t N, double uk, double yk) {
+    double* uh = d + nb + N;
+    double* yh = uh + (nb - 1);
+    if (nb > 1) {
+        for (std::size_t i = nb - 2; i > 0; --i) {
+            uh[i] = uh[i - 1];
+        }
+        uh[0] = uk;
+    }
+    if (N > 0) {
+        for (std::size_t j = N - 1; j > 0; --j) {
+            yh[j] = yh[j - 1];
+        }
+        yh[0] = yk;
+    }
+}
+
+/**
+ * @brief p + q con los coeficientes alineados en z^0
+ */
+std::vector<double> addPolynomials(const std::vector<double>& p, const std::vector<double>& q) {
+    std::vector<double> r(std::max(p.size(), q.size()), 0.0);
+    for (std::size_t i = 0; i < p.size(); ++i) {
+        r[i] += p[i];
+    }
+    for (std::size_t i = 0; i < q.size(); ++i) {
+        r[i] += q[i];
+    }
+    return r;
+}
+
+/**
+ * @brief Orden de b(z^-1) / a(z^-1)
+ */
+inline std::size_t tfOrder(const std::vector<double>& b, const std::vector<double>& a) {
+    return std::max(b.size(), a.size()) - 1;
+}
+
+} // namespace
+
+/*========================================================================*/
+/*                             SYSTEM GRAPH                               */
+/*========================================================================*/
+
+SystemGraph::SystemGraph(double Ts) : Ts_(Ts) {
+    if (Ts_ <= 0.0) {
+        throw DiscreteSystems::InvalidSamplingTime("SystemGraph: el período de muestreo Ts debe ser > 0");
+    }
+}
+
+BlockId SystemGraph::add(BlockKind kind, const std::string& name) {
+    Block blk;
+    blk.kind = kind;
+    blk.name = name;
+    blk.value = 0.0;
+    blocks_.push_back(blk);
+    return blocks_.size() - 1;
+}
+
+BlockId SystemGraph::addInput(const std::string& name) {
+    return add(BlockKind::Input, name);
+}
+
+BlockId SystemGraph::addGain(const std::string& name, double k) {
+    const BlockId id = add(BlockKind::Gain, name);
+    blocks_[id].value = k;
+    return id;
+}
+
+BlockId SystemGraph::addSum(const std::string& name) {
+    return add(BlockKind::Sum, name);
+}
+
+BlockId SystemGraph::addTransferFunction(const std::string& name, const std::vector<double>& b,
+                                         const std::vector<double>& a) {
+    if (a.empty()) {
+        throw DiscreteSystems::InvalidCoefficients("SystemGraph: el denominador de '" + name + "' no debe estar vacío");
+    }
+    if (b.empty()) {
+        throw DiscreteSystems::InvalidCoefficients("SystemGraph: el numerador de '" + name + "' no debe estar vacío");
+    }
+    if (a[0] == 0.0) {
+        throw DiscreteSystems::InvalidCoefficients("SystemGraph: a[0] de '" + name + "' debe ser distinto de 0");
+    }
+    const BlockId id = add(BlockKind::TransferFunction, name);
+    Block& blk = blocks_[id];
+    const double a0 = a[0];
+    blk.a.resize(a.size());
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        blk.a[i] = a[i] / a0;
+    }
+    blk.b.resize(b.size());
+    for (std::size_t i = 0; i < b.size(); ++i) {
+        blk.b[i] = b[i] / a0;
+    }
+    return id;
+}
+
+BlockId SystemGraph::addSystem(const std::string& name, const DiscreteSystems::TransferFunctionSystem& sys) {
+    if (sys.getSamplingTime() != Ts_) {
+        throw DiscreteSystems::InvalidSamplingTime("SystemGraph: el período de '" + name + "' no coincide con el del grafo");
+    }
+    return addTransferFunction(name, sys.getNumerator(), sys.getDenominator());
+}
+
+BlockId SystemGraph::addPID(const std::string& name, const Controlador::PIDController& pid) {
+    if (pid.getSamplingTime() != Ts_) {
+        throw DiscreteSystems::InvalidSamplingTime("SystemGraph: el período de '" + name + "' no coincide con el del grafo");
+    }
+    std::vector<double> b, a;
+    pid.getTransferFunction(b, a);
+    return addTransferFunction(name, b, a);
+}
+
+BlockId SystemGraph::addDelay(const std::string& name, double initial) {
+    const BlockId id = add(BlockKind::Delay, name);
+    blocks_[id].value = initial;
+    return id;
+}
+
+BlockId SystemGraph::addSaturation(const std::string& name, double lo, double hi) {
+    if (lo > hi) {
+        throw DiscreteSystems::InvalidCoefficients("SystemGraph: los límites de '" + name + "' deben cumplir lo <= hi");
+    }
+    const BlockId id = add(BlockKind::Saturation, name);
+    blocks_[id].b.push_back(lo);
+    blocks_[id].b.push_back(hi);
+    return id;
+}
+
+void SystemGraph::checkId(BlockId id) const {
+    if (id >= blocks_.size()) {
+        throw InvalidGraph("SystemGraph: el bloque " + std::to_string(id) + " no existe");
+    }
+}
+
+void SystemGraph::connect(BlockId from, BlockId to, double weight) {
+    checkId(from);
+    checkId(to);
+    Block& dst = blocks_[to];
+    if (dst.kind == BlockKind::Input) {
+        throw InvalidGraph("SystemGraph: la entrada externa '" + dst.name + "' no admite conexiones");
+    }
+    if (dst.kind != BlockKind::Sum) {
+        if (!dst.inputs.empty()) {
+            throw InvalidGraph("SystemGraph: el bloque '" + dst.name + "' ya tiene entrada");
+        }
+        if (weight != 1.0) {
+            throw InvalidGraph("SystemGraph: sólo las uniones sumadoras admiten pesos ('" + dst.name + "')");
+        }
+    }
+    dst.inputs.push_back(std::make_pair(from, weight));
+}
+
+BlockId SystemGraph::parallel(const std::string& name, BlockId in, BlockId a, BlockId b) {
+    checkId(in);
+    checkId(a);
+    checkId(b);
+    connect(in, a);
+    connect(in, b);
+    const BlockId sum = addSum(name);
+    connect(a, sum);
+    connect(b, sum);
+    return sum;
+}
+
+BlockId SystemGraph::feedback(const std::string& name, BlockId reference, BlockId forward, BlockId back,
+                              double sign) {
+    checkId(reference);
+    checkId(forward);
+    checkId(back);
+    const BlockId sum = addSum(name);
+    connect(reference, sum);
+    connect(back, sum, sign);
+    connect(sum, forward);
+    return sum;
+}
+
+bool SystemGraph::isDelayed(BlockId id) const {
+    const Block& blk = blocks_.at(id);
+    return blk.kind == BlockKind::Delay || (blk.kind == BlockKind::TransferFunction && blk.b[0] == 0.0);
+}
+
+bool SystemGraph::isLTI(BlockId id) const {
+    const Block& blk = blocks_.at(id);
+    return blk.kind == BlockKind::Gain || blk.kind == BlockKind::TransferFunction
+        || (blk.kind == BlockKind::Delay && blk.value == 0.0);
+}
+
+void SystemGraph::transferFunction(BlockId id, std::vector<double>& b, std::vector<double>& a) const {
+    if (!isLTI(id)) {
+        throw InvalidGraph("SystemGraph: el bloque '" + name(id) + "' no es LTI");
+    }
+    const Block& blk = blocks_[id];
+    switch (blk.kind) {
+    case BlockKind::Gain:
+        b.assign(1, blk.value);
+        a.assign(1, 1.0);
+        break;
+    case BlockKind::Delay:
+        b.assign(1, 0.0);
+        b.push_back(1.0);
+        a.assign(1, 1.0);
+        break;
+    default:
+        b = blk.b;
+        a = blk.a;
+        break;
+    }
+}
+
+CompiledGraph SystemGraph::compile() const {
+    const std::size_t n = blocks_.size();
+    if (n == 0) {
+        throw InvalidGraph("SystemGraph: el grafo está vacío");
+    }
+    for (std::size_t v = 0; v < n; ++v) {
+        if (blocks_[v].kind != BlockKind::Input && blocks_[v].inputs.empty()) {
+            throw InvalidGraph("SystemGraph: el bloque '" + blocks_[v].name + "' no tiene entrada");
+        }
+    }
+
+    // Dependencias de la fase de cálculo: sólo las salidas de bloques con
+    // paso directo; las entradas externas y los bloques sin paso directo ya
+    // tienen su salida al empezar la fase
+    std::vector<std::size_t> pending(n, 0);
+    std::vector<std::vector<BlockId> > succ(n);
+    std::size_t nodes = 0;
+    for (std::size_t v = 0; v < n; ++v) {
+        if (blocks_[v].kind == BlockKind::Input) {
+            continue;
+        }
+        ++nodes;
+        for (std::size_t i = 0; i < blocks_[v].inputs.size(); ++i) {
+            const BlockId u = blocks_[v].inputs[i].first;
+            if (blocks_[u].kind != BlockKind::Input && !isDelayed(u)) {
+                ++pending[v];
+                succ[u].push_back(v);
+            }
+        }
+    }
+
+    // Kahn con cola FIFO sembrada en orden de declaración (plan determinista)
+    std::vector<BlockId> order;
+    order.reserve(nodes);
+    for (std::size_t v = 0; v < n; ++v) {
+        if (blocks_[v].kind != BlockKind::Input && pending[v] == 0) {
+            order.push_back(v);
+        }
+    }
+    for (std::size_t head = 0; head < order.size(); ++head) {
+        const BlockId u = order[head];
+        for (std::size_t i = 0; i < succ[u].size(); ++i) {
+            if (--pending[succ[u][i]] == 0) {
+                order.push_back(succ[u][i]);
+            }
+        }
+    }
+    if (order.size() != nodes) {
+        // Quedan los lazos y lo que cuelga de ellos: se descarta lo que no
+        // alimenta a otro bloque pendiente hasta dejar sólo los lazos
+        std::vector<bool> left(n, false);
+        for (std::size_t v = 0; v < n; ++v) {
+            left[v] = blocks_[v].kind != BlockKind::Input && pending[v] > 0;
+        }
+        for (bool pruned = true; pruned;) {
+            pruned = false;
+            for (std::size_t v = 0; v < n; ++v) {
+                if (!left[v]) {
+                    continue;
+                }
+                bool feeds = false;
+                for (std::size_t i = 0; i < succ[v].size() && !feeds; ++i) {
+                    feeds = left[succ[v][i]];
+                }
+                if (!feeds) {
+                    left[v] = false;
+                    pruned = true;
+                }
+            }
+        }
+        std::string names;
+        for (std::size_t v = 0; v < n; ++v) {
+            if (left[v]) {
+                names += (names.empty() ? "'" : ", '") + blocks_[v].name + "'";
+            }
+        }
+        throw InvalidGraph("SystemGraph: lazo algebraico entre bloques con paso directo: " + names);
+    }
+
+    CompiledGraph g;
+    g.Ts_ = Ts_;
+    g.signals_.assign(n, 0.0);
+    g.offsets_.assign(n, kNone);
+    g.names_.resize(n);
+    for (std::size_t v = 0; v < n; ++v) {
+        g.names_[v] = blocks_[v].name;
+        if (blocks_[v].kind == BlockKind::Input) {
+            g.inputs_.push_back(v);
+        }
+    }
+
+    // Tramo de cada bloque en el arena, en el orden en que se ejecuta por primera vez
+    std::vector<double>& arena = g.arena_;
+    std::vector<std::size_t> outputOf(n, kNone);
+    for (std::size_t pass = 0; pass < 2; ++pass) {
+        for (std::size_t i = 0; i < order.size(); ++i) {
+            const BlockId v = order[i];
+            const Block& blk = blocks_[v];
+            const bool delayed = isDelayed(v);
+            if (pass == 0 && !delayed) {
+                continue;
+            }
+            CompiledGraph::Operation op = CompiledGraph::Operation();
+            op.block = v;
+            op.in = blk.inputs[0].first;
+            op.output = kNone;
+            if (g.offsets_[v] == kNone) {
+                g.offsets_[v] = arena.size();
+                switch (blk.kind) {
+                case BlockKind::Gain:
+                case BlockKind::Delay:
+                    arena.push_back(blk.value);
+                    break;
+                case BlockKind::Sum:
+                    for (std::size_t j = 0; j < blk.inputs.size(); ++j) {
+                        arena.push_back(blk.inputs[j].second);
+                    }
+                    break;
+                case BlockKind::TransferFunction:
+                    arena.insert(arena.end(), blk.b.begin(), blk.b.end());
+                    arena.insert(arena.end(), blk.a.begin() + 1, blk.a.end());
+                    arena.resize(arena.size() + (blk.b.size() - 1) + (blk.a.size() - 1), 0.0);
+                    break;
+                case BlockKind::Saturation:
+                    arena.insert(arena.end(), blk.b.begin(), blk.b.end());
+                    break;
+                case BlockKind::Input:
+                    break;
+                }
+            }
+            op.data = g.offsets_[v];
+            switch (blk.kind) {
+            case BlockKind::Gain:
+                op.code = CompiledGraph::OpCode::Gain;
+                break;
+            case BlockKind::Sum:
+                op.code = CompiledGraph::OpCode::Sum;
+                op.in = g.operands_.size();
+                op.count = blk.inputs.size();
+                for (std::size_t j = 0; j < blk.inputs.size(); ++j) {
+                    g.operands_.push_back(blk.inputs[j].first);
+                }
+                break;
+            case BlockKind::TransferFunction:
+                op.code = !delayed ? CompiledGraph::OpCode::Tf
+                        : pass == 0 ? CompiledGraph::OpCode::TfOutput : CompiledGraph::OpCode::TfUpdate;
+                op.count = blk.b.size();
+                op.order = blk.a.size() - 1;
+                break;
+            case BlockKind::Delay:
+                op.code = pass == 0 ? CompiledGraph::OpCode::DelayOutput : CompiledGraph::OpCode::DelayUpdate;
+                break;
+            case BlockKind::Saturation:
+                op.code = CompiledGraph::OpCode::Saturation;
+                break;
+            case BlockKind::Input:
+                break;
+            }
+            if (pass == 0) {
+                outputOf[v] = g.outputs_.size();
+                g.outputs_.push_back(op);
+            } else {
+                op.output = outputOf[v];
+                g.schedule_.push_back(op);
+            }
+        }
+    }
+    g.initial_ = arena;
+    return g;
+}
+
+/*========================================================================*/
+/*                            COMPILED GRAPH                              */
+/*========================================================================*/
+
+void CompiledGraph::tick(const double* inputs) {
+    double* s = &signals_[0];
+    latch(s);
+    setInputs(inputs, s);
+    execute(0, schedule_.size(), s);
+    ++k_;
+}
+
+void CompiledGraph::reset() {
+    arena_ = initial_;
+    signals_.assign(signals_.size(), 0.0);
+    k_ = 0;
+}
+
+void CompiledGraph::latch(double* values) const {
+    const double* A = arena_.empty() ? nullptr : &arena_[0];
+    for (std::size_t i = 0; i < outputs_.size(); ++i) {
+        const Operation& op = outputs_[i];
+        values[op.block] = op.code == OpCode::DelayOutput ? A[op.data]
+                         : tfResponse(A + op.data, op.count, op.order, 0.0, false);
+    }
+}
+
+void CompiledGraph::latch(std::size_t first, std::size_t last, double* values) const {
+    const double* A = arena_.empty() ? nullptr : &arena_[0];
+    for (std::size_t i = first; i < last; ++i) {
+        if (schedule_[i].output == kNone) {
+            continue;
+        }
+        const Operation& op = outputs_[schedule_[i].output];
+        values[op.block] = op.code == OpCode::DelayOutput ? A[op.data]
+                         : tfResponse(A + op.data, op.count, op.order, 0.0, false);
+    }
+}
+
+void CompiledGraph::setInputs(const double* inputs, double* values) const {
+    for (std::size_t i = 0; i < inputs_.size(); ++i) {
+        values[inputs_[i]] = inputs[i];
+    }
+}
+
+void CompiledGraph::execute(std::size_t first, std::size_t last, double* s) {
+    double* A = arena_.empty() ? nullptr : &arena_[0];
+    const std::size_t* x = operands_.empty() ? nullptr : &operands_[0];
+    for (std::size_t i = first; i < last; ++i) {
+        const Operation& op = schedule_[i];
+        double* d = A + op.data;
+        switch (op.code) {
+        case OpCode::Gain:
+            s[op.block] = d[0] * s[op.in];
+            break;
+        case OpCode::Sum: {
+            const std::size_t* in = x + op.in;
+            double acc = 0.0;
+            for (std::size_t j = 0; j < op.count; ++j) {
+                acc += d[j] * s[in[j]];
+            }
+            s[op.block] = acc;
+            break;
+        }
+        case OpCode::Tf: {
+            const double u = s[op.in];
+            const double y = tfResponse(d, op.count, op.order, u, true);
+            tfPush(d, op.count, op.order, u, y);
+            s[op.block] = y;
+            break;
+        }
+        case OpCode::TfUpdate:
+            tfPush(d, op.count, op.order, s[op.in], s[op.block]);
+            break;
+        case OpCode::DelayUpdate:
+            d[0] = s[op.in];
+            break;
+        case OpCode::Saturation: {
+            const double u = s[op.in];
+            s[op.block] = u < d[0] ? d[0] : (u > d[1] ? d[1] : u);
+            break;
+        }
+        case OpCode::TfOutput:
+        case OpCode::DelayOutput:
+            break;
+        }
+    }
+}
+
+BlockId CompiledGraph::find(const std::string& name) const {
+    for (std::size_t v = 0; v < names_.size(); ++v) {
+        if (names_[v] == name) {
+            return v;
+        }
+    }
+    return kNone;
+}
+
+/*========================================================================*/
+/*                          GRAFO DEL LAZO                                */
+/*========================================================================*/
+
+SystemGraph makeLoopGraph(const Controlador::PIDController& pid,
+                          const DiscreteSystems::TransferFunctionSystem& plant) {
+    SystemGraph g(pid.getSamplingTime());
+    const BlockId r = g.addInput("r");
+    const BlockId c = g.addPID("pid", pid);
+    const BlockId dac = g.addGain("dac", 1.0);
+    const BlockId p = g.addSystem("planta", plant);
+    const BlockId adc = g.addDelay("adc");
+    g.feedback("e", r, c, adc);
+    g.series(g.series(g.series(c, dac), p), adc);
+    return g;
+}
+
+
+/*========================================================================*/
+/*                              FUSIÓN                                    */
+/*========================================================================*/
+
+namespace {
+
+/**
+ * @struct Absorbed
+ * @brief Bloque absorbido: función de transferencia desde la entrada del bloque fusionado hasta él
+ */
+struct Absorbed {
+    BlockId id;
+    std::vector<double> b, a;
+};
+
+} // namespace
+
+Fusion fuse(const SystemGraph& graph, const std::vector<BlockId>& observe, std::size_t maxOrder) {
+    typedef SystemGraph::Block Block;
+    const std::size_t n = graph.blocks_.size();
+    for (std::size_t i = 0; i < observe.size(); ++i) {
+        graph.checkId(observe[i]);
+    }
+
+    // Copia de trabajo con los bloques LTI como funciones de transferencia;
+    // cada bloque vivo lleva la lista de los que absorbió
+    std::vector<Block> blocks = graph.blocks_;
+    std::vector<bool> alive(n, true);
+    std::vector<bool> touched(n, false);
+    std::vector<bool> lti(n, false);
+    std::vector<std::vector<Absorbed> > absorbed(n);
+    for (std::size_t v = 0; v < n; ++v) {
+        lti[v] = graph.isLTI(v);
+        if (lti[v]) {
+            graph.transferFunction(v, blocks[v].b, blocks[v].a);
+            blocks[v].kind = BlockKind::TransferFunction;
+        }
+    }
+    auto consumers = [&](BlockId u) {
+        std::size_t c = 0;
+        for (std::size_t v = 0; v < n; ++v) {
+            if (!alive[v]) {
+                continue;
+            }
+            for (std::size_t i = 0; i < blocks[v].inputs.size(); ++i) {
+                c += blocks[v].inputs[i].first == u ? 1 : 0;
+            }
+        }
+        return c;
+    };
+    // Retira u y devuelve lo que había absorbido más él mismo, referidos a la entrada de u
+    auto absorb = [&](BlockId u) {
+        std::vector<Absorbed> moved = absorbed[u];
+        Absorbed self = {u, blocks[u].b, blocks[u].a};
+        moved.push_back(self);
+        absorbed[u].clear();
+        alive[u] = false;
+        return moved;
+    };
+
+    Fusion result(graph.Ts_);
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        // Serie u → v
+        for (BlockId v = 0; v < n; ++v) {
+            if (!alive[v] || !lti[v]) {
+                continue;
+            }
+            const BlockId u = blocks[v].inputs.empty() ? kNone : blocks[v].inputs[0].first;
+            if (u == kNone || u == v || !lti[u] || blocks[u].inputs.empty()
+                || blocks[u].inputs[0].first == v || consumers(u) != 1) {
+                continue;
+            }
+            std::vector<double> b = DiscreteSystems::Polynomial::multiply(blocks[u].b, blocks[v].b);
+            std::vector<double> a = DiscreteSystems::Polynomial::multiply(blocks[u].a, blocks[v].a);
+            if (tfOrder(b, a) > maxOrder) {
+                continue;
+            }
+            for (std::size_t i = 0; i < absorbed[v].size(); ++i) {
+                Absorbed& m = absorbed[v][i];
+                m.b = DiscreteSystems::Polynomial::multiply(blocks[u].b, m.b);
+                m.a = DiscreteSystems::Polynomial::multiply(blocks[u].a, m.a);
+            }
+            std::vector<Absorbed> moved = absorb(u);
+            absorbed[v].insert(absorbed[v].begin(), moved.begin(), moved.end());
+            blocks[v].b.swap(b);
+            blocks[v].a.swap(a);
+            blocks[v].inputs = blocks[u].inputs;
+            touched[v] = true;
+            ++result.merged;
+            changed = true;
+        }
+
+        // Paralelo x → {H_i} → Σ w_i·H_i
+        for (BlockId s = 0; s < n; ++s) {
+            const std::vector<std::pair<BlockId, double> >& in = blocks[s].inputs;
+            if (!alive[s] || blocks[s].kind != BlockKind::Sum || in.size() < 2) {
+                continue;
+            }
+            bool fusable = true;
+            const BlockId x = blocks[in[0].first].inputs.empty() ? kNone : blocks[in[0].first].inputs[0].first;
+            for (std::size_t i = 0; i < in.size() && fusable; ++i) {
+                const BlockId c = in[i].first;
+                fusable = c != s && lti[c] && !blocks[c].inputs.empty() && blocks[c].inputs[0].first == x
+                       && x != s && consumers(c) == 1;
+            }
+            if (!fusable) {
+                continue;
+            }
+            std::vector<double> a(1, 1.0);
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                a = DiscreteSystems::Polynomial::multiply(a, blocks[in[i].first].a);
+            }
+            std::vector<double> b;
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                std::vector<double> term = blocks[in[i].first].b;
+                for (std::size_t j = 0; j < term.size(); ++j) {
+                    term[j] *= in[i].second;
+                }
+                for (std::size_t j = 0; j < in.size(); ++j) {
+                    if (j != i) {
+                        term = DiscreteSystems::Polynomial::multiply(term, blocks[in[j].first].a);
+                    }
+                }
+                b = addPolynomials(b, term);
+            }
+            if (tfOrder(b, a) > maxOrder) {
+                continue;
+            }
+            for (std::size_t i = 0; i < in.size(); ++i) {
+                std::vector<Absorbed> moved = absorb(in[i].first);
+                absorbed[s].insert(absorbed[s].end(), moved.begin(), moved.end());
+            }
+            result.merged += in.size();
+            blocks[s].kind = BlockKind::TransferFunction;
+            blocks[s].b.swap(b);
+            blocks[s].a.swap(a);
+            blocks[s].inputs.assign(1, std::make_pair(x, 1.0));
+            lti[s] = true;
+            touched[s] = true;
+            changed = true;
+        }
+    }
+
+    // Grafo reducido en orden de declaración (los bloques intactos conservan
+    // su tipo) y, al final, las sondas
+    result.map.assign(n, kNone);
+    std::vector<Block>& out = result.graph.blocks_;
+    for (BlockId v = 0; v < n; ++v) {
+        if (alive[v]) {
+            result.map[v] = out.size();
+            out.push_back(touched[v] ? blocks[v] : graph.blocks_[v]);
+        }
+    }
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        for (std::size_t j = 0; j < out[i].inputs.size(); ++j) {
+            out[i].inputs[j].first = result.map[out[i].inputs[j].first];
+        }
+    }
+    for (BlockId v = 0; v < n; ++v) {
+        for (std::size_t i = 0; i < absorbed[v].size(); ++i) {
+            const Absorbed& m = absorbed[v][i];
+            if (std::find(observe.begin(), observe.end(), m.id) == observe.end()) {
+                continue;
+            }
+            Block probe;
+            probe.kind = BlockKind::TransferFunction;
+            probe.name = graph.blocks_[m.id].name;
+            probe.b = m.b;
+            probe.a = m.a;
+            probe.value = 0.0;
+            probe.inputs.assign(1, std::make_pair(result.map[blocks[v].inputs[0].first], 1.0));
+            result.map[m.id] = out.size();
+            result.probes.push_back(out.size());
+            out.push_back(probe);
+        }
+    }
+    return result;
+}
+
+DiscreteSystems::TransferFunctionSystem toSystem(const SystemGraph& graph, BlockId id,
+                                                 DiscreteSystems::FilterStructure structure,
+                                                 std::size_t bufferSize) {
+    std::vector<double> b, a;
+    graph.transferFunction(id, b, a);
+    return DiscreteSystems::TransferFunctionSystem(b, a, graph.getSamplingTime(), bufferSize, structure);
+}
+
+} // namespace Grafo
@@ -0,0 +1,444 @@
+/**
+ * @file main.cpp
+ * @brief Simulación headless del lazo cerrado más rápida que el tiempo real
+ *
+ * Uso: control_system [-t segundos] [-r escalon|rampa|seno] [-m rapido|hilos|unhilo]
+ *                       [-f perfil.bin] [-o fichero.tsv] [-g fichero.rec] [-s] [-p /segmento]
+ *                       [-R] [-c cpu,cpu,...] [-x traza.json]
+ *
+ * - -t: tiempo de planta a simular en segundos (por defecto 3600)
+ * - -r: señal de referencia (por defecto escalon)
+ * - -f: reproduce como referencia un perfil binario de double muestreado a
+ *       Ts (RefSignal::TableSignal, proyectado en memoria); sustituye a -r
+ * - -m: rapido (sin esperas, por defecto), hilos (un hilo por bloque a
+ *       ritmo Ts) o unhilo (toda la cadena en un hilo a ritmo Ts)
+ * - -o: activa el modo registro y vuelca el buffer final de la planta
+ *       (sólo en modo rapido); .npy, .mat y .bin se escriben en binario,
+ *       cualquier otra extensión en TSV
+ * - -g: graba u(k) e y(k) de todos los ticks, en cualquier modo y sin el
+ *       límite del buffer, con DiscreteSystems::StreamRecorder (un hilo
+ *       escritor vuelca a disco); .gz se comprime si hay zlib
+ * - -s: instrumenta los bloques e imprime latencias y plazos perdidos
+ * - -p: publica cada tick en el segmento de memoria compartida indicado
+ *       (Telemetria::TelemetryReader para leerlo) y aplica los comandos
+ *       recibidos por su buzón (SetReferenceOffset sólo en modo rapido)
+ * - -R: endurece los hilos de control (TiempoReal::RuntimeConfig::hardened():
+ *       mlockall, SCHED_FIFO, pila prefallada, calentamiento y vigilancia
+ *       de reservas); sólo en los modos de tiempo real
+ * - -c: CPU de cada hilo de control (hilos: Ref, PID, DAC, Planta, ADC;
+ *       unhilo: la cadena); -1 deja un hilo sin fijar
+ * - -x: traza los hilos de control y el observador (Traza::Tracer) y guarda
+ *       la traza en formato JSON de Chrome (chrome://tracing,
+ *       ui.perfetto.dev); sólo en los modos de tiempo real
+ *
+ * En modo rapido el lazo se ejecuta sin esperas ni E/S por tick; al terminar
+ * se imprime un resumen con el factor de aceleración respecto al tiempo real
+ * y las métricas de respuesta (Metricas::StepResponse, calculadas en línea).
+ * En los modos de tiempo real se imprimen además los plazos perdidos y el
+ * mayor retraso del temporizador y, con -R o -c, las reservas detectadas en
+ * los hilos de control y los pasos que el sistema rechazó (p. ej. SCHED_FIFO
+ * sin privilegios).
+ */
+
+#include <DiscreteSystems/StreamRecorder.h>
+#include <instrumentacion.h>
+#include <lazo.h>
+#include <metricas.h>
+#include <telemetria.h>
+#include <tiempo_real.h>
+#include <traza.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const double Ts = 0.01;     ///< Período de muestreo común [s]
+const double Kp = 2.0;      ///< Ganancia proporcional
+const double Ki = 4.0;      ///< Ganancia integral
+const double Kd = 0.01;     ///< Ganancia derivativa
+
+/// Buffer del Tracer que usa el observador (0...4: hilos del Pipeline)
+const std::size_t kObserverBuffer = 5;
+
+/// Pista del observador en la traza (0...5: pistas del Pipeline)
+const std::uint16_t kObserverTrack = 6;
+
+/// Ticks entre dos recogidas de la traza desde el observador
+const std::size_t kTraceCollectEvery = 1024;
+
+/** @brief Sin instrumentación no hay nada que informar */
+template <class Loop>
+void report(Loop&, Instrumentacion::Disabled) {}
+
+/** @brief Imprime las estadísticas de latencia de cada bloque */
+template <class Loop>
+void report(Loop& loop, Instrumentacion::Enabled) {
+    std::cout << "Ref:    " << loop.ref().probe().stats() << "\n";
+    std::cout << "PID:    " << loop.pid().probe().stats() << "\n";
+    std::cout << "DAC:    " << loop.dac().probe().stats() << "\n";
+    std::cout << "Planta: " << loop.plant().probe().stats() << "\n";
+    std::cout << "ADC:    " << loop.adc().probe().stats() << "\n";
+}
+
+/**
+ * @brief Formato de volcado según la extensión (.npy, .mat, .bin; TSV en otro caso)
+ */
+DiscreteSystems::ExportFormat exportFormat(const std::string& path) {
+    const std::string::size_type dot = path.rfind('.');
+    const std::string ext = (dot == std::string::npos) ? std::string() : path.substr(dot);
+    if (ext == ".npy") {
+        return DiscreteSystems::ExportFormat::NPY;
+    } else if (ext == ".mat") {
+        return DiscreteSystems::ExportFormat::MAT;
+    } else if (ext == ".bin") {
+        return DiscreteSystems::ExportFormat::RAW;
+    }
+    return DiscreteSystems::ExportFormat::TSV;
+}
+
+/**
+ * @brief Tiempo de respuesta como texto ("n/d" si no está definido)
+ */
+std::string orNa(double t) {
+    if (std::isnan(t)) {
+        return "n/d";
+    }
+    std::ostringstream os;
+    os << std::fixed << std::setprecision(6) << t;
+    return os.str();
+}
+
+/**
+ * @brief Aplica un comando del buzón de telemetría al lazo
+ *
+ * Las ganancias se publican sin bloqueo y el PID las adopta en su siguiente
+ * tick, también desde otro hilo; el desplazamiento de la referencia sólo
+ * puede cambiarse desde el hilo que la evalúa (modo rapido).
+ *
+ * @param realTime true si los bloques corren en otros hilos
+ * @return false si el comando no es reconocido o no se puede aplicar
+ */
+template <class Loop>
+bool apply(Loop& loop, const Telemetria::Command& cmd, bool realTime) {
+    switch (cmd.type) {
+    case Telemetria::CommandType::SetGains:
+        loop.pid().setGains(cmd.values[0], cmd.values[1], cmd.values[2]);
+        return true;
+    case Telemetria::CommandType::SetReferenceOffset:
+        if (realTime) {
+            return false;
+        }
+        loop.ref().offset() = cmd.values[0];
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Ejecuta la simulación con una referencia concreta e imprime el resumen
+ * @param ref Señal de referencia
+ * @param seconds Tiempo de planta a simular [s]
+ * @param realTime true para ejecutar con TiempoReal::Pipeline a ritmo Ts
+ * @param mode Reparto de bloques entre hilos en tiempo real
+ * @param output Fichero para el buffer de la planta (vacío: sin registro)
+ * @param segment Segmento de telemetría (vacío: sin publicar)
+ * @param record Fichero de grabación continua (vacío: sin grabar)
+ * @param runtime Endurecimiento de los hilos de control en tiempo real
+ * @param trace Fichero de la traza de eventos (vacío: sin trazar)
+ * @tparam Policy Instrumentacion::Enabled o Instrumentacion::Disabled
+ * @return Código de salida del programa
+ */
+template <class Policy, class Ref>
+int simulate(const Ref& ref, double seconds, bool realTime, TiempoReal::Mode mode,
+             const std::string& output, const std::string& segment, const std::string& record,
+             const TiempoReal::RuntimeConfig& runtime, const std::string& trace) {
+    using Instrumentacion::Instrumented;
+    auto loop = Lazo::makeLoop(Instrumented<Ref, Policy>(ref),
+                               Instrumented<Controlador::PIDController, Policy>(Kp, Ki, Kd, Ts),
+                               Instrumented<Convertidores::DAConverter, Policy>(Ts),
+                               Instrumented<Planta::Sistema, Policy>(Ts),
+                               Instrumented<Convertidores::ADConverter, Policy>(Ts));
+    loop.setRecording(!output.empty());
+
+    const std::size_t K = static_cast<std::size_t>(std::llround(seconds / Ts));
+    Metricas::StepResponse metrics(Ts);
+    Lazo::TickData last = Lazo::TickData();
+
+    std::unique_ptr<Telemetria::TelemetryWriter> telemetry;
+    if (!segment.empty()) {
+        telemetry.reset(new Telemetria::TelemetryWriter(segment, Ts));
+    }
+    std::size_t commands = 0, ignored = 0;
+
+    std::unique_ptr<DiscreteSystems::StreamRecorder> recorder;
+    if (!record.empty()) {
+        const bool gz = record.size() > 3 && record.compare(record.size() - 3, 3, ".gz") == 0;
+        recorder.reset(new DiscreteSystems::StreamRecorder(
+            record, 65536, 8, DiscreteSystems::DropPolicy::DropNewest,
+            gz ? DiscreteSystems::Compression::Gzip : DiscreteSystems::Compression::None));
+    }
+
+    // Un buffer por hilo del Pipeline y otro para el observador
+    std::unique_ptr<Traza::Tracer> tracer;
+    Traza::TraceBuffer* observerTrace = nullptr;
+    if (!trace.empty()) {
+        tracer.reset(new Traza::Tracer(kObserverBuffer + 1));
+        tracer->nameThread(kObserverBuffer, "Observador");
+        tracer->nameTrack(kObserverTrack, "observador");
+        observerTrace = &tracer->buffer(kObserverBuffer);
+    }
+
+    // Lazo que ejecuta los bloques: el Pipeline trabaja sobre su propia copia
+    decltype(&loop) active = &loop;
+
+    auto observer = [&](const Lazo::TickData& d) {
+        const std::uint64_t tick = static_cast<std::uint64_t>(d.k);
+        if (observerTrace) {
+            observerTrace->record(Traza::EventKind::Begin, kObserverTrack, tick);
+        }
+        metrics.update(d.r, d.y);
+        last = d;
+        if (recorder) {
+            recorder->append(static_cast<int>(d.k), d.u, d.y);
+        }
+        if (telemetry) {
+            telemetry->publish(d);
+            Telemetria::Command cmd;
+            while (telemetry->pollCommand(cmd)) {
+                if (apply(*active, cmd, realTime)) {
+                    ++commands;
+                    if (observerTrace) {
+                        // Marca del comando aplicado (valor: su tipo)
+                        observerTrace->record(Traza::EventKind::Instant, kObserverTrack, tick,
+                                              static_cast<double>(static_cast<int>(cmd.type)));
+                    }
+                } else {
+                    ++ignored;
+                }
+            }
+        }
+        if (observerTrace) {
+            observerTrace->record(Traza::EventKind::End, kObserverTrack, tick);
+            if (tick % kTraceCollectEvery == 0) {
+                tracer->collect();
+            }
+        }
+        return std::isfinite(d.y);
+    };
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::size_t ticks = 0;
+    TiempoReal::Stats st = TiempoReal::Stats();
+    if (realTime) {
+        TiempoReal::Pipeline<decltype(loop)> pipe(loop, Ts, mode);
+        pipe.setRuntimeConfig(runtime);
+        pipe.setTracer(tracer.get());
+        active = &pipe.loop();
+        st = pipe.run(K, observer);
+        ticks = pipe.getK();
+        report(pipe.loop(), Policy());
+    } else {
+        loop.run(K, observer);
+        ticks = loop.getK();
+        report(loop, Policy());
+    }
+    if (recorder) {
+        recorder->close();
+    }
+    if (tracer) {
+        tracer->save(trace);
+    }
+    const auto t1 = std::chrono::steady_clock::now();
+    const double wall = std::chrono::duration<double>(t1 - t0).count();
+
+    std::cout << std::fixed << std::setprecision(6);
+    std::cout << "Ticks:               " << ticks << "\n";
+    std::cout << "Tiempo simulado [s]: " << ticks * Ts << "\n";
+    std::cout << "Tiempo real [s]:     " << wall << "\n";
+    if (wall > 0.0) {
+        std::cout << "Aceleración:         " << std::setprecision(0)
+                  << ticks * Ts / wall << "x\n" << std::setprecision(6);
+    }
+    if (realTime) {
+        std::cout << "Plazos perdidos:     " << st.overruns << "\n";
+        std::cout << "Retraso máx. [us]:   " << st.maxLatenessNs / 1000 << "\n";
+        std::cout << "Ticks descartados:   " << st.dropped << "\n";
+        if (runtime.tripwire != TiempoReal::Tripwire::Off) {
+            std::cout << "Reservas en hilos:   " << st.allocations << "\n";
+        }
+        if (st.rejected != 0) {
+            std::cout << "Pasos rechazados:   "
+                      << (st.rejected & TiempoReal::kRejectedLockMemory ? " mlockall" : "")
+                      << (st.rejected & TiempoReal::kRejectedAffinity ? " afinidad" : "")
+                      << (st.rejected & TiempoReal::kRejectedPriority ? " SCHED_FIFO" : "")
+                      << (st.rejected & TiempoReal::kRejectedTripwire ? " vigilancia" : "") << "\n";
+        }
+    }
+    if (telemetry) {
+        std::cout << "Ticks publicados:    " << telemetry->published() << "\n";
+        std::cout << "Comandos aplicados:  " << commands << "\n";
+        std::cout << "Comandos ignorados:  " << ignored << "\n";
+    }
+    if (recorder) {
+        std::cout << "Muestras grabadas:   " << recorder->written() << "\n";
+        std::cout << "Muestras perdidas:   " << recorder->dropped() << "\n";
+    }
+    if (tracer) {
+        std::cout << "Eventos trazados:    " << tracer->size() << "\n";
+        std::cout << "Eventos perdidos:    " << tracer->dropped() << "\n";
+    }
+    std::cout << "r final:             " << last.r << "\n";
+    std::cout << "y final:             " << last.y << "\n";
+    const Metricas::Summary m = metrics.summary();
+    std::cout << "IAE:                 " << m.iae << "\n";
+    std::cout << "ISE:                 " << m.ise << "\n";
+    std::cout << "ITAE:                " << m.itae << "\n";
+    std::cout << "Sobreoscilación [%]: " << m.overshoot << "\n";
+    std::cout << "Subida [s]:          " << orNa(m.riseTime) << "\n";
+    std::cout << "Establecimiento [s]: " << orNa(m.settlingTime) << "\n";
+    std::cout << "Error estacionario:  " << m.steadyStateError << "\n";
+
+    if (recorder && recorder->failed()) {
+        std::cerr << "StreamRecorder: error al escribir '" << record << "'\n";
+        return 1;
+    }
+
+    if (!output.empty()) {
+        try {
+            loop.plant().bufferDump(output, exportFormat(output));
+        } catch (const DiscreteSystems::ExportError& ex) {
+            std::cerr << ex.what() << "\n";
+            return 1;
+        }
+    }
+    return std::isfinite(last.y) ? 0 : 1;
+}
+
+/**
+ * @brief Elige en tiempo de ejecución la instanciación con o sin instrumentación
+ */
+template <class Ref>
+int run(const Ref& ref, bool instrument, double seconds, bool realTime,
+        TiempoReal::Mode mode, const std::string& output, const std::string& segment,
+        const std::string& record, const TiempoReal::RuntimeConfig& runtime, const std::string& trace) {
+    try {
+        if (instrument) {
+            return simulate<Instrumentacion::Enabled>(ref, seconds, realTime, mode, output, segment, record, runtime, trace);
+        }
+        return simulate<Instrumentacion::Disabled>(ref, seconds, realTime, mode, output, segment, record, runtime, trace);
+    } catch (const std::exception& ex) {
+        std::cerr << ex.what() << "\n";
+        return 1;
+    }
+}
+
+void usage(const char* prog) {
+    std::cerr << "Uso: " << prog << " [-t segundos] [-r escalon|rampa|seno]"
+              << " [-m rapido|hilos|unhilo] [-f perfil.bin] [-o fichero.tsv] [-g fichero.rec] [-s] [-p /segmento]"
+              << " [-R] [-c cpu,cpu,...] [-x traza.json]\n";
+}
+
+/**
+ * @brief Lee una lista de CPU separadas por comas
+ * @return false si algún elemento no es un entero
+ */
+bool parseCpus(const std::string& text, std::vector<int>& cpus) {
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        const long cpu = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0') {
+            return false;
+        }
+        cpus.push_back(static_cast<int>(cpu));
+    }
+    return !cpus.empty();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    double seconds = 3600.0;
+    std::string signal = "escalon";
+    std::string mode = "rapido";
+    std::string output;
+    std::string segment;
+    std::string profile;
+    std::string record;
+    std::string trace;
+    bool instrument = false;
+    bool hardened = false;
+    std::vector<int> cpus;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            signal = argv[++i];
+        } else if (std::strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            mode = argv[++i];
+        } else if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (std::strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+            profile = argv[++i];
+        } else if (std::strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+            record = argv[++i];
+        } else if (std::strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            segment = argv[++i];
+        } else if (std::strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+            trace = argv[++i];
+        } else if (std::strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            if (!parseCpus(argv[++i], cpus)) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "-s") == 0) {
+            instrument = true;
+        } else if (std::strcmp(argv[i], "-R") == 0) {
+            hardened = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    const bool realTime = (mode != "rapido");
+    if (seconds <= 0.0 || (mode != "rapido" && mode != "hilos" && mode != "unhilo")
+        || (realTime && !output.empty()) || (!realTime && (hardened || !cpus.empty() || !trace.empty()))) {
+        usage(argv[0]);
+        return 1;
+    }
+    const TiempoReal::Mode rtMode = (mode == "unhilo") ? TiempoReal::Mode::SingleThread
+                                                       : TiempoReal::Mode::Threaded;
+    TiempoReal::RuntimeConfig runtime = hardened ? TiempoReal::RuntimeConfig::hardened()
+                                                 : TiempoReal::RuntimeConfig();
+    runtime.cpus = cpus;
+
+    if (!profile.empty()) {
+        try {
+            return run(RefSignal::TableSignal(Ts, profile), instrument, seconds, realTime, rtMode,
+                       output, segment, record, runtime, trace);
+        } catch (const std::exception& ex) {
+            std::cerr << ex.what() << "\n";
+            return 1;
+        }
+    }
+    if (signal == "escalon") {
+        return run(RefSignal::StepSignal(Ts, 1.0, 0.0), instrument, seconds, realTime, rtMode, output, segment, record, runtime, trace);
+    } else if (signal == "rampa") {
+        return run(RefSignal::RampSignal(Ts, 0.1, 0.0), instrument, seconds, realTime, rtMode, output, segment, record, runtime, trace);
+    } else if (signal == "seno") {
+        return run(RefSignal::SineSignal(Ts, 1.0, 0.2), instrument, seconds, realTime, rtMode, output, segment, record, runtime, trace);
+    }
+    usage(argv[0]);
+    return 1;
+}
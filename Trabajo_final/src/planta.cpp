@@ -16,4 +16,14 @@ Sistema::Sistema(double Tp, size_t bufferSize)
     )
 {}
 
+Sistema::Sistema(const std::vector<double>& b, const std::vector<double>& a, double Tp, size_t bufferSize)
+    : TransferFunctionSystem(b, a, Tp, bufferSize)
+{}
+
+Sistema Sistema::tustin(double Tp, size_t bufferSize) {
+    const double tau = 0.5;                  // constante de tiempo de G(s)
+    const double d = Tp + 2.0 * tau;
+    return Sistema({Tp / d, Tp / d}, {1.0, (Tp - 2.0 * tau) / d}, Tp, bufferSize);
+}
+
 } // namespace Planta
@@ -5,13 +5,146 @@
 
 #include "ref.h"
 
+#include <DiscreteSystems/Checkpoint.h>
+#include <DiscreteSystems/Exceptions.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <limits>
 #include <stdexcept>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 namespace RefSignal {
 
     /// Constante 2π para cálculos trigonométricos
     static constexpr double TWO_PI = 6.28318530717958647692;
 
+    /// Carriles de los bucles de generate()
+    static constexpr std::size_t LANES = 8;
+
+    /// k = kb + LANE[j] es exacto (enteros < 2^53) y evita convertir size_t
+    /// a double en cada muestra, que no se vectoriza sin AVX-512
+    static const double LANE[LANES] = {0.0, 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0};
+
+    /// Muestras entre reanclajes del oscilador de addSine()
+    static constexpr std::size_t SINE_ANCHOR = 256;
+
+    /// Tolerancia relativa para tratar (time / tableTs) como índice entero
+    static constexpr double TABLE_SNAP = 1e-9;
+
+    /**
+     * @brief out[i] = f(out[i], time) con time = (k0 + i) * Ts - shift.
+     *
+     * Núcleo común de los generate(): bloques de LANES muestras sin
+     * conversiones entero→real que el compilador vectoriza.
+     */
+    template <class F>
+    static void forEachTime(double* out, std::size_t n, std::size_t k0,
+                            double Ts, double shift, F f) {
+        std::size_t i = 0;
+        for (; i + LANES <= n; i += LANES) {
+            const double kb = static_cast<double>(k0 + i);
+            for (std::size_t j = 0; j < LANES; ++j) {
+                const double time = (kb + LANE[j]) * Ts - shift;
+                out[i + j] = f(out[i + j], time);
+            }
+        }
+        for (; i < n; ++i) {
+            const double time = static_cast<double>(k0 + i) * Ts - shift;
+            out[i] = f(out[i], time);
+        }
+    }
+
+    /**
+     * @brief out[i] += a * sin(2π f time + phase) con time = (k0 + i) * Ts - shift.
+     *
+     * Ocho osciladores de rotación desfasados una muestra; cada SINE_ANCHOR
+     * muestras se reanclan con la fase exacta para que el error no crezca.
+     */
+    static void addSine(double* out, std::size_t n, std::size_t k0, double Ts, double shift,
+                        double a, double freq, double phase) {
+        const double delta = TWO_PI * freq * Ts;
+
+        // Rotaciones de j muestras (desfase de cada carril) y de LANES muestras (avance)
+        double wc[LANES], ws[LANES];
+        for (std::size_t j = 0; j < LANES; ++j) {
+            wc[j] = std::cos(static_cast<double>(j) * delta);
+            ws[j] = std::sin(static_cast<double>(j) * delta);
+        }
+        const double stepC = std::cos(static_cast<double>(LANES) * delta);
+        const double stepS = std::sin(static_cast<double>(LANES) * delta);
+
+        for (std::size_t b = 0; b < n; b += SINE_ANCHOR) {
+            const std::size_t m = std::min(SINE_ANCHOR, n - b);
+
+            // Reanclaje con la misma fase que computeAt()
+            const double theta = TWO_PI * freq * (static_cast<double>(k0 + b) * Ts - shift) + phase;
+            const double c0 = std::cos(theta), s0 = std::sin(theta);
+            double c[LANES], s[LANES];
+            for (std::size_t j = 0; j < LANES; ++j) {
+                c[j] = c0 * wc[j] - s0 * ws[j];
+                s[j] = s0 * wc[j] + c0 * ws[j];
+            }
+
+            std::size_t i = 0;
+            for (; i + LANES <= m; i += LANES) {
+                for (std::size_t j = 0; j < LANES; ++j) {
+                    out[b + i + j] += a * s[j];
+                    const double cn = c[j] * stepC - s[j] * stepS;
+                    s[j] = s[j] * stepC + c[j] * stepS;
+                    c[j] = cn;
+                }
+            }
+            for (std::size_t j = 0; i < m; ++i, ++j) {
+                out[b + i] += a * s[j];
+            }
+        }
+    }
+
+    /**
+     * @brief Valor de una tabla muestreada cada tableTs en el instante time.
+     *
+     * Fuera de la tabla mantiene el primer o el último valor. Si time cae
+     * sobre una muestra (salvo TABLE_SNAP), devuelve la muestra exacta.
+     */
+    static double tableAt(const double* data, std::size_t size, double tableTs,
+                          Interpolation interp, double time) {
+        const double x = time / tableTs;
+        if (!(x > 0.0)) {
+            return data[0];
+        }
+        const double last = static_cast<double>(size - 1);
+        if (x >= last) {
+            return data[size - 1];
+        }
+        const double r = std::floor(x + 0.5);
+        if (std::fabs(x - r) <= TABLE_SNAP * (1.0 + r)) {
+            return data[static_cast<std::size_t>(r)];
+        }
+        const std::size_t i = static_cast<std::size_t>(x);
+        if (interp == Interpolation::Hold) {
+            return data[i];
+        }
+        const double f = x - static_cast<double>(i);
+        return data[i] + f * (data[i + 1] - data[i]);
+    }
+
+    /**
+     * @brief Libera la proyección de un fichero de TableSignal.
+     */
+    struct MappingDeleter {
+        std::size_t bytes;
+        void operator()(const void* addr) const {
+            munmap(const_cast<void*>(addr), bytes);
+        }
+    };
+
     /*========================================================================*/
     /*                     CLASE BASE: Signal                                 */
     /*========================================================================*/
@@ -19,25 +152,54 @@ namespace RefSignal {
     /**
      * @brief Añade un par (time, value) al buffer circular.
      *
-     * Si el buffer está lleno, elimina el elemento más antiguo.
+     * Si el buffer está lleno, sobrescribe el elemento más antiguo.
      */
     void Signal::addToBuffer(double time, double value) {
-        if (time_buffer_.size() >= buffer_size_) {
-            time_buffer_.pop_front();
-            value_buffer_.pop_front();
+        if (buffer_size_ != capacity_) {
+            resizeBuffer();
+        }
+        time_buffer_[head_] = time;
+        time_buffer_[head_ + capacity_] = time;
+        value_buffer_[head_] = value;
+        value_buffer_[head_ + capacity_] = value;
+        head_ = (head_ + 1 == capacity_) ? 0 : head_ + 1;
+        if (count_ < capacity_) {
+            ++count_;
         }
-        time_buffer_.push_back(time);
-        value_buffer_.push_back(value);
+    }
+
+    void Signal::resizeBuffer() {
+        if (buffer_size_ == 0) {
+            throw std::invalid_argument("Signal: buffer_size debe ser >= 1");
+        }
+        const std::size_t keep = std::min(count_, buffer_size_);
+        std::vector<double> times(2 * buffer_size_, 0.0);
+        std::vector<double> values(2 * buffer_size_, 0.0);
+        if (keep > 0) {
+            const double* t = timeBuffer().end() - keep;
+            const double* v = valueBuffer().end() - keep;
+            for (std::size_t i = 0; i < keep; ++i) {
+                times[i] = times[i + buffer_size_] = t[i];
+                values[i] = values[i + buffer_size_] = v[i];
+            }
+        }
+        time_buffer_.swap(times);
+        value_buffer_.swap(values);
+        capacity_ = buffer_size_;
+        count_ = keep;
+        head_ = keep % capacity_;
     }
 
     Signal::Signal(double Ts, double offset, std::size_t buffer_size)
-        : Ts_(Ts), offset_(offset), t_(0.0), buffer_size_(buffer_size) {
+        : Ts_(Ts), offset_(offset), t_(0.0), k_(0), buffer_size_(buffer_size),
+          capacity_(0), head_(0), count_(0) {
         if (Ts_ <= 0.0) {
             throw std::invalid_argument("Signal: Ts debe ser > 0");
         }
         if (buffer_size_ == 0) {
             throw std::invalid_argument("Signal: buffer_size debe ser >= 1");
         }
+        resizeBuffer();
     }
 
     double Signal::compute() const {
@@ -52,14 +214,99 @@ namespace RefSignal {
     double Signal::next() {
         double value = compute();
         addToBuffer(t_, value);
-        t_ += Ts_;
+        if (t_ == static_cast<double>(k_) * Ts_) {
+            t_ = static_cast<double>(++k_) * Ts_;
+        } else {
+            t_ += Ts_;
+        }
         return value;
     }
 
+    void Signal::generate(double* out, std::size_t n, std::size_t k0) const {
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] = computeAt(static_cast<double>(k0 + i) * Ts_);
+        }
+    }
+
+    void Signal::hold(std::size_t n, double value) {
+        // Las muestras que no caben en el buffer sólo avanzan el tiempo
+        const std::size_t kept = std::min(n, buffer_size_);
+        const std::size_t gap = n - kept;
+        if (t_ == static_cast<double>(k_) * Ts_) {
+            k_ += gap;
+            t_ = static_cast<double>(k_) * Ts_;
+        } else {
+            t_ += static_cast<double>(gap) * Ts_;
+        }
+        for (std::size_t i = 0; i < kept; ++i) {
+            addToBuffer(t_, value);
+            if (t_ == static_cast<double>(k_) * Ts_) {
+                t_ = static_cast<double>(++k_) * Ts_;
+            } else {
+                t_ += Ts_;
+            }
+        }
+    }
+
+    double Signal::constantUntil(double time) const {
+        return time;
+    }
+
     void Signal::reset() {
         t_ = 0.0;
-        time_buffer_.clear();
-        value_buffer_.clear();
+        k_ = 0;
+        head_ = 0;
+        count_ = 0;
+    }
+
+    void Signal::checkpoint(DiscreteSystems::CheckpointWriter& w) const {
+        w.begin(DiscreteSystems::checkpointTag('S', 'I', 'G', 'N'), 1);
+        w.writeF64(Ts_);
+        w.writeF64(t_);
+        w.writeU64(k_);
+        w.writeU64(buffer_size_);
+        if (w.buffers()) {
+            const BufferView times = timeBuffer();
+            w.writeArray(times.data(), times.size());
+            const BufferView values = valueBuffer();
+            w.writeArray(values.data(), values.size());
+        }
+        w.end();
+    }
+
+    void Signal::restore(DiscreteSystems::CheckpointReader& r) {
+        r.begin(DiscreteSystems::checkpointTag('S', 'I', 'G', 'N'), 1);
+        if (r.readF64() != Ts_) {
+            throw DiscreteSystems::CheckpointError("Signal: el período de la instantánea no coincide con el de la señal");
+        }
+        const double t = r.readF64();
+        const std::size_t k = static_cast<std::size_t>(r.readU64());
+        const std::size_t size = static_cast<std::size_t>(r.readU64());
+        std::vector<double> times, values;
+        if (r.buffers()) {
+            r.readArray(times);
+            r.readArray(values);
+        }
+        r.end();
+        if (size == 0 || times.size() != values.size() || times.size() > size) {
+            throw DiscreteSystems::CheckpointError("Signal: historial de la instantánea no válido");
+        }
+
+        // Mismos anillos espejados que resizeBuffer(), con las muestras desde 0
+        if (size != capacity_) {
+            std::vector<double>(2 * size, 0.0).swap(time_buffer_);
+            std::vector<double>(2 * size, 0.0).swap(value_buffer_);
+        }
+        const std::size_t count = times.size();
+        for (std::size_t i = 0; i < count; ++i) {
+            time_buffer_[i] = time_buffer_[i + size] = times[i];
+            value_buffer_[i] = value_buffer_[i + size] = values[i];
+        }
+        buffer_size_ = capacity_ = size;
+        count_ = count;
+        head_ = count % size;
+        t_ = t;
+        k_ = k;
     }
 
     /*--- Getters / Setters ---*/
@@ -92,11 +339,13 @@ namespace RefSignal {
         return buffer_size_;
     }
 
-    const std::deque<double>& Signal::timeBuffer() const {
-        return time_buffer_;
+    BufferView Signal::timeBuffer() const {
+        const std::size_t start = (head_ + capacity_ - count_) % capacity_;
+        return BufferView(time_buffer_.data() + start, count_);
     }
-    const std::deque<double>& Signal::valueBuffer() const {
-        return value_buffer_;
+    BufferView Signal::valueBuffer() const {
+        const std::size_t start = (head_ + capacity_ - count_) % capacity_;
+        return BufferView(value_buffer_.data() + start, count_);
     }
 
     /**
@@ -105,8 +354,10 @@ namespace RefSignal {
      * Formato: time,value por línea.
      */
     std::ostream& operator<<(std::ostream& os, const Signal& s) {
-        for (std::size_t i = 0; i < s.time_buffer_.size(); ++i) {
-            os << s.time_buffer_[i] << "," << s.value_buffer_[i] << "\n";
+        const BufferView times = s.timeBuffer();
+        const BufferView values = s.valueBuffer();
+        for (std::size_t i = 0; i < times.size(); ++i) {
+            os << times[i] << "," << values[i] << "\n";
         }
         return os;
     }
@@ -125,6 +376,17 @@ namespace RefSignal {
         return (time >= step_time_) ? amplitude_ + offset_ : offset_;
     }
 
+    double StepSignal::constantUntil(double time) const {
+        return (time >= step_time_) ? std::numeric_limits<double>::infinity() : step_time_;
+    }
+
+    void StepSignal::generate(double* out, std::size_t n, std::size_t k0) const {
+        const double st = step_time_, hi = amplitude_ + offset_, lo = offset_;
+        forEachTime(out, n, k0, Ts_, 0.0, [=](double, double time) {
+            return (time >= st) ? hi : lo;
+        });
+    }
+
     double& StepSignal::amplitude() {
         return amplitude_;
     }
@@ -157,6 +419,14 @@ namespace RefSignal {
         }
     }
 
+    void RampSignal::generate(double* out, std::size_t n, std::size_t k0) const {
+        const double t0 = start_time_, m = slope_, off = offset_;
+        forEachTime(out, n, k0, Ts_, 0.0, [=](double, double time) {
+            const double ramp = m * (time - t0) + off;
+            return (time < t0) ? off : ramp;
+        });
+    }
+
     double& RampSignal::slope() {
         return slope_;
     }
@@ -187,6 +457,11 @@ namespace RefSignal {
         return amplitude_ * std::sin(TWO_PI * freq_ * time + phase_) + offset_;
     }
 
+    void SineSignal::generate(double* out, std::size_t n, std::size_t k0) const {
+        std::fill(out, out + n, offset_);
+        addSine(out, n, k0, Ts_, 0.0, amplitude_, freq_, phase_);
+    }
+
     double& SineSignal::amplitude() {
         return amplitude_;
     }
@@ -208,4 +483,362 @@ namespace RefSignal {
         return phase_;
     }
 
+    /*========================================================================*/
+    /*                          SEÑAL DE TABLA                                */
+    /*========================================================================*/
+
+    TableSignal::TableSignal(double Ts, const std::string& path, double table_ts,
+                             Interpolation interp, double offset, std::size_t buffer_size)
+        : Signal(Ts, offset, buffer_size),
+          data_(nullptr), size_(0), table_ts_(0.0), interp_(interp) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("TableSignal: no se pudo abrir '" + path + "': " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            const std::string err = std::strerror(errno);
+            ::close(fd);
+            throw std::runtime_error("TableSignal: no se pudo leer el tamaño de '" + path + "': " + err);
+        }
+        const std::size_t bytes = static_cast<std::size_t>(st.st_size);
+        if (bytes == 0 || bytes % sizeof(double) != 0) {
+            ::close(fd);
+            throw std::invalid_argument("TableSignal: '" + path + "' debe contener un número entero (> 0) de double");
+        }
+        void* addr = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        const std::string err = std::strerror(errno);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            throw std::runtime_error("TableSignal: no se pudo proyectar '" + path + "': " + err);
+        }
+        // La reproducción recorre la tabla en orden: lectura anticipada agresiva
+        madvise(addr, bytes, MADV_SEQUENTIAL);
+
+        storage_ = std::shared_ptr<const void>(addr, MappingDeleter{bytes});
+        data_ = static_cast<const double*>(addr);
+        size_ = bytes / sizeof(double);
+        init(table_ts);
+    }
+
+    TableSignal::TableSignal(double Ts, std::vector<double> samples, double table_ts,
+                             Interpolation interp, double offset, std::size_t buffer_size)
+        : Signal(Ts, offset, buffer_size),
+          data_(nullptr), size_(0), table_ts_(0.0), interp_(interp) {
+        if (samples.empty()) {
+            throw std::invalid_argument("TableSignal: la tabla no puede estar vacía");
+        }
+        std::shared_ptr<std::vector<double> > owned = std::make_shared<std::vector<double> >();
+        owned->swap(samples);
+        data_ = owned->data();
+        size_ = owned->size();
+        storage_ = owned;
+        init(table_ts);
+    }
+
+    void TableSignal::init(double table_ts) {
+        if (table_ts < 0.0) {
+            throw std::invalid_argument("TableSignal: table_ts debe ser > 0");
+        }
+        table_ts_ = (table_ts == 0.0) ? Ts_ : table_ts;
+    }
+
+    double TableSignal::computeAt(double time) const {
+        return tableAt(data_, size_, table_ts_, interp_, time) + offset_;
+    }
+
+    void TableSignal::generate(double* out, std::size_t n, std::size_t k0) const {
+        const double off = offset_;
+        if (table_ts_ == Ts_) {
+            // Misma cadencia: copia directa, manteniendo la última muestra al final
+            const std::size_t avail = (k0 < size_) ? std::min(n, size_ - k0) : 0;
+            for (std::size_t i = 0; i < avail; ++i) {
+                out[i] = data_[k0 + i] + off;
+            }
+            std::fill(out + avail, out + n, data_[size_ - 1] + off);
+            return;
+        }
+        const double* data = data_;
+        const std::size_t size = size_;
+        const double tts = table_ts_;
+        const Interpolation interp = interp_;
+        forEachTime(out, n, k0, Ts_, 0.0, [=](double, double time) {
+            return tableAt(data, size, tts, interp, time) + off;
+        });
+    }
+
+    void TableSignal::writeFile(const std::string& path, const double* data, std::size_t n) {
+        std::ofstream os(path.c_str(), std::ios::binary | std::ios::trunc);
+        os.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(n * sizeof(double)));
+        if (!os) {
+            throw std::runtime_error("TableSignal: no se pudo escribir '" + path + "'");
+        }
+    }
+
+    const double* TableSignal::data() const {
+        return data_;
+    }
+    std::size_t TableSignal::size() const {
+        return size_;
+    }
+    double TableSignal::tableTs() const {
+        return table_ts_;
+    }
+    Interpolation TableSignal::interpolation() const {
+        return interp_;
+    }
+    double TableSignal::duration() const {
+        return static_cast<double>(size_ - 1) * table_ts_;
+    }
+
+    /*========================================================================*/
+    /*                        TÉRMINOS APLANADOS                              */
+    /*========================================================================*/
+
+    SignalTerms::SignalTerms() : constant_(0.0) {}
+
+    void SignalTerms::add(const StepSignal& s) {
+        constant_ += s.offset();
+        step_time_.push_back(s.stepTime());
+        step_amp_.push_back(s.amplitude());
+    }
+
+    void SignalTerms::add(const RampSignal& s) {
+        constant_ += s.offset();
+        ramp_start_.push_back(s.startTime());
+        ramp_slope_.push_back(s.slope());
+    }
+
+    void SignalTerms::add(const SineSignal& s) {
+        constant_ += s.offset();
+        sine_amp_.push_back(s.amplitude());
+        sine_freq_.push_back(s.frequency());
+        sine_phase_.push_back(s.phase());
+    }
+
+    void SignalTerms::add(const TableSignal& s) {
+        constant_ += s.offset();
+        Table t;
+        t.storage = s.storage_;
+        t.data = s.data_;
+        t.size = s.size_;
+        t.tableTs = s.table_ts_;
+        t.interp = s.interp_;
+        tables_.push_back(t);
+    }
+
+    void SignalTerms::add(const SignalTerms& terms) {
+        constant_ += terms.constant_;
+        step_time_.insert(step_time_.end(), terms.step_time_.begin(), terms.step_time_.end());
+        step_amp_.insert(step_amp_.end(), terms.step_amp_.begin(), terms.step_amp_.end());
+        ramp_start_.insert(ramp_start_.end(), terms.ramp_start_.begin(), terms.ramp_start_.end());
+        ramp_slope_.insert(ramp_slope_.end(), terms.ramp_slope_.begin(), terms.ramp_slope_.end());
+        sine_amp_.insert(sine_amp_.end(), terms.sine_amp_.begin(), terms.sine_amp_.end());
+        sine_freq_.insert(sine_freq_.end(), terms.sine_freq_.begin(), terms.sine_freq_.end());
+        sine_phase_.insert(sine_phase_.end(), terms.sine_phase_.begin(), terms.sine_phase_.end());
+        tables_.insert(tables_.end(), terms.tables_.begin(), terms.tables_.end());
+    }
+
+    void SignalTerms::addConstant(double c) {
+        constant_ += c;
+    }
+
+    double SignalTerms::eval(double time, double init) const {
+        double v = init + constant_;
+        for (std::size_t i = 0; i < step_time_.size(); ++i) {
+            v += (time >= step_time_[i]) ? step_amp_[i] : 0.0;
+        }
+        for (std::size_t i = 0; i < ramp_start_.size(); ++i) {
+            v += (time < ramp_start_[i]) ? 0.0 : ramp_slope_[i] * (time - ramp_start_[i]);
+        }
+        for (std::size_t i = 0; i < sine_amp_.size(); ++i) {
+            v += sine_amp_[i] * std::sin(TWO_PI * sine_freq_[i] * time + sine_phase_[i]);
+        }
+        for (std::size_t i = 0; i < tables_.size(); ++i) {
+            const Table& t = tables_[i];
+            v += tableAt(t.data, t.size, t.tableTs, t.interp, time);
+        }
+        return v;
+    }
+
+    void SignalTerms::accumulate(double* out, std::size_t n, std::size_t k0,
+                                 double Ts, double shift) const {
+        const double c = constant_;
+        for (std::size_t i = 0; i < n; ++i) {
+            out[i] += c;
+        }
+        for (std::size_t i = 0; i < step_time_.size(); ++i) {
+            const double st = step_time_[i], a = step_amp_[i];
+            forEachTime(out, n, k0, Ts, shift, [=](double o, double time) {
+                return o + ((time >= st) ? a : 0.0);
+            });
+        }
+        for (std::size_t i = 0; i < ramp_start_.size(); ++i) {
+            const double t0 = ramp_start_[i], m = ramp_slope_[i];
+            forEachTime(out, n, k0, Ts, shift, [=](double o, double time) {
+                return o + ((time < t0) ? 0.0 : m * (time - t0));
+            });
+        }
+        for (std::size_t i = 0; i < sine_amp_.size(); ++i) {
+            addSine(out, n, k0, Ts, shift, sine_amp_[i], sine_freq_[i], sine_phase_[i]);
+        }
+        for (std::size_t i = 0; i < tables_.size(); ++i) {
+            const Table& t = tables_[i];
+            const double* data = t.data;
+            const std::size_t size = t.size;
+            const double tts = t.tableTs;
+            const Interpolation interp = t.interp;
+            forEachTime(out, n, k0, Ts, shift, [=](double o, double time) {
+                return o + tableAt(data, size, tts, interp, time);
+            });
+        }
+    }
+
+    std::size_t SignalTerms::size() const {
+        return step_time_.size() + ramp_start_.size() + sine_amp_.size() + tables_.size();
+    }
+
+    double SignalTerms::constant() const {
+        return constant_;
+    }
+
+    /*========================================================================*/
+    /*                          SEÑAL SUMA                                    */
+    /*========================================================================*/
+
+    SumSignal::SumSignal(double Ts, double offset, std::size_t buffer_size)
+        : Signal(Ts, offset, buffer_size) {}
+
+    SumSignal& SumSignal::add(const StepSignal& s) {
+        terms_.add(s);
+        return *this;
+    }
+    SumSignal& SumSignal::add(const RampSignal& s) {
+        terms_.add(s);
+        return *this;
+    }
+    SumSignal& SumSignal::add(const SineSignal& s) {
+        terms_.add(s);
+        return *this;
+    }
+    SumSignal& SumSignal::add(const TableSignal& s) {
+        terms_.add(s);
+        return *this;
+    }
+    SumSignal& SumSignal::add(const SumSignal& s) {
+        terms_.add(s.terms_);
+        terms_.addConstant(s.offset_);
+        return *this;
+    }
+
+    double SumSignal::computeAt(double time) const {
+        return terms_.eval(time, offset_);
+    }
+
+    void SumSignal::generate(double* out, std::size_t n, std::size_t k0) const {
+        std::fill(out, out + n, offset_);
+        terms_.accumulate(out, n, k0, Ts_);
+    }
+
+    const SignalTerms& SumSignal::terms() const {
+        return terms_;
+    }
+
+    /*========================================================================*/
+    /*                        SEÑAL POR TRAMOS                                */
+    /*========================================================================*/
+
+    PiecewiseSignal::PiecewiseSignal(double Ts, double offset, std::size_t buffer_size)
+        : Signal(Ts, offset, buffer_size), end_(0.0) {}
+
+    PiecewiseSignal& PiecewiseSignal::appendTerms(double duration, const SignalTerms& terms) {
+        if (!(duration > 0.0)) {
+            throw std::invalid_argument("PiecewiseSignal: la duración del tramo debe ser > 0");
+        }
+        start_.push_back(end_);
+        segments_.push_back(terms);
+        end_ += duration;
+        return *this;
+    }
+
+    PiecewiseSignal& PiecewiseSignal::append(double duration, const StepSignal& s) {
+        SignalTerms t;
+        t.add(s);
+        return appendTerms(duration, t);
+    }
+    PiecewiseSignal& PiecewiseSignal::append(double duration, const RampSignal& s) {
+        SignalTerms t;
+        t.add(s);
+        return appendTerms(duration, t);
+    }
+    PiecewiseSignal& PiecewiseSignal::append(double duration, const SineSignal& s) {
+        SignalTerms t;
+        t.add(s);
+        return appendTerms(duration, t);
+    }
+    PiecewiseSignal& PiecewiseSignal::append(double duration, const TableSignal& s) {
+        SignalTerms t;
+        t.add(s);
+        return appendTerms(duration, t);
+    }
+    PiecewiseSignal& PiecewiseSignal::append(double duration, const SumSignal& s) {
+        SignalTerms t;
+        t.add(s.terms());
+        t.addConstant(s.offset());
+        return appendTerms(duration, t);
+    }
+
+    std::size_t PiecewiseSignal::segmentAt(double time) const {
+        const std::size_t idx = static_cast<std::size_t>(
+            std::upper_bound(start_.begin(), start_.end(), time) - start_.begin());
+        return (idx == 0) ? 0 : idx - 1;
+    }
+
+    double PiecewiseSignal::computeAt(double time) const {
+        if (segments_.empty()) {
+            return offset_;
+        }
+        const std::size_t s = segmentAt(time);
+        return segments_[s].eval(time - start_[s], offset_);
+    }
+
+    void PiecewiseSignal::generate(double* out, std::size_t n, std::size_t k0) const {
+        std::fill(out, out + n, offset_);
+        if (segments_.empty()) {
+            return;
+        }
+        std::size_t i = 0;
+        while (i < n) {
+            const std::size_t k = k0 + i;
+            const std::size_t s = segmentAt(static_cast<double>(k) * Ts_);
+            std::size_t m = n - i;
+            if (s + 1 < start_.size()) {
+                // Primera muestra del tramo siguiente, con la misma
+                // comparación que segmentAt(): k * Ts >= inicio
+                const double next = start_[s + 1];
+                const double est = std::ceil(next / Ts_);
+                if (est < static_cast<double>(k + m)) {
+                    std::size_t kEnd = std::max(k + 1, static_cast<std::size_t>(est));
+                    while (kEnd > k + 1 && static_cast<double>(kEnd - 1) * Ts_ >= next) {
+                        --kEnd;
+                    }
+                    while (static_cast<double>(kEnd) * Ts_ < next) {
+                        ++kEnd;
+                    }
+                    m = std::min(m, kEnd - k);
+                }
+            }
+            segments_[s].accumulate(out + i, m, k, Ts_, start_[s]);
+            i += m;
+        }
+    }
+
+    std::size_t PiecewiseSignal::segments() const {
+        return segments_.size();
+    }
+
+    double PiecewiseSignal::duration() const {
+        return end_;
+    }
+
 } // namespace RefSignal
@@ -0,0 +1,295 @@
+/**
+ * @file telemetria.cpp
+ * @brief Implementación de la telemetría en memoria compartida
+ */
+
+#include "telemetria.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace Telemetria {
+
+namespace {
+
+/** @brief Desplazamiento del anillo dentro del segmento */
+const std::size_t kSlotsOffset = (sizeof(SegmentHeader) + 63) & ~std::size_t(63);
+
+std::size_t segmentSize(std::size_t capacity) {
+    return kSlotsOffset + capacity * sizeof(TelemetrySlot);
+}
+
+std::runtime_error systemError(const char* who, const std::string& what, const std::string& name) {
+    return std::runtime_error(std::string(who) + ": " + what + " '" + name + "': " + std::strerror(errno));
+}
+
+std::int64_t monotonicNs() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+/**
+ * @brief Proyecta un segmento existente y valida su cabecera
+ * @param who Clase que abre (para los mensajes)
+ * @param writable true para PROT_READ | PROT_WRITE
+ * @param size Tamaño proyectado (salida)
+ */
+void* openSegment(const char* who, const std::string& name, bool writable, std::size_t& size) {
+    int fd = shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        throw systemError(who, "no se pudo abrir el segmento", name);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < kSlotsOffset) {
+        close(fd);
+        throw std::runtime_error(std::string(who) + ": segmento '" + name + "' demasiado pequeño");
+    }
+    size = static_cast<std::size_t>(st.st_size);
+    void* base = mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        throw systemError(who, "no se pudo proyectar el segmento", name);
+    }
+
+    const SegmentHeader* h = static_cast<const SegmentHeader*>(base);
+    std::string error;
+    if (h->magic.load(std::memory_order_acquire) != kMagic) {
+        error = "no inicializado";
+    } else if (h->version != kVersion || h->recordSize != sizeof(TelemetryRecord)) {
+        error = "versión incompatible";
+    } else if (h->capacity == 0 || (h->capacity & (h->capacity - 1)) != 0
+               || segmentSize(h->capacity) > size) {
+        error = "capacidad inválida";
+    }
+    if (!error.empty()) {
+        munmap(base, size);
+        throw std::runtime_error(std::string(who) + ": segmento '" + name + "' " + error);
+    }
+    return base;
+}
+
+} // namespace
+
+/*========================================================================*/
+/*                          TELEMETRY WRITER                              */
+/*========================================================================*/
+
+TelemetryWriter::TelemetryWriter(const std::string& name, double Ts, std::size_t capacity)
+    : name_(name), base_(nullptr), size_(0), header_(nullptr), slots_(nullptr),
+      mask_(0), next_(0), Ts_(Ts)
+{
+    if (capacity == 0 || capacity > (std::size_t(1) << 30)) {
+        throw std::invalid_argument("TelemetryWriter: capacidad fuera de rango");
+    }
+    std::size_t cap = 1;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+    mask_ = cap - 1;
+    size_ = segmentSize(cap);
+
+    // Un segmento anterior con el mismo nombre (p. ej. de un proceso que
+    // terminó sin limpiar) se sustituye: los lectores que lo tuvieran
+    // proyectado siguen viendo el antiguo hasta que lo reabran
+    shm_unlink(name_.c_str());
+    int fd = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+        throw systemError("TelemetryWriter", "no se pudo crear el segmento", name_);
+    }
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        std::runtime_error err = systemError("TelemetryWriter", "no se pudo dimensionar el segmento", name_);
+        close(fd);
+        shm_unlink(name_.c_str());
+        throw err;
+    }
+    base_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base_ == MAP_FAILED) {
+        std::runtime_error err = systemError("TelemetryWriter", "no se pudo proyectar el segmento", name_);
+        shm_unlink(name_.c_str());
+        throw err;
+    }
+
+    // ftruncate deja el segmento a cero; se construyen los atómicos en su sitio
+    header_ = new (base_) SegmentHeader;
+    header_->version = kVersion;
+    header_->recordSize = sizeof(TelemetryRecord);
+    header_->capacity = static_cast<std::uint32_t>(cap);
+    header_->Ts = Ts_;
+    header_->writeSeq.store(0, std::memory_order_relaxed);
+    header_->mailbox.enqueuePos.store(0, std::memory_order_relaxed);
+    header_->mailbox.dequeuePos.store(0, std::memory_order_relaxed);
+    for (std::size_t i = 0; i < kMailboxSize; ++i) {
+        header_->mailbox.cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    slots_ = reinterpret_cast<TelemetrySlot*>(static_cast<char*>(base_) + kSlotsOffset);
+    for (std::size_t i = 0; i < cap; ++i) {
+        new (&slots_[i]) TelemetrySlot;
+        slots_[i].seq.store(0, std::memory_order_relaxed);
+    }
+    // Publicar la cabecera en último lugar: un lector que abra antes ve magic = 0
+    header_->magic.store(kMagic, std::memory_order_release);
+}
+
+TelemetryWriter::~TelemetryWriter() {
+    munmap(base_, size_);
+    shm_unlink(name_.c_str());
+}
+
+void TelemetryWriter::publish(const Lazo::TickData& d) {
+    const std::uint64_t i = next_++;
+    TelemetrySlot& slot = slots_[i & mask_];
+
+    // Secuencia impar: la ranura está a medio escribir
+    slot.seq.store(2 * i + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TelemetryRecord& rec = slot.record;
+    rec.k = d.k;
+    rec.stampNs = monotonicNs();
+    rec.t = static_cast<double>(d.k) * Ts_;
+    rec.r = d.r;
+    rec.e = d.e;
+    rec.u = d.u;
+    rec.y = d.y;
+    rec.s = d.s;
+
+    slot.seq.store(2 * i + 2, std::memory_order_release);
+    header_->writeSeq.store(i + 1, std::memory_order_release);
+}
+
+bool TelemetryWriter::pollCommand(Command& cmd) {
+    CommandMailbox& mb = header_->mailbox;
+    const std::uint64_t pos = mb.dequeuePos.load(std::memory_order_relaxed);
+    CommandCell& cell = mb.cells[pos & (kMailboxSize - 1)];
+    if (cell.seq.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+    cmd = cell.command;
+    // Devolver la celda a los emisores para la siguiente vuelta
+    cell.seq.store(pos + kMailboxSize, std::memory_order_release);
+    mb.dequeuePos.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+/*========================================================================*/
+/*                          TELEMETRY READER                              */
+/*========================================================================*/
+
+TelemetryReader::TelemetryReader(const std::string& name)
+    : base_(nullptr), size_(0), header_(nullptr), slots_(nullptr), mask_(0), Ts_(0.0)
+{
+    base_ = openSegment("TelemetryReader", name, false, size_);
+    header_ = static_cast<const SegmentHeader*>(base_);
+    slots_ = reinterpret_cast<const TelemetrySlot*>(static_cast<const char*>(base_) + kSlotsOffset);
+    mask_ = header_->capacity - 1;
+    Ts_ = header_->Ts;
+}
+
+TelemetryReader::~TelemetryReader() {
+    munmap(base_, size_);
+}
+
+std::uint64_t TelemetryReader::latest() const {
+    return header_->writeSeq.load(std::memory_order_acquire);
+}
+
+bool TelemetryReader::read(std::uint64_t i, TelemetryRecord& out) const {
+    const TelemetrySlot& slot = slots_[i & mask_];
+    const std::uint64_t expected = 2 * i + 2;
+    if (slot.seq.load(std::memory_order_acquire) != expected) {
+        return false;
+    }
+    out = slot.record;
+    // Si el escritor empezó a pisar la ranura durante la copia, la secuencia cambió
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.seq.load(std::memory_order_relaxed) == expected;
+}
+
+std::size_t TelemetryReader::readSince(std::uint64_t& cursor, TelemetryRecord* out, std::size_t max,
+                                       std::uint64_t* lost) const {
+    const std::uint64_t head = latest();
+    const std::uint64_t window = mask_ + 1;
+    if (head > window && cursor < head - window) {
+        if (lost) {
+            *lost += head - window - cursor;
+        }
+        cursor = head - window;
+    }
+    std::size_t n = 0;
+    while (n < max && cursor < head) {
+        if (read(cursor, out[n])) {
+            ++n;
+        } else if (lost) {
+            // Sobrescrito mientras se leía: el escritor ya ha dado la vuelta
+            ++*lost;
+        }
+        ++cursor;
+    }
+    return n;
+}
+
+/*========================================================================*/
+/*                          COMMAND SENDER                                */
+/*========================================================================*/
+
+CommandSender::CommandSender(const std::string& name)
+    : base_(nullptr), size_(0), header_(nullptr)
+{
+    base_ = openSegment("CommandSender", name, true, size_);
+    header_ = static_cast<SegmentHeader*>(base_);
+}
+
+CommandSender::~CommandSender() {
+    munmap(base_, size_);
+}
+
+bool CommandSender::send(const Command& cmd) {
+    CommandMailbox& mb = header_->mailbox;
+    std::uint64_t pos = mb.enqueuePos.load(std::memory_order_relaxed);
+    CommandCell* cell;
+    for (;;) {
+        cell = &mb.cells[pos & (kMailboxSize - 1)];
+        const std::uint64_t seq = cell->seq.load(std::memory_order_acquire);
+        const std::int64_t diff = static_cast<std::int64_t>(seq - pos);
+        if (diff == 0) {
+            if (mb.enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;   // lleno: el proceso de control no ha vaciado el buzón
+        } else {
+            pos = mb.enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->command = cmd;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool CommandSender::setGains(double Kp, double Ki, double Kd) {
+    Command cmd = Command();
+    cmd.type = CommandType::SetGains;
+    cmd.values[0] = Kp;
+    cmd.values[1] = Ki;
+    cmd.values[2] = Kd;
+    return send(cmd);
+}
+
+bool CommandSender::setReferenceOffset(double offset) {
+    Command cmd = Command();
+    cmd.type = CommandType::SetReferenceOffset;
+    cmd.values[0] = offset;
+    return send(cmd);
+}
+
+} // namespace Telemetria
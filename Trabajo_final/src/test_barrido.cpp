@@ -0,0 +1,269 @@
+/**
+ * @file test_barrido.cpp
+ * @brief Programa de prueba para los barridos de parámetros
+ *
+ * Prueba:
+ * - WorkStealingPool: cada índice se procesa exactamente una vez
+ * - runSweep: el resultado no depende del número de hilos
+ * - reset(): cada fila coincide con un lazo recién construido
+ * - randomPoints: reproducible y dentro de la caja
+ * - Divergencia y configurador propio (perturbación de la planta)
+ * - SweepOptions::warm: cada punto parte del prototipo en marcha, igual que
+ *   una copia o una instantánea restaurada
+ */
+
+#include <barrido.h>
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace Barrido;
+using namespace std;
+
+namespace {
+
+const double Ts = 0.01;
+
+/**
+ * @brief Punto con ganancia de planta perturbada
+ */
+struct PlantPoint {
+    GainPoint gains;
+    double plantGain;   ///< Factor sobre el numerador de la planta nominal
+};
+
+typedef Lazo::LoopRunner<RefSignal::StepSignal, Controlador::PIDController, Convertidores::DAConverter,
+                         DiscreteSystems::TransferFunctionSystem, Convertidores::ADConverter> TfLoop;
+
+DiscreteSystems::TransferFunctionSystem plant(double g) {
+    return DiscreteSystems::TransferFunctionSystem({0.0099 * g, 0.0099 * g}, {1.0, -0.9802}, Ts);
+}
+
+bool same(const Metrics& a, const Metrics& b) {
+    // NaN == NaN es falso: los tiempos se comparan por su representación
+    return a.iae == b.iae && a.ise == b.ise && a.itae == b.itae && a.overshoot == b.overshoot
+        && (a.riseTime == b.riseTime || (std::isnan(a.riseTime) && std::isnan(b.riseTime)))
+        && (a.settlingTime == b.settlingTime || (std::isnan(a.settlingTime) && std::isnan(b.settlingTime)))
+        && a.steadyStateError == b.steadyStateError && a.ticks == b.ticks && a.abort == b.abort;
+}
+
+} // namespace
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE LOS BARRIDOS DE PARÁMETROS               ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    bool ok = true;
+
+    // ========== PRUEBA 1: REPARTO CON ROBO DE TRABAJO ==========
+    cout << "========================================\n";
+    cout << "  WORKSTEALINGPOOL\n";
+    cout << "========================================\n";
+    {
+        bool okPool = true;
+        const size_t sizes[] = {0, 1, 3, 1000, 100000};
+        WorkStealingPool pool(4);
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            const size_t n = sizes[s];
+            vector<atomic<int> > visits(n);
+            for (size_t i = 0; i < n; ++i) {
+                visits[i].store(0);
+            }
+            // Coste desigual: los primeros índices son mucho más caros,
+            // de modo que los demás hilos acaban robando
+            pool.parallelFor(n, [&visits](unsigned, size_t i) {
+                volatile double x = 0.0;
+                const size_t work = i < 100 ? 20000 : 10;
+                for (size_t j = 0; j < work; ++j) {
+                    x = x + 1.0;
+                }
+                visits[i].fetch_add(1);
+            });
+            size_t bad = 0;
+            for (size_t i = 0; i < n; ++i) {
+                bad += visits[i].load() != 1 ? 1 : 0;
+            }
+            cout << "  n = " << setw(6) << n << ": índices mal visitados = " << bad
+                 << ", robos = " << pool.lastSteals() << "\n";
+            okPool = okPool && bad == 0;
+        }
+        cout << "  Cada índice una vez: " << (okPool ? "OK" : "FALLO") << "\n";
+        ok = ok && okPool;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 2: INDEPENDENCIA DEL NÚMERO DE HILOS ==========
+    cout << "========================================\n";
+    cout << "  BARRIDO EN REJILLA: 1 HILO FRENTE A 4\n";
+    cout << "========================================\n";
+    auto proto = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                Controlador::PIDController(1.0, 0.0, 0.0, Ts),
+                                Convertidores::DAConverter(Ts),
+                                Planta::Sistema(Ts),
+                                Convertidores::ADConverter(Ts));
+    const vector<GainPoint> grid = gridPoints({0.5, 1.0, 2.0, 4.0}, {0.0, 2.0, 4.0}, {0.0, 0.01});
+    const SweepOptions serialOpt(1500, 1);
+    const SweepOptions parallelOpt(1500, 4);
+    const vector<Metrics> serial = runSweep(proto, grid, serialOpt);
+    const vector<Metrics> parallel = runSweep(proto, grid, parallelOpt);
+    {
+        bool okThreads = serial.size() == grid.size() && parallel.size() == grid.size();
+        for (size_t i = 0; okThreads && i < grid.size(); ++i) {
+            okThreads = same(serial[i], parallel[i]);
+        }
+        cout << "  Puntos: " << grid.size() << "\n";
+        cout << "  Filas idénticas: " << (okThreads ? "OK" : "FALLO") << "\n";
+        ok = ok && okThreads;
+
+        const size_t best = bestByIae(parallel);
+        cout << "  Mejor IAE: Kp=" << grid[best].Kp << " Ki=" << grid[best].Ki << " Kd=" << grid[best].Kd
+             << " → IAE=" << parallel[best].iae << "\n";
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 3: REINICIO FRENTE A LAZO NUEVO ==========
+    cout << "========================================\n";
+    cout << "  reset() FRENTE A LAZO RECIÉN CONSTRUIDO\n";
+    cout << "========================================\n";
+    {
+        bool okReset = true;
+        for (size_t i = 0; i < grid.size(); i += 5) {
+            auto fresh = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                        Controlador::PIDController(grid[i].Kp, grid[i].Ki, grid[i].Kd, Ts),
+                                        Convertidores::DAConverter(Ts),
+                                        Planta::Sistema(Ts),
+                                        Convertidores::ADConverter(Ts));
+            const Metrics m = simulate(fresh, serialOpt);
+            okReset = okReset && same(m, parallel[i]);
+        }
+        cout << "  Filas coincidentes: " << (okReset ? "OK" : "FALLO") << "\n";
+        ok = ok && okReset;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 4: MONTE CARLO ==========
+    cout << "========================================\n";
+    cout << "  MUESTREO ALEATORIO\n";
+    cout << "========================================\n";
+    {
+        const GainPoint lo = {0.5, 0.0, 0.0};
+        const GainPoint hi = {4.0, 5.0, 0.02};
+        const vector<GainPoint> a = randomPoints(200, lo, hi, 7);
+        const vector<GainPoint> b = randomPoints(200, lo, hi, 7);
+        bool okRandom = a.size() == 200;
+        for (size_t i = 0; okRandom && i < a.size(); ++i) {
+            okRandom = a[i].Kp == b[i].Kp && a[i].Ki == b[i].Ki && a[i].Kd == b[i].Kd
+                && a[i].Kp >= lo.Kp && a[i].Kp <= hi.Kp && a[i].Ki >= lo.Ki && a[i].Ki <= hi.Ki
+                && a[i].Kd >= lo.Kd && a[i].Kd <= hi.Kd;
+        }
+        const vector<Metrics> r = runSweep(proto, a, SweepOptions(1000, 4));
+        size_t stable = 0;
+        for (size_t i = 0; i < r.size(); ++i) {
+            stable += r[i].abort == Metricas::Abort::None ? 1 : 0;
+        }
+        cout << "  Reproducible y dentro de la caja: " << (okRandom ? "OK" : "FALLO") << "\n";
+        cout << "  Configuraciones estables: " << stable << " / " << r.size() << "\n";
+        ok = ok && okRandom && r.size() == a.size();
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 5: DIVERGENCIA ==========
+    cout << "========================================\n";
+    cout << "  ABORTO POR DIVERGENCIA\n";
+    cout << "========================================\n";
+    {
+        // Kd enorme frente a Ts: el lazo discreto es inestable
+        vector<GainPoint> pts(1);
+        pts[0].Kp = 1.0;
+        pts[0].Ki = 0.0;
+        pts[0].Kd = 50.0;
+        const vector<Metrics> r = runSweep(proto, pts, SweepOptions(100000, 2, 1e3));
+        const bool okDiv = r[0].abort == Metricas::Abort::Output && r[0].ticks < 100000;
+        cout << "  Abortada en el tick " << r[0].ticks << ": " << (okDiv ? "OK" : "FALLO") << "\n";
+        ok = ok && okDiv;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 6: CONFIGURADOR PROPIO ==========
+    cout << "========================================\n";
+    cout << "  PERTURBACIÓN DE LA PLANTA\n";
+    cout << "========================================\n";
+    {
+        TfLoop tfProto(RefSignal::StepSignal(Ts, 1.0, 0.0), Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                       Convertidores::DAConverter(Ts), plant(1.0), Convertidores::ADConverter(Ts));
+        vector<PlantPoint> pts;
+        for (int g = 0; g < 8; ++g) {
+            PlantPoint p = {{2.0, 4.0, 0.01}, 0.6 + 0.1 * g};
+            pts.push_back(p);
+        }
+        const vector<Metrics> r = runSweep(tfProto, pts, SweepOptions(1500, 4),
+                                           [](TfLoop& loop, const PlantPoint& p) {
+                                               loop.pid().setGains(p.gains.Kp, p.gains.Ki, p.gains.Kd);
+                                               loop.plant() = plant(p.plantGain);
+                                           });
+        bool okPlant = true;
+        for (size_t i = 0; i < pts.size(); ++i) {
+            TfLoop fresh(RefSignal::StepSignal(Ts, 1.0, 0.0), Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                         Convertidores::DAConverter(Ts), plant(pts[i].plantGain), Convertidores::ADConverter(Ts));
+            const Metrics m = simulate(fresh, SweepOptions(1500));
+            cout << "  g = " << fixed << setprecision(1) << pts[i].plantGain
+                 << "  IAE = " << setprecision(6) << r[i].iae << "\n";
+            okPlant = okPlant && same(m, r[i]);
+        }
+        cout << "  Coincide con plantas construidas: " << (okPlant ? "OK" : "FALLO") << "\n";
+        ok = ok && okPlant;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 7: BARRIDO DESDE UN LAZO EN MARCHA ==========
+    cout << "========================================\n";
+    cout << "  BARRIDO DESDE UN LAZO EN MARCHA (warm)\n";
+    cout << "========================================\n";
+    {
+        // Transitorio de arranque común, simulado una sola vez
+        auto warmProto = proto;
+        warmProto.pid().setGains(2.0, 4.0, 0.01);
+        warmProto.run(500);
+        SweepOptions warmOpt(1000, 4);
+        warmOpt.warm = true;
+        SweepOptions warmSerial(1000, 1);
+        warmSerial.warm = true;
+        const vector<Metrics> r = runSweep(warmProto, grid, warmOpt);
+        const vector<Metrics> rs = runSweep(warmProto, grid, warmSerial);
+
+        DiscreteSystems::CheckpointWriter w(false);
+        warmProto.checkpoint(w);
+        bool okWarm = warmProto.getK() == 500;
+        for (size_t i = 0; okWarm && i < grid.size(); ++i) {
+            auto fork = warmProto;
+            fork.pid().setGains(grid[i].Kp, grid[i].Ki, grid[i].Kd);
+            const Metrics mf = simulate(fork, warmOpt, fork.adc().delayed());
+
+            auto restored = proto;
+            DiscreteSystems::CheckpointReader rd(w);
+            restored.restore(rd);
+            restored.pid().setGains(grid[i].Kp, grid[i].Ki, grid[i].Kd);
+            const Metrics mr = simulate(restored, warmOpt, restored.adc().delayed());
+            okWarm = same(r[i], rs[i]) && same(r[i], mf) && same(r[i], mr);
+        }
+        // La primera fila ya está en régimen: error casi nulo desde el principio
+        const bool okSettled = !same(r[0], parallel[0]) && fabs(r[0].steadyStateError) < 1e-3;
+        cout << "  IAE del punto 0: " << scientific << setprecision(3) << parallel[0].iae << " en frío, "
+             << r[0].iae << " en caliente" << fixed << "\n";
+        cout << "  Coincide con copias y con la instantánea restaurada: " << (okWarm ? "OK" : "FALLO") << "\n";
+        cout << "  Parte del estado del prototipo: " << (okSettled ? "OK" : "FALLO") << "\n";
+        ok = ok && okWarm && okSettled;
+    }
+    cout << "========================================\n\n";
+
+    if (ok) {
+        cout << "Pruebas completadas exitosamente.\n\n";
+        return 0;
+    }
+    cout << "Pruebas FALLIDAS.\n\n";
+    return 1;
+}
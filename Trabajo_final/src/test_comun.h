@@ -0,0 +1,39 @@
+/**
+ * @file test_comun.h
+ * @brief Utilidades compartidas por los programas de prueba
+ */
+
+#ifndef TEST_COMUN_H
+#define TEST_COMUN_H
+
+#include <DiscreteSystems/DiscreteSystem.h>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+/**
+ * @brief Compara next() muestra a muestra con process() por bloques.
+ * @param a Sistema alimentado con next()
+ * @param b Sistema idéntico alimentado con process()
+ * @param u Secuencia de entrada
+ * @param block Tamaño de bloque para process()
+ * @return true si salidas y buffers coinciden exactamente
+ */
+inline bool sameAsNext(DiscreteSystems::DiscreteSystem& a,
+                       DiscreteSystems::DiscreteSystem& b,
+                       const std::vector<double>& u, std::size_t block) {
+    std::vector<double> ya(u.size()), yb(u.size());
+    for (std::size_t i = 0; i < u.size(); ++i) {
+        ya[i] = a.next(u[i]);
+    }
+    for (std::size_t i = 0; i < u.size(); i += block) {
+        std::size_t n = std::min(block, u.size() - i);
+        b.process(&u[i], &yb[i], n);
+    }
+    std::ostringstream da, db;
+    a.bufferDump(da);
+    b.bufferDump(db);
+    return ya == yb && a.getK() == b.getK() && da.str() == db.str();
+}
+
+#endif // TEST_COMUN_H
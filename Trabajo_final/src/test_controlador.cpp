@@ -6,12 +6,23 @@
  * - PIDController: Respuesta a escalón y sintonización on-line
  * - ADConverter: Verifica el retardo de una muestra
  * - DAConverter: Verifica el paso directo
+ * - process(): Verifica que el procesamiento por bloques coincide con next()
+ * - FixedPID: coincide bit a bit con PIDController
+ * - PIDBank: cada canal coincide bit a bit con un PIDController
+ * - Sintonización concurrente: nunca se usa un juego de coeficientes mezclado
+ * - Transición sin saltos (setBumpless / setGains con rampa)
+ * - BasicPID en float, Q15 y Q31: desviación frente a double y saturación
  */
 
 #include "controlador.h"
 #include "convertidores.h"
+#include "test_comun.h"
+#include <atomic>
+#include <cmath>
 #include <iostream>
 #include <iomanip>
+#include <thread>
+#include <vector>
 
 using namespace Controlador;
 using namespace Convertidores;
@@ -129,6 +140,265 @@ int main() {
     }
     cout << "========================================\n\n";
 
+    // ========== PRUEBA 5: PROCESAMIENTO POR BLOQUES ==========
+    cout << "========================================\n";
+    cout << "  PROCESAMIENTO POR BLOQUES (process)\n";
+    cout << "========================================\n";
+    cout << "  3000 muestras, bloques de 1, 7, 1024 y 5000\n";
+    cout << "----------------------------------------\n";
+
+    vector<double> e(3000);
+    for (size_t i = 0; i < e.size(); ++i) {
+        e[i] = 1.0 / (1.0 + static_cast<double>(i % 37)) - 0.25;
+    }
+
+    bool ok = true;
+    const size_t blocks[] = {1, 7, 1024, 5000};
+    for (size_t block : blocks) {
+        PIDController p1(1.0, 0.5, 0.1, Ts), p2(1.0, 0.5, 0.1, Ts);
+        ADConverter ad1(Ts), ad2(Ts);
+        DAConverter da1(Ts), da2(Ts);
+        bool okPid = sameAsNext(p1, p2, e, block);
+        bool okAdc = sameAsNext(ad1, ad2, e, block);
+        bool okDac = sameAsNext(da1, da2, e, block);
+        cout << "  bloque=" << setw(5) << block
+             << "  PID: " << (okPid ? "OK" : "FALLO")
+             << "  ADC: " << (okAdc ? "OK" : "FALLO")
+             << "  DAC: " << (okDac ? "OK" : "FALLO") << "\n";
+        ok = ok && okPid && okAdc && okDac;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 6: NÚCLEO PID FIJO ==========
+    cout << "========================================\n";
+    cout << "  NÚCLEO PID FIJO (FixedPID)\n";
+    cout << "========================================\n";
+
+    PIDController pidRef(1.0, 0.5, 0.1, Ts);
+    FixedPID pidFijo(1.0, 0.5, 0.1, Ts);
+    bool okFijo = true;
+    for (size_t i = 0; i < e.size(); ++i) {
+        okFijo = okFijo && (pidFijo.step(e[i]) == pidRef.next(e[i]));
+    }
+    cout << "  Comparación bit a bit (3000 muestras): " << (okFijo ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okFijo;
+
+    // ========== PRUEBA 7: BANCO DE PID ==========
+    cout << "========================================\n";
+    cout << "  BANCO DE PID (PIDBank)\n";
+    cout << "========================================\n";
+
+    const size_t C = 11;
+    PIDBank bank(C, 1.0, 0.5, 0.1, Ts);
+    vector<PIDController> pids;
+    for (size_t c = 0; c < C; ++c) {
+        double Kp = 1.0 + 0.1 * c, Ki = 0.5 - 0.02 * c, Kd = 0.05 * c;
+        bank.channel(c).setGains(Kp, Ki, Kd);
+        pids.push_back(PIDController(Kp, Ki, Kd, Ts));
+    }
+    vector<double> eb(e.size() * C), ub(e.size() * C);
+    for (size_t t = 0; t < e.size(); ++t) {
+        for (size_t c = 0; c < C; ++c) {
+            eb[t * C + c] = e[(t + 13 * c) % e.size()];
+        }
+    }
+    bank.process(eb.data(), ub.data(), e.size());
+    bool okBank = true;
+    for (size_t t = 0; t < e.size(); ++t) {
+        for (size_t c = 0; c < C; ++c) {
+            okBank = okBank && (ub[t * C + c] == pids[c].next(eb[t * C + c]));
+        }
+    }
+    cout << "  " << C << " canales, comparación bit a bit: " << (okBank ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okBank;
+
+    // ========== PRUEBA 8: SINTONIZACIÓN CONCURRENTE ==========
+    cout << "========================================\n";
+    cout << "  GANANCIAS PUBLICADAS DESDE OTRO HILO\n";
+    cout << "========================================\n";
+    {
+        // Dos juegos muy distintos: un juego mezclado daría un Δu que no
+        // coincide con ninguno de los dos
+        const double gains[2][3] = {{1.0, 0.5, 0.1}, {7.0, 3.0, 0.9}};
+        double a[2][3];
+        for (int j = 0; j < 2; ++j) {
+            a[j][0] = gains[j][0] + gains[j][1] * Ts + gains[j][2] / Ts;
+            a[j][1] = -gains[j][0] - 2.0 * gains[j][2] / Ts;
+            a[j][2] = gains[j][2] / Ts;
+        }
+
+        PIDController pidRt(gains[0][0], gains[0][1], gains[0][2], Ts);
+        std::atomic<bool> stop(false);
+        std::atomic<unsigned long> published(0);
+        std::thread tuner([&]() {
+            for (unsigned long i = 1; !stop.load(); ++i) {
+                const int j = static_cast<int>(i & 1);
+                pidRt.setGains(gains[j][0], gains[j][1], gains[j][2]);
+                published.store(i);
+                if (i % 97 == 0) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+
+        const size_t N = 2000000;
+        size_t torn = 0, used[2] = {0, 0};
+        double e1 = 0.0, e2 = 0.0, u1 = 0.0;
+        for (size_t k = 0; k < N; ++k) {
+            const double ek = std::sin(0.37 * static_cast<double>(k));
+            const double uk = pidRt.step(ek);
+            bool match = false;
+            for (int j = 0; j < 2; ++j) {
+                if (uk == u1 + (a[j][0] * ek + a[j][1] * e1 + a[j][2] * e2)) {
+                    ++used[j];
+                    match = true;
+                    break;
+                }
+            }
+            torn += match ? 0 : 1;
+            e2 = e1;
+            e1 = ek;
+            u1 = uk;
+            // Evita que la salida crezca sin límite con el juego integral
+            // y deja correr al otro hilo aunque haya un solo núcleo
+            if (k % 1000 == 999) {
+                pidRt.reset();
+                e1 = e2 = u1 = 0.0;
+                std::this_thread::yield();
+            }
+        }
+        stop.store(true);
+        tuner.join();
+
+        cout << "  Publicaciones: " << published.load() << ", ticks: " << N << "\n";
+        cout << "  Ticks con juego A / B: " << used[0] << " / " << used[1] << "\n";
+        cout << "  Ticks con juego mezclado: " << torn << "\n";
+        const bool okTorn = torn == 0;
+        cout << "  Sin juegos mezclados: " << (okTorn ? "OK" : "FALLO") << "\n";
+
+        PIDController pidGet(1.0, 0.5, 0.1, Ts);
+        pidGet.setKd(0.3);
+        pidGet.setKp(2.0);
+        const bool okGet = pidGet.getKp() == 2.0 && pidGet.getKi() == 0.5 && pidGet.getKd() == 0.3
+                        && pidGet.gainsPending();
+        pidGet.step(0.0);
+        const bool okApplied = !pidGet.gainsPending();
+        cout << "  Getters y adopción en el siguiente tick: " << (okGet && okApplied ? "OK" : "FALLO") << "\n";
+        ok = ok && okTorn && okGet && okApplied;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 9: TRANSICIÓN SIN SALTOS ==========
+    cout << "========================================\n";
+    cout << "  TRANSICIÓN SIN SALTOS (rampa de 50 ticks)\n";
+    cout << "========================================\n";
+    {
+        // Error suave alrededor de 1: el cambio inmediato hace saltar Δu en
+        // (ΔKi·Ts + ...)·e en el tick del cambio; la rampa lo reparte
+        PIDController inmediato(1.0, 0.5, 0.0, Ts);
+        PIDController rampa(1.0, 0.5, 0.0, Ts);
+        const double aT[3] = {4.0 + 2.0 * Ts + 0.05 / Ts, -4.0 - 2.0 * 0.05 / Ts, 0.05 / Ts};
+        double e1 = 0.0, e2 = 0.0;
+        const size_t ramp = 50, change = 200, K = 600;
+        double maxJumpImm = 0.0, maxJumpRamp = 0.0;
+        double prevImm = 0.0, prevRamp = 0.0, du1Imm = 0.0, du1Ramp = 0.0;
+        bool okEnd = true;
+        for (size_t k = 0; k < K; ++k) {
+            if (k == change) {
+                inmediato.setGains(4.0, 2.0, 0.05);
+                rampa.setGains(4.0, 2.0, 0.05, ramp);
+            }
+            const double ek = 1.0 + 0.2 * std::sin(0.02 * static_cast<double>(k));
+            const double uImm = inmediato.step(ek);
+            const double uRamp = rampa.step(ek);
+            const double duImm = uImm - prevImm, duRamp = uRamp - prevRamp;
+            if (k > change - 5 && k < change + ramp + 5) {
+                maxJumpImm = max(maxJumpImm, fabs(duImm - du1Imm));
+                maxJumpRamp = max(maxJumpRamp, fabs(duRamp - du1Ramp));
+            }
+            // Terminada la rampa, Δu es exactamente el del juego de destino
+            if (k >= change + ramp - 1) {
+                okEnd = okEnd && !rampa.gainsPending()
+                     && uRamp == prevRamp + (aT[0] * ek + aT[1] * e1 + aT[2] * e2);
+            }
+            e2 = e1;
+            e1 = ek;
+            prevImm = uImm;
+            prevRamp = uRamp;
+            du1Imm = duImm;
+            du1Ramp = duRamp;
+        }
+        cout << "  Máx. |Δu[k] - Δu[k-1]| inmediato: " << setprecision(6) << maxJumpImm << "\n";
+        cout << "  Máx. |Δu[k] - Δu[k-1]| con rampa: " << maxJumpRamp << "\n";
+        const bool okRamp = maxJumpRamp < 0.1 * maxJumpImm && okEnd;
+        cout << "  Rampa sin saltos y completada: " << (okRamp ? "OK" : "FALLO") << "\n";
+
+        // setBumpless aplica la rampa a los setters normales
+        PIDController porDefecto(1.0, 0.5, 0.0, Ts);
+        porDefecto.setBumpless(ramp);
+        porDefecto.setKp(4.0);
+        size_t ticks = 0;
+        porDefecto.step(1.0);
+        while (porDefecto.gainsPending()) {
+            porDefecto.step(1.0);
+            ++ticks;
+        }
+        const bool okDefault = ticks + 1 == ramp && porDefecto.getBumpless() == ramp;
+        cout << "  setBumpless(" << ramp << "): transición en " << ticks + 1 << " ticks: "
+             << (okDefault ? "OK" : "FALLO") << "\n";
+        ok = ok && okRamp && okDefault;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 10: PID EN FLOAT Y PUNTO FIJO ==========
+    cout << "========================================\n";
+    cout << "  BasicPID EN FLOAT, Q15 Y Q31\n";
+    cout << "========================================\n";
+    {
+        using DiscreteSystems::Q15;
+        using DiscreteSystems::Q31;
+        vector<double> ez(4000);
+        for (size_t k = 0; k < ez.size(); ++k) {
+            ez[k] = 0.1 * sin(0.02 * static_cast<double>(k)) + 0.05 * cos(0.13 * static_cast<double>(k));
+        }
+        const FixedPID ref(1.0, 0.5, 0.1, Ts);
+        const DiscreteSystems::Deviation dFloat =
+            DiscreteSystems::compareWithReference(BasicPID<float>(1.0, 0.5, 0.1, Ts), ref, ez.data(), ez.size());
+        const DiscreteSystems::Deviation dQ31 =
+            DiscreteSystems::compareWithReference(BasicPID<Q31>(1.0, 0.5, 0.1, Ts), ref, ez.data(), ez.size());
+        const DiscreteSystems::Deviation dQ15 =
+            DiscreteSystems::compareWithReference(BasicPID<Q15>(1.0, 0.5, 0.1, Ts), ref, ez.data(), ez.size());
+        cout << scientific << setprecision(2);
+        cout << "  Desviación máxima: float " << dFloat.maxAbs << ", Q31 " << dQ31.maxAbs
+             << ", Q15 " << dQ15.maxAbs << " (rms " << dQ15.rms << ")\n";
+        cout << fixed << setprecision(4);
+        const bool okDev = dFloat.maxAbs < 1e-5 && dQ31.maxAbs < 1e-6 && dQ15.maxAbs < 1e-2;
+        cout << "  Dentro de las cotas de cada palabra: " << (okDev ? "OK" : "FALLO") << "\n";
+
+        // Error sostenido: la integral lleva u al fondo de escala y allí se
+        // queda; u[k-1] se guarda saturado, así que no hay acumulación oculta
+        DiscreteSystems::ReferenceCheck<BasicPID<Q15>, FixedPID> sat(BasicPID<Q15>(1.0, 0.5, 0.1, Ts), ref);
+        const double fullScale = 32767.0 / 32768.0;
+        double u = 0.0, uMin = 1.0;
+        size_t atFullScale = 0;
+        for (int k = 0; k < 2000; ++k) {
+            u = sat.step(0.5);
+            uMin = min(uMin, u);
+            atFullScale = u == fullScale ? atFullScale + 1 : 0;
+        }
+        const bool okSat = uMin > 0.0 && atFullScale > 1900 && sat.deviation().maxAbs > 1.0;
+        cout << "  u saturada en " << u << " sin envolver: " << (okSat ? "OK" : "FALLO") << "\n";
+        ok = ok && okDev && okSat;
+    }
+    cout << "========================================\n\n";
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
     cout << "Pruebas completadas exitosamente.\n\n";
 
     return 0;
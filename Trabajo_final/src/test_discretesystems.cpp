@@ -0,0 +1,1218 @@
+/**
+ * @file test_discretesystems.cpp
+ * @brief Programa de prueba para la librería DiscreteSystems
+ *
+ * Prueba:
+ * - TransferFunctionSystem: respuesta a escalón
+ * - StateSpaceSystem: respuesta a escalón
+ * - process(): Verifica que el procesamiento por bloques coincide con next()
+ * - FilterStructure::SecondOrderSections: coincide con la forma directa,
+ *   también en orden 20-32 (Butterworth y raíces múltiples)
+ * - StateSpaceSystem (n=64): coincide con el producto fila por vector
+ * - FixedTransferFunction / FixedStateSpace: coinciden con las clases dinámicas
+ * - TransferFunctionBank: cada canal coincide con un TransferFunctionSystem
+ * - snapshot() / readSince(): lecturas consistentes con un escritor concurrente
+ * - bufferDump(): formatos binarios y volcado directo a fichero
+ * - StreamRecorder: grabación sin pérdidas, políticas de descarte y gzip
+ * - RecordingPolicy: buffer por columnas, sólo salida, float32 y sin registro
+ * - BasicTransferFunction: double bit a bit; float, Q15 y Q31 frente a double;
+ *   saturación, envoltura y redondeo
+ * - advance(): avance con entrada constante por potencias de la matriz de
+ *   transición (MatrixPowers vacío no hace nada); hold() en el buffer y en
+ *   StreamRecorder
+ * - Analysis: respuesta en frecuencia (TF y SS, uno y varios hilos),
+ *   impulso/escalón frente a next(), polos (también de orden 24) y márgenes
+ *   analíticos
+ * - FIR largos: convolución FFT particionada en process() frente a la
+ *   forma directa, con bloques de cualquier tamaño y next() intercalados
+ * - checkpoint()/restore(): continuación bit a bit de TF (DF, SOS, FIR por
+ *   FFT) y SS, con y sin buffers; instantáneas de otro tipo o truncadas
+ */
+
+#include <DiscreteSystems.h>
+#include <DiscreteSystems/FixedSystems.h>
+#include <DiscreteSystems/ScalarSystems.h>
+#include <DiscreteSystems/Analysis.h>
+#include <DiscreteSystems/MatrixPowers.h>
+#include "test_comun.h"
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <numeric>
+
+using namespace DiscreteSystems;
+using namespace std;
+
+/**
+ * @brief Guarda a a mitad de u, lo restaura en fresh y continúa ambos.
+ * @param a Sistema que se simula desde el principio
+ * @param fresh Sistema construido igual que a, sin simular
+ * @param u Secuencia de entrada (la segunda mitad se procesa tras restaurar)
+ * @param buffers Incluir los buffers de registro en la instantánea
+ * @return true si salidas, k y (con buffers) volcados coinciden exactamente
+ */
+static bool restoresExactly(DiscreteSystem& a, DiscreteSystem& fresh,
+                            const vector<double>& u, bool buffers) {
+    const size_t half = u.size() / 2;
+    vector<double> ya(u.size()), yb(u.size());
+    a.process(&u[0], &ya[0], half);
+    CheckpointWriter w(buffers);
+    a.checkpoint(w);
+    CheckpointReader r(w);
+    fresh.restore(r);
+    a.process(&u[half], &ya[half], u.size() - half);
+    fresh.process(&u[half], &yb[half], u.size() - half);
+    ostringstream da, db;
+    a.bufferDump(da);
+    fresh.bufferDump(db);
+    const bool sameOut = equal(ya.begin() + half, ya.end(), yb.begin() + half);
+    return sameOut && a.getK() == fresh.getK() && (!buffers || da.str() == db.str());
+}
+
+/**
+ * @brief Polos de un Butterworth digital de orden n par (bilineal, fc en fracción de fs)
+ * @return n/2 polos de parte imaginaria positiva
+ */
+static vector<complex<double>> butterworthPoles(int n, double fc) {
+    const double pi = 3.14159265358979323846;
+    const double wc = tan(pi * fc);
+    vector<complex<double>> p;
+    for (int k = 0; k < n / 2; ++k) {
+        const complex<double> s = wc * polar(1.0, pi * (2 * k + n + 1) / (2.0 * n));
+        p.push_back((1.0 + s) / (1.0 - s));
+    }
+    return p;
+}
+
+/**
+ * @brief Denominador en z^-1 con los polos dados y sus conjugados
+ */
+static vector<double> fromConjugatePoles(const vector<complex<double>>& p) {
+    vector<double> a(1, 1.0);
+    for (size_t i = 0; i < p.size(); ++i) {
+        const double q[] = {1.0, -2.0 * p[i].real(), norm(p[i])};
+        a = Polynomial::multiply(a, vector<double>(q, q + 3));
+    }
+    return a;
+}
+
+/**
+ * @brief Volcado TSV con operator<< muestra a muestra (formato de referencia).
+ */
+static string referenceTSV(const vector<Sample>& v, int precision, bool fixedMode) {
+    ostringstream os;
+    if (fixedMode) {
+        os << fixed;
+    }
+    os << setprecision(precision) << "# k\tu(k)\ty(k)" << '\n';
+    for (size_t i = 0; i < v.size(); ++i) {
+        os << v[i].k << '\t' << v[i].in << '\t' << v[i].out << '\n';
+    }
+    return os.str();
+}
+
+static string readFile(const string& path) {
+    ifstream is(path.c_str(), ios::binary);
+    return string(istreambuf_iterator<char>(is), istreambuf_iterator<char>());
+}
+
+/**
+ * @brief Comprueba que bytes contiene las columnas k, u, y de v como float64.
+ */
+static bool sameColumns(const string& bytes, size_t offset, const vector<Sample>& v) {
+    const size_t n = v.size();
+    if (bytes.size() != offset + 3 * n * sizeof(double)) {
+        return false;
+    }
+    vector<double> col(3 * n);
+    memcpy(&col[0], bytes.data() + offset, col.size() * sizeof(double));
+    for (size_t i = 0; i < n; ++i) {
+        if (col[i] != v[i].k || col[n + i] != v[i].in || col[2 * n + i] != v[i].out) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE LA LIBRERÍA DISCRETESYSTEMS              ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    const double Ts = 0.1;
+    bool ok = true;
+
+    // Sistemas de referencia: segundo orden en ambas representaciones
+    const vector<double> b = {0.0, 0.2, 0.1};
+    const vector<double> a = {1.0, -1.2, 0.5};
+    const vector<vector<double>> A = {{1.2, -0.5}, {1.0, 0.0}};
+    const vector<double> B = {1.0, 0.0};
+    const vector<double> C = {0.2, 0.1};
+
+    // ========== PRUEBA 1: RESPUESTA A ESCALÓN ==========
+    cout << "========================================\n";
+    cout << "  RESPUESTA A ESCALÓN (TF y SS)\n";
+    cout << "========================================\n";
+    cout << "  H(z) = (0.2z^-1 + 0.1z^-2) / (1 - 1.2z^-1 + 0.5z^-2)\n";
+    cout << "----------------------------------------\n";
+    cout << setw(6) << "k" << " | "
+         << setw(12) << "y_tf[k]" << " | "
+         << setw(12) << "y_ss[k]" << "\n";
+    cout << "----------------------------------------\n";
+
+    TransferFunctionSystem tf(b, a, Ts);
+    StateSpaceSystem ss(A, B, C, 0.0, Ts);
+    for (int k = 0; k < 10; ++k) {
+        double ytf = tf.next(1.0);
+        double yss = ss.next(1.0);
+        cout << setw(6) << k << " | "
+             << setw(12) << fixed << setprecision(6) << ytf << " | "
+             << setw(12) << setprecision(6) << yss << "\n";
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 2: PROCESAMIENTO POR BLOQUES ==========
+    cout << "========================================\n";
+    cout << "  PROCESAMIENTO POR BLOQUES (process)\n";
+    cout << "========================================\n";
+    cout << "  3000 muestras, bloques de 1, 7, 100 y 5000\n";
+    cout << "----------------------------------------\n";
+
+    vector<double> u(3000);
+    for (size_t i = 0; i < u.size(); ++i) {
+        u[i] = (i % 50 < 25) ? 1.0 : -0.5;
+    }
+
+    const size_t blocks[] = {1, 7, 100, 5000};
+    for (size_t block : blocks) {
+        TransferFunctionSystem tf1(b, a, Ts), tf2(b, a, Ts);
+        StateSpaceSystem ss1(A, B, C, 0.3, Ts), ss2(A, B, C, 0.3, Ts);
+        bool okTf = sameAsNext(tf1, tf2, u, block);
+        bool okSs = sameAsNext(ss1, ss2, u, block);
+        cout << "  bloque=" << setw(5) << block
+             << "  TF: " << (okTf ? "OK" : "FALLO")
+             << "  SS: " << (okSs ? "OK" : "FALLO") << "\n";
+        ok = ok && okTf && okSs;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 3: SECCIONES DE SEGUNDO ORDEN ==========
+    cout << "========================================\n";
+    cout << "  SECCIONES DE SEGUNDO ORDEN (SOS)\n";
+    cout << "========================================\n";
+    cout << "  Orden 2 y orden 16 (polos en 0.95, ceros en -1)\n";
+    cout << "----------------------------------------\n";
+
+    // Filtro de orden 16 construido a partir de sus polos y ceros
+    vector<double> bh(1, 1.0), ah(1, 1.0);
+    for (int i = 0; i < 8; ++i) {
+        double theta = 0.1 + 0.15 * i;
+        const double zc[] = {1.0, 2.0, 1.0};
+        const double pc[] = {1.0, -2.0 * 0.95 * cos(theta), 0.95 * 0.95};
+        bh = Polynomial::multiply(bh, vector<double>(zc, zc + 3));
+        ah = Polynomial::multiply(ah, vector<double>(pc, pc + 3));
+    }
+    for (size_t i = 0; i < bh.size(); ++i) {
+        bh[i] *= 1e-6;
+    }
+
+    struct Case { const char* name; vector<double> b; vector<double> a; };
+    const Case cases[] = {{"orden 2 ", b, a}, {"orden 16", bh, ah}};
+    for (const Case& c : cases) {
+        TransferFunctionSystem df(c.b, c.a, Ts);
+        TransferFunctionSystem sos(c.b, c.a, Ts, 100, FilterStructure::SecondOrderSections);
+        double maxDiff = 0.0, maxY = 0.0;
+        for (size_t i = 0; i < u.size(); ++i) {
+            double y1 = df.next(u[i]);
+            double y2 = sos.next(u[i]);
+            maxDiff = max(maxDiff, fabs(y1 - y2));
+            maxY = max(maxY, fabs(y1));
+        }
+        bool okSos = maxDiff <= 1e-6 * max(1.0, maxY);
+        cout << "  " << c.name << "  secciones=" << setw(2) << sos.getSections().size() / 5
+             << "  max|y_df - y_sos| = " << scientific << setprecision(2) << maxDiff
+             << "  " << (okSos ? "OK" : "FALLO") << "\n";
+        ok = ok && okSos;
+    }
+    cout << fixed;
+
+    // Orden alto: la factorización (autovalores de la compañera) es estable
+    // hacia atrás también con raíces múltiples, que se dispersan ~eps^(1/m):
+    // la salida coincide con la forma directa en la medida de ese condicionamiento
+    cout << "----------------------------------------\n";
+    cout << "  Orden alto: Butterworth 32, polo real x20, par complejo x10\n";
+    {
+        const vector<complex<double>> bw = butterworthPoles(32, 0.25);
+        const vector<double> aBw = fromConjugatePoles(bw);
+        vector<double> bBw(1, 1.0), aReal(1, 1.0);
+        for (int i = 0; i < 32; ++i) {
+            bBw = Polynomial::multiply(bBw, vector<double>{1.0, 1.0});
+        }
+        for (int i = 0; i < 20; ++i) {
+            aReal = Polynomial::multiply(aReal, vector<double>{1.0, -0.5});
+        }
+        const vector<double> aPair = fromConjugatePoles(vector<complex<double>>(10, polar(0.6, 0.5)));
+        struct HighCase { const char* name; vector<double> b; vector<double> a; };
+        HighCase high[] = {{"Butterworth 32", bBw, aBw}, {"0.5 x20       ", {1.0}, aReal},
+                           {"0.6∠0.5 x10   ", {0.0, 1.0}, aPair}};
+        for (HighCase& c : high) {
+            // Ganancia unidad en continua
+            const double dc = accumulate(c.a.begin(), c.a.end(), 0.0) / accumulate(c.b.begin(), c.b.end(), 0.0);
+            for (size_t i = 0; i < c.b.size(); ++i) {
+                c.b[i] *= dc;
+            }
+            TransferFunctionSystem df(c.b, c.a, Ts);
+            TransferFunctionSystem sos(c.b, c.a, Ts, 100, FilterStructure::SecondOrderSections);
+            const vector<double>& sec = sos.getSections();
+            vector<double> num(1, 1.0), den(1, 1.0);
+            for (size_t i = 0; i < sec.size(); i += 5) {
+                num = Polynomial::multiply(num, vector<double>(sec.begin() + i, sec.begin() + i + 3));
+                den = Polynomial::multiply(den, vector<double>{1.0, sec[i + 3], sec[i + 4]});
+            }
+            double errCoef = 0.0, scale = 0.0;
+            for (size_t i = 0; i < den.size(); ++i) {
+                const double bi = i < c.b.size() ? c.b[i] : 0.0, ai = i < c.a.size() ? c.a[i] : 0.0;
+                const double ni = i < num.size() ? num[i] : 0.0;
+                errCoef = max(errCoef, max(fabs(ni - bi), fabs(den[i] - ai)));
+                scale = max(scale, max(fabs(bi), fabs(ai)));
+            }
+            errCoef /= scale;
+            double maxDiff = 0.0, maxY = 0.0;
+            for (size_t i = 0; i < u.size(); ++i) {
+                const double y1 = df.next(u[i]), y2 = sos.next(u[i]);
+                maxDiff = max(maxDiff, fabs(y1 - y2));
+                maxY = max(maxY, fabs(y1));
+            }
+            bool okHigh = errCoef <= 1e-13 && maxDiff <= 1e-6 * max(1.0, maxY);
+            if (c.a == aBw) {
+                // Polos simples: cada sección reproduce uno de los polos conocidos (con el
+                // error que impone el condicionamiento del denominador expandido)
+                for (size_t i = 0; okHigh && i < sec.size(); i += 5) {
+                    const complex<double> disc = sqrt(complex<double>(sec[i + 3] * sec[i + 3] - 4.0 * sec[i + 4]));
+                    const complex<double> pole = 0.5 * (-sec[i + 3] + disc);
+                    double dist = 1.0;
+                    for (size_t j = 0; j < bw.size(); ++j) {
+                        dist = min(dist, min(abs(pole - bw[j]), abs(pole - conj(bw[j]))));
+                    }
+                    okHigh = dist <= 1e-6;
+                }
+            }
+            cout << "  " << c.name << "  secciones=" << setw(2) << sec.size() / 5
+                 << "  error coef. = " << scientific << setprecision(2) << errCoef
+                 << "  max|y_df - y_sos| = " << maxDiff << "  " << (okHigh ? "OK" : "FALLO") << "\n";
+            ok = ok && okHigh;
+        }
+    }
+    cout << fixed;
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 4: NÚCLEO DE ESPACIO DE ESTADOS ==========
+    cout << "========================================\n";
+    cout << "  NÚCLEO DE ESPACIO DE ESTADOS\n";
+    cout << "========================================\n";
+    cout << "  Referencia: producto fila por vector\n";
+    cout << "----------------------------------------\n";
+
+    const size_t orders[] = {1, 3, 17, 64};
+    for (size_t n : orders) {
+        vector<vector<double>> An(n, vector<double>(n));
+        vector<double> Bn(n), Cn(n);
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                An[i][j] = 0.9 / n * cos(1.0 + i * 0.7 + j * 1.3);
+            }
+            Bn[i] = sin(0.3 * i);
+            Cn[i] = cos(0.2 * i);
+        }
+        StateSpaceSystem ssn(An, Bn, Cn, 0.1, Ts);
+        vector<double> x(n, 0.0), xn(n);
+        bool okN = true;
+        for (size_t k = 0; k < 500; ++k) {
+            double uk = u[k];
+            double yref = 0.0;
+            for (size_t i = 0; i < n; ++i) {
+                yref += Cn[i] * x[i];
+            }
+            yref += 0.1 * uk;
+            for (size_t i = 0; i < n; ++i) {
+                double sum = 0.0;
+                for (size_t j = 0; j < n; ++j) {
+                    sum += An[i][j] * x[j];
+                }
+                xn[i] = sum + Bn[i] * uk;
+            }
+            x.swap(xn);
+            okN = okN && (ssn.next(uk) == yref) && (ssn.getState() == x);
+        }
+        cout << "  n=" << setw(3) << n << "  " << (okN ? "OK" : "FALLO") << "\n";
+        ok = ok && okN;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 5: SISTEMAS DE ORDEN FIJO ==========
+    cout << "========================================\n";
+    cout << "  SISTEMAS DE ORDEN FIJO\n";
+    cout << "========================================\n";
+
+    FixedTransferFunction<2, 2> ftf({{b[0], b[1], b[2]}}, {{a[0], a[1], a[2]}});
+    FixedStateSpace<2> fss({{{{A[0][0], A[0][1]}}, {{A[1][0], A[1][1]}}}},
+                           {{B[0], B[1]}}, {{C[0], C[1]}}, 0.3);
+    TransferFunctionSystem tfRef(b, a, Ts);
+    StateSpaceSystem ssRef(A, B, C, 0.3, Ts);
+    bool okFtf = true, okFss = true;
+    for (size_t i = 0; i < u.size(); ++i) {
+        okFtf = okFtf && (ftf.step(u[i]) == tfRef.next(u[i]));
+        okFss = okFss && (fss.step(u[i]) == ssRef.next(u[i]));
+    }
+    cout << "  FixedTransferFunction<2,2>: " << (okFtf ? "OK" : "FALLO") << "\n";
+    cout << "  FixedStateSpace<2>:         " << (okFss ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okFtf && okFss;
+
+    // ========== PRUEBA 6: BANCO DE FUNCIONES DE TRANSFERENCIA ==========
+    cout << "========================================\n";
+    cout << "  BANCO DE FUNCIONES DE TRANSFERENCIA\n";
+    cout << "========================================\n";
+    cout << "  Canales independientes frente a TransferFunctionSystem\n";
+    cout << "----------------------------------------\n";
+
+    const size_t channelCounts[] = {1, 5, 8, 13};
+    for (size_t C : channelCounts) {
+        TransferFunctionBank bank(C, 2, 2, Ts);
+        vector<TransferFunctionSystem> refs;
+        for (size_t c = 0; c < C; ++c) {
+            vector<double> bc = {0.01 * c, 0.2 + 0.01 * c, 0.1};
+            vector<double> ac = {1.0 + 0.1 * c, -1.2, 0.5 - 0.02 * c};
+            bank.channel(c).setCoefficients(bc, ac);
+            refs.push_back(TransferFunctionSystem(bc, ac, Ts));
+        }
+        const size_t steps = 1000;
+        vector<double> ub(steps * C), yb(steps * C);
+        for (size_t t = 0; t < steps; ++t) {
+            for (size_t c = 0; c < C; ++c) {
+                ub[t * C + c] = u[(t + 17 * c) % u.size()] * (1.0 + 0.1 * c);
+            }
+        }
+        bank.process(ub.data(), yb.data(), steps);
+        bool okBank = true;
+        for (size_t t = 0; t < steps; ++t) {
+            for (size_t c = 0; c < C; ++c) {
+                okBank = okBank && (yb[t * C + c] == refs[c].next(ub[t * C + c]));
+            }
+        }
+        for (size_t c = 0; c < C; ++c) {
+            okBank = okBank && (bank.channel(c).output(1) == yb[(steps - 1) * C + c])
+                            && (bank.channel(c).input(0) == ub[(steps - 1) * C + c]);
+        }
+        cout << "  canales=" << setw(3) << C << "  " << (okBank ? "OK" : "FALLO") << "\n";
+        ok = ok && okBank;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 7: LECTURAS CONCURRENTES DEL BUFFER ==========
+    cout << "========================================\n";
+    cout << "  LECTURAS CONCURRENTES DEL BUFFER\n";
+    cout << "========================================\n";
+
+    // Un solo hilo: snapshot() y readSince() reproducen el historial
+    TransferFunctionSystem id(vector<double>(1, 1.0), vector<double>(1, 1.0), Ts, 64);
+    vector<Sample> snap(64), delta;
+    uint64_t cursor = 0, lost = 0;
+    bool okSnap = id.snapshot(&snap[0], 64) == 0;
+    for (int k = 0; k < 40; ++k) {
+        id.next(k);
+    }
+    cursor = id.readSince(cursor, delta, &lost);
+    okSnap = okSnap && cursor == 40 && delta.size() == 40 && lost == 0 && delta[39].k == 39;
+    double blockIn[100], blockOut[100];
+    for (int i = 0; i < 100; ++i) {
+        blockIn[i] = 40 + i;
+    }
+    id.process(blockIn, blockOut, 100);
+    delta.clear();
+    cursor = id.readSince(cursor, delta, &lost);
+    size_t got = id.snapshot(&snap[0], 10);
+    okSnap = okSnap && cursor == 140 && delta.size() == 64 && lost == 36
+                    && delta.front().k == 76 && delta.back().k == 139
+                    && got == 10 && snap[0].k == 130 && snap[9].k == 139;
+    id.reset();
+    id.next(7.0);
+    delta.clear();
+    cursor = id.readSince(cursor, delta, &lost);
+    okSnap = okSnap && delta.size() == 1 && delta[0].k == 0 && delta[0].in == 7.0
+                    && id.snapshot(&snap[0], 64) == 1;
+    cout << "  Un hilo (historial, incrementos, reset): " << (okSnap ? "OK" : "FALLO") << "\n";
+
+    // Escritor y lector concurrentes: toda muestra leída es íntegra y consecutiva
+    TransferFunctionSystem shared(vector<double>(1, 1.0), vector<double>(1, 1.0), Ts, 256);
+    const int writes = 2000000;
+    thread writer([&shared, writes]() {
+        double blk[37], out[37];
+        for (int k = 0; k < writes; ) {
+            if (k % 1000 < 500) {
+                shared.next(k);
+                ++k;
+            } else {
+                int n = min(37, writes - k);
+                for (int i = 0; i < n; ++i) {
+                    blk[i] = k + i;
+                }
+                shared.process(blk, out, n);
+                k += n;
+            }
+        }
+    });
+    bool okConc = true;
+    size_t reads = 0, samples = 0;
+    uint64_t cur = 0;
+    vector<Sample> buf(256), inc;
+    while (shared.getSequence() < static_cast<uint64_t>(writes)) {
+        size_t n = shared.snapshot(&buf[0], 256);
+        for (size_t i = 0; i < n; ++i) {
+            okConc = okConc && buf[i].in == buf[i].k && buf[i].out == buf[i].k
+                            && (i == 0 || buf[i].k == buf[i - 1].k + 1);
+        }
+        inc.clear();
+        uint64_t lostNow = 0;
+        uint64_t next = shared.readSince(cur, inc, &lostNow);
+        okConc = okConc && inc.size() + lostNow == next - cur;
+        for (size_t i = 0; i < inc.size(); ++i) {
+            okConc = okConc && inc[i].in == inc[i].k
+                            && static_cast<uint64_t>(inc[i].k) == cur + lostNow + i;
+        }
+        cur = next;
+        ++reads;
+        samples += n;
+    }
+    writer.join();
+    cout << "  Escritor concurrente (" << reads << " lecturas, " << samples << " muestras): "
+         << (okConc ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okSnap && okConc;
+
+    // ========== PRUEBA 8: EXPORTACIÓN BINARIA Y A FICHERO ==========
+    cout << "========================================\n";
+    cout << "  EXPORTACIÓN BINARIA Y A FICHERO\n";
+    cout << "========================================\n";
+
+    TransferFunctionSystem ex(b, a, Ts, 1000);
+    for (int k = 0; k < 2500; ++k) {
+        ex.next(1.0 + 0.001 * k);
+    }
+    vector<Sample> hist(1000);
+    ex.snapshot(&hist[0], 1000);
+
+    // Texto: mismo resultado que operator<< con la precisión y el modo del stream
+    ostringstream tsv, tsvFixed;
+    ex.bufferDump(tsv);
+    tsvFixed << fixed << setprecision(10);
+    ex.bufferDump(tsvFixed);
+    bool okText = tsv.str() == referenceTSV(hist, 6, false)
+               && tsvFixed.str() == referenceTSV(hist, 10, true);
+    cout << "  TSV idéntico a operator<< (general y fixed): " << (okText ? "OK" : "FALLO") << "\n";
+
+    ostringstream raw, npy, mat;
+    ex.bufferDump(raw, ExportFormat::RAW);
+    ex.bufferDump(npy, ExportFormat::NPY);
+    ex.bufferDump(mat, ExportFormat::MAT);
+    const string npyStr = npy.str(), matStr = mat.str();
+    const size_t npyHeader = 10 + (static_cast<unsigned char>(npyStr[8]) | static_cast<unsigned char>(npyStr[9]) << 8);
+    bool okRaw = sameColumns(raw.str(), 0, hist);
+    bool okNpy = npyStr.compare(0, 6, "\x93NUMPY") == 0 && npyHeader % 64 == 0
+              && npyStr.find("'shape': (1000, 3)") < npyHeader
+              && npyStr.find("'fortran_order': True") < npyHeader
+              && sameColumns(npyStr, npyHeader, hist);
+    bool okMat = matStr.size() > 192 && matStr.compare(0, 10, "MATLAB 5.0") == 0
+              && matStr[126] == 'I' && matStr[127] == 'M'
+              && matStr.compare(176, 4, "data") == 0 && sameColumns(matStr, 192, hist);
+    cout << "  RAW (columnas float64):  " << (okRaw ? "OK" : "FALLO") << "\n";
+    cout << "  NPY (cabecera de " << npyHeader << " bytes): " << (okNpy ? "OK" : "FALLO") << "\n";
+    cout << "  MAT Level 5 (data 1000x3): " << (okMat ? "OK" : "FALLO") << "\n";
+
+    // Ruta directa a fichero: mismos bytes que el volcado a stream
+    const ExportFormat fmts[] = {ExportFormat::TSV, ExportFormat::RAW, ExportFormat::NPY, ExportFormat::MAT};
+    const string streams[] = {tsv.str(), raw.str(), npyStr, matStr};
+    bool okFile = true;
+    const string path = "test_discretesystems_export.bin";
+    for (int f = 0; f < 4; ++f) {
+        ex.bufferDump(path, fmts[f]);
+        okFile = okFile && readFile(path) == streams[f];
+    }
+    bool okThrow = false;
+    try {
+        ex.bufferDump("/directorio/inexistente/x.npy", ExportFormat::NPY);
+    } catch (const ExportError&) {
+        okThrow = true;
+    }
+    cout << "  Fichero (mmap) igual que stream: " << (okFile ? "OK" : "FALLO")
+         << "  error de E/S como ExportError: " << (okThrow ? "OK" : "FALLO") << "\n";
+
+    // Coste con un buffer de 1M muestras
+    const size_t big = 1000000;
+    TransferFunctionSystem large(b, a, Ts, big);
+    vector<double> ub(big, 1.0), yb(big);
+    large.process(&ub[0], &yb[0], big);
+    vector<Sample> bigHist(big);
+    large.snapshot(&bigHist[0], big);
+    auto t0 = chrono::steady_clock::now();
+    const string slow = referenceTSV(bigHist, 6, false);
+    auto t1 = chrono::steady_clock::now();
+    ostringstream fast;
+    large.bufferDump(fast);
+    auto t2 = chrono::steady_clock::now();
+    large.bufferDump(path, ExportFormat::NPY);
+    auto t3 = chrono::steady_clock::now();
+    bool okBig = fast.str() == slow;
+    remove(path.c_str());
+    auto ms = [](chrono::steady_clock::duration d) { return chrono::duration<double, milli>(d).count(); };
+    cout << fixed << setprecision(1)
+         << "  1M muestras: operator<< " << ms(t1 - t0) << " ms, TSV " << ms(t2 - t1)
+         << " ms, NPY a fichero " << ms(t3 - t2) << " ms  " << (okBig ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okText && okRaw && okNpy && okMat && okFile && okThrow && okBig;
+
+    // ========== PRUEBA 9: GRABACIÓN CONTINUA ==========
+    cout << "========================================\n";
+    cout << "  GRABACIÓN CONTINUA (StreamRecorder)\n";
+    cout << "========================================\n";
+
+    // Sin pérdidas: el conjunto de páginas cabe la traza entera, y el
+    // buffer circular del sistema (100 muestras) no limita la grabación
+    const string recPath = "test_discretesystems_stream.rec";
+    const int recSteps = 50000;
+    const size_t recBlock = 20000;
+    TransferFunctionSystem recSys(b, a, Ts, 100), twin(b, a, Ts, 100);
+    vector<double> recIn, recOut;
+    bool okRec = true;
+    {
+        StreamRecorder recorder(recPath, 4096, 64);
+        recSys.setRecorder(&recorder);
+        for (int k = 0; k < recSteps; ++k) {
+            const double uk = sin(0.001 * k);
+            recSys.next(uk);
+            recIn.push_back(uk);
+            recOut.push_back(twin.next(uk));
+        }
+        vector<double> ublk(recBlock), yblk(recBlock), ytwin(recBlock);
+        for (size_t i = 0; i < recBlock; ++i) {
+            ublk[i] = 0.5 + 0.0001 * i;
+        }
+        recSys.process(&ublk[0], &yblk[0], recBlock);
+        twin.process(&ublk[0], &ytwin[0], recBlock);
+        recIn.insert(recIn.end(), ublk.begin(), ublk.end());
+        recOut.insert(recOut.end(), ytwin.begin(), ytwin.end());
+        recorder.close();
+        recSys.setRecorder(nullptr);
+        okRec = recorder.appended() == recIn.size() && recorder.written() == recIn.size()
+             && recorder.dropped() == 0 && !recorder.failed();
+    }
+    vector<Sample> rec = StreamRecorder::readFile(recPath);
+    okRec = okRec && rec.size() == recIn.size();
+    for (size_t i = 0; okRec && i < rec.size(); ++i) {
+        okRec = rec[i].k == static_cast<int>(i) && rec[i].in == recIn[i] && rec[i].out == recOut[i];
+    }
+    cout << "  " << rec.size() << " muestras con buffer de 100, sin pérdidas: "
+         << (okRec ? "OK" : "FALLO") << "\n";
+
+    // Escritor desbordado: 2 páginas de 64 muestras frente a una ráfaga sin pausas
+    const DropPolicy policies[] = {DropPolicy::DropNewest, DropPolicy::DropPage};
+    const char* policyNames[] = {"DropNewest", "DropPage  "};
+    const int burst = 1000000;
+    bool okDrop = true;
+    for (int p = 0; p < 2; ++p) {
+        uint64_t appended, written, dropped;
+        {
+            StreamRecorder tiny(recPath, 64, 2, policies[p]);
+            for (int k = 0; k < burst; ++k) {
+                tiny.append(k, 1.0, static_cast<double>(k));
+            }
+            tiny.close();
+            appended = tiny.appended();
+            written = tiny.written();
+            dropped = tiny.dropped();
+        }
+        vector<Sample> got = StreamRecorder::readFile(recPath);
+        bool okPolicy = appended == static_cast<uint64_t>(burst) && dropped > 0
+                     && written + dropped == appended && got.size() == written;
+        for (size_t i = 0; okPolicy && i < got.size(); ++i) {
+            okPolicy = got[i].out == got[i].k && (i == 0 || got[i].k > got[i - 1].k);
+        }
+        // DropPage siempre conserva lo más reciente
+        if (policies[p] == DropPolicy::DropPage) {
+            okPolicy = okPolicy && !got.empty() && got.back().k == burst - 1;
+        }
+        cout << "  " << policyNames[p] << ": escritas=" << written << "  descartadas=" << dropped
+             << "  contabilidad y orden: " << (okPolicy ? "OK" : "FALLO") << "\n";
+        okDrop = okDrop && okPolicy;
+    }
+
+    // Compresión
+    bool okGz = true;
+    if (StreamRecorder::compressionAvailable()) {
+        const int gzSamples = 100000;
+        {
+            StreamRecorder gz(recPath, 8192, 16, DropPolicy::DropNewest, Compression::Gzip);
+            for (int k = 0; k < gzSamples; ++k) {
+                gz.append(k, 1.0, 0.5 * (k % 100));
+            }
+            gz.close();
+            okGz = gz.written() == static_cast<uint64_t>(gzSamples) && !gz.failed();
+        }
+        const size_t gzBytes = readFile(recPath).size();
+        vector<Sample> got = StreamRecorder::readFile(recPath);
+        okGz = okGz && got.size() == static_cast<size_t>(gzSamples)
+            && gzBytes < gzSamples * sizeof(StreamRecorder::Record);
+        for (size_t i = 0; okGz && i < got.size(); ++i) {
+            okGz = got[i].k == static_cast<int>(i) && got[i].out == 0.5 * (i % 100);
+        }
+        cout << "  gzip: " << gzBytes << " bytes para " << gzSamples << " muestras: "
+             << (okGz ? "OK" : "FALLO") << "\n";
+    } else {
+        cout << "  gzip: no disponible (compilado sin zlib)\n";
+    }
+    remove(recPath.c_str());
+
+    bool okRecErr = false;
+    try {
+        StreamRecorder bad("/directorio/inexistente/x.rec");
+    } catch (const ExportError&) {
+        okRecErr = true;
+    }
+    try {
+        StreamRecorder bad(recPath, 64, 1);
+        okRecErr = false;
+    } catch (const InvalidDimensions&) {
+    }
+    cout << "  Errores de apertura y dimensiones: " << (okRecErr ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okRec && okDrop && okGz && okRecErr;
+
+    // ========== PRUEBA 10: POLÍTICAS DE REGISTRO ==========
+    cout << "========================================\n";
+    cout << "  POLÍTICAS DE REGISTRO (RecordingPolicy)\n";
+    cout << "========================================\n";
+
+    const RecordingPolicy policiesRec[] = {
+        RecordingPolicy(),
+        RecordingPolicy(RecordFields::Output),
+        RecordingPolicy(RecordFields::InputOutput, RecordPrecision::Float),
+        RecordingPolicy(RecordFields::Output, RecordPrecision::Float),
+        RecordingPolicy(RecordFields::None)
+    };
+    const char* policyRecNames[] = {"u+y double", "y double  ", "u+y float ", "y float   ", "ninguno   "};
+    const size_t expectedBytes[] = {16, 8, 8, 4, 0};
+
+    // Referencia: stepping sin cambios y salida idéntica con cualquier política
+    const size_t polBuf = 1000;
+    TransferFunctionSystem polRef(b, a, Ts, polBuf);
+    vector<double> polU(300), polY(300);
+    for (size_t i = 0; i < polU.size(); ++i) {
+        polU[i] = cos(0.01 * i);
+    }
+    vector<double> refOut;
+    for (int k = 0; k < 2500; ++k) {
+        refOut.push_back(polRef.next(0.001 * k));
+    }
+    polRef.process(&polU[0], &polY[0], polU.size());
+    refOut.insert(refOut.end(), polY.begin(), polY.end());
+    vector<Sample> refHist(polBuf);
+    polRef.snapshot(&refHist[0], polBuf);
+
+    bool okPol = true;
+    for (int p = 0; p < 5; ++p) {
+        const RecordingPolicy pol = policiesRec[p];
+        TransferFunctionSystem sys(b, a, Ts, polBuf, FilterStructure::DirectForm, pol);
+        bool okSame = true;
+        for (int k = 0; k < 2500; ++k) {
+            okSame = okSame && sys.next(0.001 * k) == refOut[k];
+        }
+        sys.process(&polU[0], &polY[0], polU.size());
+        for (size_t i = 0; i < polY.size(); ++i) {
+            okSame = okSame && polY[i] == refOut[2500 + i];
+        }
+
+        vector<Sample> hist(polBuf);
+        const size_t n = sys.snapshot(&hist[0], polBuf);
+        bool okHist = pol.bytesPerSample() == expectedBytes[p]
+                   && n == (pol.fields == RecordFields::None ? 0 : polBuf) && sys.getCount() == n;
+        const bool hasIn = pol.fields == RecordFields::InputOutput;
+        const bool dbl = pol.precision == RecordPrecision::Double;
+        for (size_t i = 0; okHist && i < n; ++i) {
+            const Sample& r = refHist[i];
+            const double in = dbl ? r.in : static_cast<float>(r.in);
+            const double out = dbl ? r.out : static_cast<float>(r.out);
+            okHist = hist[i].k == r.k && hist[i].out == out
+                  && (hasIn ? hist[i].in == in : std::isnan(hist[i].in));
+        }
+        cout << "  " << policyRecNames[p] << ": " << pol.bytesPerSample() << " B/muestra, salida "
+             << (okSame ? "idéntica" : "DISTINTA") << ", historial " << (okHist ? "OK" : "FALLO") << "\n";
+        okPol = okPol && okSame && okHist;
+    }
+
+    // Cambio de política en marcha: el buffer se vacía y k continúa
+    TransferFunctionSystem sw(b, a, Ts, 100);
+    for (int k = 0; k < 250; ++k) {
+        sw.next(1.0);
+    }
+    sw.setRecordingPolicy(RecordingPolicy(RecordFields::Output, RecordPrecision::Float));
+    bool okSwitch = sw.getCount() == 0;
+    for (int k = 0; k < 30; ++k) {
+        sw.next(1.0);
+    }
+    vector<Sample> swHist;
+    uint64_t swLost = 0;
+    sw.readSince(0, swHist, &swLost);
+    okSwitch = okSwitch && swHist.size() == 30 && swHist.front().k == 250 && swHist.back().k == 279;
+    sw.reset();
+    sw.next(1.0);
+    vector<Sample> one(1);
+    okSwitch = okSwitch && sw.snapshot(&one[0], 1) == 1 && one[0].k == 0;
+    cout << "  setRecordingPolicy() en marcha y reset(): " << (okSwitch ? "OK" : "FALLO") << "\n";
+
+    // Sólo salida: la columna u se exporta como NaN
+    TransferFunctionSystem outOnly(b, a, Ts, 10, FilterStructure::DirectForm, RecordingPolicy(RecordFields::Output));
+    for (int k = 0; k < 10; ++k) {
+        outOnly.next(1.0);
+    }
+    ostringstream rawOut;
+    outOnly.bufferDump(rawOut, ExportFormat::RAW);
+    double uCol;
+    memcpy(&uCol, rawOut.str().data() + 10 * sizeof(double), sizeof(double));
+    bool okNan = rawOut.str().size() == 30 * sizeof(double) && std::isnan(uCol);
+    cout << "  Exportación sin columna u (NaN): " << (okNan ? "OK" : "FALLO") << "\n";
+
+    // Coste de registro en una cadena de cinco bloques
+    const int chainTicks = 2000000;
+    cout << "  Cadena de 5 bloques, " << chainTicks << " ticks con buffer de 4096:\n";
+    for (int p = 0; p < 5; ++p) {
+        vector<TransferFunctionSystem> chain;
+        for (int i = 0; i < 5; ++i) {
+            chain.push_back(TransferFunctionSystem(b, a, Ts, 4096, FilterStructure::DirectForm, policiesRec[p]));
+        }
+        double x = 0.0;
+        auto c0 = chrono::steady_clock::now();
+        for (int k = 0; k < chainTicks; ++k) {
+            double v = 1.0 - 0.5 * x;
+            for (int i = 0; i < 5; ++i) {
+                v = chain[i].next(v);
+            }
+            x = v;
+        }
+        auto c1 = chrono::steady_clock::now();
+        cout << "    " << policyRecNames[p] << ": " << setprecision(1)
+             << chrono::duration<double, nano>(c1 - c0).count() / chainTicks << " ns/tick"
+             << "  (y=" << setprecision(4) << x << ")\n";
+    }
+    cout << "========================================\n\n";
+    ok = ok && okPol && okSwitch && okNan;
+
+    // ========== PRUEBA 11: TIPOS ESCALARES ==========
+    cout << "========================================\n";
+    cout << "  TIPOS ESCALARES (float, Q15, Q31)\n";
+    cout << "========================================\n";
+    {
+        const vector<double> bp = {0.0099, 0.0099};
+        const vector<double> ap = {1.0, -0.9802};
+        vector<double> x(4000);
+        for (size_t k = 0; k < x.size(); ++k) {
+            x[k] = (k < 2000 ? 0.5 : -0.25) + 0.2 * sin(0.01 * static_cast<double>(k));
+        }
+
+        // double: mismo orden de operaciones que TransferFunctionSystem
+        BasicTransferFunction<double> tfDouble(b, a);
+        TransferFunctionSystem tfDyn(b, a, Ts);
+        bool okDouble = true;
+        for (size_t k = 0; k < x.size(); ++k) {
+            okDouble = okDouble && tfDouble.step(x[k]) == tfDyn.next(x[k]);
+        }
+        cout << "  BasicTransferFunction<double> bit a bit: " << (okDouble ? "OK" : "FALLO") << "\n";
+
+        const BasicTransferFunction<double> ref(bp, ap);
+        const Deviation dFloat = compareWithReference(BasicTransferFunction<float>(bp, ap), ref, x.data(), x.size());
+        const Deviation dQ31 = compareWithReference(BasicTransferFunction<Q31>(bp, ap), ref, x.data(), x.size());
+        const Deviation dQ15 = compareWithReference(BasicTransferFunction<Q15>(bp, ap), ref, x.data(), x.size());
+        cout << scientific << setprecision(2);
+        cout << "  Desviación máxima: float " << dFloat.maxAbs << ", Q31 " << dQ31.maxAbs
+             << ", Q15 " << dQ15.maxAbs << " (k = " << dQ15.argMax << ")\n";
+        cout << fixed << setprecision(4);
+        // Q15: el redondeo de y(k) se amplifica por 1 / (1 - 0.9802)
+        const bool okDev = dFloat.maxAbs < 1e-5 && dQ31.maxAbs < 1e-6 && dQ15.maxAbs < 2e-3
+                        && dQ15.maxAbs > dQ31.maxAbs && dQ15.samples == x.size();
+        cout << "  Dentro de las cotas de cada palabra: " << (okDev ? "OK" : "FALLO") << "\n";
+
+        typedef ScalarTraits<Q15> T15;
+        typedef Fixed<int16_t, 15, Overflow::Wrap> Q15Wrap;
+        typedef Fixed<int16_t, 15, Overflow::Saturate, Rounding::Truncate> Q15Trunc;
+        const bool okSat = T15::fromDouble(2.0).raw == 32767 && T15::fromDouble(-2.0).raw == -32768
+                        && T15::fromDouble(nan("")).raw == 0
+                        && ScalarTraits<Q15Wrap>::fromDouble(1.0).raw == -32768
+                        && ScalarTraits<Q15Wrap>::fromDouble(1.25).raw == -24576
+                        && T15::fromDouble(-1e-6).raw == 0 && ScalarTraits<Q15Trunc>::fromDouble(-1e-6).raw == -1
+                        && ScalarTraits<Q31>::toDouble(ScalarTraits<Q31>::fromDouble(0.5)) == 0.5;
+        cout << "  Conversión con saturación, envoltura y redondeo: " << (okSat ? "OK" : "FALLO") << "\n";
+
+        // Ganancia 4: la salida satura en el fondo de escala; con envoltura cambia de signo
+        BasicTransferFunction<Q15> gainSat({4.0}, {1.0});
+        BasicTransferFunction<Q15Wrap> gainWrap({4.0}, {1.0});
+        const bool okOut = gainSat.step(T15::fromDouble(0.5)).raw == 32767
+                        && gainWrap.step(ScalarTraits<Q15Wrap>::fromDouble(0.5)).raw == 0
+                        && gainWrap.step(ScalarTraits<Q15Wrap>::fromDouble(0.375)).raw == -16384;
+        bool okRange = false;
+        try {
+            BasicTransferFunction<Q15> tooBig({100.0}, {1.0});
+        } catch (const InvalidCoefficients&) {
+            okRange = true;
+        }
+        cout << "  Salida saturada / envuelta y coeficiente fuera de rango: "
+             << (okOut && okRange ? "OK" : "FALLO") << "\n";
+        ok = ok && okDouble && okDev && okSat && okOut && okRange;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 12: AVANCE CON ENTRADA CONSTANTE ==========
+    cout << "========================================\n";
+    cout << "  AVANCE CON ENTRADA CONSTANTE (advance)\n";
+    cout << "========================================\n";
+    cout << "  advance(k, u) frente a k llamadas a next(u)\n";
+    cout << "----------------------------------------\n";
+    {
+        const size_t jumps[] = {1, 2, 7, 1000, 123456};
+        const char* names[] = {"SS       ", "TF forma directa", "TF SOS   "};
+        for (int c = 0; c < 3; ++c) {
+            double maxRel = 0.0;
+            bool okK = true;
+            for (size_t steps : jumps) {
+                StateSpaceSystem ss1(A, B, C, 0.3, Ts), ss2(A, B, C, 0.3, Ts);
+                TransferFunctionSystem df1(b, a, Ts), df2(b, a, Ts);
+                TransferFunctionSystem sos1(b, a, Ts, 100, FilterStructure::SecondOrderSections);
+                TransferFunctionSystem sos2(b, a, Ts, 100, FilterStructure::SecondOrderSections);
+                DiscreteSystem& s1 = c == 0 ? static_cast<DiscreteSystem&>(ss1) : c == 1 ? df1 : sos1;
+                DiscreteSystem& s2 = c == 0 ? static_cast<DiscreteSystem&>(ss2) : c == 1 ? df2 : sos2;
+                // Estado inicial no nulo, salto y continuación con otra entrada
+                for (int i = 0; i < 5; ++i) {
+                    s1.next(0.1 * i);
+                    s2.next(0.1 * i);
+                }
+                double y1 = s1.advance(steps, 0.7), y2 = 0.0;
+                for (size_t i = 0; i < steps; ++i) {
+                    y2 = s2.next(0.7);
+                }
+                maxRel = max(maxRel, fabs(y1 - y2) / max(1.0, fabs(y2)));
+                for (int i = 0; i < 20; ++i) {
+                    y1 = s1.next(-0.2);
+                    y2 = s2.next(-0.2);
+                    maxRel = max(maxRel, fabs(y1 - y2) / max(1.0, fabs(y2)));
+                }
+                okK = okK && s1.getK() == s2.getK();
+            }
+            const bool okAdv = maxRel <= 1e-9 && okK;
+            cout << "  " << names[c] << "  max error relativo = " << scientific << setprecision(2)
+                 << maxRel << "  " << (okAdv ? "OK" : "FALLO") << "\n";
+            ok = ok && okAdv;
+        }
+        cout << fixed;
+
+        // Caché sin construir: apply() no toca el vector ni calcula potencias
+        MatrixPowers none;
+        double z[2] = {1.5, -2.0};
+        none.apply(0, z);
+        none.apply(123456, z);
+        const bool okEmpty = none.empty() && none.cachedLevels() == 0 && z[0] == 1.5 && z[1] == -2.0;
+        cout << "  MatrixPowers vacío: apply() sin efecto: " << (okEmpty ? "OK" : "FALLO") << "\n";
+        ok = ok && okEmpty;
+
+        // hold(): el buffer recibe bufferSize copias contiguas y el grabador un solo registro
+        const string holdPath = "test_discretesystems_hold.rec";
+        TransferFunctionSystem held(b, a, Ts, 100);
+        bool okRecHold = false;
+        {
+            StreamRecorder recorder(holdPath, 4096, 64);
+            held.setRecorder(&recorder);
+            held.next(1.0);
+            held.hold(300, 1.0, 0.25);
+            held.next(1.0);
+            recorder.close();
+            held.setRecorder(nullptr);
+            okRecHold = recorder.appended() == 3 && recorder.dropped() == 0;
+        }
+        vector<Sample> snap(100);
+        const size_t got = held.snapshot(&snap[0], snap.size());
+        bool okHold = got == 100 && held.getK() == 302 && held.getCount() == 100;
+        for (size_t i = 0; okHold && i + 1 < got; ++i) {
+            okHold = snap[i].k == static_cast<int>(202 + i) && snap[i].in == 1.0 && snap[i].out == 0.25;
+        }
+        okHold = okHold && snap[99].k == 301;
+        cout << "  hold(300) con buffer de 100: k contiguo y valores mantenidos: "
+             << (okHold ? "OK" : "FALLO") << "\n";
+
+        const vector<Sample> rec = StreamRecorder::readFile(holdPath);
+        okRecHold = okRecHold && rec.size() == 302;
+        for (size_t i = 0; okRecHold && i < rec.size(); ++i) {
+            okRecHold = rec[i].k == static_cast<int>(i)
+                     && (i == 0 || i == 301 || (rec[i].in == 1.0 && rec[i].out == 0.25));
+        }
+        std::remove(holdPath.c_str());
+        cout << "  StreamRecorder: un registro de tramo expandido por readFile(): "
+             << (okRecHold ? "OK" : "FALLO") << "\n";
+        ok = ok && okHold && okRecHold;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 13: ANÁLISIS SIN SIMULACIÓN ==========
+    cout << "========================================\n";
+    cout << "  ANÁLISIS SIN SIMULACIÓN (Analysis)\n";
+    cout << "========================================\n";
+    {
+        typedef Analysis::Complex cplx;
+        const double wN = 3.14159265358979323846 / Ts;
+        const vector<double> w = Analysis::logspace(1e-3 * wN, wN, 10000);
+
+        // Horner por bloques frente a la evaluación directa con std::complex
+        TransferFunctionSystem tfa(b, a, Ts);
+        StateSpaceSystem ssa(A, B, C, 0.3, Ts);
+        const vector<cplx> Htf = Analysis::frequencyResponse(tfa, w, 1);
+        const vector<cplx> Htf4 = Analysis::frequencyResponse(tfa, w, 4);
+        const vector<cplx> Hss = Analysis::frequencyResponse(ssa, w, 4);
+        double errTf = 0.0, errSs = 0.0;
+        bool okThreads = true;
+        for (size_t i = 0; i < w.size(); ++i) {
+            const cplx q = polar(1.0, -w[i] * Ts);
+            const cplx h = (b[0] + q * (b[1] + q * b[2])) / (a[0] + q * (a[1] + q * a[2]));
+            errTf = max(errTf, abs(Htf[i] - h) / abs(h));
+            errSs = max(errSs, abs(Hss[i] - (h + 0.3)) / abs(h + 0.3));
+            okThreads = okThreads && Htf[i] == Htf4[i];
+        }
+        const bool okFreq = errTf <= 1e-12 && errSs <= 1e-12 && okThreads;
+        cout << "  10000 frecuencias: error TF = " << scientific << setprecision(2) << errTf
+             << ", SS = " << errSs << fixed << ", 1 y 4 hilos idénticos: " << (okFreq ? "OK" : "FALLO") << "\n";
+
+        const Analysis::Bode bd = Analysis::bode(w, Htf);
+        bool okBode = fabs(bd.magnitudeDb[0] - 20.0 * log10(abs(Htf[0]))) < 1e-12;
+        for (size_t i = 1; okBode && i < w.size(); ++i) {
+            okBode = fabs(bd.phaseDeg[i] - bd.phaseDeg[i - 1]) < 180.0;
+        }
+        cout << "  Bode: fase desenrollada: " << (okBode ? "OK" : "FALLO") << "\n";
+
+        // Impulso y escalón frente a la simulación (TF en SOS y SS, orden 2)
+        TransferFunctionSystem sim(b, a, Ts, 100, FilterStructure::SecondOrderSections);
+        TransferFunctionSystem simStep(b, a, Ts, 100, FilterStructure::SecondOrderSections);
+        StateSpaceSystem ssImp(A, B, C, 0.3, Ts), ssStep(A, B, C, 0.3, Ts);
+        const vector<double> hImp = Analysis::impulse(sim, 2000), hStep = Analysis::step(simStep, 2000);
+        const vector<double> sImp = Analysis::impulse(ssImp, 200), sStep = Analysis::step(ssStep, 200);
+        double errRespTf = 0.0, errRespSs = 0.0, scale = 0.0;
+        for (size_t k = 0; k < 2000; ++k) {
+            const double yi = sim.next(k == 0 ? 1.0 : 0.0), ys = simStep.next(1.0);
+            errRespTf = max(errRespTf, max(fabs(yi - hImp[k]), fabs(ys - hStep[k])));
+            scale = max(scale, fabs(ys));
+        }
+        for (size_t k = 0; k < 200; ++k) {
+            errRespSs = max(errRespSs, max(fabs(ssImp.next(k == 0 ? 1.0 : 0.0) - sImp[k]),
+                                           fabs(ssStep.next(1.0) - sStep[k])));
+        }
+        const bool okResp = errRespTf <= 1e-12 * scale && errRespSs <= 1e-12 && sim.getK() == 2000;
+        cout << "  impulse()/step() frente a next(): " << (okResp ? "OK" : "FALLO") << "\n";
+
+        // Polos: 0.6 ± 0.3742j (|p| = √0.5) en TF y SS
+        const vector<cplx> pTf = Analysis::poles(tfa), pSs = Analysis::poles(ssa);
+        bool okPoles = pTf.size() == 2 && pSs.size() == 2 && Analysis::isStable(pTf);
+        for (size_t i = 0; okPoles && i < 2; ++i) {
+            okPoles = fabs(abs(pTf[i]) - sqrt(0.5)) < 1e-12 && fabs(pTf[i].real() - 0.6) < 1e-12
+                   && fabs(abs(pSs[i]) - sqrt(0.5)) < 1e-12;
+        }
+        const vector<double> unstable = {1.0, -2.5, 1.0};   // polos 2 y 0.5
+        okPoles = okPoles && !Analysis::isStable(Analysis::poles(vector<double>(1, 1.0), unstable));
+        cout << "  Polos y estabilidad: " << (okPoles ? "OK" : "FALLO") << "\n";
+
+        // Orden 24: 12 pares conocidos, en SS girados por una reflexión densa
+        // (A = P D P) y en TF como denominador expandido
+        vector<complex<double>> known;
+        for (int i = 0; i < 12; ++i) {
+            known.push_back(polar(0.5 + 0.035 * i, 0.2 + 0.23 * i));
+        }
+        const size_t nh = 2 * known.size();
+        vector<vector<double>> D(nh, vector<double>(nh, 0.0)), Ah(nh, vector<double>(nh, 0.0));
+        for (size_t i = 0; i < known.size(); ++i) {
+            D[2 * i][2 * i] = D[2 * i + 1][2 * i + 1] = known[i].real();
+            D[2 * i][2 * i + 1] = -known[i].imag();
+            D[2 * i + 1][2 * i] = known[i].imag();
+        }
+        vector<double> v(nh);
+        double vv = 0.0;
+        for (size_t i = 0; i < nh; ++i) {
+            v[i] = 1.0 + 0.1 * static_cast<double>(i);
+            vv += v[i] * v[i];
+        }
+        for (size_t i = 0; i < nh; ++i) {
+            for (size_t j = 0; j < nh; ++j) {
+                double s = 0.0;   // (P D P)_ij con P = I - 2 v v^T / (v^T v)
+                for (size_t k = 0; k < nh; ++k) {
+                    for (size_t l = 0; l < nh; ++l) {
+                        const double pik = (i == k ? 1.0 : 0.0) - 2.0 * v[i] * v[k] / vv;
+                        const double plj = (l == j ? 1.0 : 0.0) - 2.0 * v[l] * v[j] / vv;
+                        s += pik * D[k][l] * plj;
+                    }
+                }
+                Ah[i][j] = s;
+            }
+        }
+        StateSpaceSystem ssh(Ah, vector<double>(nh, 1.0), vector<double>(nh, 1.0), 0.0, Ts);
+        const vector<cplx> pSsHigh = Analysis::poles(ssh);
+        const vector<cplx> pTfHigh = Analysis::poles(vector<double>(1, 1.0), fromConjugatePoles(known));
+        // Distancia máxima de cada polo calculado al conocido más cercano
+        auto worst = [&known](const vector<cplx>& p) {
+            double err = 0.0;
+            for (size_t i = 0; i < p.size(); ++i) {
+                double d = 1.0;
+                for (size_t j = 0; j < known.size(); ++j) {
+                    d = min(d, min(abs(p[i] - known[j]), abs(p[i] - conj(known[j]))));
+                }
+                err = max(err, d);
+            }
+            return err;
+        };
+        const double errSsHigh = worst(pSsHigh), errTfHigh = worst(pTfHigh);
+        const bool okHigh = pSsHigh.size() == nh && pTfHigh.size() == nh && errSsHigh <= 1e-12 && errTfHigh <= 1e-10
+                         && Analysis::isStable(pSsHigh);
+        cout << "  Polos de orden 24: error SS = " << scientific << setprecision(2) << errSsHigh
+             << ", TF = " << errTfHigh << fixed << ": " << (okHigh ? "OK" : "FALLO") << "\n";
+        okPoles = okPoles && okHigh;
+
+        // L = z^-1 / (1 - z^-1): |L| = 1 en ωTs = π/3 con PM = 60°; L(-1) = -1/2: GM = 2
+        const Analysis::Margins mi = Analysis::margins({0.0, 1.0}, {1.0, -1.0}, Ts);
+        // L = 0.5 z^-1: sin cruce de ganancia
+        const Analysis::Margins mg = Analysis::margins({0.0, 0.5}, {1.0}, Ts);
+        const bool okMargins = fabs(mi.phaseMargin - 60.0) < 1e-9 && fabs(mi.gainCrossover * Ts - wN * Ts / 3.0) < 1e-9
+                            && fabs(mi.gainMargin - 2.0) < 1e-9 && fabs(mi.phaseCrossover - wN) < 1e-9 * wN
+                            && fabs(mg.gainMargin - 2.0) < 1e-12 && std::isinf(mg.phaseMargin);
+        cout << "  Márgenes: PM = " << setprecision(4) << mi.phaseMargin << "°, GM = " << mi.gainMargin
+             << ": " << (okMargins ? "OK" : "FALLO") << "\n";
+        ok = ok && okFreq && okBode && okResp && okPoles && okMargins;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 14: FIR LARGOS POR FFT ==========
+    cout << "========================================\n";
+    cout << "  FIR LARGOS: CONVOLUCIÓN FFT EN process()\n";
+    cout << "========================================\n";
+    {
+        const size_t tapCounts[] = {40, 200, 4096};
+        const size_t expectedP[] = {0, 64, 256};
+        for (int c = 0; c < 3; ++c) {
+            const size_t taps = tapCounts[c];
+            vector<double> h(taps);
+            double sumAbs = 0.0;
+            for (size_t i = 0; i < taps; ++i) {
+                h[i] = sin(0.05 * i) * exp(-3.0 * i / taps);
+                sumAbs += fabs(h[i]);
+            }
+            // a = [1, 0]: misma ecuación en forma directa, sin el camino FFT
+            TransferFunctionSystem fir(h, {1.0}, Ts, 100), direct(h, {1.0, 0.0}, Ts, 100);
+            const size_t chunks[] = {1000, 256, 7, 5000, 300, 64, 2048};
+            double maxErr = 0.0;
+            size_t pos = 0;
+            for (int r = 0; r < 3; ++r) {
+                for (size_t chunk : chunks) {
+                    vector<double> ub(chunk), y1(chunk), y2(chunk);
+                    for (size_t i = 0; i < chunk; ++i) {
+                        ub[i] = u[(pos + i) % u.size()] + 0.1 * sin(0.3 * (pos + i));
+                    }
+                    fir.process(&ub[0], &y1[0], chunk);
+                    direct.process(&ub[0], &y2[0], chunk);
+                    for (size_t i = 0; i < chunk; ++i) {
+                        maxErr = max(maxErr, fabs(y1[i] - y2[i]));
+                    }
+                    pos += chunk;
+                    // next() intercalado: la línea de retardo se reconstruye en el siguiente bloque
+                    maxErr = max(maxErr, fabs(fir.next(0.25) - direct.next(0.25)));
+                    ++pos;
+                }
+            }
+            const double bound = 1e-13 * sumAbs * 1.1;
+            const bool okFir = fir.getFftPartition() == expectedP[c] && maxErr <= bound && fir.getK() == direct.getK();
+            cout << "  " << setw(4) << taps << " coeficientes  P = " << setw(3) << fir.getFftPartition()
+                 << "  max|y_fft - y_df| = " << scientific << setprecision(2) << maxErr
+                 << fixed << "  " << (okFir ? "OK" : "FALLO") << "\n";
+            ok = ok && okFir;
+        }
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 15: INSTANTÁNEAS DE ESTADO ==========
+    cout << "========================================\n";
+    cout << "  INSTANTÁNEAS (checkpoint / restore)\n";
+    cout << "========================================\n";
+    {
+        vector<double> uc(600);
+        for (size_t i = 0; i < uc.size(); ++i) {
+            uc[i] = sin(0.07 * i) + 0.3 * cos(0.31 * i);
+        }
+        const vector<double> bq = {0.02, 0.05, 0.04, 0.01};
+        const vector<double> aq = {1.0, -2.1, 1.6, -0.42};
+        vector<double> h(200);
+        for (size_t i = 0; i < h.size(); ++i) {
+            h[i] = sin(0.05 * i) * exp(-0.015 * i);
+        }
+        const vector<vector<double>> Ac = {{0.5, 0.1, 0.0}, {-0.2, 0.7, 0.05}, {0.0, 0.1, 0.3}};
+        const vector<double> Bc = {1.0, 0.5, -0.2}, Cc = {0.3, -0.1, 0.8};
+
+        for (int buffers = 1; buffers >= 0; --buffers) {
+            TransferFunctionSystem df1(bq, aq, Ts, 500), df2(bq, aq, Ts, 500);
+            TransferFunctionSystem sos1(bq, aq, Ts, 500, FilterStructure::SecondOrderSections);
+            TransferFunctionSystem sos2(bq, aq, Ts, 500, FilterStructure::SecondOrderSections);
+            const RecordingPolicy f32(RecordFields::InputOutput, RecordPrecision::Float);
+            TransferFunctionSystem fir1(h, {1.0}, Ts, 100, FilterStructure::DirectForm, f32);
+            TransferFunctionSystem fir2(h, {1.0}, Ts, 100, FilterStructure::DirectForm, f32);
+            StateSpaceSystem ss1(Ac, Bc, Cc, 0.1, Ts), ss2(Ac, Bc, Cc, 0.1, Ts);
+            const bool okDf = restoresExactly(df1, df2, uc, buffers == 1);
+            const bool okSos = restoresExactly(sos1, sos2, uc, buffers == 1);
+            const bool okFfir = restoresExactly(fir1, fir2, uc, buffers == 1);
+            const bool okSs = restoresExactly(ss1, ss2, uc, buffers == 1);
+            cout << "  " << (buffers == 1 ? "con buffers:" : "sin buffers:")
+                 << "  DF " << (okDf ? "OK" : "FALLO") << "  SOS " << (okSos ? "OK" : "FALLO")
+                 << "  FIR/FFT " << (okFfir ? "OK" : "FALLO") << "  SS " << (okSs ? "OK" : "FALLO") << "\n";
+            ok = ok && okDf && okSos && okFfir && okSs;
+        }
+
+        // Otro tipo de sistema, otro orden o instantánea truncada
+        TransferFunctionSystem tf(bq, aq, Ts, 100), tf2(bq, {1.0, -0.5}, Ts, 100);
+        StateSpaceSystem ss(Ac, Bc, Cc, 0.1, Ts);
+        for (size_t i = 0; i < 50; ++i) {
+            tf.next(uc[i]);
+        }
+        CheckpointWriter w;
+        tf.checkpoint(w);
+        int rejected = 0;
+        const int before = ss.getK();
+        CheckpointReader r1(w);
+        try { ss.restore(r1); } catch (const CheckpointError&) { ++rejected; }
+        CheckpointReader r2(w);
+        try { tf2.restore(r2); } catch (const CheckpointError&) { ++rejected; }
+        CheckpointReader r3(w.data().data(), w.size() / 2);
+        try { tf2.restore(r3); } catch (const CheckpointError&) { ++rejected; }
+        const char junk[16] = {'n', 'o', ' ', 'e', 's'};
+        try { CheckpointReader r4(junk, sizeof(junk)); } catch (const CheckpointError&) { ++rejected; }
+        const bool okReject = rejected == 4 && ss.getK() == before && tf2.getK() == 0;
+        cout << "  Tipo, orden, truncado y cabecera inválidos rechazados sin cambios: "
+             << (okReject ? "OK" : "FALLO") << "\n";
+        ok = ok && okReject;
+    }
+    cout << "========================================\n\n";
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
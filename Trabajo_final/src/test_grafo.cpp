@@ -0,0 +1,419 @@
+/**
+ * @file test_grafo.cpp
+ * @brief Programa de prueba para los diagramas de bloques compilados
+ *
+ * Prueba:
+ * - makeLoopGraph(): coincide bit a bit con LoopRunner; reset()
+ * - Arena: un tramo por bloque, contiguos y en el orden del plan
+ * - series(), parallel() y feedback() frente a la composición manual
+ * - Retardos en lazo mutuo: la fase de salida lee el estado antes de actualizarlo
+ * - Validación: lazos algebraicos, bloques sin entrada y conexiones inválidas
+ * - fuse(): serie y paralelo LTI, sondas de señales absorbidas, saturación,
+ *   toSystem() en forma directa y en SOS, y límite de orden
+ */
+
+#include <grafo.h>
+#include <lazo.h>
+#include <DiscreteSystems/Polynomial.h>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+using namespace Grafo;
+using namespace std;
+
+namespace {
+
+/**
+ * @brief Mensaje de la InvalidGraph que lanza compile() (vacío si compila)
+ */
+string rejection(const SystemGraph& g) {
+    try {
+        g.compile();
+    } catch (const InvalidGraph& ex) {
+        cout << "    " << ex.what() << "\n";
+        return ex.what();
+    }
+    return "";
+}
+
+/**
+ * @brief Máxima diferencia entre dos señales de sendos grafos en K ticks con la misma entrada
+ */
+double maxDiff(CompiledGraph& a, BlockId ia, CompiledGraph& b, BlockId ib, size_t K,
+               double (*input)(size_t)) {
+    double err = 0.0;
+    for (size_t k = 0; k < K; ++k) {
+        const double in = input(k);
+        a.tick(&in);
+        b.tick(&in);
+        err = max(err, fabs(a.value(ia) - b.value(ib)));
+    }
+    return err;
+}
+
+double stepInput(size_t k) {
+    return k >= 5 ? 1.0 : 0.0;
+}
+
+double chirpInput(size_t k) {
+    return sin(0.0005 * static_cast<double>(k * k));
+}
+
+} // namespace
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE DIAGRAMAS DE BLOQUES                     ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    const double Ts = 0.01;
+    const size_t K = 2000;
+    bool ok = true;
+
+    RefSignal::StepSignal ref(Ts, 1.0, 0.055);
+    Controlador::PIDController pid(2.0, 4.0, 0.01, Ts);
+    Planta::Sistema planta(Ts);
+
+    // ========== PRUEBA 1: LAZO FRENTE A LOOPRUNNER ==========
+    cout << "========================================\n";
+    cout << "  GRAFO DEL LAZO FRENTE A LOOPRUNNER\n";
+    cout << "========================================\n";
+
+    auto loop = Lazo::makeLoop(ref, pid, Convertidores::DAConverter(Ts), planta, Convertidores::ADConverter(Ts));
+    CompiledGraph graph = makeLoopGraph(pid, planta).compile();
+    const BlockId gr = graph.find("r"), ge = graph.find("e"), gu = graph.find("pid");
+    const BlockId gy = graph.find("planta"), gs = graph.find("adc");
+    auto source = [&](size_t k, double* in) { in[0] = ref.RefSignal::StepSignal::computeAt(static_cast<double>(k) * Ts); };
+
+    vector<Lazo::TickData> expected(K);
+    bool okLoop = true;
+    size_t seen = 0;
+    graph.run(K, source, [&](const Frame& f) {
+        const Lazo::TickData d = loop.tick();
+        expected[f.k] = d;
+        okLoop = okLoop && f.k == d.k && f[gr] == d.r && f[gs] == d.s && f[ge] == d.e
+                        && f[gu] == d.u && f[gy] == d.y;
+        ++seen;
+        return true;
+    });
+    okLoop = okLoop && seen == K && graph.getK() == K;
+    cout << "  Comparación bit a bit (" << K << " ticks): " << (okLoop ? "OK" : "FALLO") << "\n";
+
+    graph.reset();
+    bool okReset = graph.getK() == 0;
+    for (size_t k = 0; k < 100; ++k) {
+        double in[1];
+        source(k, in);
+        graph.tick(in);
+        okReset = okReset && graph.value(gy) == expected[k].y;
+    }
+    cout << "  reset() y tick(inputs): " << (okReset ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okLoop && okReset;
+
+    // ========== PRUEBA 2: DISPOSICIÓN DEL ARENA ==========
+    cout << "========================================\n";
+    cout << "  ARENA EN ORDEN DE EJECUCIÓN\n";
+    cout << "========================================\n";
+
+    cout << "  Plan:";
+    vector<const CompiledGraph::Operation*> plan;
+    for (size_t i = 0; i < graph.outputs().size(); ++i) {
+        plan.push_back(&graph.outputs()[i]);
+    }
+    for (size_t i = 0; i < graph.schedule().size(); ++i) {
+        plan.push_back(&graph.schedule()[i]);
+    }
+    // Tramo de cada bloque: e (2 pesos), pid (b, a1, 2 u, 1 y), planta (b, a1, 1 u, 1 y), dac y adc (1)
+    const char* names[] = {"r", "pid", "dac", "planta", "adc", "e"};
+    const size_t spans[] = {0, 3 + 1 + 2 + 1, 1, 2 + 1 + 1 + 1, 1, 2};
+    // Cada bloque empieza donde acaba el anterior en su primera aparición en el plan
+    bool okArena = true;
+    size_t next = 0;
+    vector<bool> placed(graph.size(), false);
+    for (size_t i = 0; i < plan.size(); ++i) {
+        const BlockId b = plan[i]->block;
+        cout << " " << names[b];
+        okArena = okArena && plan[i]->data == graph.arenaOffset(b);
+        if (!placed[b]) {
+            okArena = okArena && graph.arenaOffset(b) == next;
+            next = graph.arenaOffset(b) + spans[b];
+            placed[b] = true;
+        }
+    }
+    okArena = okArena && next == graph.arena().size() && graph.arenaOffset(gr) == static_cast<size_t>(-1)
+                      && graph.schedule().front().block == ge && graph.outputs().size() == 1
+                      && graph.outputs()[0].block == gs;
+    cout << "\n  " << graph.arena().size() << " doubles contiguos, un tramo por bloque: "
+         << (okArena ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okArena;
+
+    // ========== PRUEBA 3: SERIE, PARALELO Y REALIMENTACIÓN ==========
+    cout << "========================================\n";
+    cout << "  SERIE, PARALELO Y REALIMENTACIÓN\n";
+    cout << "========================================\n";
+
+    const vector<double> b1 = {0.2, 0.1}, a1 = {1.0, -0.5};
+    const vector<double> b2 = {0.3, 0.0, -0.1}, a2 = {1.0, 0.2, 0.05};
+
+    // Serie: H1·H2 frente al producto de polinomios
+    SystemGraph gs1(Ts);
+    const BlockId in1 = gs1.addInput("u");
+    const BlockId h1 = gs1.addTransferFunction("h1", b1, a1);
+    const BlockId h2 = gs1.addTransferFunction("h2", b2, a2);
+    gs1.series(gs1.series(in1, h1), h2);
+    CompiledGraph cs = gs1.compile();
+    DiscreteSystems::TransferFunctionSystem prod(DiscreteSystems::Polynomial::multiply(b1, b2),
+                                                 DiscreteSystems::Polynomial::multiply(a1, a2), Ts);
+    // Paralelo: H1 + H2 frente a dos sistemas sueltos
+    SystemGraph gp(Ts);
+    const BlockId in2 = gp.addInput("u");
+    const BlockId p1 = gp.addTransferFunction("h1", b1, a1);
+    const BlockId p2 = gp.addTransferFunction("h2", b2, a2);
+    const BlockId psum = gp.parallel("suma", in2, p1, p2);
+    CompiledGraph cp = gp.compile();
+    DiscreteSystems::TransferFunctionSystem s1(b1, a1, Ts), s2(b2, a2, Ts);
+    // Realimentación positiva con ganancia y retardo: y(k) = u(k) + 0.5·y(k-1)
+    SystemGraph gf(Ts);
+    const BlockId in3 = gf.addInput("u");
+    const BlockId fk = gf.addGain("k", 1.0);
+    const BlockId fd = gf.addGain("h", 0.5);
+    const BlockId fz = gf.addDelay("z");
+    gf.feedback("e", in3, fk, fz, 1.0);
+    gf.series(gf.series(fk, fd), fz);
+    CompiledGraph cf = gf.compile();
+
+    double errSeries = 0.0, yFb = 0.0;
+    bool okPar = true, okFb = true;
+    for (size_t k = 0; k < K; ++k) {
+        const double u[1] = {sin(0.05 * static_cast<double>(k)) + (k % 7 == 0 ? 1.0 : 0.0)};
+        cs.tick(u);
+        cp.tick(u);
+        cf.tick(u);
+        errSeries = max(errSeries, fabs(cs.value(h2) - prod.step(u[0])));
+        okPar = okPar && cp.value(psum) == s1.step(u[0]) + s2.step(u[0]);
+        yFb = u[0] + 0.5 * yFb;
+        okFb = okFb && cf.value(fk) == yFb;
+    }
+    const bool okSeries = errSeries < 1e-12;
+    cout << "  series(): max|Δy| = " << scientific << setprecision(2) << errSeries << fixed
+         << "  " << (okSeries ? "OK" : "FALLO") << "\n";
+    cout << "  parallel() bit a bit: " << (okPar ? "OK" : "FALLO") << "\n";
+    cout << "  feedback() con retardo en la realimentación: " << (okFb ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okSeries && okPar && okFb;
+
+    // ========== PRUEBA 4: RETARDOS EN LAZO MUTUO ==========
+    cout << "========================================\n";
+    cout << "  RETARDOS EN LAZO MUTUO\n";
+    cout << "========================================\n";
+
+    // z1 → z2 → z1: sin fase de salida, el segundo retardo leería el valor ya actualizado
+    SystemGraph gz(Ts);
+    const BlockId z1 = gz.addDelay("z1", 1.0);
+    const BlockId z2 = gz.addDelay("z2", 2.0);
+    gz.connect(z2, z1);
+    gz.connect(z1, z2);
+    // Función de transferencia sin paso directo (b0 = 0) en el mismo lazo: z^-1 / (1 - 0.5 z^-1)
+    const BlockId zt = gz.addTransferFunction("t", {0.0, 1.0}, {1.0, -0.5});
+    gz.connect(z1, zt);
+    CompiledGraph cz = gz.compile();
+    DiscreteSystems::TransferFunctionSystem tref({0.0, 1.0}, {1.0, -0.5}, Ts);
+    bool okSwap = cz.outputs().size() == 3;
+    for (size_t k = 0; k < 10; ++k) {
+        cz.tick();
+        const double want1 = k % 2 == 0 ? 1.0 : 2.0;
+        okSwap = okSwap && cz.value(z1) == want1 && cz.value(z2) == 3.0 - want1
+                        && cz.value(zt) == tref.step(want1);
+    }
+    cout << "  Intercambio z1 ↔ z2 y b0 = 0: " << (okSwap ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okSwap;
+
+    // ========== PRUEBA 5: VALIDACIÓN ==========
+    cout << "========================================\n";
+    cout << "  VALIDACIÓN DEL GRAFO\n";
+    cout << "========================================\n";
+
+    // Lazo algebraico: e → pid → planta → e sin retardo (la planta tiene b0 != 0)
+    SystemGraph ga(Ts);
+    const BlockId ar = ga.addInput("r");
+    const BlockId ac = ga.addPID("pid", pid);
+    const BlockId ap = ga.addSystem("planta", planta);
+    const BlockId aout = ga.addGain("salida", 1.0);
+    ga.feedback("e", ar, ac, ap);
+    ga.series(ac, ap);
+    ga.series(ap, aout);
+    const string loopMsg = rejection(ga);
+    bool okAlg = loopMsg.find("lazo algebraico") != string::npos
+              && loopMsg.find("'pid', 'planta', 'e'") != string::npos && loopMsg.find("salida") == string::npos;
+    cout << "  Lazo algebraico detectado (sólo sus bloques): " << (okAlg ? "OK" : "FALLO") << "\n";
+
+    SystemGraph gn(Ts);
+    gn.addInput("r");
+    gn.addGain("suelta", 2.0);
+    bool okMissing = rejection(gn).find("'suelta' no tiene entrada") != string::npos;
+    cout << "  Bloque sin entrada: " << (okMissing ? "OK" : "FALLO") << "\n";
+
+    int thrown = 0;
+    SystemGraph gc(Ts);
+    const BlockId cr = gc.addInput("r");
+    const BlockId cg = gc.addGain("g", 1.0);
+    gc.connect(cr, cg);
+    try { gc.connect(cr, cg); } catch (const InvalidGraph&) { ++thrown; }          // segunda entrada
+    try { gc.connect(cg, cr); } catch (const InvalidGraph&) { ++thrown; }          // hacia una entrada
+    try { gc.connect(cr, 99); } catch (const InvalidGraph&) { ++thrown; }          // id inexistente
+    try { gc.connect(cr, gc.addDelay("z"), -1.0); } catch (const InvalidGraph&) { ++thrown; }  // peso fuera de Sum
+    try { gc.addSystem("p", Planta::Sistema(2 * Ts)); } catch (const DiscreteSystems::InvalidSamplingTime&) { ++thrown; }
+    try { gc.addTransferFunction("t", {1.0}, {0.0}); } catch (const DiscreteSystems::InvalidCoefficients&) { ++thrown; }
+    try { SystemGraph bad(0.0); } catch (const DiscreteSystems::InvalidSamplingTime&) { ++thrown; }
+    bool okConnect = thrown == 7;
+    cout << "  Conexiones y parámetros inválidos (" << thrown << "/7): " << (okConnect ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okAlg && okMissing && okConnect;
+
+    // ========== PRUEBA 6: FUSIÓN DE BLOQUES ==========
+    cout << "========================================\n";
+    cout << "  FUSIÓN DE BLOQUES LTI\n";
+    cout << "========================================\n";
+
+    const double tol = 1e-9;
+    const SystemGraph loopGraph = makeLoopGraph(pid, planta);
+    const BlockId oPid = 1, oPlanta = 3, oAdc = 4, oE = 5;
+
+    // pid → dac → planta → adc queda en un solo bloque "adc" alimentado por e
+    Fusion fl = fuse(loopGraph);
+    CompiledGraph ref1 = loopGraph.compile();
+    CompiledGraph fl1 = fl.graph.compile();
+    const bool okShape = fl.graph.size() == 3 && fl.merged == 3 && fl.probes.empty()
+                      && fl.map[oPid] == SIZE_MAX && fl.map[oPlanta] == SIZE_MAX
+                      && fl.graph.name(fl.map[oAdc]) == "adc" && fl1.schedule().size() == 2;
+    const double errLoop = maxDiff(ref1, oAdc, fl1, fl.map[oAdc], K, stepInput);
+    bool okFused = okShape && errLoop < tol;
+    cout << "  Lazo: " << loopGraph.size() << " → " << fl.graph.size() << " bloques, "
+         << fl1.schedule().size() << " operaciones, error máx " << scientific << setprecision(2)
+         << errLoop << fixed << ": " << (okFused ? "OK" : "FALLO") << "\n";
+
+    // Las sondas reconstruyen u e y sin alterar el lazo
+    Fusion fo = fuse(loopGraph, {oPid, oPlanta});
+    CompiledGraph ref2 = loopGraph.compile();
+    CompiledGraph fo1 = fo.graph.compile();
+    CompiledGraph fl2 = fl.graph.compile();
+    double errU = 0.0, errY = 0.0;
+    bool sameLoop = true;
+    for (size_t k = 0; k < K; ++k) {
+        const double in = stepInput(k);
+        ref2.tick(&in);
+        fo1.tick(&in);
+        fl2.tick(&in);
+        errU = max(errU, fabs(ref2.value(oPid) - fo1.value(fo.map[oPid])));
+        errY = max(errY, fabs(ref2.value(oPlanta) - fo1.value(fo.map[oPlanta])));
+        sameLoop = sameLoop && fo1.value(fo.map[oE]) == fl2.value(fl.map[oE]);
+    }
+    bool okProbes = fo.probes.size() == 2 && fo.graph.size() == 5 && sameLoop && errU < tol && errY < tol;
+    cout << "  Sondas de u e y (error máx " << scientific << setprecision(2) << max(errU, errY)
+         << fixed << ", lazo intacto): " << (okProbes ? "OK" : "FALLO") << "\n";
+
+    // Paralelo: biquad + 0.5 sobre la misma entrada
+    SystemGraph gpar(Ts);
+    const BlockId pin = gpar.addInput("x");
+    const BlockId ph = gpar.addTransferFunction("h", {0.2, 0.3, 0.1}, {1.0, -0.5, 0.2});
+    const BlockId pg = gpar.addGain("g", 0.5);
+    const BlockId pjoin = gpar.parallel("p", pin, ph, pg);
+    Fusion fp = fuse(gpar);
+    CompiledGraph rpar = gpar.compile();
+    CompiledGraph cpar = fp.graph.compile();
+    const double errPar = maxDiff(rpar, pjoin, cpar, fp.map[pjoin], K, chirpInput);
+    bool okParallel = fp.graph.size() == 2 && fp.merged == 2
+                   && fp.graph.kind(fp.map[pjoin]) == BlockKind::TransferFunction && errPar < tol;
+    cout << "  Paralelo h + 0.5 (error máx " << scientific << setprecision(2) << errPar << fixed
+         << "): " << (okParallel ? "OK" : "FALLO") << "\n";
+
+    // La saturación (no lineal) corta la cadena: sólo se funde dac → planta → adc
+    SystemGraph gsat(Ts);
+    const BlockId sr = gsat.addInput("r");
+    const BlockId sc = gsat.addPID("pid", pid);
+    const BlockId ssat = gsat.addSaturation("sat", -2.0, 2.0);
+    const BlockId sdac = gsat.addGain("dac", 1.0);
+    const BlockId sp = gsat.addSystem("planta", planta);
+    const BlockId sadc = gsat.addDelay("adc");
+    gsat.feedback("e", sr, sc, sadc);
+    gsat.series(gsat.series(gsat.series(gsat.series(sc, ssat), sdac), sp), sadc);
+    Fusion fs = fuse(gsat);
+    CompiledGraph rsat = gsat.compile();
+    CompiledGraph csat = fs.graph.compile();
+    bool clipped = false;
+    double errSat = 0.0;
+    for (size_t k = 0; k < K; ++k) {
+        const double in = stepInput(k);
+        rsat.tick(&in);
+        csat.tick(&in);
+        clipped = clipped || fabs(rsat.value(sc)) > 2.0;
+        errSat = max(errSat, fabs(rsat.value(sadc) - csat.value(fs.map[sadc])));
+    }
+    bool okSat = fs.graph.size() == 5 && fs.merged == 2 && fs.map[sc] != SIZE_MAX
+              && fs.graph.kind(fs.map[ssat]) == BlockKind::Saturation && fs.map[sp] == SIZE_MAX
+              && clipped && errSat < tol;
+    cout << "  Saturación intacta (recorta: " << (clipped ? "sí" : "no") << ", error máx "
+         << scientific << setprecision(2) << errSat << fixed << "): " << (okSat ? "OK" : "FALLO") << "\n";
+
+    // toSystem(): el bloque fusionado como TransferFunctionSystem, directo y en SOS
+    DiscreteSystems::TransferFunctionSystem df = toSystem(fl.graph, fl.map[oAdc]);
+    DiscreteSystems::TransferFunctionSystem sos = toSystem(fl.graph, fl.map[oAdc],
+                                                           DiscreteSystems::FilterStructure::SecondOrderSections);
+    CompiledGraph fl3 = fl.graph.compile();
+    double errDf = 0.0, errSos = 0.0;
+    for (size_t k = 0; k < K; ++k) {
+        const double in = stepInput(k);
+        fl3.tick(&in);
+        const double e = fl3.value(fl.map[oE]);
+        errDf = max(errDf, fabs(df.step(e) - fl3.value(fl.map[oAdc])));
+        errSos = max(errSos, fabs(sos.step(e) - fl3.value(fl.map[oAdc])));
+    }
+    bool okSystem = df.getDenominator().size() == 3 && errDf == 0.0 && errSos < 1e-6;
+    cout << "  toSystem() forma directa (bit a bit) y SOS (error máx " << scientific << setprecision(2)
+         << errSos << fixed << "): " << (okSystem ? "OK" : "FALLO") << "\n";
+
+    // maxOrder: cuatro biquads con orden máximo 4 quedan en dos bloques
+    SystemGraph gq(Ts);
+    BlockId last = gq.addInput("x");
+    for (int i = 0; i < 4; ++i) {
+        last = gq.series(last, gq.addTransferFunction("bq" + to_string(i), {0.2, 0.3, 0.1}, {1.0, -0.5, 0.2}));
+    }
+    Fusion fq = fuse(gq, {}, 4);
+    CompiledGraph rq = gq.compile();
+    CompiledGraph cq = fq.graph.compile();
+    const double errOrder = maxDiff(rq, last, cq, fq.map[last], K, chirpInput);
+    bool okOrder = fq.graph.size() == 3 && fq.merged == 2 && errOrder < tol;
+    cout << "  Orden máximo 4 (8 → 2 bloques de orden 4): " << (okOrder ? "OK" : "FALLO") << "\n";
+
+    // Un retardo con salida inicial no nula no es LTI y no se funde
+    SystemGraph gd(Ts);
+    const BlockId dx = gd.addInput("x");
+    const BlockId dz = gd.addDelay("z", 1.0);
+    gd.series(gd.series(dx, dz), gd.addGain("g", 2.0));
+    bool okAffine = fuse(gd).graph.size() == 3 && !gd.isLTI(dz);
+    int fuseThrown = 0;
+    try { fuse(gd, {99}); } catch (const InvalidGraph&) { ++fuseThrown; }
+    try { toSystem(gd, dz); } catch (const InvalidGraph&) { ++fuseThrown; }
+    try { gd.addSaturation("s", 1.0, -1.0); } catch (const DiscreteSystems::InvalidCoefficients&) { ++fuseThrown; }
+    okAffine = okAffine && fuseThrown == 3;
+    cout << "  Retardo con estado inicial y llamadas inválidas: " << (okAffine ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okFused && okProbes && okParallel && okSat && okSystem && okOrder && okAffine;
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
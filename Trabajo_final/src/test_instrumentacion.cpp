@@ -0,0 +1,124 @@
+/**
+ * @file test_instrumentacion.cpp
+ * @brief Programa de prueba para la instrumentación de latencia
+ *
+ * Prueba:
+ * - LatencyHistogram: cubetas y percentiles con error relativo <= 1/16
+ * - Instrumented<Block, Disabled>: mismo tamaño y mismas salidas que Block
+ * - Instrumented<Block, Enabled>: cuenta llamadas en LoopRunner y plazos perdidos
+ */
+
+#include <instrumentacion.h>
+#include <lazo.h>
+#include <iostream>
+#include <iomanip>
+
+using namespace Instrumentacion;
+using namespace std;
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE INSTRUMENTACIÓN                          ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    const double Ts = 0.01;
+    bool ok = true;
+
+    // ========== PRUEBA 1: HISTOGRAMA LOG-LINEAL ==========
+    cout << "========================================\n";
+    cout << "  HISTOGRAMA LOG-LINEAL\n";
+    cout << "========================================\n";
+
+    bool okIdx = true;
+    const uint64_t probes[] = {0, 1, 15, 16, 17, 31, 32, 1000, 123456789, ~uint64_t(0)};
+    for (uint64_t v : probes) {
+        size_t i = LatencyHistogram::index(v);
+        okIdx = okIdx && i < LatencyHistogram::kBuckets && v <= LatencyHistogram::upperBound(i)
+                      && (i == 0 || v > LatencyHistogram::upperBound(i - 1));
+    }
+    cout << "  Cubetas contiguas y ordenadas: " << (okIdx ? "OK" : "FALLO") << "\n";
+
+    LatencyHistogram h;
+    for (uint64_t v = 1; v <= 100000; ++v) {
+        h.record(v);
+    }
+    struct Q { const char* name; double p; double exact; };
+    const Q qs[] = {{"p50  ", 0.5, 50000}, {"p99  ", 0.99, 99000}, {"p99.9", 0.999, 99900}};
+    bool okPct = h.count() == 100000 && h.max() == 100000;
+    for (const Q& q : qs) {
+        double got = static_cast<double>(h.percentile(q.p));
+        bool okQ = got >= q.exact && got <= q.exact * (1.0 + 1.0 / 16);
+        cout << "  " << q.name << " = " << setw(7) << static_cast<uint64_t>(got)
+             << "  (exacto " << static_cast<uint64_t>(q.exact) << ")  " << (okQ ? "OK" : "FALLO") << "\n";
+        okPct = okPct && okQ;
+    }
+    cout << "========================================\n\n";
+    ok = ok && okIdx && okPct;
+
+    // ========== PRUEBA 2: POLÍTICA DESACTIVADA ==========
+    cout << "========================================\n";
+    cout << "  POLÍTICA DESACTIVADA (Disabled)\n";
+    cout << "========================================\n";
+
+    bool okSize = sizeof(Instrumented<Controlador::PIDController, Disabled>) == sizeof(Controlador::PIDController)
+               && sizeof(Instrumented<RefSignal::StepSignal, Disabled>) == sizeof(RefSignal::StepSignal);
+    Instrumented<Controlador::PIDController, Disabled> pidOff(2.0, 4.0, 0.01, Ts);
+    Controlador::PIDController pidRef(2.0, 4.0, 0.01, Ts);
+    bool okSame = true;
+    for (int k = 0; k < 1000; ++k) {
+        double e = 1.0 / (1 + k % 7);
+        okSame = okSame && pidOff.next(e) == pidRef.next(e) && pidOff.step(e) == pidRef.step(e);
+    }
+    cout << "  Mismo tamaño que el bloque: " << (okSize ? "OK" : "FALLO") << "\n";
+    cout << "  Mismas salidas:             " << (okSame ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okSize && okSame;
+
+    // ========== PRUEBA 3: POLÍTICA ACTIVA EN EL LAZO ==========
+    cout << "========================================\n";
+    cout << "  POLÍTICA ACTIVA EN EL LAZO (Enabled)\n";
+    cout << "========================================\n";
+
+    const size_t K = 5000;
+    auto loop = Lazo::makeLoop(Instrumented<RefSignal::StepSignal>(Ts, 1.0, 0.0),
+                               Instrumented<Controlador::PIDController>(2.0, 4.0, 0.01, Ts),
+                               Instrumented<Convertidores::DAConverter>(Ts),
+                               Instrumented<Planta::Sistema>(Ts),
+                               Instrumented<Convertidores::ADConverter>(Ts));
+    auto plain = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                                Convertidores::DAConverter(Ts),
+                                Planta::Sistema(Ts),
+                                Convertidores::ADConverter(Ts));
+    bool okLoop = true;
+    for (size_t k = 0; k < K; ++k) {
+        okLoop = okLoop && loop.tick().y == plain.tick().y;
+    }
+    const BlockStats& ps = loop.plant().probe().stats();
+    okLoop = okLoop && loop.ref().probe().stats().calls() == K && loop.pid().probe().stats().calls() == K
+                    && ps.calls() == K && loop.adc().probe().stats().calls() == K
+                    && ps.execution().p50() <= ps.execution().max();
+    cout << "  Planta: " << ps << "\n";
+    cout << "  Llamadas contadas y salidas iguales: " << (okLoop ? "OK" : "FALLO") << "\n";
+
+    // Período de 1 ns: cada llamada empieza tarde y pierde su plazo
+    Instrumented<Convertidores::DAConverter> fast(1e-9);
+    for (int k = 0; k < 100; ++k) {
+        fast.next(1.0);
+    }
+    bool okMiss = fast.probe().stats().deadlineMisses() >= 99 && fast.probe().stats().calls() == 100;
+    cout << "  Plazos perdidos con Ts = 1 ns: " << fast.probe().stats().deadlineMisses()
+         << "/100  " << (okMiss ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okLoop && okMiss;
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
@@ -0,0 +1,432 @@
+/**
+ * @file test_lazo.cpp
+ * @brief Programa de prueba para el motor del lazo cerrado
+ *
+ * Prueba:
+ * - LoopRunner: coincide con la composición manual de los bloques con next()
+ * - Modo registro: rellena los buffers con los mismos valores que el modo rápido
+ * - Observador: detiene la simulación cuando devuelve false
+ * - Núcleos fijos (FixedPID, SistemaFijo): coinciden con las clases dinámicas
+ * - MultirateLoop: N = 1 coincide con LoopRunner; N = 10 con la composición
+ *   manual (ZOH del DAC y diezmado del ADC); razones inválidas
+ * - SteadyState: el salto de los tramos en reposo coincide con ejecutarlos
+ * - analyzeLoop(): estabilidad y margen de ganancia frente a la simulación
+ * - checkpoint()/restore(): continuación bit a bit desde fichero y sin
+ *   buffers, bifurcación en copias, MultirateLoop e instantáneas inválidas
+ */
+
+#include <lazo.h>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+using namespace Lazo;
+using namespace std;
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DEL LAZO CERRADO                            ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    const double Ts = 0.01;
+    const size_t K = 2000;
+    bool ok = true;
+
+    RefSignal::StepSignal ref(Ts, 1.0, 0.055);
+    Controlador::PIDController pid(2.0, 4.0, 0.01, Ts);
+    Convertidores::DAConverter dac(Ts);
+    Planta::Sistema planta(Ts);
+    Convertidores::ADConverter adc(Ts);
+
+    // ========== PRUEBA 1: COMPOSICIÓN MANUAL ==========
+    cout << "========================================\n";
+    cout << "  LOOPRUNNER FRENTE A COMPOSICIÓN MANUAL\n";
+    cout << "========================================\n";
+    cout << setw(6) << "k" << " | "
+         << setw(10) << "r[k]" << " | "
+         << setw(10) << "u[k]" << " | "
+         << setw(10) << "y[k]" << "\n";
+    cout << "----------------------------------------\n";
+
+    LoopRunner<RefSignal::StepSignal> loop(ref, pid, dac, planta, adc);
+    RefSignal::StepSignal r2(ref);
+    Controlador::PIDController p2(pid);
+    Convertidores::DAConverter d2(dac);
+    Planta::Sistema g2(planta);
+    Convertidores::ADConverter a2(adc);
+
+    vector<TickData> fast;
+    bool okManual = true;
+    double s = 0.0;
+    for (size_t k = 0; k < K; ++k) {
+        TickData d = loop.tick();
+        double rk = r2.compute(k);
+        double ek = rk - s;
+        double uk = p2.next(ek);
+        double yk = g2.next(d2.next(uk));
+        double sk = a2.next(yk);
+        okManual = okManual && d.k == k && d.r == rk && d.s == sk && d.e == ek
+                            && d.u == uk && d.y == yk;
+        s = yk;
+        fast.push_back(d);
+        if (k % 400 == 0) {
+            cout << setw(6) << k << " | "
+                 << setw(10) << fixed << setprecision(6) << d.r << " | "
+                 << setw(10) << d.u << " | "
+                 << setw(10) << d.y << "\n";
+        }
+    }
+    cout << "  Comparación bit a bit (" << K << " ticks): " << (okManual ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okManual;
+
+    // ========== PRUEBA 2: MODO REGISTRO ==========
+    cout << "========================================\n";
+    cout << "  MODO REGISTRO\n";
+    cout << "========================================\n";
+
+    LoopRunner<RefSignal::StepSignal> rec(ref, pid, dac, planta, adc);
+    rec.setRecording(true);
+    bool okRec = true;
+    size_t idx = 0;
+    rec.run(K, [&](const TickData& d) {
+        okRec = okRec && d.y == fast[idx].y && d.u == fast[idx].u;
+        ++idx;
+        return true;
+    });
+    okRec = okRec && idx == K && rec.getK() == K
+                  && rec.plant().getCount() == 1024 && rec.pid().getCount() == 1024
+                  && rec.ref().valueBuffer().size() == 1024;
+    cout << "  Salidas iguales al modo rápido y buffers llenos: " << (okRec ? "OK" : "FALLO") << "\n";
+
+    rec.reset();
+    okRec = okRec && rec.getK() == 0 && rec.plant().getCount() == 0 && rec.tick().y == fast[0].y;
+    cout << "  reset(): " << (okRec ? "OK" : "FALLO") << "\n";
+
+    // Sin registro en los bloques: mismas salidas y buffers vacíos
+    rec.reset();
+    rec.setRecordingPolicy(DiscreteSystems::RecordingPolicy(DiscreteSystems::RecordFields::None));
+    bool okPolicy = true;
+    for (size_t k = 0; k < K; ++k) {
+        okPolicy = okPolicy && rec.tick().y == fast[k].y;
+    }
+    okPolicy = okPolicy && rec.plant().getCount() == 0 && rec.pid().getCount() == 0
+                        && rec.dac().getCount() == 0 && rec.adc().getCount() == 0;
+    cout << "  setRecordingPolicy(None): " << (okPolicy ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okRec && okPolicy;
+
+    // ========== PRUEBA 3: OBSERVADOR ==========
+    cout << "========================================\n";
+    cout << "  OBSERVADOR CON PARADA ANTICIPADA\n";
+    cout << "========================================\n";
+
+    LoopRunner<RefSignal::StepSignal> obs(ref, pid, dac, planta, adc);
+    size_t done = obs.run(K, [](const TickData& d) { return d.y < 0.5; });
+    bool okObs = done < K && obs.getK() == done && fast[done - 1].y >= 0.5
+                          && fast[done - 2].y < 0.5;
+    cout << "  Parada en y >= 0.5 tras " << done << " ticks: " << (okObs ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okObs;
+
+    // ========== PRUEBA 4: NÚCLEOS FIJOS ==========
+    cout << "========================================\n";
+    cout << "  NÚCLEOS FIJOS (FixedPID, SistemaFijo)\n";
+    cout << "========================================\n";
+
+    auto fixedLoop = makeLoop(ref, Controlador::FixedPID(2.0, 4.0, 0.01, Ts), dac,
+                              Planta::SistemaFijo(), adc);
+    bool okFixed = true;
+    for (size_t k = 0; k < K; ++k) {
+        okFixed = okFixed && fixedLoop.tick().y == fast[k].y;
+    }
+    cout << "  Comparación bit a bit (" << K << " ticks): " << (okFixed ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okFixed;
+
+    // ========== PRUEBA 5: MULTITASA CON N = 1 ==========
+    cout << "========================================\n";
+    cout << "  MULTIRATELOOP CON N = 1 FRENTE A LOOPRUNNER\n";
+    cout << "========================================\n";
+
+    auto single = makeMultirateLoop(ref, pid, dac, planta, adc, Rates(1));
+    bool okSingle = true;
+    for (size_t k = 0; k < K; ++k) {
+        const TickData d = single.tick();
+        okSingle = okSingle && d.k == fast[k].k && d.r == fast[k].r && d.s == fast[k].s
+                            && d.u == fast[k].u && d.y == fast[k].y;
+    }
+    single.reset();
+    single.setRecording(true);
+    size_t i = 0;
+    single.run(K, [&](const TickData& d) {
+        okSingle = okSingle && d.y == fast[i++].y;
+        return true;
+    });
+    okSingle = okSingle && single.plant().getK() == static_cast<int>(K) && single.adc().getK() == static_cast<int>(K);
+    cout << "  Comparación bit a bit (" << K << " ticks, ambos modos): " << (okSingle ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okSingle;
+
+    // ========== PRUEBA 6: PLANTA A PASO FINO ==========
+    cout << "========================================\n";
+    cout << "  PLANTA A Ts/10, ADC A Ts/2\n";
+    cout << "========================================\n";
+
+    const size_t N = 10, Na = 5;
+    const Planta::Sistema fina = Planta::Sistema::tustin(Ts / N);
+    const Convertidores::ADConverter adcFino(Ts / N * Na);   // muestrea cada Na pasos de planta
+    auto multi = makeMultirateLoop(ref, pid, dac, fina, adcFino, Rates(N, Na));
+    Controlador::PIDController p3(pid);
+    Planta::Sistema g3(fina);
+    Convertidores::ADConverter a3(adcFino);
+    bool okMulti = true;
+    size_t adcSamples = 0;
+    double yLast = 0.0;
+    for (size_t k = 0; k < K; ++k) {
+        const TickData d = multi.tick();
+        const double sk = a3.delayed();
+        const double uk = p3.next(ref.compute(k) - sk);
+        double yk = 0.0;
+        for (size_t j = 0; j < N; ++j) {
+            yk = g3.next(uk);                   // ZOH: u(k) durante los N pasos
+            if ((j + 1) % Na == 0) {
+                a3.next(yk);
+                ++adcSamples;
+            }
+        }
+        okMulti = okMulti && d.s == sk && d.u == uk && d.y == yk;
+        yLast = yk;
+    }
+    // Con registro el reloj del ADC sigue al de la planta: K·(N/Na) muestras de Tp·Na = K·Ts
+    auto recordedMulti = makeMultirateLoop(ref, pid, dac, fina, adcFino, Rates(N, Na));
+    recordedMulti.setRecording(true);
+    recordedMulti.run(K);
+    const double adcTime = recordedMulti.adc().getK() * recordedMulti.adc().getSamplingTime();
+    okMulti = okMulti && multi.getPlantK() == K * N && adcSamples == K * (N / Na)
+                      && static_cast<size_t>(recordedMulti.adc().getK()) == adcSamples
+                      && fabs(adcTime - recordedMulti.plant().getK() * fina.getSamplingTime()) < 1e-9
+                      && fabs(adcTime - K * Ts) < 1e-9;
+    cout << "  y(" << K << "·Ts) = " << fixed << setprecision(6) << yLast
+         << " (LoopRunner a Ts: " << fast[K - 1].y << ")\n";
+    cout << "  Pasos de planta = " << multi.getPlantK() << ", muestras del ADC = " << adcSamples << "\n";
+    cout << "  Coincide con la composición manual: " << (okMulti ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okMulti;
+
+    // ========== PRUEBA 7: RAZONES INVÁLIDAS ==========
+    cout << "========================================\n";
+    cout << "  RAZONES DE TASA INVÁLIDAS\n";
+    cout << "========================================\n";
+
+    const Rates bad[] = {Rates(0), Rates(10, 0), Rates(10, 3)};
+    bool okBad = true;
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); ++i) {
+        try {
+            makeMultirateLoop(ref, pid, dac, fina, adcFino, bad[i]);
+            okBad = false;
+        } catch (const DiscreteSystems::InvalidSamplingTime&) {
+        }
+    }
+    cout << "  N = 0, Na = 0 y Na que no divide a N rechazadas: " << (okBad ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okBad;
+
+    // ========== PRUEBA 8: SALTO DE TRAMOS EN REPOSO ==========
+    cout << "========================================\n";
+    cout << "  SALTO DE TRAMOS EN REPOSO (SteadyState)\n";
+    cout << "========================================\n";
+
+    const size_t Kq = 200000;
+    const SteadyState modes[] = {SteadyState(8), SteadyState(8, 1e-12), SteadyState(8, 0.0, 5000)};
+    const char* modeNames[] = {"tolerancia 0     ", "tolerancia 1e-12 ", "maxSkip 5000     "};
+    bool okQuiet = true;
+    for (int recMode = 0; recMode < 2; ++recMode) {
+        for (int m = 0; m < 3; ++m) {
+            LoopRunner<RefSignal::StepSignal> full(ref, pid, dac, planta, adc);
+            LoopRunner<RefSignal::StepSignal> quick(ref, pid, dac, planta, adc);
+            full.setRecording(recMode == 1);
+            quick.setRecording(recMode == 1);
+            quick.setSteadyState(modes[m]);
+            full.run(Kq);
+            quick.run(Kq);
+            // El estado tras el salto es el mismo: los ticks siguientes coinciden
+            const TickData df = full.tick(), dq = quick.tick();
+            const double tol = m == 1 ? 1e-9 : 0.0;
+            bool okMode = quick.getK() == full.getK() && quick.skipped() > Kq / 2
+                       && fabs(df.y - dq.y) <= tol && fabs(df.u - dq.u) <= tol;
+            if (recMode == 1) {
+                vector<DiscreteSystems::Sample> sf(1024), sq(1024);
+                const size_t nf = full.plant().snapshot(&sf[0], sf.size());
+                const size_t nq = quick.plant().snapshot(&sq[0], sq.size());
+                okMode = okMode && nf == nq && nq == 1024 && quick.ref().valueBuffer().size() == 1024;
+                for (size_t i = 0; okMode && i < nq; ++i) {
+                    okMode = sf[i].k == sq[i].k && fabs(sf[i].out - sq[i].out) <= tol;
+                }
+            }
+            cout << "  " << (recMode == 1 ? "registro " : "rápido   ") << modeNames[m]
+                 << " saltados = " << setw(6) << quick.skipped() << "  " << (okMode ? "OK" : "FALLO") << "\n";
+            okQuiet = okQuiet && okMode;
+        }
+    }
+
+    // Con el escalón aún por llegar, el salto se detiene en t = step_time
+    RefSignal::StepSignal late(Ts, 1.0, 5.0);
+    LoopRunner<RefSignal::StepSignal> lateFull(late, pid, dac, planta, adc);
+    LoopRunner<RefSignal::StepSignal> lateQuick(late, pid, dac, planta, adc);
+    lateQuick.setSteadyState(SteadyState(8));
+    lateFull.run(Kq);
+    lateQuick.run(Kq);
+    const bool okLate = lateQuick.skipped() > 0 && lateFull.tick().y == lateQuick.tick().y;
+    cout << "  Escalón en t = 5 s tras reposo inicial: " << (okLate ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okQuiet && okLate;
+
+    // ========== PRUEBA 9: ANÁLISIS DEL LAZO ==========
+    cout << "========================================\n";
+    cout << "  ANÁLISIS DEL LAZO (analyzeLoop)\n";
+    cout << "========================================\n";
+
+    const LoopAnalysis an = analyzeLoop(pid, planta);
+    cout << "  GM = " << setprecision(3) << an.margins.gainMargin << " veces a "
+         << an.margins.phaseCrossover << " rad/s, PM = " << an.margins.phaseMargin << " grados a "
+         << an.margins.gainCrossover << " rad/s\n";
+    bool okAn = an.stable && an.poles.size() == 4 && an.margins.gainMargin > 1.0 && an.margins.phaseMargin > 0.0
+             && fabs(fast[K - 1].y - 1.0) < 1e-3;
+
+    // Las ganancias escaladas justo por debajo / encima del margen cruzan el límite de estabilidad
+    const double scales[] = {0.98, 1.02};
+    for (int i = 0; i < 2; ++i) {
+        const double g = scales[i] * an.margins.gainMargin;
+        const Controlador::PIDController scaled(2.0 * g, 4.0 * g, 0.01 * g, Ts);
+        const LoopAnalysis as = analyzeLoop(scaled, planta);
+        auto sim = makeLoop(ref, scaled, dac, planta, adc);
+        double peak = 0.0;
+        for (size_t k = 0; k < 20 * K; ++k) {
+            peak = max(peak, fabs(sim.tick().y));
+        }
+        const bool diverges = peak > 1e3;
+        okAn = okAn && as.stable == (i == 0) && diverges == (i == 1);
+        cout << "  Ganancia x" << setprecision(2) << scales[i] << "·GM: " << (as.stable ? "estable" : "inestable")
+             << ", max|y| simulado = " << scientific << peak << fixed << "\n";
+    }
+    cout << "  Coincide con la simulación: " << (okAn ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okAn;
+
+    // ========== PRUEBA 10: INSTANTÁNEAS DEL LAZO ==========
+    cout << "========================================\n";
+    cout << "  INSTANTÁNEAS (checkpoint / restore)\n";
+    cout << "========================================\n";
+
+    typedef LoopRunner<RefSignal::StepSignal> Loop;
+    Loop warm(ref, pid, dac, planta, adc);
+    warm.setRecording(true);
+    warm.pid().setBumpless(200);
+    warm.run(300);
+    warm.pid().setGains(3.0, 5.0, 0.02);    // transición a medias al guardar
+    warm.run(100);
+
+    const char* ckPath = "test_lazo_checkpoint.bin";
+    DiscreteSystems::CheckpointWriter full(true);
+    warm.checkpoint(full);
+    full.save(ckPath);
+    DiscreteSystems::CheckpointWriter light(false);
+    warm.checkpoint(light);
+
+    // Restaurado sobre lazos nuevos con los bloques del original
+    Loop fromFile(ref, pid, dac, planta, adc);
+    Loop fromMemory(ref, pid, dac, planta, adc);
+    bool okMapped = false;
+    {
+        DiscreteSystems::CheckpointReader rf(ckPath);
+        okMapped = rf.mapped();
+        fromFile.restore(rf);
+    }
+    DiscreteSystems::CheckpointReader rm(light);
+    fromMemory.restore(rm);
+    std::remove(ckPath);
+
+    vector<DiscreteSystems::Sample> sw(1024), sr(1024);
+    const size_t nw = warm.plant().snapshot(&sw[0], sw.size());
+    const size_t nr = fromFile.plant().snapshot(&sr[0], sr.size());
+    bool okBuffers = nw == nr && nw == 400 && fromMemory.plant().snapshot(&sr[0], sr.size()) == 0
+                  && fromFile.ref().valueBuffer().size() == warm.ref().valueBuffer().size();
+    const size_t nr2 = fromFile.plant().snapshot(&sr[0], sr.size());
+    for (size_t i = 0; okBuffers && i < nr2; ++i) {
+        okBuffers = sw[i].k == sr[i].k && sw[i].in == sr[i].in && sw[i].out == sr[i].out;
+    }
+    for (size_t i = 0; okBuffers && i < warm.ref().valueBuffer().size(); ++i) {
+        okBuffers = warm.ref().valueBuffer()[i] == fromFile.ref().valueBuffer()[i]
+                 && warm.ref().timeBuffer()[i] == fromFile.ref().timeBuffer()[i];
+    }
+
+    // Bifurcación en memoria: copias del lazo caliente
+    vector<Loop> forks(4, warm);
+    bool okContinue = fromFile.getK() == warm.getK() && fromMemory.getK() == warm.getK()
+                   && fromFile.pid().getKp() == 3.0 && fromFile.recording();
+    for (size_t k = 0; k < 1000; ++k) {
+        const TickData d = warm.tick();
+        const TickData df = fromFile.tick();
+        const TickData dm = fromMemory.tick();
+        okContinue = okContinue && df.k == d.k && df.u == d.u && df.y == d.y && df.s == d.s
+                  && dm.u == d.u && dm.y == d.y;
+        for (size_t f = 0; f < forks.size(); ++f) {
+            const TickData dk = forks[f].tick();
+            okContinue = okContinue && dk.u == d.u && dk.y == d.y;
+        }
+    }
+    cout << "  Instantánea: " << full.size() << " bytes con buffers, " << light.size() << " sin buffers\n";
+    cout << "  Fichero proyectado con mmap: " << (okMapped ? "OK" : "FALLO") << "\n";
+    cout << "  Buffers restaurados idénticos: " << (okBuffers ? "OK" : "FALLO") << "\n";
+    cout << "  Continuación bit a bit (fichero, memoria y 4 copias): " << (okContinue ? "OK" : "FALLO") << "\n";
+
+    // MultirateLoop
+    auto mrA = makeMultirateLoop(ref, pid, dac, fina, adcFino, Rates(N, Na));
+    auto mrB = makeMultirateLoop(ref, pid, dac, fina, adcFino, Rates(N, Na));
+    mrA.run(250);
+    DiscreteSystems::CheckpointWriter mw;
+    mrA.checkpoint(mw);
+    DiscreteSystems::CheckpointReader mr(mw);
+    mrB.restore(mr);
+    bool okMr = mrB.getK() == mrA.getK();
+    for (size_t k = 0; k < 500; ++k) {
+        const TickData a = mrA.tick(), b = mrB.tick();
+        okMr = okMr && a.u == b.u && a.y == b.y;
+    }
+    cout << "  MultirateLoop: " << (okMr ? "OK" : "FALLO") << "\n";
+
+    // Instantáneas que no corresponden al lazo
+    int rejected = 0;
+    {
+        Loop other(RefSignal::StepSignal(2 * Ts, 1.0, 0.0), Controlador::PIDController(2.0, 4.0, 0.01, 2 * Ts),
+                   Convertidores::DAConverter(2 * Ts), Planta::Sistema(2 * Ts), Convertidores::ADConverter(2 * Ts));
+        DiscreteSystems::CheckpointReader r1(full);
+        try { other.restore(r1); } catch (const DiscreteSystems::CheckpointError&) { ++rejected; }
+
+        DiscreteSystems::CheckpointReader r2(mw);
+        try { fromMemory.restore(r2); } catch (const DiscreteSystems::CheckpointError&) { ++rejected; }
+
+        DiscreteSystems::CheckpointReader r3(full.data().data(), full.size() - 8);
+        try { fromMemory.restore(r3); } catch (const DiscreteSystems::CheckpointError&) { ++rejected; }
+
+        try { DiscreteSystems::CheckpointReader r4("no_existe.bin"); } catch (const DiscreteSystems::CheckpointError&) { ++rejected; }
+    }
+    const bool okRejected = rejected == 4;
+    cout << "  Período, etiqueta, truncado y fichero inexistente rechazados: " << (okRejected ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okMapped && okBuffers && okContinue && okMr && okRejected;
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
@@ -0,0 +1,220 @@
+/**
+ * @file test_metricas.cpp
+ * @brief Programa de prueba para las métricas de respuesta en línea
+ *
+ * Prueba:
+ * - StepResponse frente al posproceso de la traza completa (lazo con PID)
+ * - Respuesta de primer orden: subida y establecimiento analíticos
+ * - Escalones sucesivos: las métricas de escalón se reinician
+ * - Aborto anticipado como observador de LoopRunner::run()
+ */
+
+#include <lazo.h>
+#include <metricas.h>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace Metricas;
+using namespace std;
+
+namespace {
+
+const double Ts = 0.01;
+
+/**
+ * @brief Métricas calculadas a posteriori sobre la traza completa
+ */
+Summary offline(const vector<double>& r, const vector<double>& y, double band) {
+    const double nan = numeric_limits<double>::quiet_NaN();
+    Summary s = Summary();
+    const size_t n = y.size();
+    for (size_t k = 0; k < n; ++k) {
+        const double e = r[k] - y[k];
+        s.iae += fabs(e) * Ts;
+        s.ise += e * e * Ts;
+        s.itae += k * Ts * fabs(e) * Ts;
+    }
+    // Último escalón: último cambio de r
+    size_t k0 = 0;
+    for (size_t k = 1; k < n; ++k) {
+        if (r[k] != r[k - 1]) {
+            k0 = k;
+        }
+    }
+    const double y0 = k0 == 0 ? 0.0 : y[k0 - 1];
+    const double span = r[k0] - y0;
+    double peak = 0.0;
+    long low = -1, high = -1, out = -1;
+    for (size_t k = k0; k < n; ++k) {
+        const double p = (y[k] - y0) / span;
+        peak = max(peak, p);
+        if (low < 0 && p >= 0.1) low = static_cast<long>(k - k0);
+        if (high < 0 && p >= 0.9) high = static_cast<long>(k - k0);
+        if (fabs(r[k] - y[k]) > band * fabs(span)) out = static_cast<long>(k - k0);
+    }
+    s.overshoot = peak > 1.0 ? (peak - 1.0) * 100.0 : 0.0;
+    s.riseTime = (low >= 0 && high >= 0) ? (high - low) * Ts : nan;
+    s.settlingTime = out == static_cast<long>(n - 1 - k0) ? nan : (out + 1) * Ts;
+    s.steadyStateError = r[n - 1] - y[n - 1];
+    s.stepTime = k0 * Ts;
+    s.ticks = n;
+    return s;
+}
+
+bool close(double a, double b) {
+    if (std::isnan(a) || std::isnan(b)) {
+        return std::isnan(a) && std::isnan(b);
+    }
+    return fabs(a - b) <= 1e-9 * max(1.0, fabs(b));
+}
+
+bool same(const Summary& a, const Summary& b) {
+    return close(a.iae, b.iae) && close(a.ise, b.ise) && close(a.itae, b.itae)
+        && close(a.overshoot, b.overshoot) && close(a.riseTime, b.riseTime)
+        && close(a.settlingTime, b.settlingTime) && close(a.steadyStateError, b.steadyStateError)
+        && close(a.stepTime, b.stepTime) && a.ticks == b.ticks;
+}
+
+void print(const char* label, const Summary& s) {
+    cout << "  " << label << " " << s << "\n";
+}
+
+} // namespace
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE LAS MÉTRICAS DE RESPUESTA                ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    bool ok = true;
+    cout << fixed << setprecision(4);
+
+    // ========== PRUEBA 1: EN LÍNEA FRENTE A POSPROCESO ==========
+    cout << "========================================\n";
+    cout << "  LAZO CON PID: EN LÍNEA FRENTE A TRAZA\n";
+    cout << "========================================\n";
+    {
+        auto loop = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.05),
+                                   Controlador::PIDController(2.0, 30.0, 0.0, Ts),
+                                   Convertidores::DAConverter(Ts),
+                                   Planta::Sistema(Ts),
+                                   Convertidores::ADConverter(Ts));
+        StepResponse eval(Ts);
+        vector<double> r, y;
+        for (size_t k = 0; k < 1500; ++k) {
+            const Lazo::TickData d = loop.tick();
+            eval.update(d.r, d.y);
+            r.push_back(d.r);
+            y.push_back(d.y);
+        }
+        const Summary online = eval.summary();
+        const Summary ref = offline(r, y, 0.02);
+        print("En línea: ", online);
+        print("Traza:    ", ref);
+        const bool okOnline = same(online, ref) && online.overshoot > 0.0 && !std::isnan(online.settlingTime);
+        cout << "  Coinciden: " << (okOnline ? "OK" : "FALLO") << "\n";
+        ok = ok && okOnline;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 2: PRIMER ORDEN ==========
+    cout << "========================================\n";
+    cout << "  RESPUESTA DE PRIMER ORDEN y = 1 - a^(k+1)\n";
+    cout << "========================================\n";
+    {
+        // y(k) entra al nivel p cuando k + 1 >= ln(1 - p) / ln(a)
+        const double a = 0.99;
+        StepResponse eval(Ts);
+        double y = 0.0;
+        for (size_t k = 0; k < 2000; ++k) {
+            y = a * y + (1.0 - a);
+            eval.update(1.0, y);
+        }
+        const Summary s = eval.summary();
+        const double tr = (std::ceil(std::log(0.1) / std::log(a)) - std::ceil(std::log(0.9) / std::log(a))) * Ts;
+        const double ts = (std::ceil(std::log(0.02) / std::log(a)) - 1.0) * Ts;
+        print("Métricas:", s);
+        cout << "  tr esperado = " << tr << " s, ts esperado = " << ts << " s\n";
+        const bool okFirst = close(s.riseTime, tr) && close(s.settlingTime, ts) && s.overshoot == 0.0;
+        cout << "  Sin sobreoscilación, tr y ts exactos: " << (okFirst ? "OK" : "FALLO") << "\n";
+        ok = ok && okFirst;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 3: ESCALONES SUCESIVOS ==========
+    cout << "========================================\n";
+    cout << "  DOS ESCALONES: REINICIO DE LAS MÉTRICAS\n";
+    cout << "========================================\n";
+    {
+        RefSignal::SumSignal sum(Ts);
+        sum.add(RefSignal::StepSignal(Ts, 1.0, 0.0)).add(RefSignal::StepSignal(Ts, -0.5, 8.0));
+        auto loop = Lazo::makeLoop(sum,
+                                   Controlador::PIDController(4.0, 8.0, 0.0, Ts),
+                                   Convertidores::DAConverter(Ts),
+                                   Planta::Sistema(Ts),
+                                   Convertidores::ADConverter(Ts));
+        StepResponse eval(Ts, 0.05);
+        vector<double> r, y;
+        loop.run(1600, [&](const Lazo::TickData& d) {
+            r.push_back(d.r);
+            y.push_back(d.y);
+            return eval.update(d.r, d.y);
+        });
+        const Summary online = eval.summary();
+        const Summary ref = offline(r, y, 0.05);
+        print("Segundo escalón:", online);
+        const bool okSteps = same(online, ref) && close(online.stepTime, 8.0);
+        cout << "  Medido desde t = 8 s y coincide con la traza: " << (okSteps ? "OK" : "FALLO") << "\n";
+        ok = ok && okSteps;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 4: ABORTO ANTICIPADO ==========
+    cout << "========================================\n";
+    cout << "  ABORTO ANTICIPADO COMO OBSERVADOR\n";
+    cout << "========================================\n";
+    {
+        auto loop = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                   Controlador::PIDController(0.2, 0.0, 0.0, Ts),
+                                   Convertidores::DAConverter(Ts),
+                                   Planta::Sistema(Ts),
+                                   Convertidores::ADConverter(Ts));
+        Limits lim;
+        lim.maxIae = 0.5;
+        StepResponse eval(Ts, 0.02, lim);
+        const size_t ran = loop.run(100000, eval.observer());
+        const Summary s = eval.summary();
+        print("Métricas:", s);
+        // En el tick del aborto el IAE acaba de superar la cota
+        const bool okAbort = s.abort == Abort::Iae && ran == s.ticks && ran < 100000
+                          && s.iae > 0.5 && s.iae - 0.5 <= Ts;
+        cout << "  Detenido en el tick " << ran << " por " << toString(s.abort) << ": "
+             << (okAbort ? "OK" : "FALLO") << "\n";
+
+        // Tras el aborto update() no acumula más
+        const bool okFrozen = !eval.update(1.0, 0.0) && eval.ticks() == ran;
+        eval.reset();
+        const bool okReset = !eval.aborted() && eval.update(1.0, 0.0) && eval.ticks() == 1;
+        cout << "  Congelado tras el aborto y reset(): " << (okFrozen && okReset ? "OK" : "FALLO") << "\n";
+        ok = ok && okAbort && okFrozen && okReset;
+
+        Limits out;
+        out.maxAbsOutput = 1.0;
+        StepResponse nanEval(Ts, 0.02, out);
+        const bool okNan = nanEval.update(1.0, 0.5) && !nanEval.update(1.0, std::nan(""))
+                        && nanEval.abortReason() == Abort::Output;
+        cout << "  Salida no finita: " << (okNan ? "OK" : "FALLO") << "\n";
+        ok = ok && okNan;
+    }
+    cout << "========================================\n\n";
+
+    if (ok) {
+        cout << "Pruebas completadas exitosamente.\n\n";
+        return 0;
+    }
+    cout << "Pruebas FALLIDAS.\n\n";
+    return 1;
+}
@@ -5,6 +5,8 @@
  * Verifica la respuesta del sistema a:
  * - Escalón unitario
  * - Rampa
+ * - Impulso
+ * - SistemaFijo: coincide bit a bit con Sistema
  */
 
 #include "planta.h"
@@ -109,6 +111,32 @@ int main() {
     }
     cout << "========================================\n\n";
 
+    // ========== PRUEBA 4: NÚCLEO DE ORDEN FIJO ==========
+    cout << "========================================\n";
+    cout << "  NÚCLEO DE ORDEN FIJO (SistemaFijo)\n";
+    cout << "========================================\n";
+    cout << "  Comparación bit a bit con Sistema (10000 muestras)\n";
+    cout << "----------------------------------------\n";
+
+    Sistema dinamica(Tp);
+    SistemaFijo fija;
+    DiscreteSystems::FixedSystemAdapter<SistemaFijo> adaptada(SistemaFijo(), Tp);
+    bool okFijo = true, okAdaptada = true;
+    for (int k = 0; k < 10000; ++k) {
+        double uk = (k % 300 < 150) ? 1.0 : -0.3 * (k % 7);
+        double y = dinamica.next(uk);
+        okFijo = okFijo && (fija.step(uk) == y);
+        okAdaptada = okAdaptada && (adaptada.next(uk) == y);
+    }
+    cout << "  SistemaFijo::step():        " << (okFijo ? "OK" : "FALLO") << "\n";
+    cout << "  FixedSystemAdapter::next(): " << (okAdaptada ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+
+    if (!okFijo || !okAdaptada) {
+        cout << "Pruebas de planta FALLIDAS.\n\n";
+        return 1;
+    }
+
     cout << "Pruebas de planta completadas exitosamente.\n\n";
 
     return 0;
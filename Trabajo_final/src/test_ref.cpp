@@ -3,13 +3,24 @@
  * @brief Programa de prueba para el generador de señales de referencia.
  *
  * Genera muestras de cada tipo de señal (escalón, rampa, senoidal) y
- * muestra los valores para verificación manual.
+ * muestra los valores para verificación manual. Comprueba además el
+ * historial circular frente a un modelo con std::deque, la generación por
+ * bloques frente a compute(k), la ausencia de deriva temporal en next() y
+ * las señales de tabla (fichero proyectado), suma y por tramos, y el
+ * avance de tramos constantes (hold() y constantUntil()).
  */
 
 #include "ref.h"
 #include <iostream>
 #include <iomanip>
 #include <memory>
+#include <deque>
+#include <vector>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
 
 using namespace RefSignal;
 using namespace std;
@@ -69,6 +80,199 @@ int main() {
     auto sine_offset = SineSignal(Ts, 1.5, 0.5, 0.785398, 2.0);
     printSignal(sine_offset, "SEÑAL SINUSOIDAL (amplitude=1.5, freq=0.5Hz, phase=π/4, offset=2.0)", num_samples);
 
+    // ========== HISTORIAL CIRCULAR ==========
+    cout << "========================================\n";
+    cout << "  HISTORIAL CIRCULAR PREASIGNADO\n";
+    cout << "========================================\n";
+
+    RampSignal hist(Ts, 1.0, 0.0, 0.0, 100);
+    deque<double> model;
+    const double* storage = hist.valueBuffer().data();
+    bool okHist = hist.timeBuffer().empty();
+    for (int k = 0; k < 1000; ++k) {
+        model.push_back(hist.next());
+        if (model.size() > 100) {
+            model.pop_front();
+        }
+        BufferView v = hist.valueBuffer();
+        BufferView t = hist.timeBuffer();
+        okHist = okHist && v.size() == model.size() && t.size() == model.size()
+                        && v.back() == model.back() && v.front() == model.front()
+                        && t.back() == static_cast<double>(k) * Ts;
+        // Vista contigua sobre el mismo almacenamiento, sin reservas nuevas
+        okHist = okHist && v.data() >= storage && v.end() <= storage + 200;
+    }
+    BufferView v = hist.valueBuffer();
+    for (size_t i = 0; i < v.size(); ++i) {
+        okHist = okHist && v[i] == model[i];
+    }
+    cout << "  Ventana de 100 tras 1000 muestras: " << (okHist ? "OK" : "FALLO") << "\n";
+
+    // Cambio de tamaño: se conservan las muestras más recientes
+    hist.bufferSize() = 10;
+    hist.next();
+    bool okResize = hist.valueBuffer().size() == 10 && hist.valueBuffer().front() == model[91];
+    hist.reset();
+    okResize = okResize && hist.valueBuffer().empty() && hist.t() == 0.0;
+    cout << "  Cambio de tamaño y reinicio:       " << (okResize ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+
+    // ========== GENERACIÓN POR BLOQUES ==========
+    cout << "========================================\n";
+    cout << "  GENERACIÓN POR BLOQUES (1 h, Ts = 10 ms)\n";
+    cout << "========================================\n";
+
+    const double Tsh = 0.01;
+    const size_t n = 360000, k0 = 17;
+    StepSignal gStep(Tsh, 2.0, 1800.0, -1.0);
+    RampSignal gRamp(Tsh, 0.5, 10.0, 1.0);
+    SineSignal gSine(Tsh, 1.5, 0.2, 0.3, 2.0);
+    Signal* sigs[] = {&gStep, &gRamp, &gSine};
+    const char* names[] = {"Escalón", "Rampa  ", "Seno   "};
+    const double tol[] = {0.0, 0.0, 1e-9};
+    vector<double> block(n);
+    bool okGen = true;
+    for (int s = 0; s < 3; ++s) {
+        auto t0 = chrono::steady_clock::now();
+        sigs[s]->generate(block.data(), n, k0);
+        auto t1 = chrono::steady_clock::now();
+        double maxErr = 0.0, sink = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double ref = sigs[s]->compute(k0 + i);
+            sink += ref;
+            maxErr = max(maxErr, fabs(block[i] - ref));
+        }
+        auto t2 = chrono::steady_clock::now();
+        bool okS = maxErr <= tol[s] && sink == sink;
+        cout << "  " << names[s] << "  error máx = " << scientific << setprecision(2) << maxErr
+             << fixed << setprecision(2)
+             << "  generate " << chrono::duration<double, nano>(t1 - t0).count() / n << " ns/muestra"
+             << "  compute " << chrono::duration<double, nano>(t2 - t1).count() / n << " ns/muestra"
+             << "  " << (okS ? "OK" : "FALLO") << "\n";
+        okGen = okGen && okS;
+    }
+
+    // next() sin deriva: tras una hora t() es exactamente K * Ts
+    RampSignal drift(Tsh, 1.0, 0.0);
+    double lastValue = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        lastValue = drift.next();
+    }
+    bool okDrift = drift.t() == static_cast<double>(n) * Tsh && lastValue == drift.compute(n - 1);
+    cout << "  next() sin deriva tras " << n << " muestras: " << (okDrift ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+
+    // ========== TABLAS Y SEÑALES COMPUESTAS ==========
+    cout << "========================================\n";
+    cout << "  TABLAS Y SEÑALES COMPUESTAS\n";
+    cout << "========================================\n";
+
+    // Perfil de 1 h: escalón + rampa + seno, aplanado en una sola pasada
+    SumSignal profile(Tsh, 0.5);
+    profile.add(StepSignal(Tsh, 1.0, 600.0)).add(RampSignal(Tsh, 1e-3, 1200.0, -0.25))
+           .add(SineSignal(Tsh, 0.1, 0.05));
+    bool okSum = profile.terms().size() == 3 && profile.terms().constant() == -0.25;
+    double sumErr = 0.0;
+    profile.generate(block.data(), n);
+    for (size_t k = 0; k < n; k += 7) {
+        const double t = static_cast<double>(k) * Tsh;
+        const double direct = 0.5 + StepSignal(Tsh, 1.0, 600.0).computeAt(t)
+                            + RampSignal(Tsh, 1e-3, 1200.0, -0.25).computeAt(t)
+                            + SineSignal(Tsh, 0.1, 0.05).computeAt(t);
+        sumErr = max(sumErr, max(fabs(profile.compute(k) - direct), fabs(block[k] - direct)));
+    }
+    okSum = okSum && sumErr < 1e-9;
+    cout << "  SumSignal frente a la suma de señales: error máx = " << scientific << sumErr
+         << fixed << "  " << (okSum ? "OK" : "FALLO") << "\n";
+
+    // Grabación y reproducción desde fichero proyectado
+    const string path = "test_ref_perfil.bin";
+    TableSignal::writeFile(path, block.data(), n);
+    auto t0 = chrono::steady_clock::now();
+    TableSignal table(Tsh, path);
+    auto t1 = chrono::steady_clock::now();
+    vector<double> played(n + 10);
+    table.generate(played.data(), played.size());
+    bool okTable = table.size() == n && table.duration() == (n - 1) * Tsh;
+    for (size_t k = 0; k < n; ++k) {
+        okTable = okTable && played[k] == block[k] && table.compute(k) == block[k];
+    }
+    okTable = okTable && played[n + 9] == block[n - 1] && table.compute(n + 100) == block[n - 1];
+    cout << "  TableSignal (" << n << " muestras, apertura "
+         << setprecision(1) << chrono::duration<double, micro>(t1 - t0).count()
+         << " us) reproduce el perfil: " << (okTable ? "OK" : "FALLO") << "\n";
+
+    // Tabla a la mitad de cadencia: interpolación lineal y retención
+    vector<double> coarse;
+    coarse.push_back(0.0);
+    coarse.push_back(2.0);
+    coarse.push_back(4.0);
+    TableSignal lin(Tsh, coarse, 2 * Tsh);
+    TableSignal hold(Tsh, coarse, 2 * Tsh, Interpolation::Hold);
+    double interp[6];
+    lin.generate(interp, 6);
+    bool okInterp = fabs(lin.compute(1) - 1.0) < 1e-12 && lin.compute(2) == 2.0
+                 && hold.compute(1) == 0.0 && hold.compute(3) == 2.0
+                 && fabs(interp[3] - 3.0) < 1e-12 && interp[5] == 4.0;
+    cout << "  Interpolación lineal y retención:  " << (okInterp ? "OK" : "FALLO") << "\n";
+
+    // Tramos: rampa 10 s, meseta 20 s, tabla grabada y seno indefinido
+    PiecewiseSignal pw(Tsh);
+    pw.append(10.0, RampSignal(Tsh, 0.1, 0.0))
+      .append(20.0, StepSignal(Tsh, 1.0, 0.0))
+      .append(600.0, table)
+      .append(1.0, SineSignal(Tsh, 0.5, 1.0, 0.0, 1.0));
+    pw.generate(block.data(), n);
+    double pwErr = 0.0;
+    for (size_t k = 0; k < n; ++k) {
+        pwErr = max(pwErr, fabs(block[k] - pw.compute(k)));
+    }
+    bool okPw = pw.segments() == 4 && pw.duration() == 631.0 && pwErr < 1e-9
+             && fabs(pw.compute(999) - 0.999) < 1e-12 && pw.compute(1000) == 1.0
+             && pw.compute(3000) == played[0] && fabs(pw.compute(63100) - 1.0) < 1e-12;
+    cout << "  PiecewiseSignal: error máx generate = " << scientific << pwErr
+         << fixed << "  " << (okPw ? "OK" : "FALLO") << "\n";
+
+    bool okMissing = false;
+    try {
+        TableSignal missing(Tsh, string("no_existe.bin"));
+    } catch (const runtime_error&) {
+        okMissing = true;
+    }
+    remove(path.c_str());
+    cout << "  Fichero inexistente lanza excepción: " << (okMissing ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    bool okComposite = okSum && okTable && okInterp && okPw && okMissing;
+
+    // ========== TRAMOS CONSTANTES ==========
+    cout << "========================================\n";
+    cout << "  TRAMOS CONSTANTES (hold / constantUntil)\n";
+    cout << "========================================\n";
+    bool okHold = true;
+    {
+        StepSignal a(0.01, 1.0, 5.0, 0.0, 64), b(0.01, 1.0, 5.0, 0.0, 64);
+        for (int i = 0; i < 300; ++i) {
+            a.next();
+        }
+        b.next();
+        b.hold(299, b.compute());
+        okHold = a.t() == b.t() && a.next() == b.next() && b.valueBuffer().size() == 64;
+        for (size_t i = 0; okHold && i < 64; ++i) {
+            okHold = a.timeBuffer()[i] == b.timeBuffer()[i] && a.valueBuffer()[i] == b.valueBuffer()[i];
+        }
+        const bool okUntil = a.constantUntil(0.5) == 5.0 && std::isinf(a.constantUntil(5.0))
+                          && RampSignal(0.01, 1.0, 0.0).constantUntil(0.5) == 0.5;
+        cout << "  hold(299) igual a 299 llamadas a next(): " << (okHold ? "OK" : "FALLO") << "\n";
+        cout << "  constantUntil (escalón antes y después, rampa): " << (okUntil ? "OK" : "FALLO") << "\n";
+        okHold = okHold && okUntil;
+    }
+    cout << "========================================\n\n";
+
+    if (!okHist || !okResize || !okGen || !okDrift || !okComposite || !okHold) {
+        cout << "Prueba FALLIDA.\n\n";
+        return 1;
+    }
+
     cout << "Prueba completada exitosamente.\n\n";
 
     return 0;
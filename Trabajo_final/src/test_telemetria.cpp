@@ -0,0 +1,229 @@
+/**
+ * @file test_telemetria.cpp
+ * @brief Programa de prueba para la telemetría en memoria compartida
+ *
+ * Prueba:
+ * - TelemetryWriter/TelemetryReader: registros del lazo idénticos en el lector
+ * - Anillo: un lector atrasado recupera la ventana reciente y cuenta las pérdidas
+ * - Lector concurrente: ningún registro leído está a medio escribir
+ * - Buzón de comandos: varios emisores sin pérdidas y orden por emisor
+ */
+
+#include <telemetria.h>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+using namespace Telemetria;
+using namespace std;
+
+namespace {
+
+/** @brief Tick sintético cuyos campos se deducen de k */
+Lazo::TickData synthetic(size_t k) {
+    Lazo::TickData d;
+    d.k = k;
+    d.r = static_cast<double>(k);
+    d.e = 2.0 * k;
+    d.u = 3.0 * k;
+    d.y = 4.0 * k;
+    d.s = 5.0 * k;
+    return d;
+}
+
+bool consistent(const TelemetryRecord& rec) {
+    const double k = static_cast<double>(rec.k);
+    return rec.r == k && rec.e == 2.0 * k && rec.u == 3.0 * k && rec.y == 4.0 * k && rec.s == 5.0 * k;
+}
+
+} // namespace
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE TELEMETRÍA EN MEMORIA COMPARTIDA         ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    const double Ts = 0.01;
+    const string name = "/test_telemetria_" + to_string(getpid());
+    bool ok = true;
+
+    // ========== PRUEBA 1: REGISTROS DEL LAZO ==========
+    cout << "========================================\n";
+    cout << "  REGISTROS DEL LAZO\n";
+    cout << "========================================\n";
+
+    bool okLoop = true;
+    {
+        TelemetryWriter writer(name, Ts, 1000);
+        TelemetryReader reader(name);
+        auto loop = Lazo::makeLoop(RefSignal::StepSignal(Ts, 1.0, 0.0),
+                                   Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                                   Convertidores::DAConverter(Ts),
+                                   Planta::Sistema(Ts),
+                                   Convertidores::ADConverter(Ts));
+        vector<Lazo::TickData> sent;
+        for (int k = 0; k < 500; ++k) {
+            sent.push_back(loop.tick());
+            writer.publish(sent.back());
+        }
+        vector<TelemetryRecord> got(1024);
+        uint64_t cursor = 0, lost = 0;
+        size_t n = reader.readSince(cursor, got.data(), got.size(), &lost);
+        okLoop = reader.capacity() == 1024 && reader.getSamplingTime() == Ts
+              && n == sent.size() && lost == 0 && cursor == 500;
+        for (size_t i = 0; okLoop && i < n; ++i) {
+            const Lazo::TickData& d = sent[i];
+            okLoop = got[i].k == d.k && got[i].r == d.r && got[i].e == d.e && got[i].u == d.u
+                  && got[i].y == d.y && got[i].s == d.s && got[i].t == d.k * Ts
+                  && (i == 0 || got[i].stampNs >= got[i - 1].stampNs);
+        }
+        cout << "  Capacidad redondeada: " << reader.capacity() << "\n";
+        cout << "  " << n << " registros idénticos al lazo: " << (okLoop ? "OK" : "FALLO") << "\n";
+    }
+
+    bool okErr = false;
+    try {
+        TelemetryReader missing(name);
+    } catch (const runtime_error& ex) {
+        okErr = true;
+        cout << "  Excepción: " << ex.what() << "\n";
+    }
+    cout << "  Segmento eliminado al destruir el escritor: " << (okErr ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okLoop && okErr;
+
+    // ========== PRUEBA 2: LECTOR ATRASADO ==========
+    cout << "========================================\n";
+    cout << "  LECTOR ATRASADO\n";
+    cout << "========================================\n";
+
+    bool okLap = true;
+    {
+        TelemetryWriter writer(name, Ts, 64);
+        TelemetryReader reader(name);
+        for (size_t k = 0; k < 1000; ++k) {
+            writer.publish(synthetic(k));
+        }
+        vector<TelemetryRecord> got(64);
+        uint64_t cursor = 0, lost = 0;
+        size_t n = reader.readSince(cursor, got.data(), got.size(), &lost);
+        okLap = n == 64 && lost == 1000 - 64 && got.front().k == 1000 - 64 && got.back().k == 999;
+        TelemetryRecord old;
+        okLap = okLap && !reader.read(10, old) && !reader.read(1000, old) && reader.latest() == 1000;
+        cout << "  leídos=" << n << "  perdidos=" << lost << "  " << (okLap ? "OK" : "FALLO") << "\n";
+    }
+    cout << "========================================\n\n";
+    ok = ok && okLap;
+
+    // ========== PRUEBA 3: LECTOR CONCURRENTE ==========
+    cout << "========================================\n";
+    cout << "  LECTOR CONCURRENTE\n";
+    cout << "========================================\n";
+
+    bool okConc = true;
+    {
+        const size_t K = 2000000;
+        TelemetryWriter writer(name, Ts, 256);
+        TelemetryReader reader(name);
+        thread producer([&writer, K]() {
+            for (size_t k = 0; k < K; ++k) {
+                writer.publish(synthetic(k));
+            }
+        });
+        vector<TelemetryRecord> got(64);
+        uint64_t cursor = 0, lost = 0, seen = 0, last = 0;
+        bool first = true;
+        while (cursor < K) {
+            size_t n = reader.readSince(cursor, got.data(), got.size(), &lost);
+            for (size_t i = 0; i < n; ++i) {
+                okConc = okConc && consistent(got[i]) && (first || got[i].k > last);
+                last = got[i].k;
+                first = false;
+            }
+            seen += n;
+        }
+        producer.join();
+        okConc = okConc && seen + lost == K && writer.published() == K;
+        cout << "  leídos=" << seen << "  perdidos=" << lost
+             << "  sin registros rotos: " << (okConc ? "OK" : "FALLO") << "\n";
+    }
+    cout << "========================================\n\n";
+    ok = ok && okConc;
+
+    // ========== PRUEBA 4: BUZÓN DE COMANDOS ==========
+    cout << "========================================\n";
+    cout << "  BUZÓN DE COMANDOS\n";
+    cout << "========================================\n";
+
+    bool okCmd = true;
+    {
+        TelemetryWriter writer(name, Ts);
+        CommandSender full(name);
+        size_t accepted = 0;
+        while (full.setReferenceOffset(static_cast<double>(accepted))) {
+            ++accepted;
+        }
+        Command cmd;
+        size_t drained = 0;
+        while (writer.pollCommand(cmd)) {
+            okCmd = okCmd && cmd.type == CommandType::SetReferenceOffset && cmd.values[0] == drained;
+            ++drained;
+        }
+        okCmd = okCmd && accepted == kMailboxSize && drained == kMailboxSize;
+        cout << "  Buzón lleno tras " << accepted << " comandos: " << (okCmd ? "OK" : "FALLO") << "\n";
+
+        const int senders = 4;
+        const size_t perSender = 100000;
+        vector<thread> threads;
+        for (int s = 0; s < senders; ++s) {
+            threads.push_back(thread([&name, s, perSender]() {
+                CommandSender tx(name);
+                for (size_t i = 0; i < perSender; ++i) {
+                    while (!tx.setGains(static_cast<double>(s), static_cast<double>(i), 0.0)) {
+                        this_thread::yield();
+                    }
+                }
+            }));
+        }
+        vector<size_t> next(senders, 0);
+        size_t received = 0;
+        bool okOrder = true;
+        while (received < senders * perSender) {
+            if (!writer.pollCommand(cmd)) {
+                this_thread::yield();
+                continue;
+            }
+            const int s = static_cast<int>(cmd.values[0]);
+            okOrder = okOrder && cmd.type == CommandType::SetGains && s >= 0 && s < senders
+                             && cmd.values[1] == next[s];
+            if (s >= 0 && s < senders) {
+                ++next[s];
+            }
+            ++received;
+        }
+        for (size_t i = 0; i < threads.size(); ++i) {
+            threads[i].join();
+        }
+        okOrder = okOrder && !writer.pollCommand(cmd);
+        cout << "  " << received << " comandos de " << senders
+             << " emisores, en orden por emisor: " << (okOrder ? "OK" : "FALLO") << "\n";
+        okCmd = okCmd && okOrder;
+    }
+    cout << "========================================\n\n";
+    ok = ok && okCmd;
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
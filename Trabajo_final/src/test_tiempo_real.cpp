@@ -0,0 +1,403 @@
+/**
+ * @file test_tiempo_real.cpp
+ * @brief Programa de prueba para la ejecución en tiempo real del lazo
+ *
+ * Prueba:
+ * - SpscRing: orden y ausencia de pérdidas entre dos hilos
+ * - Pipeline (Threaded y SingleThread): coincide con LoopRunner
+ * - PeriodicTimer: la ejecución tarda K períodos de reloj
+ * - GraphPipeline (Threaded con varios tramos y SingleThread): coincide con
+ *   CompiledGraph::tick() y deja el mismo estado en el arena
+ * - AllocationTripwire: detecta una reserva y guarda su pila; el tick del
+ *   lazo (rápido y con registro), next()/process() de SS y TF (incluida la
+ *   convolución FFT) no reservan memoria (se omite si la sustitución de
+ *   malloc no está compilada; la vigilancia pedida consta entonces como
+ *   kRejectedTripwire)
+ * - RuntimeConfig: Pipeline y GraphPipeline endurecidos (afinidad, pila
+ *   prefallada, calentamiento, vigilancia) coinciden con la ejecución
+ *   normal sin reservas en los hilos de control; una CPU inexistente se
+ *   indica en Stats::rejected
+ * - Trazas: Pipeline y GraphPipeline trazados coinciden con la ejecución
+ *   normal, sin reservas, con un tramo Begin/End por bloque y tick y cada
+ *   push emparejado con su pop
+ */
+
+#include <tiempo_real.h>
+#include <DiscreteSystems.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace TiempoReal;
+using namespace std;
+
+typedef Lazo::LoopRunner<RefSignal::StepSignal> Loop;
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE EJECUCIÓN EN TIEMPO REAL                 ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    const double Ts = 0.01;
+    bool ok = true;
+
+    // ========== PRUEBA 1: COLA SPSC ==========
+    cout << "========================================\n";
+    cout << "  COLA SPSC ENTRE DOS HILOS\n";
+    cout << "========================================\n";
+
+    const size_t count = 1000000;
+    SpscRing<size_t, 256> ring;
+    thread producer([&ring, count]() {
+        for (size_t i = 0; i < count; ++i) {
+            while (!ring.push(i)) {
+                this_thread::yield();
+            }
+        }
+    });
+    bool okRing = true;
+    for (size_t i = 0; i < count; ++i) {
+        size_t v;
+        while (!ring.pop(v)) {
+            this_thread::yield();
+        }
+        okRing = okRing && v == i;
+    }
+    producer.join();
+    okRing = okRing && ring.size() == 0;
+    cout << "  " << count << " elementos en orden: " << (okRing ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okRing;
+
+    // ========== PRUEBA 2: PIPELINE FRENTE A LOOPRUNNER ==========
+    cout << "========================================\n";
+    cout << "  PIPELINE FRENTE A LOOPRUNNER\n";
+    cout << "========================================\n";
+
+    const Loop proto(RefSignal::StepSignal(Ts, 1.0, 0.055),
+                     Controlador::PIDController(2.0, 4.0, 0.01, Ts),
+                     Convertidores::DAConverter(Ts),
+                     Planta::Sistema(Ts),
+                     Convertidores::ADConverter(Ts));
+    const size_t K = 20000;
+    Loop reference(proto);
+    vector<Lazo::TickData> expected(K);
+    for (size_t k = 0; k < K; ++k) {
+        expected[k] = reference.tick();
+    }
+
+    const Mode modes[] = {Mode::Threaded, Mode::SingleThread};
+    const char* names[] = {"Threaded    ", "SingleThread"};
+    for (int m = 0; m < 2; ++m) {
+        Pipeline<Loop> pipe(proto, 0.0, modes[m]);
+        bool okPipe = true;
+        Stats st = pipe.run(K, [&](const Lazo::TickData& d) {
+            const Lazo::TickData& x = expected[d.k];
+            okPipe = okPipe && d.r == x.r && d.s == x.s && d.e == x.e && d.u == x.u && d.y == x.y;
+            return true;
+        });
+        okPipe = okPipe && pipe.getK() == K && st.ticks + st.dropped == K
+                        && pipe.loop().adc().delayed() == expected[K - 1].y;
+        cout << "  " << names[m] << "  ticks=" << st.ticks << "  descartados=" << st.dropped
+             << "  " << (okPipe ? "OK" : "FALLO") << "\n";
+        ok = ok && okPipe;
+    }
+
+    // Parada anticipada desde el observador
+    Pipeline<Loop> stopper(proto, 0.0, Mode::Threaded);
+    Stats stStop = stopper.run(K, [](const Lazo::TickData& d) { return d.k < 100; });
+    bool okStop = stStop.ticks == 101;
+    cout << "  parada anticipada tras " << stStop.ticks << " ticks: " << (okStop ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okStop;
+
+    // ========== PRUEBA 3: TEMPORIZADOR PERIÓDICO ==========
+    cout << "========================================\n";
+    cout << "  TEMPORIZADOR DE PLAZOS ABSOLUTOS\n";
+    cout << "========================================\n";
+
+    const size_t Krt = 100;
+    const double period = 0.001;
+    for (int m = 0; m < 2; ++m) {
+        Pipeline<Loop> pipe(proto, period, modes[m]);
+        auto t0 = chrono::steady_clock::now();
+        Stats st = pipe.run(Krt);
+        double elapsed = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+        bool okRt = st.ticks == Krt && elapsed >= Krt * period * 0.99;
+        cout << "  " << names[m] << "  " << Krt << " ticks de 1 ms en "
+             << fixed << setprecision(1) << elapsed * 1e3 << " ms"
+             << "  desbordamientos=" << st.overruns
+             << "  retraso máx=" << st.maxLatenessNs / 1000 << " us"
+             << "  " << (okRt ? "OK" : "FALLO") << "\n";
+        ok = ok && okRt;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 4: GRAPHPIPELINE FRENTE A COMPILEDGRAPH ==========
+    cout << "========================================\n";
+    cout << "  GRAPHPIPELINE FRENTE A COMPILEDGRAPH\n";
+    cout << "========================================\n";
+
+    const RefSignal::StepSignal gref(Ts, 1.0, 0.055);
+    const Grafo::CompiledGraph protoGraph =
+        Grafo::makeLoopGraph(Controlador::PIDController(2.0, 4.0, 0.01, Ts), Planta::Sistema(Ts)).compile();
+    auto source = [&gref, Ts](size_t k, double* in) {
+        in[0] = gref.RefSignal::StepSignal::computeAt(static_cast<double>(k) * Ts);
+    };
+    const size_t Kg = 20000;
+    Grafo::CompiledGraph refGraph(protoGraph);
+    vector<vector<double> > frames(Kg);
+    for (size_t k = 0; k < Kg; ++k) {
+        double in[1];
+        source(k, in);
+        refGraph.tick(in);
+        frames[k] = refGraph.values();
+    }
+
+    const Mode graphModes[] = {Mode::Threaded, Mode::Threaded, Mode::SingleThread};
+    const size_t stageCounts[] = {0, 2, 1};
+    for (int m = 0; m < 3; ++m) {
+        GraphPipeline pipe(protoGraph, 0.0, graphModes[m], stageCounts[m]);
+        bool okGraph = true;
+        Stats st = pipe.run(Kg, source, [&](const Grafo::Frame& f) {
+            okGraph = okGraph && f.k < Kg && vector<double>(f.values, f.values + frames[f.k].size()) == frames[f.k];
+            return true;
+        });
+        // La mitad en una segunda llamada: retoma desde el estado del arena
+        GraphPipeline halves(protoGraph, 0.0, graphModes[m], stageCounts[m]);
+        halves.run(Kg / 2, source);
+        halves.run(Kg - Kg / 2, source);
+        okGraph = okGraph && pipe.getK() == Kg && st.ticks + st.dropped == Kg && halves.getK() == Kg
+                          && pipe.graph().arena() == refGraph.arena() && halves.graph().arena() == refGraph.arena();
+        cout << "  " << names[m == 2 ? 1 : 0] << "  tramos=" << pipe.stages() << "  ticks=" << st.ticks
+             << "  descartados=" << st.dropped << "  " << (okGraph ? "OK" : "FALLO") << "\n";
+        ok = ok && okGraph;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 5: VIGILANCIA DE RESERVAS ==========
+    cout << "========================================\n";
+    cout << "  VIGILANCIA DE RESERVAS EN EL HILO DE CONTROL\n";
+    cout << "========================================\n";
+
+    // Sin sustitución (ENABLE_ALLOC_TRIPWIRE=OFF, sanitizers...) no hay nada que vigilar
+    const bool installed = AllocationTripwire::installed();
+    cout << "  sustitución de malloc compilada: " << (installed ? "sí" : "no (se omite la prueba)") << "\n";
+    if (installed) {
+        const size_t before = AllocationTripwire::trips();
+        AllocationTripwire::arm(Tripwire::Count);
+        vector<double>* leak = new vector<double>(16, 1.0);
+        const bool armed = AllocationTripwire::armed();
+        AllocationTripwire::disarm();
+        delete leak;
+        void* frames[16];
+        const bool okTrip = armed && AllocationTripwire::trips() - before == 2
+                         && AllocationTripwire::firstTrip(frames, 16) > 0 && !AllocationTripwire::armed();
+        cout << "  reserva detectada con su pila: " << (okTrip ? "OK" : "FALLO") << "\n";
+        ok = ok && okTrip;
+
+        // Bloques listos antes de armar: a partir de ahí ningún paso debe reservar
+        Loop fast(proto), recorded(proto);
+        recorded.setRecording(true);
+        DiscreteSystems::StateSpaceSystem ss({{0.9, 0.1}, {0.0, 0.8}}, {0.0, 1.0}, {1.0, 0.0}, 0.0, Ts);
+        vector<double> taps(DiscreteSystems::TransferFunctionSystem::kFftMinTaps * 4, 0.01);
+        DiscreteSystems::TransferFunctionSystem fir(taps, {1.0}, Ts);
+        vector<double> ub(1024, 1.0), yb(1024, 0.0);
+        fir.process(&ub[0], &yb[0], ub.size());
+
+        const size_t t0 = AllocationTripwire::trips();
+        AllocationTripwire::arm(Tripwire::Count);
+        fast.run(K);
+        recorded.run(K);
+        for (size_t k = 0; k < K; ++k) {
+            ss.next(1.0);
+        }
+        ss.process(&ub[0], &yb[0], ub.size());
+        fir.next(1.0);
+        fir.process(&ub[0], &yb[0], ub.size());
+        AllocationTripwire::disarm();
+        const size_t hot = AllocationTripwire::trips() - t0;
+        const bool okHot = hot == 0;
+        cout << "  reservas en lazo, SS y FIR por FFT: " << hot << "  " << (okHot ? "OK" : "FALLO") << "\n";
+        ok = ok && okHot;
+    }
+    cout << "========================================\n\n";
+
+    // ========== PRUEBA 6: EJECUCIÓN ENDURECIDA ==========
+    cout << "========================================\n";
+    cout << "  EJECUCIÓN ENDURECIDA (RuntimeConfig)\n";
+    cout << "========================================\n";
+
+    // Sin SCHED_FIFO: con hilos en espera activa podría acaparar la única CPU
+    RuntimeConfig hard;
+    hard.lockMemory = true;
+    hard.stackPrefault = 64 * 1024;
+    hard.cpus = vector<int>(5, 0);
+    hard.warmupTicks = 32;
+    hard.tripwire = Tripwire::Count;
+    // Sin sustitución de malloc la vigilancia pedida debe constar como rechazada
+    const unsigned required = installed ? 0u : kRejectedTripwire;
+    const unsigned tolerated = kRejectedLockMemory | required;
+    for (int m = 0; m < 2; ++m) {
+        Pipeline<Loop> pipe(proto, 0.0, modes[m]);
+        pipe.setRuntimeConfig(hard);
+        bool okHard = true;
+        Stats st = pipe.run(K, [&](const Lazo::TickData& d) {
+            const Lazo::TickData& x = expected[d.k];
+            okHard = okHard && d.r == x.r && d.s == x.s && d.e == x.e && d.u == x.u && d.y == x.y;
+            return true;
+        });
+        okHard = okHard && pipe.getK() == K && st.ticks + st.dropped == K
+                        && pipe.loop().adc().delayed() == expected[K - 1].y && st.allocations == 0
+                        && (st.rejected & ~tolerated) == 0 && (st.rejected & required) == required;
+        cout << "  " << names[m] << "  ticks=" << st.ticks << "  reservas=" << st.allocations
+             << "  rechazos=" << st.rejected << "  " << (okHard ? "OK" : "FALLO") << "\n";
+        ok = ok && okHard;
+    }
+    for (int m = 0; m < 3; ++m) {
+        GraphPipeline pipe(protoGraph, 0.0, graphModes[m], stageCounts[m]);
+        pipe.setRuntimeConfig(hard);
+        bool okHard = true;
+        Stats st = pipe.run(Kg, source, [&](const Grafo::Frame& f) {
+            okHard = okHard && f.k < Kg && equal(f.values, f.values + frames[f.k].size(), frames[f.k].begin());
+            return true;
+        });
+        okHard = okHard && pipe.getK() == Kg && st.ticks + st.dropped == Kg
+                        && pipe.graph().arena() == refGraph.arena() && st.allocations == 0
+                        && (st.rejected & ~tolerated) == 0 && (st.rejected & required) == required;
+        cout << "  Grafo " << names[m == 2 ? 1 : 0] << "  tramos=" << pipe.stages() << "  reservas=" << st.allocations
+             << "  rechazos=" << st.rejected << "  " << (okHard ? "OK" : "FALLO") << "\n";
+        ok = ok && okHard;
+    }
+
+    RuntimeConfig badCpu;
+    badCpu.cpus = vector<int>(1, 100000);
+    Pipeline<Loop> pinned(proto, 0.0, Mode::SingleThread);
+    pinned.setRuntimeConfig(badCpu);
+    Stats stPin = pinned.run(K);
+    const bool okPin = stPin.ticks + stPin.dropped == K && pinned.loop().adc().delayed() == expected[K - 1].y
+                    && (stPin.rejected & kRejectedAffinity) != 0;
+    cout << "  CPU inexistente en Stats::rejected: " << (okPin ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okPin;
+
+    // ========== PRUEBA 7: TRAZAS DE EVENTOS ==========
+    cout << "========================================\n";
+    cout << "  TRAZAS DE EVENTOS (Traza::Tracer)\n";
+    cout << "========================================\n";
+
+    if (Traza::kEnabled) {
+        // Eventos de un tick en el hilo del PID: dos pop, Begin, End y push
+        const size_t capacity = 8 * K;
+        RuntimeConfig watched;
+        watched.tripwire = Tripwire::Count;
+        for (int m = 0; m < 2; ++m) {
+            Traza::Tracer tracer(5, capacity);
+            Pipeline<Loop> pipe(proto, 0.0, modes[m]);
+            pipe.setRuntimeConfig(watched);
+            pipe.setTracer(&tracer);
+            bool okTrace = true;
+            Stats st = pipe.run(K, [&](const Lazo::TickData& d) {
+                const Lazo::TickData& x = expected[d.k];
+                okTrace = okTrace && d.r == x.r && d.s == x.s && d.e == x.e && d.u == x.u && d.y == x.y;
+                return true;
+            });
+            tracer.collect();
+            const size_t threads = modes[m] == Mode::SingleThread ? 1 : 5;
+            size_t pushes = 0, pops = 0;
+            for (size_t t = 0; t < threads; ++t) {
+                size_t begins = 0, ends = 0;
+                const vector<Traza::Event>& ev = tracer.events(t);
+                for (size_t i = 0; i < ev.size(); ++i) {
+                    begins += ev[i].kind == Traza::EventKind::Begin;
+                    ends += ev[i].kind == Traza::EventKind::End;
+                    pushes += ev[i].kind == Traza::EventKind::Push;
+                    pops += ev[i].kind == Traza::EventKind::Pop;
+                }
+                okTrace = okTrace && begins == K && ends == K;
+            }
+            // El primer s(k) lo ceba run() y el último no se envía
+            okTrace = okTrace && st.ticks + st.dropped == K && st.allocations == 0 && tracer.dropped() == 0
+                              && (threads == 1 ? pushes == 0 && pops == 0 : pushes == 5 * K - 1 && pops == 5 * K);
+            cout << "  " << names[m] << "  eventos=" << tracer.size() << "  reservas=" << st.allocations
+                 << "  " << (okTrace ? "OK" : "FALLO") << "\n";
+            ok = ok && okTrace;
+        }
+
+        Traza::Tracer graphTracer(2, capacity);
+        GraphPipeline traced(protoGraph, 0.0, Mode::Threaded, 2);
+        traced.setRuntimeConfig(watched);
+        traced.setTracer(&graphTracer);
+        Stats stG = traced.run(Kg, source);
+        graphTracer.collect();
+        size_t pushes = 0, pops = 0;
+        for (size_t i = 0; i < graphTracer.events(0).size(); ++i) {
+            pushes += graphTracer.events(0)[i].kind == Traza::EventKind::Push;
+        }
+        for (size_t i = 0; i < graphTracer.events(1).size(); ++i) {
+            pops += graphTracer.events(1)[i].kind == Traza::EventKind::Pop;
+        }
+        const bool okGraphTrace = traced.graph().arena() == refGraph.arena() && stG.allocations == 0
+                               && pushes == Kg && pops == Kg && graphTracer.dropped() == 0;
+        cout << "  Grafo Threaded      tramos=2  eventos=" << graphTracer.size() << "  "
+             << (okGraphTrace ? "OK" : "FALLO") << "\n";
+        ok = ok && okGraphTrace;
+
+        // Juegos publicados con transición suave: una marca por juego adoptado,
+        // no una por tick de la rampa
+        const double newKp[] = {3.0, 1.5};
+        for (int m = 0; m < 2; ++m) {
+            Traza::Tracer tracer(5, capacity);
+            Pipeline<Loop> pipe(proto, 0.0, modes[m]);
+            pipe.setTracer(&tracer);
+            pipe.loop().pid().setBumpless(50);
+            for (int g = 0; g < 2; ++g) {
+                pipe.loop().pid().setKp(newKp[g]);
+                pipe.run(K / 2);
+                tracer.collect();
+            }
+            const vector<Traza::Event>& ev = tracer.events(modes[m] == Mode::SingleThread ? 0 : 1);
+            vector<double> marks;
+            for (size_t i = 0; i < ev.size(); ++i) {
+                if (ev[i].kind == Traza::EventKind::GainChange) {
+                    marks.push_back(ev[i].value);
+                }
+            }
+            const bool okGains = marks.size() == 2
+                              && fabs(marks[0] - newKp[0]) < 1e-9 && fabs(marks[1] - newKp[1]) < 1e-9;
+            cout << "  " << names[m] << "  setBumpless(50), 2 juegos: marcas de ganancias=" << marks.size()
+                 << "  " << (okGains ? "OK" : "FALLO") << "\n";
+            ok = ok && okGains;
+        }
+
+        bool okSmall = false;
+        try {
+            Traza::Tracer small(1);
+            Pipeline<Loop> pipe(proto, 0.0, Mode::Threaded);
+            pipe.setTracer(&small);
+        } catch (const invalid_argument& ex) {
+            okSmall = true;
+            cout << "  Excepción: " << ex.what() << "\n";
+        }
+        cout << "  Tracer con menos buffers que hilos: " << (okSmall ? "OK" : "FALLO") << "\n";
+        ok = ok && okSmall;
+    } else {
+        cout << "  Trazas desactivadas en la compilación (ENABLE_TRACING=OFF)\n";
+    }
+    cout << "========================================\n\n";
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
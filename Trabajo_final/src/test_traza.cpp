@@ -0,0 +1,204 @@
+/**
+ * @file test_traza.cpp
+ * @brief Programa de prueba para las trazas de eventos
+ *
+ * Prueba:
+ * - TraceBuffer: orden, descarte con la cola llena y recuperación tras drain()
+ * - Productor y consumidor concurrentes: cada evento se recoge o se cuenta
+ *   como descartado, en orden
+ * - Reloj: los instantes convertidos a ns siguen a steady_clock
+ * - Exportación a Chrome JSON: nombres, tramos, flechas de flujo y marcas;
+ *   valores NaN o infinitos como null
+ */
+
+#include <traza.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Traza;
+using namespace std;
+
+namespace {
+
+/** @brief Apariciones de un fragmento en un texto */
+size_t occurrences(const string& text, const string& what) {
+    size_t n = 0;
+    for (size_t at = text.find(what); at != string::npos; at = text.find(what, at + what.size())) {
+        ++n;
+    }
+    return n;
+}
+
+} // namespace
+
+int main() {
+    cout << "\n";
+    cout << "╔══════════════════════════════════════════════════════╗\n";
+    cout << "║   PRUEBA DE TRAZAS DE EVENTOS                        ║\n";
+    cout << "╚══════════════════════════════════════════════════════╝\n\n";
+
+    if (!kEnabled) {
+        cout << "Trazas desactivadas en la compilación (ENABLE_TRACING=OFF): nada que probar.\n\n";
+        return 0;
+    }
+
+    bool ok = true;
+
+    // ========== PRUEBA 1: COLA DE EVENTOS ==========
+    cout << "========================================\n";
+    cout << "  COLA DE EVENTOS DE UN HILO\n";
+    cout << "========================================\n";
+
+    TraceBuffer buf(6);
+    for (uint64_t k = 0; k < 10; ++k) {
+        buf.record(EventKind::Instant, 7, k, 0.5 * k);
+    }
+    vector<Event> out;
+    const size_t moved = buf.drain(out);
+    bool okBuf = buf.capacity() == 8 && moved == 8 && buf.dropped() == 2 && buf.size() == 0;
+    for (size_t i = 0; okBuf && i < out.size(); ++i) {
+        okBuf = out[i].k == i && out[i].value == 0.5 * i && out[i].kind == EventKind::Instant && out[i].id == 7
+             && (i == 0 || out[i].stamp >= out[i - 1].stamp);
+    }
+    buf.record(EventKind::Begin, 1, 10);
+    okBuf = okBuf && buf.drain(out) == 1 && out.back().k == 10 && out.back().kind == EventKind::Begin;
+    cout << "  Capacidad redondeada: " << buf.capacity() << "\n";
+    cout << "  recogidos=" << moved << "  descartados=" << buf.dropped() << "  " << (okBuf ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okBuf;
+
+    // ========== PRUEBA 2: PRODUCTOR Y CONSUMIDOR CONCURRENTES ==========
+    cout << "========================================\n";
+    cout << "  PRODUCTOR Y CONSUMIDOR CONCURRENTES\n";
+    cout << "========================================\n";
+
+    const uint64_t count = 1000000;
+    TraceBuffer shared(1024);
+    thread producer([&shared, count]() {
+        for (uint64_t k = 0; k < count; ++k) {
+            shared.record(EventKind::Instant, 0, k);
+        }
+    });
+    vector<Event> got;
+    got.reserve(count);
+    while (got.size() + shared.dropped() < count) {
+        shared.drain(got);
+        this_thread::yield();
+    }
+    producer.join();
+    shared.drain(got);
+    bool okConc = got.size() + shared.dropped() == count;
+    for (size_t i = 1; okConc && i < got.size(); ++i) {
+        okConc = got[i].k > got[i - 1].k;
+    }
+    cout << "  recogidos=" << got.size() << "  descartados=" << shared.dropped()
+         << "  " << (okConc ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okConc;
+
+    // ========== PRUEBA 3: RELOJ ==========
+    cout << "========================================\n";
+    cout << "  RELOJ DE LAS TRAZAS\n";
+    cout << "========================================\n";
+
+    Tracer clockTracer(1, 16);
+    const uint64_t ns0 = Clock::steadyNs();
+    clockTracer.buffer(0).record(EventKind::Instant, 0, 0);
+    this_thread::sleep_for(chrono::milliseconds(20));
+    clockTracer.buffer(0).record(EventKind::Instant, 0, 1);
+    const uint64_t ns1 = Clock::steadyNs();
+    ostringstream sink;
+    clockTracer.writeChromeJson(sink);
+    const vector<Event>& pair = clockTracer.events(0);
+    bool okClock = pair.size() == 2;
+    if (okClock) {
+        const double t0 = clockTracer.toNs(pair[0].stamp), t1 = clockTracer.toNs(pair[1].stamp);
+        const double dt = t1 - t0;
+        // Margen de 1 µs por la resolución de la calibración
+        okClock = dt >= 19e6 && dt <= static_cast<double>(ns1 - ns0) + 1e3
+               && t0 >= static_cast<double>(ns0) - 1e3 && t1 <= static_cast<double>(ns1) + 1e3;
+        cout << "  " << fixed << setprecision(3) << dt * 1e-6 << " ms entre eventos (20 ms de espera)"
+             << "  " << (okClock ? "OK" : "FALLO") << "\n";
+    }
+    cout << "========================================\n\n";
+    ok = ok && okClock;
+
+    // ========== PRUEBA 4: EXPORTACIÓN A CHROME JSON ==========
+    cout << "========================================\n";
+    cout << "  EXPORTACIÓN A CHROME JSON\n";
+    cout << "========================================\n";
+
+    Tracer tracer(2, 256);
+    tracer.nameThread(0, "productor");
+    tracer.nameThread(1, "consumidor \"B\"");
+    tracer.nameTrack(0, "cálculo");
+    tracer.nameChannel(3, "A→B");
+    const uint64_t ticks = 20;
+    for (uint64_t k = 0; k < ticks; ++k) {
+        tracer.buffer(0).record(EventKind::Begin, 0, k);
+        tracer.buffer(0).record(EventKind::End, 0, k);
+        tracer.buffer(0).record(EventKind::Push, 3, k);
+        tracer.buffer(1).record(EventKind::Pop, 3, k);
+    }
+    tracer.buffer(0).record(EventKind::DeadlineMiss, 0, 5, 1500.0);
+    tracer.buffer(1).record(EventKind::GainChange, 0, 6, 2.5);
+    const size_t midway = tracer.collect();
+    ostringstream json;
+    tracer.writeChromeJson(json);
+    const string text = json.str();
+    bool okJson = midway == 4 * ticks + 2 && tracer.size() == 4 * ticks + 2 && tracer.dropped() == 0
+               && occurrences(text, "{") == occurrences(text, "}")
+               && occurrences(text, "\"ph\":\"M\"") == 2
+               && occurrences(text, "\"ph\":\"B\"") == ticks && occurrences(text, "\"ph\":\"E\"") == ticks
+               && occurrences(text, "\"ph\":\"s\"") == ticks && occurrences(text, "\"ph\":\"f\"") == ticks
+               && occurrences(text, "\"ph\":\"X\"") == 2 * ticks && occurrences(text, "\"ph\":\"i\"") == 2
+               && occurrences(text, "\"name\":\"A→B\"") == 4 * ticks
+               && occurrences(text, "\"name\":\"cálculo\"") == 2 * ticks
+               && text.find("\"consumidor \\\"B\\\"\"") != string::npos
+               && text.find("\"retraso_ns\":1500") != string::npos && text.find("\"Kp\":2.5") != string::npos
+               && text.find("\"id\":" + to_string((uint64_t(3) << 32) | 7)) != string::npos;
+    cout << "  " << tracer.size() << " eventos, " << text.size() << " bytes de JSON: " << (okJson ? "OK" : "FALLO") << "\n";
+
+    // JSON no admite nan ni inf: una señal divergida no debe invalidar la traza
+    Tracer nonFinite(1, 16);
+    nonFinite.buffer(0).record(EventKind::Instant, 0, 0, numeric_limits<double>::quiet_NaN());
+    nonFinite.buffer(0).record(EventKind::GainChange, 0, 1, numeric_limits<double>::infinity());
+    nonFinite.buffer(0).record(EventKind::DeadlineMiss, 0, 2, -numeric_limits<double>::infinity());
+    ostringstream nfJson;
+    nonFinite.writeChromeJson(nfJson);
+    const string nf = nfJson.str();
+    const bool okNonFinite = nf.find("\"valor\":null") != string::npos && nf.find("\"Kp\":null") != string::npos
+                          && nf.find("\"retraso_ns\":null") != string::npos
+                          && nf.find(":nan") == string::npos && nf.find(":inf") == string::npos
+                          && nf.find(":-inf") == string::npos;
+    cout << "  Valores no finitos como null: " << (okNonFinite ? "OK" : "FALLO") << "\n";
+
+    bool okErr = false;
+    try {
+        tracer.save("/nonexistent/traza.json");
+    } catch (const runtime_error& ex) {
+        okErr = true;
+        cout << "  Excepción: " << ex.what() << "\n";
+    }
+    tracer.clear();
+    okErr = okErr && tracer.size() == 0 && tracer.collect() == 0;
+    cout << "  Error de escritura y clear(): " << (okErr ? "OK" : "FALLO") << "\n";
+    cout << "========================================\n\n";
+    ok = ok && okJson && okNonFinite && okErr;
+
+    if (!ok) {
+        cout << "Pruebas FALLIDAS.\n\n";
+        return 1;
+    }
+
+    cout << "Pruebas completadas exitosamente.\n\n";
+
+    return 0;
+}
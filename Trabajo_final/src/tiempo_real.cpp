@@ -0,0 +1,266 @@
+/**
+ * @file tiempo_real.cpp
+ * @brief Endurecimiento de los hilos de control y vigilancia de reservas de memoria
+ */
+
+#include "tiempo_real.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// La sustitución de malloc se apoya en los puntos de entrada __libc_* de glibc
+#if defined(TIEMPO_REAL_ALLOC_TRIPWIRE) && defined(__GLIBC__)
+#define TIEMPO_REAL_TRIPWIRE_INSTALLED 1
+#include <execinfo.h>
+#else
+#define TIEMPO_REAL_TRIPWIRE_INSTALLED 0
+#endif
+
+namespace TiempoReal {
+
+namespace {
+
+/// Marcos de pila guardados por reserva detectada
+const std::size_t kMaxFrames = 32;
+
+/// Reservas que Tripwire::Report escribe en stderr (el resto sólo se cuentan)
+const std::size_t kMaxReports = 8;
+
+/// Bytes de pila que toca cada nivel de touchStack()
+const std::size_t kStackChunk = 16384;
+
+// Inicialización constante: leerlas desde malloc no reserva nada
+thread_local Tripwire t_action = Tripwire::Off;   ///< Vigilancia del hilo actual
+#if TIEMPO_REAL_TRIPWIRE_INSTALLED
+thread_local bool t_inside = false;                ///< El hilo está informando de una reserva
+#endif
+
+std::atomic<std::size_t> g_trips(0);       ///< Reservas detectadas en el proceso
+std::atomic<std::size_t> g_reported(0);    ///< Reservas escritas en stderr
+std::atomic<bool> g_captured(false);       ///< g_frames ya tiene la primera pila
+std::atomic<std::size_t> g_depth(0);       ///< Marcos válidos de g_frames
+void* g_frames[kMaxFrames];                ///< Pila de la primera reserva detectada
+
+/**
+ * @brief Toca chunks tramos de kStackChunk bytes de pila, uno por nivel
+ *
+ * La lectura tras la llamada impide la optimización de llamada final, que
+ * reutilizaría el mismo marco.
+ */
+__attribute__((noinline)) void touchStack(std::size_t chunks) {
+    volatile char page[kStackChunk];
+    for (std::size_t i = 0; i < kStackChunk; i += 4096) {
+        page[i] = 0;
+    }
+    if (chunks > 1) {
+        touchStack(chunks - 1);
+    }
+    page[0] = page[0];
+}
+
+#if TIEMPO_REAL_TRIPWIRE_INSTALLED
+
+/** @brief Escribe en stderr sin stdio (que puede reservar) */
+void writeErr(const char* s, std::size_t n) {
+    while (n > 0) {
+        const ssize_t w = ::write(STDERR_FILENO, s, n);
+        if (w <= 0) {
+            return;
+        }
+        s += w;
+        n -= static_cast<std::size_t>(w);
+    }
+}
+
+void writeErr(const char* s) {
+    writeErr(s, std::strlen(s));
+}
+
+void writeErr(std::size_t v) {
+    char digits[24];
+    std::size_t n = 0;
+    do {
+        digits[sizeof(digits) - 1 - n++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    writeErr(digits + sizeof(digits) - n, n);
+}
+
+/**
+ * @brief Registra una reserva en un hilo vigilado y actúa según t_action
+ */
+void trip(std::size_t bytes) {
+    t_inside = true;
+    g_trips.fetch_add(1, std::memory_order_relaxed);
+    void* frames[kMaxFrames];
+    const int depth = backtrace(frames, static_cast<int>(kMaxFrames));
+    if (!g_captured.exchange(true, std::memory_order_acq_rel)) {
+        std::memcpy(g_frames, frames, static_cast<std::size_t>(depth) * sizeof(void*));
+        g_depth.store(static_cast<std::size_t>(depth), std::memory_order_release);
+    }
+    if (t_action != Tripwire::Count && g_reported.fetch_add(1, std::memory_order_relaxed) < kMaxReports) {
+        writeErr("AllocationTripwire: reserva de ");
+        writeErr(bytes);
+        writeErr(" bytes en un hilo de control:\n");
+        backtrace_symbols_fd(frames, depth, STDERR_FILENO);
+    }
+    if (t_action == Tripwire::Abort) {
+        std::abort();
+    }
+    t_inside = false;
+}
+
+inline void check(std::size_t bytes) {
+    if (t_action != Tripwire::Off && !t_inside) {
+        trip(bytes);
+    }
+}
+
+#endif
+
+} // namespace
+
+/*========================================================================*/
+/*                       VIGILANCIA DE RESERVAS                           */
+/*========================================================================*/
+
+bool AllocationTripwire::installed() {
+    return TIEMPO_REAL_TRIPWIRE_INSTALLED != 0;
+}
+
+void AllocationTripwire::arm(Tripwire action) {
+#if TIEMPO_REAL_TRIPWIRE_INSTALLED
+    // backtrace() carga libgcc la primera vez: mejor aquí que dentro de malloc
+    void* frame[1];
+    backtrace(frame, 1);
+#endif
+    t_action = action;
+}
+
+void AllocationTripwire::disarm() {
+    t_action = Tripwire::Off;
+}
+
+bool AllocationTripwire::armed() {
+    return t_action != Tripwire::Off;
+}
+
+std::size_t AllocationTripwire::trips() {
+    return g_trips.load(std::memory_order_relaxed);
+}
+
+std::size_t AllocationTripwire::firstTrip(void** frames, std::size_t n) {
+    if (!g_captured.load(std::memory_order_acquire)) {
+        return 0;
+    }
+    const std::size_t depth = std::min(n, g_depth.load(std::memory_order_acquire));
+    std::copy(g_frames, g_frames + depth, frames);
+    return depth;
+}
+
+/*========================================================================*/
+/*                     ENDURECIMIENTO DE LOS HILOS                        */
+/*========================================================================*/
+
+namespace detail {
+
+bool lockMemory() {
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0;
+}
+
+unsigned configureThread(const RuntimeConfig& config, std::size_t index) {
+    unsigned rejected = 0;
+    if (index < config.cpus.size() && config.cpus[index] >= 0) {
+        const int cpu = config.cpus[index];
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (cpu >= CPU_SETSIZE) {
+            rejected |= kRejectedAffinity;
+        } else {
+            CPU_SET(cpu, &set);
+            if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+                rejected |= kRejectedAffinity;
+            }
+        }
+    }
+    if (config.priority > 0) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = config.priority;
+        if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0) {
+            rejected |= kRejectedPriority;
+        }
+    }
+    if (config.stackPrefault > 0) {
+        touchStack((config.stackPrefault + kStackChunk - 1) / kStackChunk);
+    }
+    return rejected;
+}
+
+} // namespace detail
+
+} // namespace TiempoReal
+
+/*========================================================================*/
+/*                     SUSTITUCIÓN DE malloc (glibc)                      */
+/*========================================================================*/
+
+#if TIEMPO_REAL_TRIPWIRE_INSTALLED
+
+// operator new de libstdc++ llama a malloc: basta sustituir la familia de
+// malloc para vigilar también new, std::vector, std::string...
+extern "C" {
+
+void* __libc_malloc(std::size_t size);
+void* __libc_calloc(std::size_t n, std::size_t size);
+void* __libc_realloc(void* p, std::size_t size);
+void* __libc_memalign(std::size_t alignment, std::size_t size);
+void __libc_free(void* p);
+
+void* malloc(std::size_t size) noexcept {
+    TiempoReal::check(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(std::size_t n, std::size_t size) noexcept {
+    TiempoReal::check(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* p, std::size_t size) noexcept {
+    TiempoReal::check(size);
+    return __libc_realloc(p, size);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    TiempoReal::check(size);
+    void* p = __libc_memalign(alignment, size);
+    if (p == nullptr) {
+        return ENOMEM;
+    }
+    *out = p;
+    return 0;
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    TiempoReal::check(size);
+    return __libc_memalign(alignment, size);
+}
+
+void free(void* p) noexcept {
+    __libc_free(p);
+}
+
+} // extern "C"
+
+#endif
@@ -0,0 +1,271 @@
+/**
+ * @file traza.cpp
+ * @brief Implementación de los buffers de trazas y de la exportación a Chrome JSON
+ */
+
+#include "traza.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+#include <unistd.h>
+
+namespace Traza {
+
+namespace {
+
+std::size_t roundUpPow2(std::size_t n) {
+    std::size_t p = 1;
+    while (p < n) {
+        p <<= 1;
+    }
+    return p;
+}
+
+/** @brief Cadena JSON entre comillas */
+void writeString(std::ostream& os, const std::string& s) {
+    os << '"';
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const unsigned char c = static_cast<unsigned char>(s[i]);
+        if (c == '"' || c == '\\') {
+            os << '\\' << s[i];
+        } else if (c < 0x20) {
+            char hex[8];
+            std::snprintf(hex, sizeof(hex), "\\u%04x", c);
+            os << hex;
+        } else {
+            os << s[i];
+        }
+    }
+    os << '"';
+}
+
+/** @brief Nombre registrado o "prefijo id" si no lo hay */
+std::string nameOf(const std::vector<std::string>& names, std::size_t id, const char* prefix) {
+    if (id < names.size() && !names[id].empty()) {
+        return names[id];
+    }
+    return std::string(prefix) + " " + std::to_string(id);
+}
+
+void setName(std::vector<std::string>& names, std::size_t id, const std::string& name) {
+    if (names.size() <= id) {
+        names.resize(id + 1);
+    }
+    names[id] = name;
+}
+
+/** @brief Número JSON; NaN e infinitos, que JSON no admite, se escriben como null */
+void writeValue(std::ostream& os, double v) {
+    if (std::isfinite(v)) {
+        os << v;
+    } else {
+        os << "null";
+    }
+}
+
+/** @brief Instante en µs con resolución de ns, como lo espera el formato de Chrome */
+void writeTs(std::ostream& os, double ns) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", ns * 1e-3);
+    os << buf;
+}
+
+} // namespace
+
+/*========================================================================*/
+/*                              TRACEBUFFER                               */
+/*========================================================================*/
+
+TraceBuffer::TraceBuffer(std::size_t capacity)
+    : mask_(0), events_(), head_(0), tailCache_(0), dropped_(0), tail_(0) {
+    if (capacity == 0) {
+        throw std::invalid_argument("TraceBuffer: la capacidad debe ser > 0");
+    }
+    const std::size_t n = roundUpPow2(capacity);
+    mask_ = n - 1;
+    events_.reset(new Event[n]());
+}
+
+std::size_t TraceBuffer::drain(std::vector<Event>& out) {
+    const std::uint64_t t = tail_.load(std::memory_order_relaxed);
+    const std::uint64_t h = head_.load(std::memory_order_acquire);
+    for (std::uint64_t i = t; i != h; ++i) {
+        out.push_back(events_[i & mask_]);
+    }
+    tail_.store(h, std::memory_order_release);
+    return static_cast<std::size_t>(h - t);
+}
+
+void TraceBuffer::clear() {
+    tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+    dropped_.store(0, std::memory_order_relaxed);
+}
+
+/*========================================================================*/
+/*                                TRACER                                  */
+/*========================================================================*/
+
+Tracer::Tracer(std::size_t threads, std::size_t capacity)
+    : buffers_(), collected_(threads), threadNames_(threads), trackNames_(), channelNames_(),
+      stamp0_(Clock::now()), ns0_(Clock::steadyNs()), nsPerTick_(1.0) {
+    if (threads == 0) {
+        throw std::invalid_argument("Tracer: se necesita al menos un hilo");
+    }
+    for (std::size_t i = 0; i < threads; ++i) {
+        buffers_.push_back(std::unique_ptr<TraceBuffer>(new TraceBuffer(capacity)));
+    }
+}
+
+void Tracer::nameThread(std::size_t i, const std::string& name) {
+    setName(threadNames_, i, name);
+}
+
+void Tracer::nameTrack(std::uint16_t id, const std::string& name) {
+    setName(trackNames_, id, name);
+}
+
+void Tracer::nameChannel(std::uint16_t id, const std::string& name) {
+    setName(channelNames_, id, name);
+}
+
+std::size_t Tracer::collect() {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < buffers_.size(); ++i) {
+        n += buffers_[i]->drain(collected_[i]);
+    }
+    return n;
+}
+
+void Tracer::clear() {
+    for (std::size_t i = 0; i < buffers_.size(); ++i) {
+        buffers_[i]->clear();
+        collected_[i].clear();
+    }
+}
+
+std::size_t Tracer::size() const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < collected_.size(); ++i) {
+        n += collected_[i].size();
+    }
+    return n;
+}
+
+std::size_t Tracer::dropped() const {
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < buffers_.size(); ++i) {
+        n += buffers_[i]->dropped();
+    }
+    return n;
+}
+
+void Tracer::calibrate() {
+#if TRAZA_HAVE_TSC
+    // Pendiente TSC/steady_clock medida desde la construcción
+    const std::uint64_t stamp = Clock::now();
+    const std::uint64_t ns = Clock::steadyNs();
+    if (stamp > stamp0_ && ns > ns0_) {
+        nsPerTick_ = static_cast<double>(ns - ns0_) / static_cast<double>(stamp - stamp0_);
+    }
+#endif
+}
+
+double Tracer::toNs(std::uint64_t stamp) const {
+    const double ticks = stamp >= stamp0_ ? static_cast<double>(stamp - stamp0_)
+                                          : -static_cast<double>(stamp0_ - stamp);
+    return static_cast<double>(ns0_) + ticks * nsPerTick_;
+}
+
+void Tracer::writeChromeJson(std::ostream& os) {
+    collect();
+    calibrate();
+    const long pid = static_cast<long>(getpid());
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (std::size_t t = 0; t < collected_.size(); ++t) {
+        os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid
+           << ",\"tid\":" << t << ",\"args\":{\"name\":";
+        writeString(os, nameOf(threadNames_, t, "hilo"));
+        os << "}}";
+        first = false;
+        const std::vector<Event>& events = collected_[t];
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const Event& e = events[i];
+            const double ns = toNs(e.stamp);
+            const bool channel = e.kind == EventKind::Push || e.kind == EventKind::Pop;
+            os << ",\n{\"name\":";
+            switch (e.kind) {
+            case EventKind::DeadlineMiss:
+                writeString(os, "plazo perdido");
+                break;
+            case EventKind::GainChange:
+                writeString(os, "ganancias");
+                break;
+            default:
+                writeString(os, channel ? nameOf(channelNames_, e.id, "canal") : nameOf(trackNames_, e.id, "pista"));
+                break;
+            }
+            os << ",\"pid\":" << pid << ",\"tid\":" << t << ",\"ts\":";
+            writeTs(os, ns);
+            switch (e.kind) {
+            case EventKind::Begin:
+                os << ",\"ph\":\"B\",\"cat\":\"tick\",\"args\":{\"k\":" << e.k << "}}";
+                break;
+            case EventKind::End:
+                os << ",\"ph\":\"E\",\"cat\":\"tick\"}";
+                break;
+            case EventKind::Push:
+            case EventKind::Pop: {
+                // Tramo de duración nula con su extremo de flecha: Perfetto ata los flujos a tramos
+                const std::uint64_t flow = (static_cast<std::uint64_t>(e.id) << 32) | (e.k & 0xFFFFFFFFu);
+                const bool push = e.kind == EventKind::Push;
+                os << ",\"ph\":\"X\",\"dur\":0,\"cat\":\"canal\",\"args\":{\"k\":" << e.k
+                   << ",\"op\":\"" << (push ? "push" : "pop") << "\"}}";
+                os << ",\n{\"name\":";
+                writeString(os, nameOf(channelNames_, e.id, "canal"));
+                os << ",\"pid\":" << pid << ",\"tid\":" << t << ",\"ts\":";
+                writeTs(os, ns);
+                os << ",\"ph\":\"" << (push ? "s" : "f") << "\",\"bp\":\"e\",\"cat\":\"canal\",\"id\":" << flow << "}";
+                break;
+            }
+            case EventKind::DeadlineMiss:
+                os << ",\"ph\":\"i\",\"s\":\"t\",\"cat\":\"plazo\",\"args\":{\"k\":" << e.k
+                   << ",\"retraso_ns\":";
+                writeValue(os, e.value);
+                os << "}}";
+                break;
+            case EventKind::GainChange:
+                os << ",\"ph\":\"i\",\"s\":\"t\",\"cat\":\"control\",\"args\":{\"k\":" << e.k
+                   << ",\"Kp\":";
+                writeValue(os, e.value);
+                os << "}}";
+                break;
+            case EventKind::Instant:
+            default:
+                os << ",\"ph\":\"i\",\"s\":\"t\",\"cat\":\"marca\",\"args\":{\"k\":" << e.k
+                   << ",\"valor\":";
+                writeValue(os, e.value);
+                os << "}}";
+                break;
+            }
+        }
+    }
+    os << "\n]}\n";
+}
+
+void Tracer::save(const std::string& path) {
+    std::ofstream os(path.c_str(), std::ios::trunc);
+    if (!os) {
+        throw std::runtime_error("Tracer: no se pudo crear '" + path + "'");
+    }
+    writeChromeJson(os);
+    os.flush();
+    if (!os) {
+        throw std::runtime_error("Tracer: no se pudo escribir '" + path + "'");
+    }
+}
+
+} // namespace Traza